@@ -1,6 +1,7 @@
 #pragma once
 
 #include <BsCorePrerequisites.h>
+#include <AI/TimerWheel.hpp>
 #include <AI/WalkMode.hpp>
 #include <AI/WeaponMode.hpp>
 #include <Math/BsVector3.h>
@@ -20,9 +21,6 @@ namespace REGoth
 
   namespace AI
   {
-    struct EventMessage;
-    using SharedEMessage = bs::SPtr<EventMessage>;
-
     enum class EventMessageType
     {
       Event,
@@ -48,8 +46,6 @@ namespace REGoth
      */
     struct EventMessage : public bs::IReflectable
     {
-      using SharedEMessage = std::shared_ptr<EventMessage>;
-
       EventMessage()
       {
         subType        = 0;
@@ -118,7 +114,7 @@ namespace REGoth
       /**
        * External callbacks to trigger if this message gets processed.
        */
-      bs::Event<void(SharedEMessage)> onMessageDone;
+      bs::Event<void(EventMessage&)> onMessageDone;
 
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(EventMessage)
     };
@@ -333,6 +329,7 @@ namespace REGoth
         ST_SetNpcsToState,
         ST_SetTime,
         ST_ApplyTimedOverlay,
+        ST_Perception,
         ST_StateMax
       } ConversationMessage;
 
@@ -374,11 +371,30 @@ namespace REGoth
        */
       float waitTime = 0.0f;
 
+      /**
+       * If this is a wait-message, the play time in seconds at which the wait ends. Set once the
+       * message became active, negative before. Saved, so the wait goes on after loading
+       * instead of starting over.
+       */
+      float waitDeadlineSeconds = -1.0f;
+
+      /**
+       * If this is a wait-message, the timer started once the message became active. Not saved,
+       * it is started again from waitDeadlineSeconds after loading.
+       */
+      TimerHandle waitTimer;
+
       /**
        * Waypoint name to got to, in case the state needs that
        */
       bs::String wpname;
 
+      /**
+       * If this is a perception-message, this is the script function reacting to it, e.g.
+       * `B_ASSESSPLAYER`.
+       */
+      Scripting::SymbolIndex perceptionFunction = Scripting::SYMBOL_INDEX_INVALID;
+
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(StateMessage)
     };
 
@@ -13,6 +13,10 @@ static const float MAX_HEIGHT_DIFFERENCE_TO_REACH_POSITION   = 2.0f;   // Meters
 static const float MAX_TARGET_ENTITY_MOVEMENT_BEFORE_REROUTE = 5.0f;   // Meters
 static const float MAX_POINT_DISTANCE_FOR_CLEANUP            = 5.0f;   // Meters
 
+// How often to check whether a route is outdated. A target would have to move quite fast to
+// get far away within that time.
+static const bs::UINT32 RE_ROUTE_CHECK_INTERVAL_TICKS = 10;
+
 namespace REGoth
 {
   namespace AI
@@ -102,7 +106,7 @@ namespace REGoth
       if (!mActiveRoute.targetEntity)
 
         // FIXME: This goes wrong if an npc ever gets stuck or the heights don't match
-        return mActiveRoute.positionsToGo.empty();
+        return !mActiveRoute.hasPositionsToGo();
 
       return hasTargetEntityBeenReached(positionNow);
     }
@@ -124,9 +128,9 @@ namespace REGoth
 
       if (hasNextRouteTargetBeenReached(positionNow))
       {
-        if (!mActiveRoute.positionsToGo.empty())
+        if (mActiveRoute.hasPositionsToGo())
         {
-          mActiveRoute.positionsToGo.pop_front();
+          mActiveRoute.nextPosition++;
         }
       }
 
@@ -136,7 +140,7 @@ namespace REGoth
         return inst;
       }
 
-      if (shouldReRoute(positionNow))
+      if (isReRouteCheckDue() && shouldReRoute(positionNow))
       {
         if (isTargetAnEntity())
         {
@@ -144,8 +148,11 @@ namespace REGoth
         }
         else
         {
-          assert(!mActiveRoute.positionsToGo.empty());
-          startNewRouteTo(positionNow, mActiveRoute.positionsToGo.back());
+          assert(mActiveRoute.hasPositionsToGo());
+
+          // Copy, since the route is cleared first
+          bs::Vector3 target = mActiveRoute.lastPositionToGo();
+          startNewRouteTo(positionNow, target);
         }
       }
 
@@ -156,12 +163,12 @@ namespace REGoth
 
     bool Pathfinder::hasNextRouteTargetBeenReached(const bs::Vector3& positionNow) const
     {
-      if (mActiveRoute.positionsToGo.empty())
+      if (!mActiveRoute.hasPositionsToGo())
       {
         return isTargetAnEntity() && hasTargetEntityBeenReached(positionNow);
       }
 
-      return isTargetReachedByPosition(positionNow, mActiveRoute.positionsToGo.front());
+      return isTargetReachedByPosition(positionNow, mActiveRoute.nextPositionToGo());
     }
 
     bool Pathfinder::hasTargetEntityBeenReached(const bs::Vector3& positionNow) const
@@ -200,13 +207,13 @@ namespace REGoth
         return targetEntityPosition;
       }
 
-      if (mActiveRoute.positionsToGo.empty())
+      if (!mActiveRoute.hasPositionsToGo())
       {
         return targetEntityPosition;
       }
       else
       {
-        return mActiveRoute.positionsToGo.front();
+        return mActiveRoute.nextPositionToGo();
       }
     }
 
@@ -219,9 +226,9 @@ namespace REGoth
 
       // startNewRouteTo appends the position to go to if it's off the waynet, we can't have that
       // when the target could be moving
-      if (!mActiveRoute.positionsToGo.empty())
+      if (mActiveRoute.hasPositionsToGo())
       {
-        mActiveRoute.positionsToGo.pop_back();
+        mActiveRoute.positions.pop_back();
       }
 
       mActiveRoute.targetEntity = entity;
@@ -232,16 +239,17 @@ namespace REGoth
 
     void Pathfinder::startNewRouteTo(const bs::Vector3& positionNow, const bs::Vector3& position)
     {
-      mActiveRoute.positionsToGo.clear();
-      mActiveRoute.lastKnownPosition   = positionNow;
-      mActiveRoute.targetEntity        = {};
-      mActiveRoute.isTargetUnreachable = false;
+      mActiveRoute.clearPositions();
+      mActiveRoute.lastKnownPosition      = positionNow;
+      mActiveRoute.targetEntity           = {};
+      mActiveRoute.isTargetUnreachable    = false;
+      mActiveRoute.ticksUntilReRouteCheck = RE_ROUTE_CHECK_INTERVAL_TICKS;
 
       if (isTargetReachedByPosition(positionNow, position)) return;
 
       if (canDirectlyMovetoLocation(positionNow, position))
       {
-        mActiveRoute.positionsToGo.push_back(position);
+        mActiveRoute.positions.push_back(position);
         return;
       }
 
@@ -266,17 +274,16 @@ namespace REGoth
       {
         const bs::Vector3& wpPosition = wp->SO()->getTransform().pos();
 
-        mActiveRoute.positionsToGo.push_back(wpPosition);
+        mActiveRoute.positions.push_back(wpPosition);
       }
 
       bool isDestinationOffWaynet = false;
 
-      if (mActiveRoute.positionsToGo.empty())
+      if (!mActiveRoute.hasPositionsToGo())
       {
         isDestinationOffWaynet = true;
       }
-
-      if (!isTargetReachedByPosition(mActiveRoute.positionsToGo.back(), position))
+      else if (!isTargetReachedByPosition(mActiveRoute.lastPositionToGo(), position))
       {
         isDestinationOffWaynet = true;
       }
@@ -284,7 +291,7 @@ namespace REGoth
       // If the last position is off the waynet, add it as explicit position
       if (isDestinationOffWaynet)
       {
-        mActiveRoute.positionsToGo.push_back(position);
+        mActiveRoute.positions.push_back(position);
       }
 
       cleanupRoute();
@@ -340,56 +347,88 @@ namespace REGoth
       //          There is also a maximum distance these point can be apart from each other, so NPCs
       //          would still respect paths on the worldmesh.
 
-      if (mActiveRoute.positionsToGo.size() < 3) return;
+      auto& positions = mActiveRoute.positions;
+
+      if (positions.size() - mActiveRoute.nextPosition < 3) return;
 
       bool removed;
 
       do
       {
         removed = false;
-        for (auto it = mActiveRoute.positionsToGo.begin(); it != mActiveRoute.positionsToGo.end();
-             it++)
+
+        // Removed positions are skipped by moving the kept ones to the front, like
+        // std::remove_if would, so each pass moves every position at most once.
+        bs::UINT32 numKept = mActiveRoute.nextPosition;
+        bs::UINT32 end     = (bs::UINT32)positions.size();
+
+        for (bs::UINT32 i = mActiveRoute.nextPosition; i < end; i++)
         {
-          if (canRoutePositionBeRemoved(it))
+          // Look at the route as it is after the removals so far in this pass
+          bool isRemovable = numKept > mActiveRoute.nextPosition && i + 1 < end &&
+                             canRoutePositionBeRemoved(positions[numKept - 1], positions[i],
+                                                       positions[i + 1]);
+
+          // Like erasing from a list while iterating, the position after a removed one is
+          // always kept during this pass
+          if (isRemovable)
           {
-            it      = mActiveRoute.positionsToGo.erase(it);
             removed = true;
+
+            positions[numKept] = positions[i + 1];
+            numKept++;
+            i++;
+          }
+          else
+          {
+            positions[numKept] = positions[i];
+            numKept++;
           }
         }
+
+        while (positions.size() > numKept)
+        {
+          positions.pop_back();
+        }
       } while (removed);
     }
 
-    bool Pathfinder::canRoutePositionBeRemoved(std::list<bs::Vector3>::iterator it)
+    bool Pathfinder::canRoutePositionBeRemoved(const bs::Vector3& prev, const bs::Vector3& it,
+                                               const bs::Vector3& next) const
     {
-      if (it == mActiveRoute.positionsToGo.begin()) return false;
-
-      if (it == mActiveRoute.positionsToGo.end()) return false;
-
-      if (it == std::prev(mActiveRoute.positionsToGo.end())) return false;
-
-      auto prev = std::prev(it);
-      auto next = std::next(it);
-
-      float distToPrevSq    = ((*it) - (*prev)).squaredLength();
+      float distToPrevSq    = (it - prev).squaredLength();
       float maxDistToPrevSq = MAX_POINT_DISTANCE_FOR_CLEANUP * MAX_POINT_DISTANCE_FOR_CLEANUP;
 
       // Only remove points which aren't too far appart
       if (distToPrevSq > maxDistToPrevSq) return false;
 
       const bool samePosition =
-          isTargetReachedByPosition(*prev, *it) || isTargetReachedByPosition(*next, *it);
+          isTargetReachedByPosition(prev, it) || isTargetReachedByPosition(next, it);
 
       if (samePosition) return true;
 
-      const bool detour = isTargetReachedByPosition(*prev, *next);
+      const bool detour = isTargetReachedByPosition(prev, next);
 
       if (detour) return true;
 
-      bool canMoveDirectlytoNext = canDirectlyMovetoLocation(*prev, *next);
+      bool canMoveDirectlytoNext = canDirectlyMovetoLocation(prev, next);
 
       return canMoveDirectlytoNext;
     }
 
+    bool Pathfinder::isReRouteCheckDue()
+    {
+      if (mActiveRoute.ticksUntilReRouteCheck > 0)
+      {
+        mActiveRoute.ticksUntilReRouteCheck--;
+        return false;
+      }
+
+      mActiveRoute.ticksUntilReRouteCheck = RE_ROUTE_CHECK_INTERVAL_TICKS;
+
+      return true;
+    }
+
     bool Pathfinder::shouldReRoute(const bs::Vector3& positionNow) const
     {
       // FIXME: canDirectlyMovetoLocation fails if the npc should move up/down a (walkable) hill like
@@ -410,7 +449,7 @@ namespace REGoth
 
       if (!isTargetAnEntity())
       {
-        if (mActiveRoute.positionsToGo.empty())
+        if (!mActiveRoute.hasPositionsToGo())
         {
           return false;
         }
@@ -422,7 +461,7 @@ namespace REGoth
         return false;
       }
 
-      if (mActiveRoute.positionsToGo.empty())
+      if (!mActiveRoute.hasPositionsToGo())
       {
         if (!canDirectlyMovetoLocation(positionNow, getTargetEntityPosition()))
         {
@@ -2,6 +2,7 @@
 #include <BsCorePrerequisites.h>
 #include <Math/BsVector3.h>
 #include <RTTI/RTTIUtil.hpp>
+#include <Utility/BsSmallVector.h>
 
 namespace bs
 {
@@ -40,11 +41,58 @@ namespace REGoth
         float maxSlopeAngle;
       };
 
+      /**
+       * Number of route positions which fit into a Route without allocating memory. Longer
+       * routes still work, they just move to the heap.
+       */
+      static constexpr bs::UINT32 NUM_INLINE_ROUTE_POSITIONS = 16;
+
       struct Route
       {
         bs::Vector3 lastKnownPosition;
 
-        bs::List<bs::Vector3> positionsToGo;
+        // All positions of the route, including the ones already passed, see nextPosition.
+        bs::SmallVector<bs::Vector3, NUM_INLINE_ROUTE_POSITIONS> positions;
+
+        // Index into `positions` of the position to go to next. All positions before have
+        // already been reached.
+        bs::UINT32 nextPosition = 0;
+
+        // Ticks left until the next check whether the route should be redone, see shouldReRoute().
+        bs::UINT32 ticksUntilReRouteCheck = 0;
+
+        /**
+         * @return Whether there are positions left to go to.
+         */
+        bool hasPositionsToGo() const
+        {
+          return nextPosition < positions.size();
+        }
+
+        /**
+         * @return The position to go to next. Only valid if hasPositionsToGo().
+         */
+        const bs::Vector3& nextPositionToGo() const
+        {
+          return positions[nextPosition];
+        }
+
+        /**
+         * @return The last position of the route. Only valid if hasPositionsToGo().
+         */
+        const bs::Vector3& lastPositionToGo() const
+        {
+          return positions.back();
+        }
+
+        /**
+         * Removes all positions, keeping the memory for the next route.
+         */
+        void clearPositions()
+        {
+          positions.clear();
+          nextPosition = 0;
+        }
 
         // If this is valid, the Creature will move to this entity, once it has been to
         // all positions it had to go to or has a direct line of sight to it
@@ -92,6 +140,15 @@ namespace REGoth
         return mUserConfiguration;
       }
 
+      /**
+       * Sets the waynet routes are searched on. A route which is already active stays valid,
+       * as long as the new waynet was imported from the same ZEN.
+       */
+      void setWaynet(HWaynet waynet)
+      {
+        mWaynet = waynet;
+      }
+
       /**
        * @return Whether the Pathfinder thinks the given targetposition has been reached
        */
@@ -190,9 +247,18 @@ namespace REGoth
       void cleanupRoute();
 
       /**
-       * @return Whether the route-position on the given iterator can be removed. See cleanupRoute().
+       * @return Whether the route-position `it` between the positions `prev` and `next` can be
+       *         removed. See cleanupRoute().
+       */
+      bool canRoutePositionBeRemoved(const bs::Vector3& prev, const bs::Vector3& it,
+                                     const bs::Vector3& next) const;
+
+      /**
+       * Checks shouldReRoute() every couple of ticks only, since it may need raycasts.
+       *
+       * @return Whether the active route should be redone now.
        */
-      bool canRoutePositionBeRemoved(std::list<bs::Vector3>::iterator it);
+      bool isReRouteCheckDue();
 
       /**
        * @return Whether the currently active route is considered not up-to-date and should be
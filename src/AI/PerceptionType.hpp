@@ -0,0 +1,66 @@
+#pragma once
+#include <BsPrerequisites.h>
+
+namespace REGoth
+{
+  namespace AI
+  {
+    /**
+     * Kinds of things a character can perceive. Values match the `PERC_*`-constants of the
+     * scripts, which pass them to externals like `Npc_PercEnable()`.
+     *
+     * *Active* perceptions are sensed by the character itself, see CharacterPerception.
+     * All others are *passive* and are sent to nearby characters when something happens,
+     * see `Npc_SendPassivePerc()`.
+     */
+    enum class PerceptionType : bs::INT32
+    {
+      // Active
+      AssessPlayer  = 1,
+      AssessEnemy   = 2,
+      AssessFighter = 3,
+      AssessBody    = 4,
+      AssessItem    = 5,
+
+      // Passive
+      AssessMurder       = 6,
+      AssessDefeat       = 7,
+      AssessDamage       = 8,
+      AssessOthersDamage = 9,
+      AssessThreat       = 10,
+      AssessRemoveWeapon = 11,
+      ObserveIntruder    = 12,
+      AssessFightSound   = 13,
+      AssessQuietSound   = 14,
+      AssessWarn         = 15,
+      CatchThief         = 16,
+      AssessTheft        = 17,
+      AssessCall         = 18,
+      AssessTalk         = 19,
+      AssessGivenItem    = 20,
+      AssessFakeGuild    = 21,
+      MoveMob            = 22,
+      MoveNpc            = 23,
+      DrawWeapon         = 24,
+      ObserveSuspect     = 25,
+      NpcCommand         = 26,
+      AssessMagic        = 27,
+      AssessStopMagic    = 28,
+      AssessCaster       = 29,
+      AssessSurprise     = 30,
+      AssessEnterRoom    = 31,
+      AssessUseMob       = 32,
+    };
+
+    /**
+     * Upper bound of the values in PerceptionType, for sizing lookup tables.
+     */
+    constexpr bs::UINT32 NUM_PERCEPTION_TYPES = 33;
+
+    /**
+     * Seconds between two checks for active perceptions, until the scripts set a different
+     * interval via `Npc_SetPercTime()`.
+     */
+    constexpr float DEFAULT_PERCEPTION_INTERVAL_SECONDS = 5.0f;
+  }  // namespace AI
+}  // namespace REGoth
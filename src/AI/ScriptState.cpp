@@ -7,6 +7,7 @@
 #include <components/GameClock.hpp>
 #include <components/GameWorld.hpp>
 #include <scripting/ScriptVMForGameWorld.hpp>
+#include <scripting/daedalus/DaedalusExecutionContext.hpp>
 
 namespace REGoth
 {
@@ -126,46 +127,29 @@ namespace REGoth
       mCurrentState.isRoutineState = oldIsRoutineState;
     }
 
+    void ScriptState::runInstruction(Scripting::SymbolIndex instruction)
+    {
+      bool oldIsRoutineState       = mCurrentState.isRoutineState;
+      mCurrentState.isRoutineState = false;
+
+      scriptVM().runFunctionOnSelf(instruction, mHostCharacter);
+
+      mCurrentState.isRoutineState = oldIsRoutineState;
+    }
+
     void ScriptState::fillStateScriptFunctions(AIState& state)
     {
-      const bs::String end       = state.name + "_END";
-      const bs::String loop      = state.name + "_LOOP";
-      const bs::String interrupt = state.name + "_INTERRUPT";
-      const auto& symbols        = scriptVM().scriptSymbolsConst();
+      const auto& symbols = scriptVM().scriptSymbolsConst();
 
       // No check whether this exists here, let getSymbol throw if the main-function does not exist
       mNextState.symIndex = symbols.getSymbol<Scripting::SymbolScriptFunction>(state.name).index;
 
-      // End, Loop and Interrupt are optional
-      if (symbols.hasSymbolWithName(end))
-      {
-        const auto& symbol = symbols.getSymbol<Scripting::SymbolScriptFunction>(end);
-        mNextState.symEnd  = symbol.index;
-      }
-      else
-      {
-        mNextState.symEnd = Scripting::SYMBOL_INDEX_INVALID;
-      }
+      // End, Loop and Interrupt are optional and invalid if they don't exist
+      const auto& functions = scriptVM().findStateFunctions(mNextState.symIndex);
 
-      if (symbols.hasSymbolWithName(loop))
-      {
-        const auto& symbol = symbols.getSymbol<Scripting::SymbolScriptFunction>(loop);
-        mNextState.symLoop = symbol.index;
-      }
-      else
-      {
-        mNextState.symLoop = Scripting::SYMBOL_INDEX_INVALID;
-      }
-
-      if (symbols.hasSymbolWithName(interrupt))
-      {
-        const auto& symbol      = symbols.getSymbol<Scripting::SymbolScriptFunction>(interrupt);
-        mNextState.symInterrupt = symbol.index;
-      }
-      else
-      {
-        mNextState.symInterrupt = Scripting::SYMBOL_INDEX_INVALID;
-      }
+      mNextState.symEnd       = functions.end;
+      mNextState.symLoop      = functions.loop;
+      mNextState.symInterrupt = functions.interrupt;
     }
 
     bool ScriptState::applyStateChange()
@@ -197,21 +181,36 @@ namespace REGoth
 
     bool ScriptState::doAIState(float deltaTime)
     {
+      ConcurrentLoopResult concurrentResult = mConcurrentLoopResult;
+      mConcurrentLoopResult                 = ConcurrentLoopResult();
+
+      // The loop function has already been run on a worker thread, which also added the time.
+      // Its side effects might have changed the state since, in which case the result is void.
+      if (concurrentResult.hasResult)
+      {
+        if (mCurrentState.isValid && mCurrentState.phase == AIState::Phase::Loop &&
+            mCurrentState.symLoop == concurrentResult.symLoop)
+        {
+          // Check if we're done and remove the state in the next frame
+          if (concurrentResult.isDone)
+          {
+            mCurrentState.phase = AIState::Phase::End;
+          }
+        }
+
+        return true;
+      }
+
       // Increase time this state is already running
       if (mCurrentState.isValid && mCurrentState.phase == AIState::Phase::Loop)
       {
         mCurrentState.timeRunning += deltaTime;
       }
 
-      if (isInRoutine())
+      // The ingame timer tells us when the time has left the range of the active task
+      if (mRoutine.isBoundaryReached && isInRoutine())
       {
-        bs::INT32 hour   = mWorld->gameclock()->getHour();
-        bs::INT32 minute = mWorld->gameclock()->getMinute();
-
-        if (!isTimeInTaskRange(activeTask(), hour, minute))
-        {
-          startNewRoutineTaskMatchingTime();
-        }
+        startNewRoutineTaskMatchingTime();
       }
 
       // Only do states if we do not have messages pending
@@ -338,11 +337,56 @@ namespace REGoth
       return true;
     }
 
-    void ScriptState::doAIStateDuringShrink()
+    bool ScriptState::canRunLoopFunctionConcurrently()
     {
-      bs::INT32 hour   = mWorld->gameclock()->getHour();
-      bs::INT32 minute = mWorld->gameclock()->getMinute();
+      if (!mCurrentState.isValid) return false;
+      if (mCurrentState.phase != AIState::Phase::Loop) return false;
+      if (mCurrentState.symLoop == Scripting::SYMBOL_INDEX_INVALID) return false;
+      if (mCurrentState.nativeState != NativeState::ScriptBased) return false;
+
+      // These would make doAIState() do more than just running the loop function
+      if (mRoutine.isBoundaryReached && isInRoutine()) return false;
+      if (!mHostEventQueue->isEmpty()) return false;
+      if (mHostCharacter->isPlayer()) return false;
+
+      // Externals looking at anything else can only be called on the main thread
+      if (!scriptVM().canRunOnWorkerThread(mCurrentState.symLoop)) return false;
 
+      if (!mExecutionContext)
+      {
+        mExecutionContext = scriptVM().createExecutionContext();
+
+        // Scripts of a character should not depend on which thread ran first
+        mExecutionContext->random.seed(std::rand());
+      }
+
+      return true;
+    }
+
+    void ScriptState::prepareLoopFunctionConcurrently(float deltaTime)
+    {
+      // Same as doAIState() would do
+      mCurrentState.timeRunning += deltaTime;
+    }
+
+    void ScriptState::runLoopFunctionConcurrently()
+    {
+      mConcurrentLoopResult.hasResult = true;
+      mConcurrentLoopResult.symLoop   = mCurrentState.symLoop;
+      mConcurrentLoopResult.isDone    = scriptVM().runStateLoopFunction(
+          *mExecutionContext, mCurrentState.symLoop, mHostCharacter, mStateOther, mStateVictim,
+          mStateItem);
+    }
+
+    void ScriptState::applyConcurrentSideEffects()
+    {
+      if (!mExecutionContext) return;
+
+      scriptVM().applySideEffects(*mExecutionContext);
+    }
+
+    void ScriptState::doAIStateDuringShrink()
+    {
       if (mRoutine.hasRoutine)
       {
         bool isDoingScriptState = mCurrentState.isValid || mNextState.isValid;
@@ -353,7 +397,7 @@ namespace REGoth
           // teleported to the position they should be at according to their currently
           // active routine state. This is why Diego will be already in the old-camp
           // when you reach it, even though you just saw him walking very slowly towards it.
-          if (!isTimeInTaskRange(activeTask(), hour, minute))
+          if (mRoutine.isBoundaryReached)
           {
             startNewRoutineTaskMatchingTime();
           }
@@ -491,6 +535,9 @@ namespace REGoth
       }
 
       mRoutine.hasRoutine = true;  // At least one routine-target present
+
+      // The new task might be the one to do right now
+      mRoutine.isBoundaryReached = true;
     }
 
     void ScriptState::reinitRoutine()
@@ -501,6 +548,7 @@ namespace REGoth
       mRoutine.routine.clear();
       mRoutine.activeRoutineIndex = 0;
       mRoutine.shouldStartNewRoutine = true;
+      mRoutine.isBoundaryReached     = true;
 
       if (!routine.empty())
       {
@@ -526,6 +574,16 @@ namespace REGoth
     {
       mRoutine.hasRoutine = false;
       mRoutine.routine.clear();
+
+      // Ignore the wake up which might still be scheduled
+      mRoutine.timetableTicket++;
+    }
+
+    void ScriptState::onRoutineBoundaryReached(bs::UINT32 ticket)
+    {
+      if (ticket != mRoutine.timetableTicket) return;
+
+      mRoutine.isBoundaryReached = true;
     }
 
     void ScriptState::setCurrentStateTime(float time)
@@ -548,52 +606,79 @@ namespace REGoth
 
     bool ScriptState::isTimeInTaskRange(const RoutineTask& task, bs::INT32 hours, bs::INT32 minutes)
     {
-      auto tbigger = [&](int h1, int m1, int h2, int m2) {
-        return h1 > h2 || (h1 == h2 && m1 > m2);
-      };
+      // Tasks start at their start time and last until right before their end time
+      bs::INT32 start = task.hoursStart * 60 + task.minutesStart;
+      bs::INT32 end   = task.hoursEnd * 60 + task.minutesEnd;
+      bs::INT32 now   = hours * 60 + minutes;
 
-      auto tsmaller = [&](int h1, int m1, int h2, int m2) {
-        return h1 < h2 || (h1 == h2 && m1 < m2);
-      };
-
-      auto trange = [&](int h1, int m1, int h, int m, int h2, int m2) {
-        return tbigger(h, m, h1, m1) && tsmaller(h, m, h2, m2);
-      };
-
-      bool crossesZero = task.hoursEnd < task.hoursStart;
+      bool crossesZero = end < start;
 
       if (!crossesZero)
-        return trange(task.hoursStart, task.minutesStart, hours, minutes, task.hoursEnd,
-                      task.minutesEnd);
+      {
+        return now >= start && now < end;
+      }
       else
       {
-        return trange(task.hoursStart, task.minutesStart, hours, minutes, 24, 0) &&
-               trange(0, 0, hours, minutes, task.hoursEnd, task.minutesEnd);
+        return now >= start || now < end;
       }
     }
 
     void ScriptState::startNewRoutineTaskMatchingTime()
     {
-      bs::UINT32 i     = 0;
+      mRoutine.isBoundaryReached = false;
+
+      if (mRoutine.routine.empty()) return;
+
+      scheduleNextRoutineBoundary();
+
       bs::INT32 hour   = mWorld->gameclock()->getHour();
       bs::INT32 minute = mWorld->gameclock()->getMinute();
 
-      for (RoutineTask& e : mRoutine.routine)
+      for (bs::UINT32 i = 0; i < (bs::UINT32)mRoutine.routine.size(); i++)
       {
-        // Don't start the same routine again
-        if (i == mRoutine.activeRoutineIndex)
+        if (isTimeInTaskRange(mRoutine.routine[i], hour, minute))
         {
-          if (isTimeInTaskRange(e, hour, minute))
+          // Don't start the same routine again
+          if (i != mRoutine.activeRoutineIndex)
           {
             mRoutine.activeRoutineIndex    = i;
             mRoutine.shouldStartNewRoutine = true;
-
-            return;
           }
+
+          return;
         }
+      }
+    }
 
-        i++;
+    void ScriptState::scheduleNextRoutineBoundary()
+    {
+      HGameClock gameclock = mWorld->gameclock();
+
+      // Every start and end of a task is a point where a different task could become active
+      float nextBoundary = std::numeric_limits<float>::max();
+
+      for (const RoutineTask& task : mRoutine.routine)
+      {
+        float start = gameclock->getIngameSecondsAtNext(task.hoursStart, task.minutesStart);
+        float end   = gameclock->getIngameSecondsAtNext(task.hoursEnd, task.minutesEnd);
+
+        nextBoundary = std::min(nextBoundary, std::min(start, end));
       }
+
+      mRoutine.timetableTicket++;
+
+      HCharacterEventQueue eventQueue = mHostEventQueue;
+      bs::UINT32 ticket               = mRoutine.timetableTicket;
+
+      TimerWheel& timers = gameclock->ingameTimers();
+
+      timers.cancel(mRoutine.boundaryTimer);
+
+      mRoutine.boundaryTimer = timers.schedule(nextBoundary, [eventQueue, ticket]() {
+        if (eventQueue.isDestroyed()) return;
+
+        eventQueue->onRoutineBoundaryReached(ticket);
+      });
     }
 
     REGOTH_DEFINE_RTTI(ScriptState)
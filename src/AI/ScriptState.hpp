@@ -1,4 +1,5 @@
 #pragma once
+#include <AI/TimerWheel.hpp>
 #include <BsCorePrerequisites.h>
 #include <RTTI/RTTIUtil.hpp>
 #include <scripting/ScriptTypes.hpp>
@@ -8,6 +9,7 @@ namespace REGoth
   namespace Scripting
   {
     class ScriptVMForGameWorld;
+    struct DaedalusExecutionContext;
   }
 
   class GameWorld;
@@ -137,6 +139,12 @@ namespace REGoth
        */
       void runInstruction(const bs::String& instruction);
 
+      /**
+       * Same as runInstruction(), but with the script function already looked up, like the
+       * functions reacting to perceptions.
+       */
+      void runInstruction(Scripting::SymbolIndex instruction);
+
       /**
        * To be called after a new AI-state has just been queued. This method will interrupt
        * the currently active state and start the queued one as soon as possible;
@@ -198,6 +206,43 @@ namespace REGoth
        */
       void doAIStateDuringShrink();
 
+      /**
+       * @return Whether the next doAIState() would only run the loop function of the current
+       *         state. If so, that can be done on a worker thread ahead of time via
+       *         runLoopFunctionConcurrently().
+       *
+       * @note Not thread safe. Must be called before the worker threads are started.
+       */
+      bool canRunLoopFunctionConcurrently();
+
+      /**
+       * Advances the time the current state is running, as doAIState() would. Must be called
+       * on the main thread for all characters before any of them calls
+       * runLoopFunctionConcurrently(), as scripts may look at the state time of others.
+       *
+       * Only valid if canRunLoopFunctionConcurrently() returned true.
+       *
+       * @param  deltaTime  Same as passed to doAIState().
+       */
+      void prepareLoopFunctionConcurrently(float deltaTime);
+
+      /**
+       * Runs the loop function of the current state on this states own execution context, so
+       * multiple characters can do that at once on different threads. The result is kept for
+       * the next call to doAIState(), which will not run the loop function again.
+       *
+       * Side effects of the script are recorded and must be applied on the main thread via
+       * applyConcurrentSideEffects() before calling doAIState().
+       *
+       * Only valid after prepareLoopFunctionConcurrently().
+       */
+      void runLoopFunctionConcurrently();
+
+      /**
+       * Applies the side effects recorded during runLoopFunctionConcurrently().
+       */
+      void applyConcurrentSideEffects();
+
       /**
        * Starts the routine-state set for this NPC
        * @return Whether the state could be started
@@ -257,6 +302,15 @@ namespace REGoth
         return mCurrentState.isValid ? mCurrentState.timeRunning : 0.0f;
       }
 
+      /**
+       * @return Name of the state the Character is currently in, e.g. `ZS_TALK`.
+       *         Empty if there is no active state.
+       */
+      bs::String getCurrentStateName() const
+      {
+        return mCurrentState.isValid ? mCurrentState.name : "";
+      }
+
       /**
        * Sets the time the Character has already been in it's current state
        *
@@ -270,6 +324,15 @@ namespace REGoth
        */
       void reinitRoutine();
 
+      /**
+       * Called by the ingame timer once the time passed the point scheduled via
+       * scheduleNextRoutineBoundary(). The routine will switch to the task matching the new
+       * time as soon as possible.
+       *
+       * @param  ticket  Ticket the wake up was scheduled with. Outdated tickets are ignored.
+       */
+      void onRoutineBoundaryReached(bs::UINT32 ticket);
+
     protected:
       /**
        * Quick access to the script VM
@@ -344,9 +407,17 @@ namespace REGoth
        * time being out of range from the active task, this method will figure out the
        * task which should be executed now. If the task was changed,
        * `mRoutine.shouldStartNewRoutine` will be set to true.
+       *
+       * Also schedules the next check with the ingame timers of the GameClock.
        */
       void startNewRoutineTaskMatchingTime();
 
+      /**
+       * Schedules a wake up at the next time any routine task starts or ends with the
+       * ingame timers of the worlds GameClock. Replaces the wake up scheduled before.
+       */
+      void scheduleNextRoutineBoundary();
+
       /**
        * @return The currently active routine task.
        *
@@ -371,6 +442,26 @@ namespace REGoth
       HCharacterEventQueue mHostEventQueue;
       HCharacterAI mHostAI;
 
+      /**
+       * Result of runLoopFunctionConcurrently(), used by the next doAIState().
+       */
+      struct ConcurrentLoopResult
+      {
+        // Whether the loop function has been run ahead of time
+        bool hasResult = false;
+
+        // Loop function which has been run
+        Scripting::SymbolIndex symLoop = Scripting::SYMBOL_INDEX_INVALID;
+
+        // Return value of the loop function
+        bool isDone = false;
+      };
+
+      ConcurrentLoopResult mConcurrentLoopResult;
+
+      // Execution context to run the loop function on worker threads. Created on first use.
+      bs::SPtr<Scripting::DaedalusExecutionContext> mExecutionContext;
+
       // Other/victim/item set when we started the state
       Scripting::ScriptObjectHandle mStateOther = Scripting::SCRIPT_OBJECT_HANDLE_INVALID;
       Scripting::ScriptObjectHandle mStateVictim = Scripting::SCRIPT_OBJECT_HANDLE_INVALID;
@@ -389,6 +480,16 @@ namespace REGoth
 
         // Whether any routine has been registered yet
         bool hasRoutine = false;
+
+        // Whether the ingame timer told us that the active task might have ended.
+        // Not saved, so the task is checked again after loading.
+        bool isBoundaryReached = true;
+
+        // Ticket of the latest wake up scheduled with the ingame timers. Not saved.
+        bs::UINT32 timetableTicket = 0;
+
+        // Timer of the latest wake up, cancelled when scheduling the next one. Not saved.
+        TimerHandle boundaryTimer;
       } mRoutine;
 
     public:
@@ -0,0 +1,306 @@
+#include "TimerWheel.hpp"
+#include <exception/Throw.hpp>
+
+namespace REGoth
+{
+  namespace AI
+  {
+    constexpr bs::UINT32 TimerHandle::INVALID_INDEX;
+
+    TimerWheel::TimerWheel(float ticksPerSecond)
+        : mTicksPerSecond(ticksPerSecond)
+    {
+      if (ticksPerSecond <= 0.0f)
+      {
+        REGOTH_THROW(InvalidParametersException, "A timer wheel needs at least some ticks");
+      }
+
+      mSlots.fill(TimerHandle::INVALID_INDEX);
+      mNumTimersOnLevel.fill(0);
+    }
+
+    TimerHandle TimerWheel::schedule(float seconds, Callback callback)
+    {
+      bs::UINT32 index;
+
+      if (!mFreeTimers.empty())
+      {
+        index = mFreeTimers.back();
+        mFreeTimers.pop_back();
+      }
+      else
+      {
+        index = (bs::UINT32)mTimers.size();
+        mTimers.emplace_back();
+      }
+
+      Timer& timer = mTimers[index];
+
+      // The current tick has already been processed
+      timer.deadlineTick = std::max(firstTickAt(seconds), mCurrentTick + 1);
+      timer.sequence     = mNextSequence++;
+      timer.callback     = std::move(callback);
+      timer.isScheduled  = true;
+
+      mNumScheduled++;
+
+      insertIntoSlot(index);
+
+      return TimerHandle{index, timer.generation};
+    }
+
+    bool TimerWheel::cancel(TimerHandle handle)
+    {
+      if (!isScheduled(handle)) return false;
+
+      if (mTimers[handle.index].slot != NO_SLOT)
+      {
+        unlinkFromSlot(handle.index);
+      }
+
+      release(handle.index);
+
+      return true;
+    }
+
+    bool TimerWheel::isScheduled(TimerHandle handle) const
+    {
+      if (handle.index >= mTimers.size()) return false;
+
+      const Timer& timer = mTimers[handle.index];
+
+      return timer.isScheduled && timer.generation == handle.generation;
+    }
+
+    void TimerWheel::advance(float secondsNow)
+    {
+      mSecondsNow = secondsNow;
+
+      bs::UINT64 targetTick = lastTickAt(secondsNow);
+
+      while (mCurrentTick < targetTick)
+      {
+        bs::UINT64 nextTick = findNextInterestingTick();
+
+        if (nextTick > targetTick)
+        {
+          mCurrentTick = targetTick;
+          break;
+        }
+
+        mCurrentTick = nextTick;
+
+        cascade();
+
+        bs::UINT32 slot = (bs::UINT32)(mCurrentTick & (NUM_SLOTS - 1));
+
+        if (mSlots[slot] == TimerHandle::INVALID_INDEX) continue;
+
+        bs::Vector<TimerHandle> due;
+        detachSlot(slot, due);
+
+        fire(due);
+      }
+    }
+
+    void TimerWheel::fireAll(float secondsNow)
+    {
+      bs::Vector<TimerHandle> all;
+      all.reserve(mNumScheduled);
+
+      for (bs::UINT32 slot = 0; slot < (bs::UINT32)mSlots.size(); slot++)
+      {
+        detachSlot(slot, all);
+      }
+
+      // Restart first, so timers scheduled by the callbacks are relative to the new time
+      mSecondsNow  = secondsNow;
+      mCurrentTick = lastTickAt(secondsNow);
+
+      fire(all);
+    }
+
+    void TimerWheel::insertIntoSlot(bs::UINT32 index)
+    {
+      Timer& timer = mTimers[index];
+
+      // Deadlines beyond the last wheel wait in its furthest slot and are sorted in again
+      // once that comes up
+      const bs::UINT64 maxDelta = ((bs::UINT64)1 << (SLOT_BITS * NUM_LEVELS)) - 1;
+      bs::UINT64 delta          = std::min(timer.deadlineTick - mCurrentTick, maxDelta);
+
+      bs::UINT32 level = 0;
+
+      while (level + 1 < NUM_LEVELS && delta >= ((bs::UINT64)1 << (SLOT_BITS * (level + 1))))
+      {
+        level++;
+      }
+
+      bs::UINT64 tick = mCurrentTick + delta;
+      bs::UINT32 slot =
+          level * NUM_SLOTS + (bs::UINT32)((tick >> (SLOT_BITS * level)) & (NUM_SLOTS - 1));
+
+      timer.slot     = slot;
+      timer.previous = TimerHandle::INVALID_INDEX;
+      timer.next     = mSlots[slot];
+
+      if (timer.next != TimerHandle::INVALID_INDEX)
+      {
+        mTimers[timer.next].previous = index;
+      }
+
+      mSlots[slot] = index;
+
+      mNumTimersOnLevel[level]++;
+    }
+
+    void TimerWheel::unlinkFromSlot(bs::UINT32 index)
+    {
+      Timer& timer = mTimers[index];
+
+      if (timer.previous != TimerHandle::INVALID_INDEX)
+      {
+        mTimers[timer.previous].next = timer.next;
+      }
+      else
+      {
+        mSlots[timer.slot] = timer.next;
+      }
+
+      if (timer.next != TimerHandle::INVALID_INDEX)
+      {
+        mTimers[timer.next].previous = timer.previous;
+      }
+
+      mNumTimersOnLevel[timer.slot / NUM_SLOTS]--;
+
+      timer.slot     = NO_SLOT;
+      timer.previous = TimerHandle::INVALID_INDEX;
+      timer.next     = TimerHandle::INVALID_INDEX;
+    }
+
+    void TimerWheel::detachSlot(bs::UINT32 slot, bs::Vector<TimerHandle>& result)
+    {
+      bs::UINT32 index = mSlots[slot];
+
+      while (index != TimerHandle::INVALID_INDEX)
+      {
+        Timer& timer    = mTimers[index];
+        bs::UINT32 next = timer.next;
+
+        result.push_back(TimerHandle{index, timer.generation});
+
+        timer.slot     = NO_SLOT;
+        timer.previous = TimerHandle::INVALID_INDEX;
+        timer.next     = TimerHandle::INVALID_INDEX;
+
+        mNumTimersOnLevel[slot / NUM_SLOTS]--;
+
+        index = next;
+      }
+
+      mSlots[slot] = TimerHandle::INVALID_INDEX;
+    }
+
+    void TimerWheel::cascade()
+    {
+      for (bs::UINT32 level = 1; level < NUM_LEVELS; level++)
+      {
+        bs::UINT32 shift = SLOT_BITS * level;
+
+        // A wheel only moves on once all lower wheels have gone around
+        if ((mCurrentTick & (((bs::UINT64)1 << shift) - 1)) != 0) break;
+
+        bs::UINT32 slot =
+            level * NUM_SLOTS + (bs::UINT32)((mCurrentTick >> shift) & (NUM_SLOTS - 1));
+        bs::UINT32 index = mSlots[slot];
+
+        mSlots[slot] = TimerHandle::INVALID_INDEX;
+
+        while (index != TimerHandle::INVALID_INDEX)
+        {
+          bs::UINT32 next = mTimers[index].next;
+
+          mNumTimersOnLevel[level]--;
+          insertIntoSlot(index);
+
+          index = next;
+        }
+      }
+    }
+
+    bs::UINT64 TimerWheel::findNextInterestingTick() const
+    {
+      bs::UINT32 numEmptyLevels = 0;
+
+      while (numEmptyLevels < NUM_LEVELS && mNumTimersOnLevel[numEmptyLevels] == 0)
+      {
+        numEmptyLevels++;
+      }
+
+      if (numEmptyLevels == 0) return mCurrentTick + 1;
+      if (numEmptyLevels == NUM_LEVELS) return std::numeric_limits<bs::UINT64>::max();
+
+      // Nothing happens until the first non-empty wheel moves on
+      bs::UINT32 shift = SLOT_BITS * numEmptyLevels;
+
+      return ((mCurrentTick >> shift) + 1) << shift;
+    }
+
+    void TimerWheel::fire(bs::Vector<TimerHandle>& timers)
+    {
+      std::sort(timers.begin(), timers.end(), [this](TimerHandle a, TimerHandle b) {
+        const Timer& timerA = mTimers[a.index];
+        const Timer& timerB = mTimers[b.index];
+
+        if (timerA.deadlineTick != timerB.deadlineTick)
+        {
+          return timerA.deadlineTick < timerB.deadlineTick;
+        }
+
+        return timerA.sequence < timerB.sequence;
+      });
+
+      for (TimerHandle handle : timers)
+      {
+        // Might have been cancelled by one of the callbacks called before
+        if (!isScheduled(handle)) continue;
+
+        Callback callback = std::move(mTimers[handle.index].callback);
+
+        release(handle.index);
+
+        if (callback)
+        {
+          callback();
+        }
+      }
+    }
+
+    void TimerWheel::release(bs::UINT32 index)
+    {
+      Timer& timer = mTimers[index];
+
+      timer.isScheduled = false;
+      timer.callback    = nullptr;
+      timer.generation++;
+
+      mNumScheduled--;
+      mFreeTimers.push_back(index);
+    }
+
+    bs::UINT64 TimerWheel::firstTickAt(float seconds) const
+    {
+      if (seconds <= 0.0f) return 0;
+
+      return (bs::UINT64)std::ceil(seconds * mTicksPerSecond);
+    }
+
+    bs::UINT64 TimerWheel::lastTickAt(float seconds) const
+    {
+      if (seconds <= 0.0f) return 0;
+
+      return (bs::UINT64)std::floor(seconds * mTicksPerSecond);
+    }
+  }  // namespace AI
+}  // namespace REGoth
@@ -0,0 +1,212 @@
+#pragma once
+#include <BsCorePrerequisites.h>
+#include <array>
+#include <functional>
+
+namespace REGoth
+{
+  namespace AI
+  {
+    /**
+     * Refers to a timer of a TimerWheel. Once the timer has fired or has been cancelled, the
+     * handle stops referring to it, even if the timer is reused for another deadline.
+     */
+    struct TimerHandle
+    {
+      static constexpr bs::UINT32 INVALID_INDEX = ~0u;
+
+      bs::UINT32 index      = INVALID_INDEX;
+      bs::UINT32 generation = 0;
+
+      bool isValid() const
+      {
+        return index != INVALID_INDEX;
+      }
+    };
+
+    /**
+     * Calls functions once a point in time has been reached.
+     *
+     * Time is split into *ticks* of a fixed length. Timers are sorted into the slots of
+     * several wheels by how far away their deadline is: The first wheel has one slot per tick
+     * for the next 256 ticks, the second one has one slot per 256 ticks for the next 256 * 256
+     * ticks, and so on. Whenever the first wheel has gone around once, the timers of the next
+     * slot of the second wheel are sorted into the first one, and the same goes for the higher
+     * wheels. That way, scheduling and cancelling a timer takes constant time and advancing
+     * the time only has to look at a single slot per tick.
+     *
+     * Timers fire in the order of their deadlines, timers with the same deadline in the order
+     * they were scheduled in. This also holds if the time jumps forward by a lot at once, where
+     * stretches without any timers are skipped.
+     *
+     * Timers fire on the first tick at or after their deadline. A timer can be scheduled
+     * without a callback, so the owner only checks whether it is still scheduled, see
+     * isScheduled().
+     */
+    class TimerWheel
+    {
+    public:
+      using Callback = std::function<void()>;
+
+      /**
+       * @param  ticksPerSecond  Number of ticks per second, which is how precise timers are.
+       */
+      TimerWheel(float ticksPerSecond);
+
+      /**
+       * Schedules a timer.
+       *
+       * @param  seconds   Point in time to fire at, on the same clock passed to advance().
+       *                   Timers scheduled for the past fire on the next tick.
+       * @param  callback  Called when the timer fires. Optional.
+       *
+       * @return Handle to cancel the timer with.
+       */
+      TimerHandle schedule(float seconds, Callback callback = nullptr);
+
+      /**
+       * Schedules a timer to fire the given number of seconds after the time last passed to
+       * advance(). See schedule().
+       */
+      TimerHandle scheduleIn(float delaySeconds, Callback callback = nullptr)
+      {
+        return schedule(mSecondsNow + delaySeconds, std::move(callback));
+      }
+
+      /**
+       * Cancels the given timer, so its callback will not be called.
+       *
+       * @return False, if the timer has already fired or been cancelled.
+       */
+      bool cancel(TimerHandle handle);
+
+      /**
+       * @return Whether the given timer has neither fired nor been cancelled yet.
+       */
+      bool isScheduled(TimerHandle handle) const;
+
+      /**
+       * Fires all timers with a deadline at or before the given point in time.
+       *
+       * @param  secondsNow  Current time. Must not be before the time passed last.
+       */
+      void advance(float secondsNow);
+
+      /**
+       * Fires all timers, no matter what their deadline is, and restarts at the given point in
+       * time. To be used if the time has been set back.
+       */
+      void fireAll(float secondsNow);
+
+      /**
+       * @return Number of timers which have neither fired nor been cancelled yet.
+       */
+      bs::UINT32 numScheduled() const
+      {
+        return mNumScheduled;
+      }
+
+      /**
+       * @return Time last passed to advance() or fireAll().
+       */
+      float secondsNow() const
+      {
+        return mSecondsNow;
+      }
+
+    private:
+      static constexpr bs::UINT32 SLOT_BITS  = 8;
+      static constexpr bs::UINT32 NUM_SLOTS  = 1 << SLOT_BITS;
+      static constexpr bs::UINT32 NUM_LEVELS = 4;
+
+      /**
+       * Marks a timer which is not in any slot, because it is free or about to fire.
+       */
+      static constexpr bs::UINT32 NO_SLOT = ~0u;
+
+      struct Timer
+      {
+        bs::UINT64 deadlineTick = 0;
+        bs::UINT64 sequence     = 0;
+        Callback callback;
+
+        bs::UINT32 generation = 0;
+        bs::UINT32 slot       = NO_SLOT;  // Index into mSlots
+        bs::UINT32 previous   = TimerHandle::INVALID_INDEX;
+        bs::UINT32 next       = TimerHandle::INVALID_INDEX;
+        bool isScheduled      = false;
+      };
+
+      /**
+       * Puts a scheduled timer into the slot matching its deadline.
+       */
+      void insertIntoSlot(bs::UINT32 index);
+
+      /**
+       * Removes a timer from the slot it is in.
+       */
+      void unlinkFromSlot(bs::UINT32 index);
+
+      /**
+       * Takes all timers out of the given slot and appends them to \p result.
+       */
+      void detachSlot(bs::UINT32 slot, bs::Vector<TimerHandle>& result);
+
+      /**
+       * Moves the timers of the slots of the higher wheels which are due at the current tick
+       * into the lower wheels.
+       */
+      void cascade();
+
+      /**
+       * @return The next tick after the current one where anything could happen.
+       */
+      bs::UINT64 findNextInterestingTick() const;
+
+      /**
+       * Fires the given timers in order of their deadlines. Timers which have been cancelled
+       * in the meantime are skipped.
+       */
+      void fire(bs::Vector<TimerHandle>& timers);
+
+      /**
+       * Frees the given timer, so it can be reused.
+       */
+      void release(bs::UINT32 index);
+
+      /**
+       * @return First tick at or after the given point in time.
+       */
+      bs::UINT64 firstTickAt(float seconds) const;
+
+      /**
+       * @return Last tick at or before the given point in time.
+       */
+      bs::UINT64 lastTickAt(float seconds) const;
+
+      double mTicksPerSecond;
+      float mSecondsNow = 0.0f;
+
+      /**
+       * Last tick which has been processed.
+       */
+      bs::UINT64 mCurrentTick = 0;
+
+      bs::UINT64 mNextSequence = 0;
+      bs::UINT32 mNumScheduled = 0;
+
+      bs::Vector<Timer> mTimers;
+      bs::Vector<bs::UINT32> mFreeTimers;
+
+      /**
+       * Index of the first timer of every slot. The slots of the first wheel come first.
+       */
+      std::array<bs::UINT32, NUM_SLOTS * NUM_LEVELS> mSlots;
+
+      /**
+       * Number of timers per wheel, so empty stretches can be skipped.
+       */
+      std::array<bs::UINT32, NUM_LEVELS> mNumTimersOnLevel;
+    };
+  }  // namespace AI
+}  // namespace REGoth
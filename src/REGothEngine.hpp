@@ -25,8 +25,10 @@ namespace REGoth
    * Some important virtual functions exist which can be overridden:
    *
    *  - getVdfsPackagesToLoad()
+   *  - initializeBsf()
    *  - setupInput()
    *  - setupScene()
+   *  - run()
    *
    * To actually run an instance of the engine, see the `main`-wrapper below.
    */
@@ -70,7 +72,7 @@ namespace REGoth
     /**
      * Initializes bsf and opens the window
      */
-    void initializeBsf();
+    virtual void initializeBsf();
 
     /**
      * Load all resource manifests written by previous runs of REGoth.
@@ -112,7 +114,7 @@ namespace REGoth
     /**
      * Run the main-loop
      */
-    void run();
+    virtual void run();
 
     /**
      * Shutdown bsf
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "RTTIUtil.hpp"
+#include <components/AIScheduler.hpp>
+
+namespace REGoth
+{
+  class RTTI_AIScheduler : public bs::RTTIType<AIScheduler, bs::Component, RTTI_AIScheduler>
+  {
+    BS_BEGIN_RTTI_MEMBERS
+    BS_RTTI_MEMBER_PLAIN(mNearTierRange, 0)
+    BS_RTTI_MEMBER_PLAIN(mMidTierTicks, 1)
+    BS_RTTI_MEMBER_PLAIN(mFarTierTicks, 2)
+    BS_RTTI_MEMBER_PLAIN(mScriptTimeBudgetMs, 3)
+    BS_RTTI_MEMBER_PLAIN(mIsParallelScriptStatesEnabled, 4)
+    BS_END_RTTI_MEMBERS
+
+  public:
+    RTTI_AIScheduler()
+    {
+    }
+
+    REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(AIScheduler)
+  };
+
+}  // namespace REGoth
@@ -14,6 +14,8 @@ namespace REGoth
     BS_RTTI_MEMBER_REFL(mWorld, 3)
     BS_RTTI_MEMBER_PLAIN(mWalkMode, 4)
     BS_RTTI_MEMBER_PLAIN(mWeaponMode, 5)
+    BS_RTTI_MEMBER_PLAIN(mControllerRadius, 6)
+    BS_RTTI_MEMBER_PLAIN(mControllerHeight, 7)
     BS_END_RTTI_MEMBERS
 
   public:
@@ -14,6 +14,8 @@ namespace REGoth
     BS_RTTI_MEMBER_REFLPTR(mPathfinder, 3)
     BS_RTTI_MEMBER_REFLPTR(mScriptState, 4)
     BS_RTTI_MEMBER_REFL(mVisualCharacter, 5)
+    BS_RTTI_MEMBER_PLAIN_ARRAY(mPerceptionFunctions, 6)
+    BS_RTTI_MEMBER_PLAIN(mPerceptionInterval, 7)
     BS_END_RTTI_MEMBERS
 
   public:
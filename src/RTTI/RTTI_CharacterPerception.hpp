@@ -0,0 +1,24 @@
+#pragma once
+
+#include "RTTIUtil.hpp"
+#include <components/CharacterPerception.hpp>
+
+namespace REGoth
+{
+  class RTTI_CharacterPerception
+      : public bs::RTTIType<CharacterPerception, bs::Component, RTTI_CharacterPerception>
+  {
+    BS_BEGIN_RTTI_MEMBERS
+    BS_RTTI_MEMBER_PLAIN(mPerceptionRange, 0)
+    BS_RTTI_MEMBER_PLAIN(mMaxSensingPerTick, 1)
+    BS_END_RTTI_MEMBERS
+
+  public:
+    RTTI_CharacterPerception()
+    {
+    }
+
+    REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(CharacterPerception)
+  };
+
+}  // namespace REGoth
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "RTTIUtil.hpp"
+#include <components/CharacterPhysicsLOD.hpp>
+
+namespace REGoth
+{
+  class RTTI_CharacterPhysicsLOD
+      : public bs::RTTIType<CharacterPhysicsLOD, bs::Component, RTTI_CharacterPhysicsLOD>
+  {
+    BS_BEGIN_RTTI_MEMBERS
+    BS_RTTI_MEMBER_PLAIN(mActivateRange, 0)
+    BS_RTTI_MEMBER_PLAIN(mDeactivateRange, 1)
+    BS_RTTI_MEMBER_PLAIN(mMaxSwitchesPerTick, 2)
+    BS_END_RTTI_MEMBERS
+
+  public:
+    RTTI_CharacterPhysicsLOD()
+    {
+    }
+
+    REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(CharacterPhysicsLOD)
+  };
+
+}  // namespace REGoth
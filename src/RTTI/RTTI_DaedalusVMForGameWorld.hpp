@@ -29,6 +29,7 @@ namespace REGoth
         auto obj = static_cast<DaedalusVMForGameWorld*>(_obj);
 
         obj->createAllInformationInstances();
+        obj->createStateFunctionTable();
       }
 
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(DaedalusVMForGameWorld)
@@ -97,6 +97,8 @@ namespace REGoth
       BS_RTTI_MEMBER_PLAIN(isPrgState, 5)
       BS_RTTI_MEMBER_PLAIN(waitTime, 6)
       BS_RTTI_MEMBER_PLAIN(wpname, 7)
+      BS_RTTI_MEMBER_PLAIN(perceptionFunction, 8)
+      BS_RTTI_MEMBER_PLAIN(waitDeadlineSeconds, 9)
       BS_END_RTTI_MEMBERS
 
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(StateMessage)
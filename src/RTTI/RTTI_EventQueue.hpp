@@ -9,14 +9,68 @@ namespace REGoth
     using UINT32 = bs::UINT32;
 
     BS_BEGIN_RTTI_MEMBERS
-    BS_RTTI_MEMBER_REFLPTR_ARRAY(mEventQueue, 0)
     BS_END_RTTI_MEMBERS
 
+    bs::SPtr<AI::EventMessage> getMessage(OwnerType* obj, UINT32 idx)
+    {
+      return mMessages[idx];
+    }
+
+    void setMessage(OwnerType* obj, UINT32 idx, bs::SPtr<AI::EventMessage> val)
+    {
+      mMessages[idx] = val;
+    }
+
+    UINT32 getSizeMessages(OwnerType* obj)
+    {
+      return (UINT32)mMessages.size();
+    }
+
+    void setSizeMessages(OwnerType* obj, UINT32 val)
+    {
+      mMessages.resize(val);
+    }
+
   public:
     RTTI_EventQueue()
     {
+      // Only the queued messages are saved, free slots are not worth storing
+      addReflectablePtrArrayField("mEventQueue", 0,                    //
+                                  &RTTI_EventQueue::getMessage,        //
+                                  &RTTI_EventQueue::getSizeMessages,   //
+                                  &RTTI_EventQueue::setMessage,        //
+                                  &RTTI_EventQueue::setSizeMessages);  //
+    }
+
+    void onSerializationStarted(bs::IReflectable* _obj, bs::SerializationContext* context) override
+    {
+      auto obj = static_cast<EventQueue*>(_obj);
+
+      for (bs::UINT32 slot : obj->mEventQueue)
+      {
+        mMessages.push_back(obj->mMessageSlots[slot].message);
+      }
+    }
+
+    void onDeserializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
+    {
+      auto obj = static_cast<EventQueue*>(_obj);
+
+      for (const auto& message : mMessages)
+      {
+        bs::UINT32 slot = (bs::UINT32)obj->mMessageSlots.size();
+
+        EventQueue::MessageSlot s;
+        s.message = message;
+        s.isInUse = true;
+
+        obj->mMessageSlots.push_back(s);
+        obj->mEventQueue.push_back(slot);
+      }
     }
 
     REGOTH_IMPLEMENT_RTTI_CLASS_ABSTRACT(EventQueue)
+
+    bs::Vector<bs::SPtr<AI::EventMessage>> mMessages;
   };
 }  // namespace REGoth
@@ -17,6 +17,14 @@ namespace REGoth
     {
     }
 
+    void onDeserializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
+    {
+      auto obj = static_cast<GameClock*>(_obj);
+
+      // Before any component is initialized, so timers scheduled then already see the loaded time
+      obj->restartTimers();
+    }
+
     REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(GameClock)
   };
 
@@ -18,6 +18,13 @@ namespace REGoth
     BS_RTTI_MEMBER_REFL(mGameClock, 4)
     BS_RTTI_MEMBER_REFL_ARRAY(mAllCharacters, 5)
     BS_RTTI_MEMBER_REFL_ARRAY(mAllItems, 6)
+    BS_RTTI_MEMBER_REFL(mAIScheduler, 7)
+    BS_RTTI_MEMBER_REFL(mCharacterPhysicsLOD, 8)
+    BS_RTTI_MEMBER_REFL(mCharacterPerception, 9)
+    // ID 10 held the hash of GOTHIC.DAT, which is now checked by the script VM itself
+    BS_RTTI_MEMBER_REFL(mSaveGameWriter, 11)
+    BS_RTTI_MEMBER_PLAIN_ARRAY(mSavedObjectNames, 12)
+    BS_RTTI_MEMBER_REFL_ARRAY(mSavedObjects, 13)
     BS_END_RTTI_MEMBERS
 
     public:
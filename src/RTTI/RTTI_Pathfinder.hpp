@@ -17,19 +17,44 @@ namespace REGoth
       BS_RTTI_MEMBER_PLAIN_NAMED(stepHeight, mUserConfiguration.stepHeight, 2)
       BS_RTTI_MEMBER_PLAIN_NAMED(maxSlopeAngle, mUserConfiguration.maxSlopeAngle, 3)
       BS_RTTI_MEMBER_PLAIN_NAMED(lastKnownPosition, mActiveRoute.lastKnownPosition, 4)
-      BS_RTTI_MEMBER_PLAIN_NAMED(positionsToGo, mActiveRoute.positionsToGo, 5)
       BS_RTTI_MEMBER_REFL_NAMED(targetEntity, mActiveRoute.targetEntity, 6)
       BS_RTTI_MEMBER_PLAIN_NAMED(targetEntityPositionOnStart,
                                 mActiveRoute.targetEntityPositionOnStart, 7)
       BS_RTTI_MEMBER_REFL(mWaynet, 8)
       BS_END_RTTI_MEMBERS
 
+      bs::Vector<bs::Vector3>& getPositionsToGo(OwnerType* obj)
+      {
+        const auto& route = obj->mActiveRoute;
+
+        // Positions already passed are not worth storing
+        mPositionsToGo.assign(route.positions.begin() + route.nextPosition,
+                              route.positions.end());
+
+        return mPositionsToGo;
+      }
+
+      void setPositionsToGo(OwnerType* obj, bs::Vector<bs::Vector3>& val)
+      {
+        obj->mActiveRoute.clearPositions();
+
+        for (const bs::Vector3& position : val)
+        {
+          obj->mActiveRoute.positions.push_back(position);
+        }
+      }
+
     public:
       RTTI_Pathfinder()
       {
+        addPlainField("positionsToGo", 5,                    //
+                      &RTTI_Pathfinder::getPositionsToGo,   //
+                      &RTTI_Pathfinder::setPositionsToGo);  //
       }
 
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(Pathfinder)
+
+      bs::Vector<bs::Vector3> mPositionsToGo;
     };
   }  // namespace AI
 }  // namespace REGoth
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RTTIUtil.hpp"
+#include <scripting/daedalus/DaedalusExecutionContext.hpp>
 #include <scripting/daedalus/REGothDaedalusVM.hpp>
 
 namespace REGoth
@@ -11,10 +12,12 @@ namespace REGoth
     {
       using UINT32 = bs::UINT32;
 
+      // The registers are not saved anymore, as they are only used while a script is running.
+      // IDs 0 and 1 were used by them. ID 2 held the whole DAT-file, which is now loaded from
+      // the VDFS again.
       BS_BEGIN_RTTI_MEMBERS
-      BS_RTTI_MEMBER_PLAIN(mPC, 0)
-      BS_RTTI_MEMBER_PLAIN(mCallDepth, 1)
-      BS_RTTI_MEMBER_PLAIN_ARRAY(mDatFileData, 2)
+      BS_RTTI_MEMBER_PLAIN(mDatFileName, 3)
+      BS_RTTI_MEMBER_PLAIN(mDatFileHash, 4)
       BS_END_RTTI_MEMBERS
 
     public:
@@ -26,16 +29,7 @@ namespace REGoth
       {
         auto obj = static_cast<DaedalusVM*>(_obj);
 
-        // Can't save the DAT-files datastructure, but we can save the raw dat-file as
-        // a workaround until we come up with something else.
-        obj->mDatFile = bs::bs_shared_ptr_new<Daedalus::DATFile>(obj->mDatFileData.data(),
-                                                                 obj->mDatFileData.size());
-
-        obj->mClassVarResolver = bs::bs_shared_ptr_new<DaedalusClassVarResolver>(
-            obj->mScriptSymbols, obj->mScriptObjects);
-
-        obj->mClassTemplates.createClassTemplates(obj->mScriptSymbols);
-        obj->registerAllExternals();
+        obj->rebuildFromDatFile();
       }
 
       REGOTH_IMPLEMENT_RTTI_CLASS_ABSTRACT(DaedalusVM)
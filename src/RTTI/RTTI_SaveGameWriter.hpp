@@ -0,0 +1,24 @@
+#pragma once
+#include "RTTIUtil.hpp"
+#include <components/SaveGameWriter.hpp>
+
+namespace REGoth
+{
+  class RTTI_SaveGameWriter
+      : public bs::RTTIType<SaveGameWriter, bs::Component, RTTI_SaveGameWriter>
+  {
+    BS_BEGIN_RTTI_MEMBERS
+    BS_RTTI_MEMBER_REFL(mWorld, 0)
+    BS_RTTI_MEMBER_PLAIN(mAutosaveName, 1)
+    BS_RTTI_MEMBER_PLAIN(mAutosaveIntervalSeconds, 2)
+    BS_RTTI_MEMBER_PLAIN(mTimeUntilAutosave, 3)
+    BS_END_RTTI_MEMBERS
+
+  public:
+    RTTI_SaveGameWriter()
+    {
+    }
+
+    REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(SaveGameWriter)
+  };
+}  // namespace REGoth
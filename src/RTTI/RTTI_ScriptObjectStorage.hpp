@@ -7,98 +7,67 @@ namespace REGoth
 {
   namespace Scripting
   {
-    class RTTI_ScriptObjectStorage
-        : public bs::RTTIType<ScriptObjectStorage, bs::IReflectable, RTTI_ScriptObjectStorage>
+    class RTTI_EncodedScriptObjects
+        : public bs::RTTIType<EncodedScriptObjects, bs::IReflectable, RTTI_EncodedScriptObjects>
     {
-      using UINT32 = bs::UINT32;
-
       BS_BEGIN_RTTI_MEMBERS
-      // BS_RTTI_MEMBER_PLAIN(mObjects, 0) // Commented out: Added manually, see constructor
-      // BS_RTTI_MEMBER_PLAIN(mObjectHandles, 1) // Commented out: Added manually, see constructor
-      BS_RTTI_MEMBER_PLAIN(mNextHandle, 2)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(stringTable, 0)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(layouts, 1)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(handles, 2)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(objectLayouts, 3)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(instanceNames, 4)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(ints, 5)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(floats, 6)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(strings, 7)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(functionPointers, 8)
       BS_END_RTTI_MEMBERS
 
-      ScriptObject& getObject(OwnerType* obj, UINT32 idx)
-      {
-        return mObjects[idx];
-      }
-
-      void setObject(OwnerType* obj, UINT32 idx, ScriptObject& val)
-      {
-        mObjects[idx] = val;
-      }
-
-      UINT32 getSizeObjects(OwnerType* obj)
-      {
-        return (UINT32)mObjects.size();
-      }
-
-      void setSizeObjects(OwnerType* obj, UINT32 val)
-      {
-        mObjects.resize(val);
-      }
-
-      ScriptObjectHandle& getObjectHandle(OwnerType* obj, UINT32 idx)
+    public:
+      RTTI_EncodedScriptObjects()
       {
-        return mObjectHandles[idx];
       }
 
-      void setObjectHandle(OwnerType* obj, UINT32 idx, ScriptObjectHandle& val)
-      {
-        mObjectHandles[idx] = val;
-      }
+      REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(EncodedScriptObjects)
+    };
 
-      UINT32 getSizeObjectHandles(OwnerType* obj)
-      {
-        return (UINT32)mObjectHandles.size();
-      }
+    class RTTI_ScriptObjectStorage
+        : public bs::RTTIType<ScriptObjectStorage, bs::IReflectable, RTTI_ScriptObjectStorage>
+    {
+      // The objects are saved in their compact form, see EncodedScriptObjects. IDs 0 and 1 were
+      // used by the objects and their handles.
+      BS_BEGIN_RTTI_MEMBERS
+      BS_RTTI_MEMBER_PLAIN(mNextHandle, 2)
+      BS_RTTI_MEMBER_REFL(mSerializedObjects, 3)
+      BS_END_RTTI_MEMBERS
 
-      void setSizeObjectHandles(OwnerType* obj, UINT32 val)
+    public:
+      RTTI_ScriptObjectStorage()
       {
-        mObjectHandles.resize(val);
       }
 
-    public:
-      RTTI_ScriptObjectStorage()
+      void onSerializationStarted(bs::IReflectable* _obj, bs::SerializationContext* context) override
       {
-        addReflectableArrayField("objects", 0,                                //
-                                 &RTTI_ScriptObjectStorage::getObject,        //
-                                 &RTTI_ScriptObjectStorage::getSizeObjects,   //
-                                 &RTTI_ScriptObjectStorage::setObject,        //
-                                 &RTTI_ScriptObjectStorage::setSizeObjects);  //
+        auto obj = static_cast<ScriptObjectStorage*>(_obj);
 
-        addPlainArrayField("objectHandles", 1,                                //
-                           &RTTI_ScriptObjectStorage::getObjectHandle,        //
-                           &RTTI_ScriptObjectStorage::getSizeObjectHandles,   //
-                           &RTTI_ScriptObjectStorage::setObjectHandle,        //
-                           &RTTI_ScriptObjectStorage::setSizeObjectHandles);  //
+        obj->mSerializedObjects = obj->encodeObjects();
       }
 
-      void onSerializationStarted(bs::IReflectable* _obj, bs::SerializationContext* context) override
+      void onSerializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
       {
         auto obj = static_cast<ScriptObjectStorage*>(_obj);
 
-        for (const auto& v : obj->mObjects)
-        {
-          mObjectHandles.push_back(v.first);
-          mObjects.push_back(v.second);
-        }
+        obj->mSerializedObjects = EncodedScriptObjects();
       }
 
       void onDeserializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
       {
         auto obj = static_cast<ScriptObjectStorage*>(_obj);
 
-        for (bs::UINT32 i = 0; i < (bs::UINT32)mObjectHandles.size(); i++)
-        {
-          obj->mObjects[mObjectHandles[i]] = mObjects[i];
-        }
+        obj->decodeObjects(obj->mSerializedObjects);
+        obj->mSerializedObjects = EncodedScriptObjects();
       }
 
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(ScriptObjectStorage)
-
-      bs::Vector<ScriptObject> mObjects;
-      bs::Vector<ScriptObjectHandle> mObjectHandles;
     };
 
   }  // namespace Scripting
@@ -9,13 +9,37 @@ namespace REGoth
   {
     using UINT32 = bs::UINT32;
 
+    class RTTI_ScriptSymbolValues
+        : public bs::RTTIType<ScriptSymbolValues, bs::IReflectable, RTTI_ScriptSymbolValues>
+    {
+      BS_BEGIN_RTTI_MEMBERS
+      BS_RTTI_MEMBER_PLAIN_ARRAY(intSymbols, 0)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(ints, 1)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(floatSymbols, 2)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(floats, 3)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(stringSymbols, 4)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(strings, 5)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(instanceSymbols, 6)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(instances, 7)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(functionSymbols, 8)
+      BS_RTTI_MEMBER_PLAIN_ARRAY(functionAddresses, 9)
+      BS_END_RTTI_MEMBERS
+
+    public:
+      RTTI_ScriptSymbolValues()
+      {
+      }
+
+      REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(ScriptSymbolValues)
+    };
+
     class RTTI_ScriptSymbolStorage
         : public bs::RTTIType<ScriptSymbolStorage, bs::IReflectable, RTTI_ScriptSymbolStorage>
     {
+      // The symbols themselves are created from the DAT-file again after loading, only their
+      // values are saved. IDs 1 to 3 were used by the symbols.
       BS_BEGIN_RTTI_MEMBERS
-      BS_RTTI_MEMBER_PLAIN(mSymbolsByName, 1)
-      BS_RTTI_MEMBER_REFLPTR_ARRAY(mStorage, 2)
-      BS_RTTI_MEMBER_PLAIN(mFunctionsByAddress, 3)
+      BS_RTTI_MEMBER_REFL(mSerializedValues, 4)
       BS_END_RTTI_MEMBERS
 
     public:
@@ -23,6 +47,20 @@ namespace REGoth
       {
       }
 
+      void onSerializationStarted(bs::IReflectable* _obj, bs::SerializationContext* context) override
+      {
+        auto obj = static_cast<ScriptSymbolStorage*>(_obj);
+
+        obj->mSerializedValues = obj->collectMutableValues();
+      }
+
+      void onSerializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
+      {
+        auto obj = static_cast<ScriptSymbolStorage*>(_obj);
+
+        obj->mSerializedValues = ScriptSymbolValues();
+      }
+
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(ScriptSymbolStorage)
     };
   }  // namespace Scripting
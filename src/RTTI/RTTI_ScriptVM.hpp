@@ -10,6 +10,7 @@ namespace REGoth
     class RTTI_ScriptVM : public bs::RTTIType<ScriptVM, bs::IReflectable, RTTI_ScriptVM>
     {
       BS_BEGIN_RTTI_MEMBERS
+      // Only holds the symbol values, the symbols are restored by the implementation
       BS_RTTI_MEMBER_REFL(mScriptSymbols, 1)
       BS_RTTI_MEMBER_REFL(mScriptObjects, 2)
       // BS_RTTI_MEMBER_REFL(mClassTemplates, 3) // Commented out: Can re-create after
@@ -22,13 +23,6 @@ namespace REGoth
       {
       }
 
-      void onDeserializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
-      {
-        auto obj = static_cast<ScriptVM*>(_obj);
-
-        obj->mClassTemplates.createClassTemplates(obj->mScriptSymbols);
-      }
-
       REGOTH_IMPLEMENT_RTTI_CLASS_ABSTRACT(ScriptVM)
     };
   }  // namespace Scripting
@@ -8,10 +8,10 @@ namespace REGoth
   {
 
     BS_BEGIN_RTTI_MEMBERS
-    // Explicitly Not serialized: mAllInfos
-    BS_RTTI_MEMBER_PLAIN(mKnownInfos, 0)
+    // ID 0 held the names of the known infos
     BS_RTTI_MEMBER_REFL(mSelf, 1)
     BS_RTTI_MEMBER_REFL(mGameWorld, 2)
+    BS_RTTI_MEMBER_PLAIN_ARRAY(mKnownInfos, 3)
     BS_END_RTTI_MEMBERS
 
   public:
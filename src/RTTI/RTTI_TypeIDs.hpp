@@ -71,6 +71,13 @@ namespace REGoth
     TID_REGOTH_UIDialogue                   = 600063,
     TID_REGOTH_GameplayUI                   = 600064,
     TID_REGOTH_StoryInformation             = 600065,
+    TID_REGOTH_WorldStreamer                = 600066,
+    TID_REGOTH_AIScheduler                  = 600067,
+    TID_REGOTH_CharacterPhysicsLOD          = 600068,
+    TID_REGOTH_CharacterPerception          = 600069,
+    TID_REGOTH_SaveGameWriter               = 600070,
+    TID_REGOTH_ScriptSymbolValues           = 600071,
+    TID_REGOTH_EncodedScriptObjects         = 600072,
 
   };
 }  // namespace REGoth
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "RTTIUtil.hpp"
+#include <components/WorldStreamer.hpp>
+
+namespace REGoth
+{
+  class RTTI_WorldStreamer : public bs::RTTIType<WorldStreamer, bs::Component, RTTI_WorldStreamer>
+  {
+    BS_BEGIN_RTTI_MEMBERS
+    BS_RTTI_MEMBER_PLAIN(mSectorSize, 0)
+    BS_RTTI_MEMBER_PLAIN(mLoadRange, 1)
+    BS_RTTI_MEMBER_PLAIN(mUnloadRange, 2)
+    BS_RTTI_MEMBER_PLAIN(mSectorCenters, 3)
+    BS_RTTI_MEMBER_PLAIN(mSectorPrefabs, 4)
+    BS_END_RTTI_MEMBERS
+
+  public:
+    RTTI_WorldStreamer()
+    {
+    }
+
+    REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(WorldStreamer)
+  };
+
+}  // namespace REGoth
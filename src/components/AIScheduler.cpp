@@ -0,0 +1,335 @@
+#include "AIScheduler.hpp"
+#include <Components/BsCCamera.h>
+#include <RTTI/RTTI_AIScheduler.hpp>
+#include <Scene/BsSceneManager.h>
+#include <Scene/BsSceneObject.h>
+#include <Utility/BsTime.h>
+#include <components/CharacterAI.hpp>
+#include <components/CharacterEventQueue.hpp>
+#include <components/GameWorld.hpp>
+#include <components/Waynet.hpp>
+#include <exception/Throw.hpp>
+#include <scripting/ScriptVMForGameWorld.hpp>
+#include <threading/ParallelFor.hpp>
+
+namespace REGoth
+{
+  /**
+   * Characters closer than this to the camera get their script state updated on every tick.
+   * Should be well inside the range where physics is active, see CharacterAI.
+   */
+  constexpr float DEFAULT_NEAR_TIER_RANGE_METERS = 20.0f;
+
+  /** After how many ticks characters of the Mid tier are updated. */
+  constexpr bs::UINT32 DEFAULT_MID_TIER_TICKS = 4;
+
+  /**
+   * After how many ticks characters of the Far tier are updated. Only their routine is checked
+   * there, which only changes once per ingame minute anyways.
+   */
+  constexpr bs::UINT32 DEFAULT_FAR_TIER_TICKS = 30;
+
+  /** Maximum time to spend on script states each tick, in milliseconds. */
+  constexpr float DEFAULT_SCRIPT_TIME_BUDGET_MS = 2.0f;
+
+  /**
+   * Minimum number of script state loops run by a single worker task. Most loop functions are
+   * only a handful of instructions, so smaller tasks would cost more than they save.
+   */
+  constexpr bs::UINT32 MIN_SCRIPT_STATE_LOOPS_PER_TASK = 4;
+
+  AIScheduler::AIScheduler(const bs::HSceneObject& parent)
+      : bs::Component(parent)
+      , mNearTierRange(DEFAULT_NEAR_TIER_RANGE_METERS)
+      , mMidTierTicks(DEFAULT_MID_TIER_TICKS)
+      , mFarTierTicks(DEFAULT_FAR_TIER_TICKS)
+      , mScriptTimeBudgetMs(DEFAULT_SCRIPT_TIME_BUDGET_MS)
+  {
+    setName("AIScheduler");
+  }
+
+  AIScheduler::~AIScheduler()
+  {
+  }
+
+  void AIScheduler::registerCharacter(HCharacterEventQueue eventQueue)
+  {
+    if (isRegistered(eventQueue)) return;
+
+    ScheduledCharacter character;
+    character.eventQueue  = eventQueue;
+    character.characterAI = eventQueue->SO()->getComponent<CharacterAI>();
+
+    // Spread the characters over the ticks so they don't all become due at the same time
+    character.ticksSinceUpdate = (bs::UINT32)mCharacters.size() % mMidTierTicks;
+
+    mCharacters.push_back(character);
+  }
+
+  void AIScheduler::unregisterCharacter(HCharacterEventQueue eventQueue)
+  {
+    for (auto it = mCharacters.begin(); it != mCharacters.end(); it++)
+    {
+      if (it->eventQueue == eventQueue)
+      {
+        mCharacters.erase(it);
+        return;
+      }
+    }
+  }
+
+  bool AIScheduler::isRegistered(HCharacterEventQueue eventQueue) const
+  {
+    for (const auto& character : mCharacters)
+    {
+      if (character.eventQueue == eventQueue) return true;
+    }
+
+    return false;
+  }
+
+  void AIScheduler::setNearTierRange(float rangeMeters)
+  {
+    mNearTierRange = rangeMeters;
+  }
+
+  void AIScheduler::setTierIntervals(bs::UINT32 midTierTicks, bs::UINT32 farTierTicks)
+  {
+    if (midTierTicks == 0 || farTierTicks == 0)
+    {
+      REGOTH_THROW(InvalidParametersException, "AI tier intervals must be at least one tick!");
+    }
+
+    mMidTierTicks = midTierTicks;
+    mFarTierTicks = farTierTicks;
+  }
+
+  void AIScheduler::setScriptTimeBudget(float milliseconds)
+  {
+    mScriptTimeBudgetMs = milliseconds;
+  }
+
+  void AIScheduler::setParallelScriptStates(bool enabled)
+  {
+    mIsParallelScriptStatesEnabled = enabled;
+  }
+
+  void AIScheduler::fixedUpdate()
+  {
+    removeDestroyedCharacters();
+
+    mStatistics = Statistics();
+
+    if (mCharacters.empty()) return;
+
+    float delta = bs::gTime().getFixedFrameDelta();
+
+    const auto& mainCamera = bs::gSceneManager().getMainCamera();
+
+    bs::Vector3 cameraPosition = bs::Vector3::ZERO;
+
+    if (mainCamera)
+    {
+      cameraPosition = mainCamera->getTransform().pos();
+    }
+
+    for (ScheduledCharacter& character : mCharacters)
+    {
+      character.accumulatedDelta += delta;
+      character.ticksSinceUpdate++;
+      character.tier = findTier(character, cameraPosition);
+
+      mStatistics.tiers[(bs::UINT32)character.tier].numCharacters++;
+    }
+
+    bs::UINT64 startTime = bs::gTime().getTimePrecise();
+    bs::UINT64 budgetUs  = (bs::UINT64)(mScriptTimeBudgetMs * 1000.0f);
+
+    if (mIsParallelScriptStatesEnabled)
+    {
+      runScriptStateLoopsConcurrently();
+    }
+
+    // Characters close to the camera are always updated, the budget is only for the others
+    for (ScheduledCharacter& character : mCharacters)
+    {
+      if (character.tier == Tier::Near)
+      {
+        updateCharacter(character);
+      }
+    }
+
+    // Continue with the other tiers where we stopped last time, until the budget is used up
+    bs::UINT32 numCharacters = (bs::UINT32)mCharacters.size();
+    bool isBudgetExceeded    = false;
+    bs::UINT32 nextCursor    = mRoundRobinCursor % numCharacters;
+
+    for (bs::UINT32 i = 0; i < numCharacters; i++)
+    {
+      bs::UINT32 index = (mRoundRobinCursor + i) % numCharacters;
+
+      ScheduledCharacter& character = mCharacters[index];
+
+      if (character.tier == Tier::Near) continue;
+      if (!isUpdateDue(character)) continue;
+
+      if (!isBudgetExceeded && bs::gTime().getTimePrecise() - startTime > budgetUs)
+      {
+        isBudgetExceeded = true;
+        nextCursor       = index;
+      }
+
+      if (isBudgetExceeded && !character.hasConcurrentUpdate)
+      {
+        mStatistics.tiers[(bs::UINT32)character.tier].numDeferred++;
+      }
+      else
+      {
+        updateCharacter(character);
+      }
+    }
+
+    mRoundRobinCursor = nextCursor;
+
+    mStatistics.scriptTimeMs = (bs::gTime().getTimePrecise() - startTime) / 1000.0f;
+  }
+
+  AIScheduler::Tier AIScheduler::findTier(const ScheduledCharacter& character,
+                                          const bs::Vector3& cameraPosition) const
+  {
+    if (character.characterAI && !character.characterAI->isPhysicsActive())
+    {
+      return Tier::Far;
+    }
+
+    const bs::Vector3& position = character.eventQueue->SO()->getTransform().pos();
+
+    if (position.squaredDistance(cameraPosition) < mNearTierRange * mNearTierRange)
+    {
+      return Tier::Near;
+    }
+
+    return Tier::Mid;
+  }
+
+  bool AIScheduler::isUpdateDue(const ScheduledCharacter& character) const
+  {
+    switch (character.tier)
+    {
+      case Tier::Near:
+        return true;
+
+      case Tier::Mid:
+        return character.ticksSinceUpdate >= mMidTierTicks;
+
+      case Tier::Far:
+        return character.ticksSinceUpdate >= mFarTierTicks;
+    }
+
+    return true;
+  }
+
+  void AIScheduler::updateCharacter(ScheduledCharacter& character)
+  {
+    if (character.tier == Tier::Far)
+    {
+      character.eventQueue->updateScriptStateDuringShrink();
+    }
+    else
+    {
+      character.eventQueue->updateScriptState(character.accumulatedDelta);
+    }
+
+    // The time spent far away is not added to a state, just like physics doesn't run there
+    character.accumulatedDelta    = 0.0f;
+    character.ticksSinceUpdate    = 0;
+    character.hasConcurrentUpdate = false;
+
+    mStatistics.tiers[(bs::UINT32)character.tier].numUpdated++;
+  }
+
+  void AIScheduler::runScriptStateLoopsConcurrently()
+  {
+    bs::Vector<ScheduledCharacter*> candidates;
+
+    for (ScheduledCharacter& character : mCharacters)
+    {
+      // Far characters only follow their routine, which does not run any loop function
+      if (character.tier == Tier::Far) continue;
+      if (!isUpdateDue(character)) continue;
+
+      if (character.eventQueue->canUpdateScriptStateConcurrently())
+      {
+        candidates.push_back(&character);
+      }
+    }
+
+    if (candidates.empty()) return;
+
+    HGameWorld world = SO()->getComponent<GameWorld>();
+
+    // Scripts look at the positions of all characters and waypoints. Those are computed lazily,
+    // which must not happen on multiple threads at once.
+    for (const ScheduledCharacter& character : mCharacters)
+    {
+      character.eventQueue->SO()->getTransform();
+    }
+
+    world->waynet()->populatePositionCaches();
+
+    for (ScheduledCharacter* character : candidates)
+    {
+      character->eventQueue->prepareScriptStateConcurrently(character->accumulatedDelta);
+    }
+
+    Scripting::ScriptObjectStorage& scriptObjects = world->scriptVM().scriptObjects();
+    scriptObjects.setAccessCacheEnabled(false);
+
+    Threading::parallelFor("ScriptStateLoops", (bs::UINT32)candidates.size(),
+                           MIN_SCRIPT_STATE_LOOPS_PER_TASK,
+                           [&](bs::UINT32 begin, bs::UINT32 end) {
+                             for (bs::UINT32 i = begin; i < end; i++)
+                             {
+                               ScheduledCharacter& character = *candidates[i];
+
+                               character.eventQueue->updateScriptStateConcurrently();
+                             }
+                           });
+
+    scriptObjects.setAccessCacheEnabled(true);
+
+    // Back on a single thread: Let the scripts change the world in a deterministic order
+    for (ScheduledCharacter* character : candidates)
+    {
+      character->eventQueue->applyConcurrentScriptStateSideEffects();
+      character->hasConcurrentUpdate = true;
+    }
+  }
+
+  void AIScheduler::removeDestroyedCharacters()
+  {
+    auto isDestroyed = [](const ScheduledCharacter& c) { return c.eventQueue.isDestroyed(); };
+
+    mCharacters.erase(std::remove_if(mCharacters.begin(), mCharacters.end(), isDestroyed),
+                      mCharacters.end());
+  }
+
+  void AIScheduler::logStatistics() const
+  {
+    const char* tierNames[NUM_TIERS] = {"Near", "Mid", "Far"};
+
+    for (bs::UINT32 i = 0; i < NUM_TIERS; i++)
+    {
+      const TierStatistics& tier = mStatistics.tiers[i];
+
+      bs::gDebug().logDebug(bs::StringUtil::format(
+          "[AIScheduler] {0}: {1} characters, {2} updated, {3} deferred", tierNames[i],
+          tier.numCharacters, tier.numUpdated, tier.numDeferred));
+    }
+
+    bs::gDebug().logDebug(
+        bs::StringUtil::format("[AIScheduler] Script time: {0} ms", mStatistics.scriptTimeMs));
+  }
+
+  REGOTH_DEFINE_RTTI(AIScheduler)
+}  // namespace REGoth
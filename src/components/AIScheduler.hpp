@@ -0,0 +1,213 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <RTTI/RTTIUtil.hpp>
+#include <Scene/BsComponent.h>
+
+namespace REGoth
+{
+  class CharacterEventQueue;
+  using HCharacterEventQueue = bs::GameObjectHandle<CharacterEventQueue>;
+
+  class CharacterAI;
+  using HCharacterAI = bs::GameObjectHandle<CharacterAI>;
+
+  /**
+   * Owns the script state updates of all characters in a world.
+   *
+   * Running the AI script state of a character means calling into the script VM, which is
+   * the most expensive part of a characters update. In a populated world, most characters
+   * are far away from the player, where nobody would notice if their state loop ran a little
+   * less often. This component therefore sorts every registered character into one of
+   * the following tiers, depending on its distance to the main camera:
+   *
+   *  - *Near*: The script state is updated on every fixed tick.
+   *  - *Mid*: The script state is updated every few ticks only. The time which passed since
+   *    the last update is accumulated and handed over as one delta, so the time a state is
+   *    running stays correct.
+   *  - *Far*: The character has its physics disabled (see CharacterAI), so only its daily
+   *    routine is kept up to date, see AI::ScriptState::doAIStateDuringShrink().
+   *
+   * The updates of the Mid and Far tiers are spread over multiple frames. On top of that,
+   * there is a budget for how much time may be spent on script states each frame. Once it
+   * is exceeded, the remaining characters have to wait for the next frame, where the updates
+   * continue where they stopped. Characters in the Near tier are always updated.
+   *
+   * Most of the time, a due update only consists of running the loop function of the current
+   * script state, like `ZS_SMALLTALK_LOOP`. Those are run on the worker threads for all due
+   * characters at once, each on its own execution context of the script VM. Whatever the
+   * scripts do to the world is recorded and applied afterwards, in the order of the
+   * registered characters, before the rest of the updates continue on the main thread.
+   * See DaedalusExecutionContext.
+   *
+   * Characters register themselves on initialization, see CharacterEventQueue. The list of
+   * registered characters is not saved, as they will register again after loading.
+   */
+  class AIScheduler : public bs::Component
+  {
+  public:
+    enum class Tier
+    {
+      Near,
+      Mid,
+      Far,
+    };
+
+    static constexpr bs::UINT32 NUM_TIERS = 3;
+
+    /**
+     * Counters of what the scheduler did during the last fixed tick.
+     */
+    struct TierStatistics
+    {
+      bs::UINT32 numCharacters = 0;  // Characters sorted into this tier
+      bs::UINT32 numUpdated    = 0;  // Characters whose script state was updated
+      bs::UINT32 numDeferred   = 0;  // Updates which were due but exceeded the budget
+    };
+
+    struct Statistics
+    {
+      TierStatistics tiers[NUM_TIERS];
+      float scriptTimeMs = 0.0f;  // Time spent on script states during the last tick
+    };
+
+    AIScheduler(const bs::HSceneObject& parent);
+    virtual ~AIScheduler();
+
+    /**
+     * Lets the scheduler update the script state of the given characters event queue.
+     * Registering the same queue twice has no effect.
+     */
+    void registerCharacter(HCharacterEventQueue eventQueue);
+
+    /**
+     * Stops updating the script state of the given characters event queue.
+     */
+    void unregisterCharacter(HCharacterEventQueue eventQueue);
+
+    /**
+     * @return Whether the given event queue is registered at this scheduler.
+     */
+    bool isRegistered(HCharacterEventQueue eventQueue) const;
+
+    /**
+     * Sets up to which distance to the main camera a character belongs into the Near tier.
+     * Characters further away belong into the Mid tier, until their physics is disabled.
+     */
+    void setNearTierRange(float rangeMeters);
+
+    /**
+     * Sets after how many fixed ticks characters of the Mid and Far tiers are updated.
+     *
+     * Throws if an interval is 0.
+     */
+    void setTierIntervals(bs::UINT32 midTierTicks, bs::UINT32 farTierTicks);
+
+    /**
+     * Sets the maximum time to spend on script states of the Mid and Far tiers per frame.
+     */
+    void setScriptTimeBudget(float milliseconds);
+
+    /**
+     * Sets whether loop functions of script states may run on the worker threads.
+     * If disabled, all script states are updated on the main thread.
+     */
+    void setParallelScriptStates(bool enabled);
+
+    /**
+     * @return What the scheduler did during the last fixed tick.
+     */
+    const Statistics& statistics() const
+    {
+      return mStatistics;
+    }
+
+    /**
+     * Prints the statistics of the last tick to the debug log.
+     */
+    void logStatistics() const;
+
+    /**
+     * Updates the script states of all registered characters which are due.
+     */
+    void fixedUpdate() override;
+
+  private:
+    struct ScheduledCharacter
+    {
+      HCharacterEventQueue eventQueue;
+      HCharacterAI characterAI;
+
+      /**
+       * Time passed since the script state was updated last.
+       */
+      float accumulatedDelta = 0.0f;
+
+      /**
+       * Number of fixed ticks since the script state was updated last.
+       */
+      bs::UINT32 ticksSinceUpdate = 0;
+
+      Tier tier = Tier::Near;
+
+      /**
+       * Whether the loop function of the script state has already been run on a worker
+       * thread this tick, so the update must not be deferred anymore.
+       */
+      bool hasConcurrentUpdate = false;
+    };
+
+    /**
+     * @return Which tier the given character belongs into right now.
+     */
+    Tier findTier(const ScheduledCharacter& character, const bs::Vector3& cameraPosition) const;
+
+    /**
+     * @return Whether the given character should be updated on this tick.
+     */
+    bool isUpdateDue(const ScheduledCharacter& character) const;
+
+    /**
+     * Runs the script state of the given character and resets its accumulated time.
+     */
+    void updateCharacter(ScheduledCharacter& character);
+
+    /**
+     * Runs the loop functions of all due characters which allow it on the worker threads
+     * and applies their side effects afterwards.
+     */
+    void runScriptStateLoopsConcurrently();
+
+    /**
+     * Removes characters which have been destroyed since the last tick.
+     */
+    void removeDestroyedCharacters();
+
+    /**
+     * Characters whose script states are updated by this scheduler. Not saved.
+     */
+    bs::Vector<ScheduledCharacter> mCharacters;
+
+    /**
+     * Where to continue updating the Mid and Far tiers on the next tick, so the budget is
+     * shared fairly between all characters.
+     */
+    bs::UINT32 mRoundRobinCursor = 0;
+
+    float mNearTierRange      = 0.0f;
+    bs::UINT32 mMidTierTicks  = 0;
+    bs::UINT32 mFarTierTicks  = 0;
+    float mScriptTimeBudgetMs = 0.0f;
+
+    bool mIsParallelScriptStatesEnabled = true;
+
+    Statistics mStatistics;
+
+  public:
+    REGOTH_DECLARE_RTTI(AIScheduler)
+
+  protected:
+    AIScheduler() = default;  // For RTTI
+  };
+
+  using HAIScheduler = bs::GameObjectHandle<AIScheduler>;
+}  // namespace REGoth
@@ -4,6 +4,8 @@
 #include <Scene/BsSceneObject.h>
 #include <components/CharacterAI.hpp>
 #include <components/CharacterEventQueue.hpp>
+#include <components/CharacterPerception.hpp>
+#include <components/GameClock.hpp>
 #include <components/GameWorld.hpp>
 #include <components/StoryInformation.hpp>
 #include <components/VisualCharacter.hpp>
@@ -176,12 +178,19 @@ namespace REGoth
     }
   }
 
-  void Character::refuseTalk()
+  bool Character::refuseTalk() const
   {
+    return gameWorld()->gameclock()->timers().isScheduled(mRefuseTalkTimer);
   }
 
   void Character::setRefuseTalk(bs::INT32 durationSeconds)
   {
+    AI::TimerWheel& timers = gameWorld()->gameclock()->timers();
+
+    timers.cancel(mRefuseTalkTimer);
+
+    mRefuseTalkTimer = durationSeconds > 0 ? timers.scheduleIn((float)durationSeconds)
+                                           : AI::TimerHandle();
   }
 
   void Character::setCurrentWaypoint(const bs::String& waypoint)
@@ -222,17 +231,46 @@ namespace REGoth
 
   bool Character::canSeeItem(bs::HSceneObject itemSO)
   {
-    return true;
+    const bs::Transform& transform = SO()->getTransform();
+    const bs::Vector3& target      = itemSO->getTransform().pos();
+
+    if (!isInSensesRange(target)) return false;
+    if (!CharacterPerception::isInFieldOfView(transform, target)) return false;
+
+    return CharacterPerception::isInLineOfSight(transform.pos(), target);
   }
 
   bool Character::canSeeNpcFreeLOS(bs::HSceneObject targetCharacterSO)
   {
-    return true;
+    const bs::Vector3& target = targetCharacterSO->getTransform().pos();
+
+    if (!isInSensesRange(target)) return false;
+
+    return CharacterPerception::isInLineOfSight(SO()->getTransform().pos(), target);
   }
 
   bool Character::canSeeNPC(bs::HSceneObject targetCharacterSO)
   {
-    return true;
+    const bs::Transform& transform = SO()->getTransform();
+    const bs::Vector3& target      = targetCharacterSO->getTransform().pos();
+
+    if (!isInSensesRange(target)) return false;
+    if (!CharacterPerception::isInFieldOfView(transform, target)) return false;
+
+    return CharacterPerception::isInLineOfSight(transform.pos(), target);
+  }
+
+  float Character::getSensesRange()
+  {
+    // Scripts use centimeters
+    return scriptObjectData().intValue("SENSES_RANGE") / 100.0f;
+  }
+
+  bool Character::isInSensesRange(const bs::Vector3& position)
+  {
+    float range = getSensesRange();
+
+    return SO()->getTransform().pos().squaredDistance(position) <= range * range;
   }
 
   bool Character::isOnFreepoint(const bs::String& namePart)
@@ -302,9 +340,9 @@ namespace REGoth
     return p1.distance(p2);
   }
 
-  const bs::Vector<Scripting::ScriptObjectHandle>& Character::allInfosForThisCharacter() const
+  const bs::Vector<Scripting::DialogueInfo>& Character::allInfosForThisCharacter() const
   {
-    return scriptVM().allInfosOfNpc(scriptObjectData().instanceName);
+    return scriptVM().dialogueInfosOfNpc(scriptObjectData().instanceName);
   }
 
   bs::Vector<HCharacter> Character::findCharactersInRange(float range) const
@@ -1,5 +1,6 @@
 #pragma once
 #include "ScriptBackedBy.hpp"
+#include <AI/TimerWheel.hpp>
 #include <BsPrerequisites.h>
 
 namespace REGoth
@@ -7,6 +8,11 @@ namespace REGoth
   class Character;
   using HCharacter = bs::GameObjectHandle<Character>;
 
+  namespace Scripting
+  {
+    struct DialogueInfo;
+  }
+
   /**
    * Character logic. Implements most of the * externals.
    */
@@ -225,6 +231,12 @@ namespace REGoth
      */
     bool canSeeItem(bs::HSceneObject itemSO);
 
+    /**
+     * @return How far this character can perceive things in meters, as set in
+     *         `C_NPC.senses_range`.
+     */
+    float getSensesRange();
+
     void clearAiQueue();
 
     /**
@@ -312,8 +324,16 @@ namespace REGoth
      */
     bs::String getNextWaypoint();
 
+    /**
+     * Lets this character refuse to talk for the given number of seconds, like
+     * `Npc_SetRefuseTalk()`. Replaces any time set before.
+     */
     void setRefuseTalk(bs::INT32 durationSeconds);
-    void refuseTalk();
+
+    /**
+     * @return Whether this character still refuses to talk, see setRefuseTalk().
+     */
+    bool refuseTalk() const;
 
     /**
      * Check if an AI state is active (direct).
@@ -359,11 +379,12 @@ namespace REGoth
     bool checkInfo(bool important);
 
     /**
-     * All *Information*-Instances for this Character. See DaedalusVMForGameWorld::allInfosOfNpc().
+     * All *Information*-Instances for this Character, sorted by priority. See
+     * DaedalusVMForGameWorld::dialogueInfosOfNpc().
      *
      * This is more like raw data. Use the `StoryInformation`-component to actually work with these.
      */
-    const bs::Vector<Scripting::ScriptObjectHandle>& allInfosForThisCharacter() const;
+    const bs::Vector<Scripting::DialogueInfo>& allInfosForThisCharacter() const;
 
     /**
      * Returns a list of all characters standing near this character, in the specified range.
@@ -374,6 +395,17 @@ namespace REGoth
 
     bs::INT32 GetStateTime();
 
+  private:
+    /**
+     * @return Whether the given position is not further away than the senses range.
+     */
+    bool isInSensesRange(const bs::Vector3& position);
+
+    /**
+     * Runs as long as this character refuses to talk. Not saved.
+     */
+    AI::TimerHandle mRefuseTalkTimer;
+
   public:
     REGOTH_DECLARE_RTTI(Character);
 
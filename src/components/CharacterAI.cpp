@@ -1,11 +1,11 @@
 #include "CharacterAI.hpp"
-#include <Components/BsCCamera.h>
 #include <Components/BsCCharacterController.h>
 #include <RTTI/RTTI_CharacterAI.hpp>
-#include <Scene/BsSceneManager.h>
 #include <Scene/BsSceneObject.h>
 #include <animation/StateNaming.hpp>
 #include <components/Character.hpp>
+#include <components/CharacterPerception.hpp>
+#include <components/CharacterPhysicsLOD.hpp>
 #include <components/GameWorld.hpp>
 #include <components/StoryInformation.hpp>
 #include <components/VisualCharacter.hpp>
@@ -19,18 +19,6 @@ namespace REGoth
   /** Multiplicator of how fast the character can turn while holding a weapon. */
   constexpr float TURN_SPEED_MULTIPLICATOR_WITH_WEAPON = 2.0f;
 
-  /**
-   * How far away the character can be from the camera until it should disable physics.
-   * Must be larger than the range which activates physics again, ACTIVATE_PHYSICS_RANGE_METERS.
-   * See https://regoth-project.github.io/REGoth-bs/content/characters.html
-   *
-   * TODO: Make this configurable.
-   */
-  constexpr float DEACTIVATE_PHYSICS_RANGE_METERS = 45.0;
-
-  /** See DEACTIVATE_PHYSICS_RANGE_METERS */
-  constexpr float ACTIVATE_PHYSICS_RANGE_METERS = 40.0;
-
   CharacterAI::CharacterAI(const bs::HSceneObject& parent, HGameWorld world)
       : bs::Component(parent)
       , mWorld(world)
@@ -44,48 +32,55 @@ namespace REGoth
           bs::StringUtil::format("Scene Object {0} does not have a VisualCharacter component!",
                                  SO()->getName()));
     }
+  }
 
-    mCharacterController = SO()->getComponent<bs::CCharacterController>();
+  void CharacterAI::onInitialized()
+  {
+    // Also runs after loading, where a missing controller is expected if physics were asleep
+    // while saving
+    if (mCharacterController.isDestroyed())
+    {
+      mCharacterController = SO()->getComponent<bs::CCharacterController>();
+    }
 
+    // Without a controller, physics are asleep. They get a new controller from the worlds
+    // CharacterPhysicsLOD once they wake up again, see activatePhysics().
     if (mCharacterController.isDestroyed())
     {
-      REGOTH_THROW(
-          InvalidStateException,
-          bs::StringUtil::format("Scene Object {0} does not have a CCharacterController component!",
-                                 SO()->getName()));
+      mIsPhysicsActive = false;
     }
   }
 
   void CharacterAI::deactivatePhysics()
   {
-    mIsPhysicsActive = false;
-  }
-
-  void CharacterAI::activatePhysics()
-  {
-    mIsPhysicsActive = true;
-  }
+    if (!mIsPhysicsActive) return;
 
-  bool CharacterAI::shouldDisablePhysics() const
-  {
-    const auto& mainCamera     = bs::gSceneManager().getMainCamera();
-    const auto& cameraPosition = mainCamera->getTransform().pos();
-    const auto& soPosition     = SO()->getTransform().pos();
+    mIsPhysicsActive = false;
 
-    float maxRangeSq = DEACTIVATE_PHYSICS_RANGE_METERS * DEACTIVATE_PHYSICS_RANGE_METERS;
+    // Remove the controller from the physics scene, so it doesn't cost anything while asleep
+    if (!mCharacterController.isDestroyed())
+    {
+      mControllerRadius = mCharacterController->getRadius();
+      mControllerHeight = mCharacterController->getHeight();
 
-    return cameraPosition.squaredDistance(soPosition) > maxRangeSq;
+      mCharacterController->destroy();
+      mCharacterController = {};
+    }
   }
 
-  bool CharacterAI::shouldEnablePhysics() const
+  void CharacterAI::activatePhysics()
   {
-    const auto& mainCamera     = bs::gSceneManager().getMainCamera();
-    const auto& cameraPosition = mainCamera->getTransform().pos();
-    const auto& soPosition     = SO()->getTransform().pos();
+    if (mIsPhysicsActive) return;
 
-    float minRangeSq = ACTIVATE_PHYSICS_RANGE_METERS * ACTIVATE_PHYSICS_RANGE_METERS;
+    mIsPhysicsActive = true;
 
-    return cameraPosition.squaredDistance(soPosition) < minRangeSq;
+    // The new controller starts out wherever the routine has moved the character to
+    if (mCharacterController.isDestroyed())
+    {
+      mCharacterController = SO()->addComponent<bs::CCharacterController>();
+      mCharacterController->setRadius(mControllerRadius);
+      mCharacterController->setHeight(mControllerHeight);
+    }
   }
 
   bool CharacterAI::isPhysicsActive() const
@@ -93,24 +88,6 @@ namespace REGoth
     return mIsPhysicsActive;
   }
 
-  void CharacterAI::handlePhysicsActivation()
-  {
-    if (mIsPhysicsActive)
-    {
-      if (shouldDisablePhysics())
-      {
-        deactivatePhysics();
-      }
-    }
-    else
-    {
-      if (shouldEnablePhysics())
-      {
-        activatePhysics();
-      }
-    }
-  }
-
   bool CharacterAI::goForward()
   {
     if (!isStateSwitchAllowed()) return false;
@@ -212,7 +189,18 @@ namespace REGoth
 
     // Characters should stay upright (at least most of them),
     // thus modify the position as if it were straight ahead.
-    positionSameHeight.y = SO()->getTransform().pos().y;
+    const bs::Transform& transform = SO()->getTransform();
+
+    positionSameHeight.y = transform.pos().y;
+
+    bs::Vector3 direction = positionSameHeight - transform.pos();
+    float distance        = direction.length();
+
+    if (distance < 0.001f) return;
+
+    // This is called on every tick while following a route, where the direction rarely changes.
+    // Not touching the rotation then saves updating the transforms of the whole hierarchy.
+    if (transform.getForward().dot(direction / distance) > 0.9999f) return;
 
     SO()->lookAt(positionSameHeight);
   }
@@ -238,7 +226,22 @@ namespace REGoth
 
   void CharacterAI::fixedUpdate()
   {
-    handlePhysicsActivation();
+    if (!mIsRegisteredForPhysicsLOD)
+    {
+      HCharacterPhysicsLOD physicsLOD = mWorld->characterPhysicsLOD();
+
+      // Worlds saved before there was a CharacterPhysicsLOD keep physics enabled everywhere
+      if (physicsLOD)
+      {
+        physicsLOD->registerCharacter(bs::static_object_cast<CharacterAI>(getHandle()));
+      }
+      else
+      {
+        activatePhysics();
+      }
+
+      mIsRegisteredForPhysicsLOD = true;
+    }
 
     if (!mIsPhysicsActive)
     {
@@ -367,7 +370,18 @@ namespace REGoth
 
   void CharacterAI::setWeaponMode(AI::WeaponMode mode)
   {
+    bool isDrawingWeapon = mWeaponMode == AI::WeaponMode::None && mode != AI::WeaponMode::None;
+
     mWeaponMode = mode;
+
+    HCharacter character = SO()->getComponent<Character>();
+
+    // Characters around the player should react to them drawing a weapon
+    if (isDrawingWeapon && mWorld->characterPerception() && character->isPlayer())
+    {
+      mWorld->characterPerception()->sendPassivePerception(
+          character, AI::PerceptionType::DrawWeapon, character, {});
+    }
   }
 
   void CharacterAI::stopProcessingInfos()
@@ -26,8 +26,10 @@ namespace REGoth
     /**
      * Puts the characters physics to sleep which saves processing time.
      *
-     * During physics sleep, no movement is being calculated and applied to the
-     * Character-Controller. To enable physics again, see activatePhysics().
+     * During physics sleep, no movement is being calculated and the Character-Controller
+     * is removed from the physics scene. To enable physics again, see activatePhysics().
+     *
+     * Usually called by the worlds CharacterPhysicsLOD.
      */
     void deactivatePhysics();
 
@@ -125,6 +127,7 @@ namespace REGoth
 
     // Component -----------------------------------------------------------------------------------
 
+    void onInitialized() override;
     void fixedUpdate() override;
 
     // AI - Externals ------------------------------------------------------------------------------
@@ -157,35 +160,15 @@ namespace REGoth
      */
     void setWeaponMode(AI::WeaponMode mode);
 
-  private:
-    /**
-     * Checks whether the character is so far away from the player that it should
-     * deactivate physics to save some performance. Note that there exists another
-     * method for checking whether to *activate* physics again. If the character
-     * stands between the distances required for both these methods, both will
-     * return false.
-     *
-     * See https://regoth-project.github.io/REGoth-bs/content/characters.html
-     */
-    bool shouldDisablePhysics() const;
-
-    /**
-     * Checks whether the character is so close to the player that it should
-     * wake up and activate physics. Note that there exists another
-     * method for checking whether to *deactivate* physics. If the character
-     * stands between the distances required for both these methods, both will
-     * return false.
-     *
-     * See https://regoth-project.github.io/REGoth-bs/content/characters.html
-     */
-    bool shouldEnablePhysics() const;
-
     /**
-     * Activates, deactivates or keeps the current state of whether the physics
-     * of this character are enabled. To be called every couple frames.
+     * @return The kind of weapon this character is holding right now.
      */
-    void handlePhysicsActivation();
+    AI::WeaponMode weaponMode() const
+    {
+      return mWeaponMode;
+    }
 
+  private:
     /**
      * Applies the currently set turning parameters to the character.
      *
@@ -198,6 +181,10 @@ namespace REGoth
     HGameWorld mWorld;
     bs::HCharacterController mCharacterController;
 
+    // Shape of the Character-Controller, to restore it after physics have been asleep
+    float mControllerRadius = 0.35f;
+    float mControllerHeight = 0.5f;
+
     // AI-Script state handler
     bs::SPtr<AI::ScriptState> mScriptState;
 
@@ -214,6 +201,9 @@ namespace REGoth
     // Whether Physics is being processed for this character
     bool mIsPhysicsActive = true;
 
+    // Whether the worlds CharacterPhysicsLOD has been told about this character. Not saved.
+    bool mIsRegisteredForPhysicsLOD = false;
+
     // Whether the character is running, sneaking, etc
     AI::WalkMode mWalkMode = AI::WalkMode::Run;
 
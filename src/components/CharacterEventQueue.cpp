@@ -2,8 +2,11 @@
 #include <AI/ScriptState.hpp>
 #include <RTTI/RTTI_CharacterEventQueue.hpp>
 #include <Scene/BsSceneObject.h>
+#include <components/AIScheduler.hpp>
 #include <components/Character.hpp>
 #include <components/CharacterAI.hpp>
+#include <components/CharacterPerception.hpp>
+#include <components/GameClock.hpp>
 #include <components/GameWorld.hpp>
 #include <components/VisualCharacter.hpp>
 #include <exception/Throw.hpp>
@@ -11,7 +14,7 @@
 
 namespace REGoth
 {
-  using SharedEMessage = CharacterEventQueue::SharedEMessage;
+  using MessageHandle = CharacterEventQueue::MessageHandle;
 
   CharacterEventQueue::CharacterEventQueue(const bs::HSceneObject& parent, HCharacter character,
                                            HCharacterAI characterAI,
@@ -50,6 +53,14 @@ namespace REGoth
     }
   }
 
+  void CharacterEventQueue::setWaynet(HWaynet waynet)
+  {
+    if (mPathfinder)
+    {
+      mPathfinder->setWaynet(waynet);
+    }
+  }
+
   void CharacterEventQueue::startRouteToPosition(const bs::Vector3& target)
   {
     mPathfinder->startNewRouteTo(positionNow(), target);
@@ -79,70 +90,202 @@ namespace REGoth
     mCharacterAI->goForward();
   }
 
-  void CharacterEventQueue::onExecuteEventAction(SharedEMessage message, bs::HSceneObject sender)
+  /**
+   * Sub type of handlers taking care of all sub types of a message type which have no
+   * handler of their own.
+   */
+  constexpr bs::UINT32 ANY_SUBTYPE = ~0u;
+
+  /** Returned by findEventHandler() if a message can't be handled at all. */
+  constexpr bs::UINT32 NO_EVENT_HANDLER = ~0u;
+
+  /** Number of values in AI::EventMessageType */
+  constexpr bs::UINT32 NUM_EVENT_MESSAGE_TYPES = (bs::UINT32)AI::EventMessageType::SndStopp + 1;
+
+  /**
+   * Shortcut to create an entry of CharacterEventQueue::EVENT_HANDLERS.
+   */
+#define REGOTH_EVENT_HANDLER(messageType, messageClass, subType, handler)                  \
+  {                                                                                        \
+    AI::EventMessageType::messageType, subType,                                            \
+        &CharacterEventQueue::dispatchTo<AI::messageClass, &CharacterEventQueue::handler>, \
+        #handler                                                                           \
+  }
+
+  const CharacterEventQueue::EventHandlerEntry CharacterEventQueue::EVENT_HANDLERS[] = {
+      REGOTH_EVENT_HANDLER(Event, EventMessage, ANY_SUBTYPE, EV_Event),
+      REGOTH_EVENT_HANDLER(Npc, NpcMessage, ANY_SUBTYPE, EV_Npc),
+      REGOTH_EVENT_HANDLER(Damage, DamageMessage, ANY_SUBTYPE, EV_Damage),
+      REGOTH_EVENT_HANDLER(Weapon, WeaponMessage, AI::WeaponMessage::ST_ChooseWeapon,
+                           EV_Weapon_ChooseWeapon),
+      REGOTH_EVENT_HANDLER(Weapon, WeaponMessage, ANY_SUBTYPE, EV_Weapon),
+      REGOTH_EVENT_HANDLER(Movement, MovementMessage, AI::MovementMessage::ST_GotoObject,
+                           EV_Movement_GotoObject),
+      REGOTH_EVENT_HANDLER(Movement, MovementMessage, AI::MovementMessage::ST_GotoPos,
+                           EV_Movement_GotoPos),
+      REGOTH_EVENT_HANDLER(Movement, MovementMessage, AI::MovementMessage::ST_SetWalkMode,
+                           EV_Movement_SetWalkMode),
+      REGOTH_EVENT_HANDLER(Movement, MovementMessage, ANY_SUBTYPE, EV_Movement),
+      REGOTH_EVENT_HANDLER(Attack, AttackMessage, ANY_SUBTYPE, EV_Attack),
+      REGOTH_EVENT_HANDLER(UseItem, UseItemMessage, ANY_SUBTYPE, EV_UseItem),
+      REGOTH_EVENT_HANDLER(State, StateMessage, AI::StateMessage::ST_StartState,
+                           EV_State_StartState),
+      REGOTH_EVENT_HANDLER(State, StateMessage, AI::StateMessage::ST_Wait, EV_State_Wait),
+      REGOTH_EVENT_HANDLER(State, StateMessage, AI::StateMessage::ST_Perception,
+                           EV_State_Perception),
+      REGOTH_EVENT_HANDLER(State, StateMessage, ANY_SUBTYPE, EV_State),
+      REGOTH_EVENT_HANDLER(Manipulate, ManipulateMessage, ANY_SUBTYPE, EV_Manipulate),
+      REGOTH_EVENT_HANDLER(Conversation, ConversationMessage, AI::ConversationMessage::ST_PlayAni,
+                           EV_Conversation_PlayAni),
+      REGOTH_EVENT_HANDLER(Conversation, ConversationMessage, ANY_SUBTYPE, EV_Conversation),
+      REGOTH_EVENT_HANDLER(Magic, MagicMessage, ANY_SUBTYPE, EV_Magic),
+      REGOTH_EVENT_HANDLER(Mob, MobMessage, ANY_SUBTYPE, EV_Mob),
+  };
+
+#undef REGOTH_EVENT_HANDLER
+
+  bs::UINT32 CharacterEventQueue::numEventHandlers()
+  {
+    return sizeof(EVENT_HANDLERS) / sizeof(EVENT_HANDLERS[0]);
+  }
+
+  bs::Vector<CharacterEventQueue::EventHandlerCounters>& CharacterEventQueue::eventHandlerCounters()
+  {
+    static bs::Vector<EventHandlerCounters> counters(numEventHandlers());
+
+    return counters;
+  }
+
+  bs::UINT32 CharacterEventQueue::findEventHandler(AI::EventMessageType messageType,
+                                                   bs::UINT32 subType)
+  {
+    // Lookup table generated from EVENT_HANDLERS on first use: For each message type, the
+    // handler index by sub type. The last element is the fallback for all other sub types.
+    static const bs::Vector<bs::Vector<bs::UINT32>> lookup = [] {
+      bs::Vector<bs::Vector<bs::UINT32>> result(NUM_EVENT_MESSAGE_TYPES);
+
+      for (bs::UINT32 i = 0; i < numEventHandlers(); i++)
+      {
+        const EventHandlerEntry& entry = EVENT_HANDLERS[i];
+        bs::Vector<bs::UINT32>& bySubType = result[(bs::UINT32)entry.messageType];
+
+        if (entry.subType == ANY_SUBTYPE) continue;
+
+        if (bySubType.size() <= entry.subType)
+        {
+          bySubType.resize(entry.subType + 1, NO_EVENT_HANDLER);
+        }
+
+        bySubType[entry.subType] = i;
+      }
+
+      bs::Vector<bs::UINT32> fallbacks(NUM_EVENT_MESSAGE_TYPES, NO_EVENT_HANDLER);
+
+      for (bs::UINT32 i = 0; i < numEventHandlers(); i++)
+      {
+        const EventHandlerEntry& entry = EVENT_HANDLERS[i];
+
+        if (entry.subType == ANY_SUBTYPE)
+        {
+          fallbacks[(bs::UINT32)entry.messageType] = i;
+        }
+      }
+
+      for (bs::UINT32 type = 0; type < NUM_EVENT_MESSAGE_TYPES; type++)
+      {
+        if (!result[type].empty() || fallbacks[type] != NO_EVENT_HANDLER)
+        {
+          result[type].push_back(fallbacks[type]);
+        }
+      }
+
+      return result;
+    }();
+
+    if ((bs::UINT32)messageType >= NUM_EVENT_MESSAGE_TYPES) return NO_EVENT_HANDLER;
+
+    const bs::Vector<bs::UINT32>& bySubType = lookup[(bs::UINT32)messageType];
+
+    if (bySubType.empty()) return NO_EVENT_HANDLER;
+
+    // Sub types without a handler of their own fall through to the last element
+    if (subType < bySubType.size() - 1 && bySubType[subType] != NO_EVENT_HANDLER)
+    {
+      return bySubType[subType];
+    }
+
+    return bySubType.back();
+  }
+
+  void CharacterEventQueue::onExecuteEventAction(AI::EventMessage& message,
+                                                 bs::HSceneObject sender)
   {
-    using namespace AI;
+    bs::UINT32 index = findEventHandler(message.messageType, message.subType);
 
-    bool done = false;
-    switch (message->messageType)
+    if (index == NO_EVENT_HANDLER)
     {
-      case EventMessageType::Event:
-        done = EV_Event(*message.get(), sender);
-        break;
-
-      case EventMessageType::Npc:
-        done = EV_Npc(*reinterpret_cast<NpcMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Damage:
-        done = EV_Damage(*reinterpret_cast<DamageMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Weapon:
-        done = EV_Weapon(*reinterpret_cast<WeaponMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Movement:
-        done = EV_Movement(*reinterpret_cast<MovementMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Attack:
-        done = EV_Attack(*reinterpret_cast<AttackMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::UseItem:
-        done = EV_UseItem(*reinterpret_cast<UseItemMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::State:
-        done = EV_State(*reinterpret_cast<StateMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Manipulate:
-        done = EV_Manipulate(*reinterpret_cast<ManipulateMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Conversation:
-        done = EV_Conversation(*reinterpret_cast<ConversationMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Magic:
-        done = EV_Magic(*reinterpret_cast<MagicMessage*>(message.get()), sender);
-        break;
-
-      case EventMessageType::Mob:
-        // TODO handle this somehow?
-        break;
-
-      default:
-        bs::gDebug().logWarning("[CharacterEventQueue] Unhandled Event Type: " +
-                                bs::toString((int)message->messageType));
-        done = true;
-        break;
+      bs::gDebug().logWarning("[CharacterEventQueue] Unhandled Event Type: " +
+                              bs::toString((int)message.messageType));
+
+      message.deleted = true;
+      return;
     }
 
+    bs::UINT64 startTime = bs::gTime().getTimePrecise();
+
+    bool done = (this->*EVENT_HANDLERS[index].handler)(message, sender);
+
+    EventHandlerCounters& counters = eventHandlerCounters()[index];
+    counters.numCalls++;
+    counters.totalTimeUs += bs::gTime().getTimePrecise() - startTime;
+
     // Flag as deleted if this is done
-    message->deleted = done;
+    message.deleted = done;
+  }
+
+  bs::Vector<CharacterEventQueue::EventHandlerStatistics>
+  CharacterEventQueue::eventHandlerStatistics()
+  {
+    bs::Vector<EventHandlerStatistics> result;
+
+    for (bs::UINT32 i = 0; i < numEventHandlers(); i++)
+    {
+      EventHandlerStatistics statistics;
+      statistics.handlerName = EVENT_HANDLERS[i].name;
+      statistics.numCalls    = eventHandlerCounters()[i].numCalls;
+      statistics.totalTimeUs = eventHandlerCounters()[i].totalTimeUs;
+
+      result.push_back(statistics);
+    }
+
+    return result;
+  }
+
+  void CharacterEventQueue::resetEventHandlerStatistics()
+  {
+    for (EventHandlerCounters& counters : eventHandlerCounters())
+    {
+      counters = EventHandlerCounters();
+    }
+  }
+
+  void CharacterEventQueue::logEventHandlerStatistics()
+  {
+    bs::Vector<EventHandlerStatistics> statistics = eventHandlerStatistics();
+
+    std::sort(statistics.begin(), statistics.end(),
+              [](const EventHandlerStatistics& a, const EventHandlerStatistics& b) {
+                return a.totalTimeUs > b.totalTimeUs;
+              });
+
+    for (const EventHandlerStatistics& s : statistics)
+    {
+      if (s.numCalls == 0) continue;
+
+      bs::gDebug().logDebug(bs::StringUtil::format(
+          "[CharacterEventQueue] {0}: {1} calls, {2} us total, {3} us per call", s.handlerName,
+          s.numCalls, s.totalTimeUs, s.totalTimeUs / s.numCalls));
+    }
   }
 
   bool CharacterEventQueue::EV_Event(AI::EventMessage& message, bs::HSceneObject sender)
@@ -170,77 +313,66 @@ namespace REGoth
 
   bool CharacterEventQueue::EV_Weapon(AI::WeaponMessage& message, bs::HSceneObject sender)
   {
-    bool isDone = false;
-    switch ((AI::WeaponMessage::WeaponSubType)message.subType)
-    {
-      case AI::WeaponMessage::ST_ChooseWeapon:
-        mCharacterAI->setWeaponMode(message.targetMode);
-        isDone = true;
-        break;
-      default:
-        bs::gDebug().logWarning("[CharacterEventQueue] Unhandled WeaponMode-Sub Type: " +
-                                bs::toString((int)message.subType));
-        isDone = true;
-        break;
-    }
+    bs::gDebug().logWarning("[CharacterEventQueue] Unhandled WeaponMode-Sub Type: " +
+                            bs::toString((int)message.subType));
+    return true;
+  }
 
-    return isDone;
+  bool CharacterEventQueue::EV_Weapon_ChooseWeapon(AI::WeaponMessage& message,
+                                                   bs::HSceneObject sender)
+  {
+    mCharacterAI->setWeaponMode(message.targetMode);
+    return true;
   }
 
   bool CharacterEventQueue::EV_Movement(AI::MovementMessage& message, bs::HSceneObject sender)
   {
-    bool isDone = false;
-    switch ((AI::MovementMessage::MovementSubType)message.subType)
-    {
-      case AI::MovementMessage::ST_GotoObject:
-        if (message.isFirstRun)
-        {
-          startRouteToObject(message.targetObject);
-        }
-
-        if (!mPathfinder->hasActiveRouteBeenCompleted(positionNow()))
-        {
-          travelActiveRoute();
-        }
-        else
-        {
-          mCharacterAI->stopMoving();
-
-          isDone = true;
-        }
-        break;
+    bs::gDebug().logWarning("[CharacterEventQueue] Unhandled MovementMessage-Sub Type: " +
+                            bs::toString((int)message.subType));
+    return true;
+  }
 
-      case AI::MovementMessage::ST_GotoPos:
-        if (message.isFirstRun)
-        {
-          startRouteToPosition(message.targetPosition);
-        }
+  bool CharacterEventQueue::EV_Movement_GotoObject(AI::MovementMessage& message,
+                                                   bs::HSceneObject sender)
+  {
+    if (message.isFirstRun)
+    {
+      startRouteToObject(message.targetObject);
+    }
 
-        if (!mPathfinder->hasActiveRouteBeenCompleted(positionNow()))
-        {
-          travelActiveRoute();
-        }
-        else
-        {
-          mCharacterAI->stopMoving();
+    if (!mPathfinder->hasActiveRouteBeenCompleted(positionNow()))
+    {
+      travelActiveRoute();
+      return false;
+    }
 
-          isDone = true;
-        }
-        break;
+    mCharacterAI->stopMoving();
+    return true;
+  }
 
-      case AI::MovementMessage::ST_SetWalkMode:
-        mCharacterAI->setWalkMode(message.walkMode);
-        isDone = true;
-        break;
+  bool CharacterEventQueue::EV_Movement_GotoPos(AI::MovementMessage& message,
+                                                bs::HSceneObject sender)
+  {
+    if (message.isFirstRun)
+    {
+      startRouteToPosition(message.targetPosition);
+    }
 
-      default:
-        bs::gDebug().logWarning("[CharacterEventQueue] Unhandled MovementMessage-Sub Type: " +
-                                bs::toString((int)message.subType));
-        isDone = true;
-        break;
+    if (!mPathfinder->hasActiveRouteBeenCompleted(positionNow()))
+    {
+      travelActiveRoute();
+      return false;
     }
 
-    return isDone;
+    mCharacterAI->stopMoving();
+    return true;
+  }
+
+  bool CharacterEventQueue::EV_Movement_SetWalkMode(AI::MovementMessage& message,
+                                                    bs::HSceneObject sender)
+  {
+    mCharacterAI->setWalkMode(message.walkMode);
+    return true;
   }
 
   bool CharacterEventQueue::EV_Attack(AI::AttackMessage& message, bs::HSceneObject sender)
@@ -261,62 +393,84 @@ namespace REGoth
 
   bool CharacterEventQueue::EV_State(AI::StateMessage& message, bs::HSceneObject sender)
   {
-    bool isDone = false;
+    return true;
+  }
+
+  bool CharacterEventQueue::EV_State_StartState(AI::StateMessage& message,
+                                                bs::HSceneObject sender)
+  {
+    mCharacter->useAsSelf();
 
-    switch ((AI::StateMessage::StateSubType)message.subType)
+    if (message.other)
     {
-      case AI::StateMessage::ST_StartState:
+      message.other->useAsOther();
+    }
 
-        mCharacter->useAsSelf();
+    if (message.victim)
+    {
+      message.victim->useAsVictim();
+    }
 
-        if (message.other)
-        {
-          message.other->useAsOther();
-        }
+    if (message.state.empty())
+    {
+      mScriptState->startDailyRoutine(true);
+    }
+    else
+    {
+      mScriptState->startScriptAIState(message.state);
+    }
 
-        if (message.victim)
-        {
-          message.victim->useAsVictim();
-        }
+    if (message.interruptOldState)
+    {
+      mScriptState->interruptActiveState();
+    }
+    else
+    {
+      mScriptState->requestEndActiveState();
+    }
 
-        if (message.state.empty())
-        {
-          mScriptState->startDailyRoutine(true);
-        }
-        else
-        {
-          mScriptState->startScriptAIState(message.state);
-        }
+    mScriptState->applyStateChange();
 
-        if (message.interruptOldState)
-        {
-          mScriptState->interruptActiveState();
-        }
-        else
-        {
-          mScriptState->requestEndActiveState();
-        }
+    return true;
+  }
 
-        mScriptState->applyStateChange();
+  bool CharacterEventQueue::EV_State_Wait(AI::StateMessage& message, bs::HSceneObject sender)
+  {
+    if (message.waitTime <= 0) return true;
 
-        isDone = true;
-        break;
+    AI::TimerWheel& timers = mWorld->gameclock()->timers();
 
-      case AI::StateMessage::ST_Wait:
-        message.waitTime -= bs::gTime().getFixedFrameDelta();
+    if (!message.waitTimer.isValid())
+    {
+      // Waits which were running while saving already have their deadline
+      if (message.waitDeadlineSeconds < 0.0f)
+      {
+        message.waitDeadlineSeconds = timers.secondsNow() + message.waitTime;
+      }
 
-        if (message.waitTime <= 0)
-        {
-          isDone = true;
-        }
-        break;
+      message.waitTimer = timers.schedule(message.waitDeadlineSeconds);
+    }
 
-      default:
-        isDone = true;
-        break;
+    return !timers.isScheduled(message.waitTimer);
+  }
+
+  bool CharacterEventQueue::EV_State_Perception(AI::StateMessage& message,
+                                                bs::HSceneObject sender)
+  {
+    // The perceived characters might have been destroyed since the message has been pushed
+    if (message.other.isDestroyed()) return true;
+
+    mCharacter->useAsSelf();
+    message.other->useAsOther();
+
+    if (message.victim && !message.victim.isDestroyed())
+    {
+      message.victim->useAsVictim();
     }
 
-    return isDone;
+    mScriptState->runInstruction(message.perceptionFunction);
+
+    return true;
   }
 
   bool CharacterEventQueue::EV_Manipulate(AI::ManipulateMessage& message, bs::HSceneObject sender)
@@ -329,47 +483,43 @@ namespace REGoth
 
   bool CharacterEventQueue::EV_Conversation(AI::ConversationMessage& message,
                                             bs::HSceneObject sender)
+  {
+    bs::gDebug().logWarning("[CharacterEventQueue] Unhandled Conversation-Sub Type: " +
+                            bs::toString((int)message.subType));
+    return true;
+  }
+
+  bool CharacterEventQueue::EV_Conversation_PlayAni(AI::ConversationMessage& message,
+                                                    bs::HSceneObject sender)
   {
     bool isDone = false;
 
-    switch ((AI::ConversationMessage::ConversationSubType)message.subType)
+    if (message.isFirstRun)
     {
-      case AI::ConversationMessage::ST_PlayAni:
+      // bs::gDebug().logDebug(bs::StringUtil::format(
+      //     "[CharacterEventQueue] {0} - PlayAni start: {1}", SO()->getName(), message.animation));
 
-        if (message.isFirstRun)
-        {
-          // bs::gDebug().logDebug(bs::StringUtil::format(
-          //     "[CharacterEventQueue] {0} - PlayAni start: {1}", SO()->getName(), message.animation));
-
-          message.playingClip = mVisualCharacter->findAnimationClip(message.animation);
-
-          if (message.playingClip)
-          {
-            mVisualCharacter->playAnimation(message.playingClip);
-          }
-          else
-          {
-            isDone = true;
-          }
-        }
-        else
-        {
-          isDone = !mVisualCharacter->isAnimationPlaying(message.playingClip);
-
-          if (isDone)
-          {
-            // bs::gDebug().logDebug(
-            //     bs::StringUtil::format("[CharacterEventQueue] {0} - PlayAni done: {1}",
-            //                            SO()->getName(), message.animation));
-          }
-        }
-        break;
+      message.playingClip = mVisualCharacter->findAnimationClip(message.animation);
 
-      default:
-        bs::gDebug().logWarning("[CharacterEventQueue] Unhandled Conversation-Sub Type: " +
-                                bs::toString((int)message.subType));
+      if (message.playingClip)
+      {
+        mVisualCharacter->playAnimation(message.playingClip);
+      }
+      else
+      {
         isDone = true;
-        break;
+      }
+    }
+    else
+    {
+      isDone = !mVisualCharacter->isAnimationPlaying(message.playingClip);
+
+      if (isDone)
+      {
+        // bs::gDebug().logDebug(
+        //     bs::StringUtil::format("[CharacterEventQueue] {0} - PlayAni done: {1}",
+        //                            SO()->getName(), message.animation));
+      }
     }
 
     return isDone;
@@ -383,21 +533,84 @@ namespace REGoth
     return done;
   }
 
+  bool CharacterEventQueue::EV_Mob(AI::MobMessage& message, bs::HSceneObject sender)
+  {
+    // TODO handle this somehow?
+    return false;
+  }
+
   void CharacterEventQueue::fixedUpdate()
   {
     EventQueue::fixedUpdate();
 
-    if (mCharacterAI->isPhysicsActive())
+    if (!mIsScheduled)
     {
-      mScriptState->doAIState(bs::gTime().getFixedFrameDelta());
+      HAIScheduler scheduler = mWorld->aiScheduler();
+
+      if (scheduler)
+      {
+        scheduler->registerCharacter(bs::static_object_cast<CharacterEventQueue>(getHandle()));
+        mIsScheduled = true;
+      }
+      else
+      {
+        // Worlds saved before there was a scheduler don't have one, update ourselves then
+        if (mCharacterAI->isPhysicsActive())
+        {
+          updateScriptState(bs::gTime().getFixedFrameDelta());
+        }
+        else
+        {
+          updateScriptStateDuringShrink();
+        }
+      }
     }
-    else
+
+    if (!mIsRegisteredForPerception)
     {
-      mScriptState->doAIStateDuringShrink();
+      // Worlds saved before perceptions existed just don't sense anything
+      HCharacterPerception perception = mWorld->characterPerception();
+
+      if (perception)
+      {
+        perception->registerCharacter(bs::static_object_cast<CharacterEventQueue>(getHandle()));
+      }
+
+      mIsRegisteredForPerception = true;
     }
   }
 
-  SharedEMessage CharacterEventQueue::pushGotoPosition(const bs::Vector3& position)
+  void CharacterEventQueue::updateScriptState(float deltaTime)
+  {
+    mScriptState->doAIState(deltaTime);
+  }
+
+  void CharacterEventQueue::updateScriptStateDuringShrink()
+  {
+    mScriptState->doAIStateDuringShrink();
+  }
+
+  bool CharacterEventQueue::canUpdateScriptStateConcurrently()
+  {
+    return mScriptState->canRunLoopFunctionConcurrently();
+  }
+
+  void CharacterEventQueue::prepareScriptStateConcurrently(float deltaTime)
+  {
+    mScriptState->prepareLoopFunctionConcurrently(deltaTime);
+  }
+
+  void CharacterEventQueue::updateScriptStateConcurrently()
+  {
+    mScriptState->runLoopFunctionConcurrently();
+  }
+
+  void CharacterEventQueue::applyConcurrentScriptStateSideEffects()
+  {
+    mScriptState->applyConcurrentSideEffects();
+  }
+
+  MessageHandle CharacterEventQueue::pushGotoPosition(const bs::Vector3& position)
   {
     AI::MovementMessage msg;
 
@@ -407,7 +620,7 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushGotoObject(bs::HSceneObject object)
+  MessageHandle CharacterEventQueue::pushGotoObject(bs::HSceneObject object)
   {
     AI::MovementMessage msg;
 
@@ -417,7 +630,7 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushSetWalkMode(AI::WalkMode walkMode)
+  MessageHandle CharacterEventQueue::pushSetWalkMode(AI::WalkMode walkMode)
   {
     AI::MovementMessage msg;
     msg.subType  = AI::MovementMessage::ST_SetWalkMode;
@@ -426,7 +639,7 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushWait(float seconds)
+  MessageHandle CharacterEventQueue::pushWait(float seconds)
   {
     AI::StateMessage msg;
 
@@ -436,14 +649,14 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushTalkToCharacter(HCharacter other)
+  MessageHandle CharacterEventQueue::pushTalkToCharacter(HCharacter other)
   {
     return pushInterruptAndStartScriptState("ZS_TALK", "", other, {});
   }
 
-  SharedEMessage CharacterEventQueue::pushStartScriptState(const bs::String& state,
-                                                           const bs::String& waypoint,
-                                                           HCharacter other, HCharacter victim)
+  MessageHandle CharacterEventQueue::pushStartScriptState(const bs::String& state,
+                                                          const bs::String& waypoint,
+                                                          HCharacter other, HCharacter victim)
   {
     AI::StateMessage msg;
 
@@ -460,10 +673,10 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushInterruptAndStartScriptState(const bs::String& state,
-                                                                       const bs::String& waypoint,
-                                                                       HCharacter other,
-                                                                       HCharacter victim)
+  MessageHandle CharacterEventQueue::pushInterruptAndStartScriptState(const bs::String& state,
+                                                                      const bs::String& waypoint,
+                                                                      HCharacter other,
+                                                                      HCharacter victim)
   {
     AI::StateMessage msg;
 
@@ -480,7 +693,7 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushPlayAnimation(const bs::String animation)
+  MessageHandle CharacterEventQueue::pushPlayAnimation(const bs::String animation)
   {
     AI::ConversationMessage msg;
 
@@ -490,7 +703,7 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushGoToFistModeImmediate()
+  MessageHandle CharacterEventQueue::pushGoToFistModeImmediate()
   {
     AI::WeaponMessage msg;
 
@@ -502,6 +715,59 @@ namespace REGoth
     return onMessage(msg);
   }
 
+  MessageHandle CharacterEventQueue::pushPerception(AI::PerceptionType type, HCharacter other,
+                                                    HCharacter victim)
+  {
+    if (!isPerceptionEnabled(type)) return {};
+
+    AI::StateMessage msg;
+
+    msg.subType            = AI::StateMessage::ST_Perception;
+    msg.perceptionFunction = mPerceptionFunctions[(bs::UINT32)type];
+    msg.other              = other;
+    msg.victim             = victim;
+    msg.isJob              = false;
+    msg.isHighPriority     = true;
+
+    return onMessage(msg);
+  }
+
+  void CharacterEventQueue::enablePerception(AI::PerceptionType type,
+                                             Scripting::SymbolIndex function)
+  {
+    if ((bs::UINT32)type >= AI::NUM_PERCEPTION_TYPES)
+    {
+      REGOTH_THROW(InvalidParametersException,
+                   bs::StringUtil::format("Unknown perception type: {0}", (bs::INT32)type));
+    }
+
+    if (mPerceptionFunctions.empty())
+    {
+      mPerceptionFunctions.resize(AI::NUM_PERCEPTION_TYPES, Scripting::SYMBOL_INDEX_INVALID);
+    }
+
+    mPerceptionFunctions[(bs::UINT32)type] = function;
+  }
+
+  void CharacterEventQueue::disablePerception(AI::PerceptionType type)
+  {
+    if (!isPerceptionEnabled(type)) return;
+
+    mPerceptionFunctions[(bs::UINT32)type] = Scripting::SYMBOL_INDEX_INVALID;
+  }
+
+  bool CharacterEventQueue::isPerceptionEnabled(AI::PerceptionType type) const
+  {
+    if ((bs::UINT32)type >= mPerceptionFunctions.size()) return false;
+
+    return mPerceptionFunctions[(bs::UINT32)type] != Scripting::SYMBOL_INDEX_INVALID;
+  }
+
+  void CharacterEventQueue::setPerceptionInterval(float seconds)
+  {
+    mPerceptionInterval = seconds;
+  }
+
   void CharacterEventQueue::insertRoutineTask(const AI::ScriptState::RoutineTask& task)
   {
     mScriptState->insertRoutineTask(task);
@@ -512,10 +778,20 @@ namespace REGoth
     mScriptState->reinitRoutine();
   }
 
+  void CharacterEventQueue::onRoutineBoundaryReached(bs::UINT32 ticket)
+  {
+    mScriptState->onRoutineBoundaryReached(ticket);
+  }
+
   float CharacterEventQueue::getCurrentStateRunningTime() const
   {
     return mScriptState->getCurrentStateRunningTime();
   }
 
+  bs::String CharacterEventQueue::getCurrentStateName() const
+  {
+    return mScriptState->getCurrentStateName();
+  }
+
   REGOTH_DEFINE_RTTI(CharacterEventQueue)
 }  // namespace REGoth
@@ -1,6 +1,7 @@
 #pragma once
 #include "EventQueue.hpp"
 #include <AI/Pathfinder.hpp>
+#include <AI/PerceptionType.hpp>
 #include <AI/ScriptState.hpp>
 #include <RTTI/RTTIUtil.hpp>
 
@@ -44,22 +45,22 @@ namespace REGoth
     /**
      * Push a message to go to a position into the queue.
      */
-    SharedEMessage pushGotoPosition(const bs::Vector3& position);
+    MessageHandle pushGotoPosition(const bs::Vector3& position);
 
     /**
      * Push a message to go to an object into the queue.
      */
-    SharedEMessage pushGotoObject(bs::HSceneObject object);
+    MessageHandle pushGotoObject(bs::HSceneObject object);
 
     /**
      * Push a message to set the walk-mode into the queue.
      */
-    SharedEMessage pushSetWalkMode(AI::WalkMode walkMode);
+    MessageHandle pushSetWalkMode(AI::WalkMode walkMode);
 
     /**
      * Push a message which lets the queue execution wait for the given time.
      */
-    SharedEMessage pushWait(float seconds);
+    MessageHandle pushWait(float seconds);
 
     /**
      * Push a message which lets the character talk to the given other character.
@@ -71,29 +72,78 @@ namespace REGoth
      * So, suppose you want the player to talk to Diego, you need to call pushTalkToCharacter()
      * on Diego, with `other` set to the players handle.
      */
-    SharedEMessage pushTalkToCharacter(HCharacter other);
+    MessageHandle pushTalkToCharacter(HCharacter other);
 
     /**
      * Push a message which starts a new script state after ending the current one gracefully.
      */
-    SharedEMessage pushStartScriptState(const bs::String& state, const bs::String& waypoint,
-                                        HCharacter other, HCharacter victim);
+    MessageHandle pushStartScriptState(const bs::String& state, const bs::String& waypoint,
+                                       HCharacter other, HCharacter victim);
     /**
      * Push a message which interrupts the currently active script state starts a new one.
      */
-    SharedEMessage pushInterruptAndStartScriptState(const bs::String& state,
-                                                    const bs::String& waypoint, HCharacter other,
-                                                    HCharacter victim);
+    MessageHandle pushInterruptAndStartScriptState(const bs::String& state,
+                                                   const bs::String& waypoint, HCharacter other,
+                                                   HCharacter victim);
 
     /**
      * Push a message which will make the character play an animation.
      */
-    SharedEMessage pushPlayAnimation(const bs::String animation);
+    MessageHandle pushPlayAnimation(const bs::String animation);
 
     /**
      * Push a message which will make the character go into fist-mode immediately.
      */
-    SharedEMessage pushGoToFistModeImmediate();
+    MessageHandle pushGoToFistModeImmediate();
+
+    /**
+     * Push a message which lets the character react to the given perception by running the
+     * script function enabled for it, see enablePerception(). The message is handled right
+     * away and does not wait for the other messages in the queue.
+     *
+     * @param  type    What has been perceived.
+     * @param  other   Character which has been perceived. Used as `OTHER` by the script.
+     * @param  victim  Character the perception is about, if any. Used as `VICTIM` by the script.
+     *
+     * @return Invalid handle, if the character does not react to that kind of perception.
+     */
+    MessageHandle pushPerception(AI::PerceptionType type, HCharacter other, HCharacter victim);
+
+    /**
+     * Lets the character react to the given kind of perception by running the given script
+     * function, like `Npc_PercEnable()`. Replaces the function set before.
+     */
+    void enablePerception(AI::PerceptionType type, Scripting::SymbolIndex function);
+
+    /**
+     * Lets the character ignore the given kind of perception, like `Npc_PercDisable()`.
+     */
+    void disablePerception(AI::PerceptionType type);
+
+    /**
+     * @return Whether the character reacts to the given kind of perception.
+     */
+    bool isPerceptionEnabled(AI::PerceptionType type) const;
+
+    /**
+     * Sets how often the character senses its surroundings for active perceptions, like
+     * `Npc_SetPercTime()`. See CharacterPerception.
+     */
+    void setPerceptionInterval(float seconds);
+
+    /**
+     * @return Seconds between two checks for active perceptions.
+     */
+    float perceptionInterval() const
+    {
+      return mPerceptionInterval;
+    }
+
+    /**
+     * Lets the Pathfinder of this character search routes on the given waynet. Used when the
+     * static world gets replaced, like when loading a delta save, see GameWorld::loadDelta().
+     */
+    void setWaynet(HWaynet waynet);
 
     /**
      * Insert a new routine task. See AI::ScriptState::insertRoutineTask().
@@ -106,11 +156,88 @@ namespace REGoth
      */
     void reinitRoutine();
 
+    /**
+     * Called by the ingame timers, see AI::ScriptState::onRoutineBoundaryReached().
+     */
+    void onRoutineBoundaryReached(bs::UINT32 ticket);
+
     /**
      * @return Time the current script state is running.
      */
     float getCurrentStateRunningTime() const;
 
+    /**
+     * @return Name of the current script state, e.g. `ZS_TALK`.
+     */
+    bs::String getCurrentStateName() const;
+
+    /**
+     * Runs the script state of this character, see AI::ScriptState::doAIState().
+     *
+     * This is called by the worlds AIScheduler, which may decide to not update this character
+     * on every tick. In that case, \p deltaTime is the time passed since the last update.
+     */
+    void updateScriptState(float deltaTime);
+
+    /**
+     * Only keeps the daily routine of this character up to date, see
+     * AI::ScriptState::doAIStateDuringShrink(). Called by the AIScheduler while the
+     * character is far away from the camera.
+     */
+    void updateScriptStateDuringShrink();
+
+    /**
+     * @return Whether the next updateScriptState() can be done on a worker thread, see
+     *         AI::ScriptState::canRunLoopFunctionConcurrently().
+     */
+    bool canUpdateScriptStateConcurrently();
+
+    /**
+     * Must be called on the main thread for all characters before any of them does
+     * updateScriptStateConcurrently(), see AI::ScriptState::prepareLoopFunctionConcurrently().
+     */
+    void prepareScriptStateConcurrently(float deltaTime);
+
+    /**
+     * Does the script part of the next updateScriptState() right now. Safe to be called for
+     * multiple characters at once from different threads, see
+     * AI::ScriptState::runLoopFunctionConcurrently().
+     */
+    void updateScriptStateConcurrently();
+
+    /**
+     * Applies what the scripts did during updateScriptStateConcurrently() to the world.
+     * Must be called on the main thread, before updateScriptState().
+     */
+    void applyConcurrentScriptStateSideEffects();
+
+    /**
+     * How often and how long the handler of each kind of message has been running, summed up
+     * over all characters since the last reset.
+     */
+    struct EventHandlerStatistics
+    {
+      bs::String handlerName;
+      bs::UINT32 numCalls    = 0;
+      bs::UINT64 totalTimeUs = 0;
+    };
+
+    /**
+     * @return Statistics of every message handler, see EventHandlerStatistics.
+     */
+    static bs::Vector<EventHandlerStatistics> eventHandlerStatistics();
+
+    /**
+     * Resets the statistics of all message handlers.
+     */
+    static void resetEventHandlerStatistics();
+
+    /**
+     * Prints the statistics of all message handlers which have been called to the debug log,
+     * most expensive first.
+     */
+    static void logEventHandlerStatistics();
+
   protected:
     void onInitialized() override;
 
@@ -142,7 +269,8 @@ namespace REGoth
      * Don't forget to flag the message as "done" when the action was executed
      * completely, e.g. when the animation is done.
      */
-    virtual void onExecuteEventAction(SharedEMessage message, bs::HSceneObject sender) override;
+    virtual void onExecuteEventAction(AI::EventMessage& message,
+                                      bs::HSceneObject sender) override;
 
     /**
      * Cyclic update
@@ -150,17 +278,81 @@ namespace REGoth
     virtual void fixedUpdate() override;
 
   private:
+    /**
+     * Message handlers. Each one handles a single sub type of a message type, or all sub types
+     * of a message type not handled otherwise. See EVENT_HANDLERS for which is which.
+     *
+     * @return Whether the message is done.
+     */
     bool EV_Event(AI::EventMessage& message, bs::HSceneObject sender);
     bool EV_Npc(AI::NpcMessage& message, bs::HSceneObject sender);
     bool EV_Damage(AI::DamageMessage& message, bs::HSceneObject sender);
     bool EV_Weapon(AI::WeaponMessage& message, bs::HSceneObject sender);
+    bool EV_Weapon_ChooseWeapon(AI::WeaponMessage& message, bs::HSceneObject sender);
     bool EV_Movement(AI::MovementMessage& message, bs::HSceneObject sender);
+    bool EV_Movement_GotoObject(AI::MovementMessage& message, bs::HSceneObject sender);
+    bool EV_Movement_GotoPos(AI::MovementMessage& message, bs::HSceneObject sender);
+    bool EV_Movement_SetWalkMode(AI::MovementMessage& message, bs::HSceneObject sender);
     bool EV_Attack(AI::AttackMessage& message, bs::HSceneObject sender);
     bool EV_UseItem(AI::UseItemMessage& message, bs::HSceneObject sender);
     bool EV_State(AI::StateMessage& message, bs::HSceneObject sender);
+    bool EV_State_StartState(AI::StateMessage& message, bs::HSceneObject sender);
+    bool EV_State_Wait(AI::StateMessage& message, bs::HSceneObject sender);
+    bool EV_State_Perception(AI::StateMessage& message, bs::HSceneObject sender);
     bool EV_Manipulate(AI::ManipulateMessage& message, bs::HSceneObject sender);
     bool EV_Conversation(AI::ConversationMessage& message, bs::HSceneObject sender);
+    bool EV_Conversation_PlayAni(AI::ConversationMessage& message, bs::HSceneObject sender);
     bool EV_Magic(AI::MagicMessage& message, bs::HSceneObject sender);
+    bool EV_Mob(AI::MobMessage& message, bs::HSceneObject sender);
+
+    /**
+     * Shared signature of all message handlers after dispatchTo() has been put in front.
+     */
+    using EventHandlerFn = bool (CharacterEventQueue::*)(AI::EventMessage&, bs::HSceneObject);
+
+    /**
+     * Casts the message to the type expected by the given handler and calls it.
+     */
+    template <typename T, bool (CharacterEventQueue::*Handler)(T&, bs::HSceneObject)>
+    bool dispatchTo(AI::EventMessage& message, bs::HSceneObject sender)
+    {
+      return (this->*Handler)(static_cast<T&>(message), sender);
+    }
+
+    struct EventHandlerEntry
+    {
+      AI::EventMessageType messageType;
+      bs::UINT32 subType;  // ANY_SUBTYPE for the fallback handler of the message type
+      EventHandlerFn handler;
+      const char* name;
+    };
+
+    /**
+     * Which handler to call for which message type and sub type.
+     */
+    static const EventHandlerEntry EVENT_HANDLERS[];
+
+    /**
+     * @return Index into EVENT_HANDLERS of the handler for the given message, or
+     *         NO_EVENT_HANDLER if there is none.
+     */
+    static bs::UINT32 findEventHandler(AI::EventMessageType messageType, bs::UINT32 subType);
+
+    /**
+     * @return Number of entries in EVENT_HANDLERS.
+     */
+    static bs::UINT32 numEventHandlers();
+
+    struct EventHandlerCounters
+    {
+      bs::UINT32 numCalls    = 0;
+      bs::UINT64 totalTimeUs = 0;
+    };
+
+    /**
+     * @return Running time of each handler in EVENT_HANDLERS, same indices.
+     */
+    static bs::Vector<EventHandlerCounters>& eventHandlerCounters();
 
     /**
      * Quick access to other components attached to the SO of this component
@@ -172,6 +364,29 @@ namespace REGoth
     bs::SPtr<AI::Pathfinder> mPathfinder;
     bs::SPtr<AI::ScriptState> mScriptState;
 
+    /**
+     * Whether the script state is updated by the worlds AIScheduler. Registration happens on
+     * the first tick, so it also works after loading a world. Not saved.
+     */
+    bool mIsScheduled = false;
+
+    /**
+     * Whether the active perceptions of this character are sensed by the worlds
+     * CharacterPerception. Registers on the first tick like mIsScheduled. Not saved.
+     */
+    bool mIsRegisteredForPerception = false;
+
+    /**
+     * Script function to run for each kind of perception, indexed by AI::PerceptionType.
+     * Empty until the first perception is enabled.
+     */
+    bs::Vector<Scripting::SymbolIndex> mPerceptionFunctions;
+
+    /**
+     * Seconds between two checks for active perceptions.
+     */
+    float mPerceptionInterval = AI::DEFAULT_PERCEPTION_INTERVAL_SECONDS;
+
   public:
     REGOTH_DECLARE_RTTI(CharacterEventQueue)
 
@@ -0,0 +1,477 @@
+#include "CharacterPerception.hpp"
+#include <Physics/BsPhysics.h>
+#include <RTTI/RTTI_CharacterPerception.hpp>
+#include <Scene/BsSceneManager.h>
+#include <Scene/BsSceneObject.h>
+#include <Utility/BsTime.h>
+#include <components/Character.hpp>
+#include <components/CharacterAI.hpp>
+#include <components/CharacterEventQueue.hpp>
+#include <exception/Throw.hpp>
+
+namespace REGoth
+{
+  /**
+   * Characters further away than this are never perceived. Scripts usually set a senses range
+   * of 20 meters, see `C_NPC.senses_range`.
+   */
+  constexpr float DEFAULT_PERCEPTION_RANGE_METERS = 20.0f;
+
+  /** How many characters may sense their surroundings per tick. */
+  constexpr bs::UINT32 DEFAULT_MAX_SENSING_PER_TICK = 16;
+
+  /**
+   * Number of buckets the grid cells are hashed into. Must be a power of two. Worlds have a few
+   * hundred characters, so collisions are rare.
+   */
+  constexpr bs::UINT32 NUM_GRID_BUCKETS = 1024;
+
+  /** Height of the eyes above the position of a character. */
+  constexpr float EYE_HEIGHT_METERS = 0.5f;
+
+  /**
+   * Line of sight rays start and end this far away from the characters, so their own character
+   * controllers don't block the view.
+   */
+  constexpr float BODY_RADIUS_METERS = 0.5f;
+
+  CharacterPerception::CharacterPerception(const bs::HSceneObject& parent)
+      : bs::Component(parent)
+      , mPerceptionRange(DEFAULT_PERCEPTION_RANGE_METERS)
+      , mMaxSensingPerTick(DEFAULT_MAX_SENSING_PER_TICK)
+  {
+    setName("CharacterPerception");
+  }
+
+  CharacterPerception::~CharacterPerception()
+  {
+  }
+
+  void CharacterPerception::registerCharacter(HCharacterEventQueue eventQueue)
+  {
+    if (isRegistered(eventQueue)) return;
+
+    Sensor sensor;
+    sensor.eventQueue  = eventQueue;
+    sensor.character   = eventQueue->SO()->getComponent<Character>();
+    sensor.characterAI = eventQueue->SO()->getComponent<CharacterAI>();
+
+    // Spread the characters over the interval so they don't all sense on the same tick
+    constexpr bs::UINT32 NUM_SPREAD_STEPS = 16;
+    float spread = (float)(mSensors.size() % NUM_SPREAD_STEPS) / NUM_SPREAD_STEPS;
+
+    sensor.timeUntilSensing = spread * eventQueue->perceptionInterval();
+
+    mSensors.push_back(sensor);
+    mIsGridDirty = true;
+  }
+
+  void CharacterPerception::unregisterCharacter(HCharacterEventQueue eventQueue)
+  {
+    for (auto it = mSensors.begin(); it != mSensors.end(); it++)
+    {
+      if (it->eventQueue == eventQueue)
+      {
+        mSensors.erase(it);
+
+        // Indices inside the grid are outdated now. Scripts may still send perceptions before
+        // the next tick, so the grid is rebuilt the next time it is searched.
+        mIsGridDirty = true;
+        return;
+      }
+    }
+  }
+
+  bool CharacterPerception::isRegistered(HCharacterEventQueue eventQueue) const
+  {
+    for (const auto& sensor : mSensors)
+    {
+      if (sensor.eventQueue == eventQueue) return true;
+    }
+
+    return false;
+  }
+
+  void CharacterPerception::setPerceptionRange(float rangeMeters)
+  {
+    if (rangeMeters <= 0.0f)
+    {
+      REGOTH_THROW(InvalidParametersException, "Perception range must be larger than 0!");
+    }
+
+    mPerceptionRange = rangeMeters;
+  }
+
+  void CharacterPerception::setMaxSensingPerTick(bs::UINT32 maxCharacters)
+  {
+    mMaxSensingPerTick = maxCharacters;
+  }
+
+  void CharacterPerception::sendPassivePerception(HCharacter source, AI::PerceptionType type,
+                                                  HCharacter other, HCharacter victim)
+  {
+    if (source.isDestroyed()) return;
+
+    bs::Vector<bs::UINT32> inRange;
+    findCharactersInRange(source->SO()->getTransform().pos(), mPerceptionRange, inRange);
+
+    // The scripts reacting to the perception might change the list of sensors
+    bs::Vector<HCharacterEventQueue> receivers;
+
+    for (bs::UINT32 index : inRange)
+    {
+      const Sensor& sensor = mSensors[index];
+
+      if (sensor.eventQueue.isDestroyed()) continue;
+      if (sensor.character == source) continue;
+      if (sensor.character->isPlayer()) continue;
+      if (!sensor.eventQueue->isPerceptionEnabled(type)) continue;
+
+      receivers.push_back(sensor.eventQueue);
+    }
+
+    for (HCharacterEventQueue receiver : receivers)
+    {
+      receiver->pushPerception(type, other, victim);
+      mStatistics.numPerceptions++;
+    }
+  }
+
+  bool CharacterPerception::isInLineOfSight(const bs::Vector3& from, const bs::Vector3& to)
+  {
+    const bs::Vector3 eyeLevel(0.0f, EYE_HEIGHT_METERS, 0.0f);
+
+    bs::Vector3 direction = (to + eyeLevel) - (from + eyeLevel);
+    float distance        = direction.length();
+
+    if (distance <= 2.0f * BODY_RADIUS_METERS) return true;
+
+    direction /= distance;
+
+    bs::Vector3 rayStart = from + eyeLevel + direction * BODY_RADIUS_METERS;
+    float rayLength      = distance - 2.0f * BODY_RADIUS_METERS;
+
+    const auto& physicsScene = bs::gSceneManager().getMainScene()->getPhysicsScene();
+
+    bs::PhysicsQueryHit hit;
+    return !physicsScene->rayCast(rayStart, direction, hit, BS_ALL_LAYERS, rayLength);
+  }
+
+  bool CharacterPerception::isInFieldOfView(const bs::Transform& observer,
+                                            const bs::Vector3& target)
+  {
+    bs::Vector3 toTarget = target - observer.pos();
+    bs::Vector3 forward  = observer.getForward();
+
+    // Looking up or down doesn't matter
+    toTarget.y = 0.0f;
+    forward.y  = 0.0f;
+
+    return forward.dot(toTarget) >= 0.0f;
+  }
+
+  void CharacterPerception::fixedUpdate()
+  {
+    removeDestroyedCharacters();
+
+    mStatistics = Statistics();
+
+    if (mSensors.empty()) return;
+
+    rebuildGrid();
+
+    float deltaTime = bs::gTime().getFixedFrameDelta();
+
+    bs::UINT32 maxSensing =
+        mMaxSensingPerTick == 0 ? std::numeric_limits<bs::UINT32>::max() : mMaxSensingPerTick;
+
+    // Continue where we stopped last time, so all characters get their turn
+    bs::UINT32 numSensors = (bs::UINT32)mSensors.size();
+    bool isBudgetExceeded = false;
+    bs::UINT32 nextCursor = mRoundRobinCursor % numSensors;
+
+    bs::Vector<LineOfSightCheck> checks;
+
+    for (bs::UINT32 i = 0; i < numSensors; i++)
+    {
+      bs::UINT32 index = (mRoundRobinCursor + i) % numSensors;
+
+      Sensor& sensor = mSensors[index];
+
+      sensor.timeUntilSensing -= deltaTime;
+
+      if (sensor.timeUntilSensing > 0.0f) continue;
+
+      if (!canSense(sensor))
+      {
+        sensor.timeUntilSensing = sensor.eventQueue->perceptionInterval();
+        continue;
+      }
+
+      if (mStatistics.numSensing >= maxSensing)
+      {
+        if (!isBudgetExceeded)
+        {
+          isBudgetExceeded = true;
+          nextCursor       = index;
+        }
+
+        mStatistics.numDeferred++;
+        continue;
+      }
+
+      senseSurroundings(index, checks);
+
+      sensor.timeUntilSensing = sensor.eventQueue->perceptionInterval();
+      mStatistics.numSensing++;
+    }
+
+    mRoundRobinCursor = nextCursor;
+
+    runLineOfSightChecks(checks);
+  }
+
+  bool CharacterPerception::canSense(const Sensor& sensor) const
+  {
+    // Far away characters only follow their routine, see CharacterPhysicsLOD
+    if (!sensor.characterAI || !sensor.characterAI->isPhysicsActive()) return false;
+
+    // The player perceives with their own eyes
+    if (sensor.character->isPlayer()) return false;
+
+    return sensor.eventQueue->isPerceptionEnabled(AI::PerceptionType::AssessPlayer) ||
+           sensor.eventQueue->isPerceptionEnabled(AI::PerceptionType::AssessFighter);
+  }
+
+  void CharacterPerception::senseSurroundings(bs::UINT32 sensorIndex,
+                                              bs::Vector<LineOfSightCheck>& checks)
+  {
+    const Sensor& sensor = mSensors[sensorIndex];
+
+    using AI::PerceptionType;
+
+    bool isLookingForPlayer  = sensor.eventQueue->isPerceptionEnabled(PerceptionType::AssessPlayer);
+    bool isLookingForFighter = sensor.eventQueue->isPerceptionEnabled(PerceptionType::AssessFighter);
+
+    bs::Vector3 position(mPositionsX[sensorIndex], mPositionsY[sensorIndex],
+                         mPositionsZ[sensorIndex]);
+
+    float range = std::min(sensor.character->getSensesRange(), mPerceptionRange);
+
+    bs::Vector<bs::UINT32> candidates;
+    findCharactersInRange(position, range, candidates);
+
+    const bs::Transform& transform = sensor.eventQueue->SO()->getTransform();
+
+    // Candidates are sorted closest first, so only the closest of each kind is perceived
+    for (bs::UINT32 candidate : candidates)
+    {
+      if (candidate == sensorIndex) continue;
+
+      mStatistics.numCandidates++;
+
+      const Sensor& other = mSensors[candidate];
+
+      bs::Vector3 otherPosition(mPositionsX[candidate], mPositionsY[candidate],
+                                mPositionsZ[candidate]);
+
+      if (!isInFieldOfView(transform, otherPosition)) continue;
+
+      if (isLookingForPlayer && other.character->isPlayer())
+      {
+        checks.push_back({sensorIndex, candidate, PerceptionType::AssessPlayer});
+        isLookingForPlayer = false;
+      }
+      else if (isLookingForFighter && other.characterAI &&
+               other.characterAI->weaponMode() != AI::WeaponMode::None)
+      {
+        checks.push_back({sensorIndex, candidate, PerceptionType::AssessFighter});
+        isLookingForFighter = false;
+      }
+
+      if (!isLookingForPlayer && !isLookingForFighter) break;
+    }
+  }
+
+  void CharacterPerception::runLineOfSightChecks(const bs::Vector<LineOfSightCheck>& checks)
+  {
+    // Characters often look at each other, which only needs one ray
+    bs::UnorderedMap<bs::UINT64, bool> rayResults;
+
+    struct Perception
+    {
+      HCharacterEventQueue eventQueue;
+      HCharacter other;
+      AI::PerceptionType type;
+    };
+
+    bs::Vector<Perception> perceptions;
+
+    for (const LineOfSightCheck& check : checks)
+    {
+      bs::UINT32 a = std::min(check.sensor, check.target);
+      bs::UINT32 b = std::max(check.sensor, check.target);
+
+      bs::UINT64 key = ((bs::UINT64)a << 32) | b;
+
+      auto it = rayResults.find(key);
+
+      bool isVisible;
+
+      if (it != rayResults.end())
+      {
+        isVisible = it->second;
+      }
+      else
+      {
+        bs::Vector3 from(mPositionsX[a], mPositionsY[a], mPositionsZ[a]);
+        bs::Vector3 to(mPositionsX[b], mPositionsY[b], mPositionsZ[b]);
+
+        isVisible       = isInLineOfSight(from, to);
+        rayResults[key] = isVisible;
+
+        mStatistics.numRaycasts++;
+      }
+
+      if (isVisible)
+      {
+        perceptions.push_back(
+            {mSensors[check.sensor].eventQueue, mSensors[check.target].character, check.type});
+      }
+    }
+
+    // Only push once all rays are done, the scripts reacting might move characters around
+    for (const Perception& perception : perceptions)
+    {
+      if (perception.eventQueue.isDestroyed() || perception.other.isDestroyed()) continue;
+
+      perception.eventQueue->pushPerception(perception.type, perception.other, {});
+      mStatistics.numPerceptions++;
+    }
+  }
+
+  void CharacterPerception::rebuildGrid()
+  {
+    bs::UINT32 numSensors = (bs::UINT32)mSensors.size();
+
+    mPositionsX.resize(numSensors);
+    mPositionsY.resize(numSensors);
+    mPositionsZ.resize(numSensors);
+
+    for (bs::UINT32 i = 0; i < numSensors; i++)
+    {
+      const bs::Vector3& position = mSensors[i].eventQueue->SO()->getTransform().pos();
+
+      mPositionsX[i] = position.x;
+      mPositionsY[i] = position.y;
+      mPositionsZ[i] = position.z;
+    }
+
+    // A cell the size of the perception range means only the neighbouring cells have to be
+    // looked at when searching for characters
+    mGridCellSize = mPerceptionRange;
+
+    bs::Vector<bs::UINT32> bucketOfSensor(numSensors);
+    mGridBucketStart.assign(NUM_GRID_BUCKETS + 1, 0);
+
+    for (bs::UINT32 i = 0; i < numSensors; i++)
+    {
+      bs::INT32 cellX = (bs::INT32)std::floor(mPositionsX[i] / mGridCellSize);
+      bs::INT32 cellZ = (bs::INT32)std::floor(mPositionsZ[i] / mGridCellSize);
+
+      bucketOfSensor[i] = gridBucketOf(cellX, cellZ);
+      mGridBucketStart[bucketOfSensor[i] + 1]++;
+    }
+
+    for (bs::UINT32 b = 0; b < NUM_GRID_BUCKETS; b++)
+    {
+      mGridBucketStart[b + 1] += mGridBucketStart[b];
+    }
+
+    bs::Vector<bs::UINT32> nextEntryOfBucket(mGridBucketStart.begin(),
+                                             mGridBucketStart.end() - 1);
+
+    mGridEntries.resize(numSensors);
+
+    for (bs::UINT32 i = 0; i < numSensors; i++)
+    {
+      mGridEntries[nextEntryOfBucket[bucketOfSensor[i]]++] = i;
+    }
+
+    mIsGridDirty = false;
+  }
+
+  void CharacterPerception::findCharactersInRange(const bs::Vector3& center, float range,
+                                                  bs::Vector<bs::UINT32>& result)
+  {
+    result.clear();
+
+    if (mIsGridDirty) rebuildGrid();
+
+    if (mGridEntries.empty()) return;
+
+    bs::INT32 minCellX = (bs::INT32)std::floor((center.x - range) / mGridCellSize);
+    bs::INT32 maxCellX = (bs::INT32)std::floor((center.x + range) / mGridCellSize);
+    bs::INT32 minCellZ = (bs::INT32)std::floor((center.z - range) / mGridCellSize);
+    bs::INT32 maxCellZ = (bs::INT32)std::floor((center.z + range) / mGridCellSize);
+
+    auto distanceSqTo = [&](bs::UINT32 i) {
+      float dx = mPositionsX[i] - center.x;
+      float dy = mPositionsY[i] - center.y;
+      float dz = mPositionsZ[i] - center.z;
+
+      return dx * dx + dy * dy + dz * dz;
+    };
+
+    float rangeSq = range * range;
+
+    for (bs::INT32 cellX = minCellX; cellX <= maxCellX; cellX++)
+    {
+      for (bs::INT32 cellZ = minCellZ; cellZ <= maxCellZ; cellZ++)
+      {
+        bs::UINT32 bucket = gridBucketOf(cellX, cellZ);
+
+        for (bs::UINT32 e = mGridBucketStart[bucket]; e < mGridBucketStart[bucket + 1]; e++)
+        {
+          bs::UINT32 index = mGridEntries[e];
+
+          if (distanceSqTo(index) <= rangeSq)
+          {
+            result.push_back(index);
+          }
+        }
+      }
+    }
+
+    std::sort(result.begin(), result.end(), [&](bs::UINT32 a, bs::UINT32 b) {
+      float distanceA = distanceSqTo(a);
+      float distanceB = distanceSqTo(b);
+
+      return distanceA < distanceB || (distanceA == distanceB && a < b);
+    });
+
+    // Different cells can end up in the same bucket, which would list their characters twice
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+  }
+
+  bs::UINT32 CharacterPerception::gridBucketOf(bs::INT32 cellX, bs::INT32 cellZ)
+  {
+    bs::UINT32 hash = ((bs::UINT32)cellX * 73856093u) ^ ((bs::UINT32)cellZ * 19349663u);
+
+    return hash & (NUM_GRID_BUCKETS - 1);
+  }
+
+  void CharacterPerception::removeDestroyedCharacters()
+  {
+    auto isDestroyed = [](const Sensor& s) { return s.eventQueue.isDestroyed(); };
+
+    auto firstDestroyed = std::remove_if(mSensors.begin(), mSensors.end(), isDestroyed);
+
+    if (firstDestroyed == mSensors.end()) return;
+
+    mSensors.erase(firstDestroyed, mSensors.end());
+    mIsGridDirty = true;
+  }
+
+  REGOTH_DEFINE_RTTI(CharacterPerception)
+}  // namespace REGoth
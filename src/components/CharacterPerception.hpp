@@ -0,0 +1,236 @@
+#pragma once
+#include <AI/PerceptionType.hpp>
+#include <BsPrerequisites.h>
+#include <RTTI/RTTIUtil.hpp>
+#include <Scene/BsComponent.h>
+#include <Scene/BsTransform.h>
+
+namespace REGoth
+{
+  class Character;
+  using HCharacter = bs::GameObjectHandle<Character>;
+
+  class CharacterAI;
+  using HCharacterAI = bs::GameObjectHandle<CharacterAI>;
+
+  class CharacterEventQueue;
+  using HCharacterEventQueue = bs::GameObjectHandle<CharacterEventQueue>;
+
+  /**
+   * Lets the characters of a world perceive each other.
+   *
+   * Scripts enable perceptions per character via `Npc_PercEnable()`, together with the
+   * function which reacts to them, like `B_ASSESSPLAYER`. Once a character perceives something,
+   * a perception message is pushed into its CharacterEventQueue, which runs that function.
+   *
+   * There are two kinds of perceptions:
+   *
+   *  - *Active* perceptions are sensed by the character itself, every few seconds as set by
+   *    `Npc_SetPercTime()`. This component looks for other characters within the senses range
+   *    of the character, which are in its field of view and not hidden behind a wall.
+   *
+   *  - *Passive* perceptions are triggered by events, like a fight nearby. They are sent to all
+   *    characters around the place where they happened right away, see
+   *    sendPassivePerception().
+   *
+   * Sensing is staggered: Every character senses on its own interval and only a limited number
+   * of characters sense per tick. Candidates are found via a grid of all character positions,
+   * which is rebuilt once per tick. The line of sight checks of all characters sensing in a tick
+   * are collected first and then done together, so that two characters looking at each other
+   * only need one raycast.
+   *
+   * Only characters with physics enabled sense anything, see CharacterPhysicsLOD. Those further
+   * away only follow their daily routine.
+   *
+   * Characters register themselves on their first tick, see CharacterEventQueue. The list of
+   * registered characters is not saved, as they will register again after loading.
+   */
+  class CharacterPerception : public bs::Component
+  {
+  public:
+    /**
+     * Counters of what happened during the last fixed tick.
+     */
+    struct Statistics
+    {
+      bs::UINT32 numSensing     = 0;  // Characters which sensed their surroundings
+      bs::UINT32 numDeferred    = 0;  // Characters which were due but exceeded the budget
+      bs::UINT32 numCandidates  = 0;  // Other characters found within senses range
+      bs::UINT32 numRaycasts    = 0;  // Line of sight checks done
+      bs::UINT32 numPerceptions = 0;  // Perception messages pushed
+    };
+
+    CharacterPerception(const bs::HSceneObject& parent);
+    virtual ~CharacterPerception();
+
+    /**
+     * Lets the given character sense its surroundings and be perceived by others.
+     * Registering the same character twice has no effect.
+     */
+    void registerCharacter(HCharacterEventQueue eventQueue);
+
+    /**
+     * Stops the given character from sensing and being perceived.
+     */
+    void unregisterCharacter(HCharacterEventQueue eventQueue);
+
+    /**
+     * @return Whether the given character is registered here.
+     */
+    bool isRegistered(HCharacterEventQueue eventQueue) const;
+
+    /**
+     * Sets the range in which characters are looked for. Characters with a larger senses range
+     * will not perceive anything beyond this. Also used as range of passive perceptions.
+     */
+    void setPerceptionRange(float rangeMeters);
+
+    /**
+     * Sets how many characters may sense their surroundings per tick. Characters exceeding this
+     * will sense on one of the next ticks. 0 means no limit.
+     */
+    void setMaxSensingPerTick(bs::UINT32 maxCharacters);
+
+    /**
+     * Sends a passive perception to all characters around the \p source which react to it,
+     * like `Npc_SendPassivePerc()`. The \p source itself does not perceive it.
+     *
+     * @param  source  Character at the place where something happened.
+     * @param  type    What happened.
+     * @param  other   Character which did something. Used as `OTHER` by the receivers.
+     * @param  victim  Character something was done to, if any. Used as `VICTIM`.
+     */
+    void sendPassivePerception(HCharacter source, AI::PerceptionType type, HCharacter other,
+                               HCharacter victim);
+
+    /**
+     * @return Whether nothing of the static world is in between the two positions. Both are
+     *         raised to the eye level of a character, so the floor does not block the view.
+     */
+    static bool isInLineOfSight(const bs::Vector3& from, const bs::Vector3& to);
+
+    /**
+     * @return Whether the given position is within 90 degrees of where the object with the
+     *         given transform is looking.
+     */
+    static bool isInFieldOfView(const bs::Transform& observer, const bs::Vector3& target);
+
+    /**
+     * @return What happened during the last fixed tick.
+     */
+    const Statistics& statistics() const
+    {
+      return mStatistics;
+    }
+
+    /**
+     * Lets the due characters sense their surroundings.
+     */
+    void fixedUpdate() override;
+
+  private:
+    struct Sensor
+    {
+      HCharacterEventQueue eventQueue;
+      HCharacter character;
+      HCharacterAI characterAI;
+
+      /**
+       * Counts down to the next time this character senses its surroundings.
+       */
+      float timeUntilSensing = 0.0f;
+    };
+
+    /**
+     * An active perception which will be pushed if \p target is in line of sight of \p sensor.
+     * Indices refer to mSensors.
+     */
+    struct LineOfSightCheck
+    {
+      bs::UINT32 sensor;
+      bs::UINT32 target;
+      AI::PerceptionType type;
+    };
+
+    /**
+     * @return Whether the character is able to sense its surroundings right now.
+     */
+    bool canSense(const Sensor& sensor) const;
+
+    /**
+     * Looks for the closest characters which are in the field of view of the given one and
+     * would trigger one of its active perceptions. Those are added to \p checks.
+     */
+    void senseSurroundings(bs::UINT32 sensorIndex, bs::Vector<LineOfSightCheck>& checks);
+
+    /**
+     * Does the raycasts of all the given checks and pushes the perceptions which passed.
+     */
+    void runLineOfSightChecks(const bs::Vector<LineOfSightCheck>& checks);
+
+    /**
+     * Copies the position of every registered character and sorts them into the grid.
+     */
+    void rebuildGrid();
+
+    /**
+     * Fills \p result with the indices into mSensors of all characters in the given range,
+     * closest first. Rebuilds the grid first if characters were added or removed since.
+     */
+    void findCharactersInRange(const bs::Vector3& center, float range,
+                               bs::Vector<bs::UINT32>& result);
+
+    /**
+     * @return Index of the grid bucket the given cell is sorted into.
+     */
+    static bs::UINT32 gridBucketOf(bs::INT32 cellX, bs::INT32 cellZ);
+
+    /**
+     * Removes characters which have been destroyed since the last tick.
+     */
+    void removeDestroyedCharacters();
+
+    /**
+     * Registered characters. Not saved.
+     */
+    bs::Vector<Sensor> mSensors;
+
+    /**
+     * Positions of the characters at the start of the tick, indices match mSensors.
+     */
+    bs::Vector<float> mPositionsX;
+    bs::Vector<float> mPositionsY;
+    bs::Vector<float> mPositionsZ;
+
+    /**
+     * Grid on the XZ-plane with cells the size of the perception range. Cells are hashed into a
+     * fixed number of buckets: mGridEntries holds the indices into mSensors sorted by bucket,
+     * the entries of bucket `b` start at `mGridBucketStart[b]` and end at
+     * `mGridBucketStart[b + 1]`.
+     */
+    bs::Vector<bs::UINT32> mGridBucketStart;
+    bs::Vector<bs::UINT32> mGridEntries;
+    float mGridCellSize = 0.0f;
+
+    /**
+     * Whether characters were added or removed since the grid was built, which makes the
+     * indices inside it wrong.
+     */
+    bool mIsGridDirty = false;
+
+    bs::UINT32 mRoundRobinCursor = 0;
+
+    float mPerceptionRange        = 0.0f;
+    bs::UINT32 mMaxSensingPerTick = 0;
+
+    Statistics mStatistics;
+
+  public:
+    REGOTH_DECLARE_RTTI(CharacterPerception)
+
+  protected:
+    CharacterPerception() = default;  // For RTTI
+  };
+
+  using HCharacterPerception = bs::GameObjectHandle<CharacterPerception>;
+}  // namespace REGoth
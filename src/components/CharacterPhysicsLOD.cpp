@@ -0,0 +1,195 @@
+#include "CharacterPhysicsLOD.hpp"
+#include <Components/BsCCamera.h>
+#include <RTTI/RTTI_CharacterPhysicsLOD.hpp>
+#include <Scene/BsSceneManager.h>
+#include <Scene/BsSceneObject.h>
+#include <components/CharacterAI.hpp>
+#include <exception/Throw.hpp>
+
+namespace REGoth
+{
+  /**
+   * How far away the character can be from the camera until it should disable physics.
+   * Must be larger than the range which activates physics again, DEFAULT_ACTIVATE_RANGE_METERS.
+   */
+  constexpr float DEFAULT_DEACTIVATE_RANGE_METERS = 45.0f;
+
+  /** See DEFAULT_DEACTIVATE_RANGE_METERS */
+  constexpr float DEFAULT_ACTIVATE_RANGE_METERS = 40.0f;
+
+  /** How many characters may switch their physics on or off per tick. */
+  constexpr bs::UINT32 DEFAULT_MAX_SWITCHES_PER_TICK = 8;
+
+  CharacterPhysicsLOD::CharacterPhysicsLOD(const bs::HSceneObject& parent)
+      : bs::Component(parent)
+      , mActivateRange(DEFAULT_ACTIVATE_RANGE_METERS)
+      , mDeactivateRange(DEFAULT_DEACTIVATE_RANGE_METERS)
+      , mMaxSwitchesPerTick(DEFAULT_MAX_SWITCHES_PER_TICK)
+  {
+    setName("CharacterPhysicsLOD");
+  }
+
+  CharacterPhysicsLOD::~CharacterPhysicsLOD()
+  {
+  }
+
+  void CharacterPhysicsLOD::registerCharacter(HCharacterAI characterAI)
+  {
+    if (isRegistered(characterAI)) return;
+
+    mCharacters.push_back(characterAI);
+  }
+
+  void CharacterPhysicsLOD::unregisterCharacter(HCharacterAI characterAI)
+  {
+    auto it = std::find(mCharacters.begin(), mCharacters.end(), characterAI);
+
+    if (it != mCharacters.end())
+    {
+      mCharacters.erase(it);
+    }
+  }
+
+  bool CharacterPhysicsLOD::isRegistered(HCharacterAI characterAI) const
+  {
+    return std::find(mCharacters.begin(), mCharacters.end(), characterAI) != mCharacters.end();
+  }
+
+  void CharacterPhysicsLOD::setActivationRanges(float activateMeters, float deactivateMeters)
+  {
+    if (activateMeters >= deactivateMeters)
+    {
+      REGOTH_THROW(InvalidParametersException,
+                   "Physics activation range must be smaller than the deactivation range!");
+    }
+
+    mActivateRange   = activateMeters;
+    mDeactivateRange = deactivateMeters;
+  }
+
+  void CharacterPhysicsLOD::setMaxSwitchesPerTick(bs::UINT32 maxSwitches)
+  {
+    mMaxSwitchesPerTick = maxSwitches;
+  }
+
+  void CharacterPhysicsLOD::fixedUpdate()
+  {
+    removeDestroyedCharacters();
+
+    mStatistics = Statistics();
+
+    const auto& mainCamera = bs::gSceneManager().getMainCamera();
+
+    if (!mainCamera || mCharacters.empty()) return;
+
+    computeDistancesTo(mainCamera->getTransform().pos());
+
+    float activateRangeSq   = mActivateRange * mActivateRange;
+    float deactivateRangeSq = mDeactivateRange * mDeactivateRange;
+
+    bs::Vector<bs::UINT32> toActivate;
+    bs::Vector<bs::UINT32> toDeactivate;
+
+    for (bs::UINT32 i = 0; i < (bs::UINT32)mCharacters.size(); i++)
+    {
+      bool isActive = mCharacters[i]->isPhysicsActive();
+
+      if (!isActive && mDistancesSq[i] < activateRangeSq)
+      {
+        toActivate.push_back(i);
+      }
+      else if (isActive && mDistancesSq[i] > deactivateRangeSq)
+      {
+        toDeactivate.push_back(i);
+      }
+      else if (isActive)
+      {
+        mStatistics.numActive++;
+      }
+    }
+
+    // Characters closest to the camera are the most likely to be seen, so they come first
+    std::sort(toActivate.begin(), toActivate.end(),
+              [&](bs::UINT32 a, bs::UINT32 b) { return mDistancesSq[a] < mDistancesSq[b]; });
+
+    std::sort(toDeactivate.begin(), toDeactivate.end(),
+              [&](bs::UINT32 a, bs::UINT32 b) { return mDistancesSq[a] > mDistancesSq[b]; });
+
+    bs::UINT32 numSwitchesLeft =
+        mMaxSwitchesPerTick == 0 ? std::numeric_limits<bs::UINT32>::max() : mMaxSwitchesPerTick;
+
+    for (bs::UINT32 i : toActivate)
+    {
+      if (numSwitchesLeft == 0)
+      {
+        mStatistics.numPending++;
+        continue;
+      }
+
+      mCharacters[i]->activatePhysics();
+      numSwitchesLeft--;
+
+      mStatistics.numActivated++;
+      mStatistics.numActive++;
+    }
+
+    for (bs::UINT32 i : toDeactivate)
+    {
+      if (numSwitchesLeft == 0)
+      {
+        mStatistics.numPending++;
+        mStatistics.numActive++;
+        continue;
+      }
+
+      mCharacters[i]->deactivatePhysics();
+      numSwitchesLeft--;
+
+      mStatistics.numDeactivated++;
+    }
+  }
+
+  void CharacterPhysicsLOD::computeDistancesTo(const bs::Vector3& cameraPosition)
+  {
+    bs::UINT32 numCharacters = (bs::UINT32)mCharacters.size();
+
+    mPositionsX.resize(numCharacters);
+    mPositionsY.resize(numCharacters);
+    mPositionsZ.resize(numCharacters);
+    mDistancesSq.resize(numCharacters);
+
+    for (bs::UINT32 i = 0; i < numCharacters; i++)
+    {
+      const bs::Vector3& position = mCharacters[i]->SO()->getTransform().pos();
+
+      mPositionsX[i] = position.x;
+      mPositionsY[i] = position.y;
+      mPositionsZ[i] = position.z;
+    }
+
+    // Plain loop over plain arrays, which gets vectorized by the compiler
+    const float* x = mPositionsX.data();
+    const float* y = mPositionsY.data();
+    const float* z = mPositionsZ.data();
+    float* out     = mDistancesSq.data();
+
+    for (bs::UINT32 i = 0; i < numCharacters; i++)
+    {
+      float dx = x[i] - cameraPosition.x;
+      float dy = y[i] - cameraPosition.y;
+      float dz = z[i] - cameraPosition.z;
+
+      out[i] = dx * dx + dy * dy + dz * dz;
+    }
+  }
+
+  void CharacterPhysicsLOD::removeDestroyedCharacters()
+  {
+    auto isDestroyed = [](const HCharacterAI& c) { return c.isDestroyed(); };
+
+    mCharacters.erase(std::remove_if(mCharacters.begin(), mCharacters.end(), isDestroyed),
+                      mCharacters.end());
+  }
+
+  REGOTH_DEFINE_RTTI(CharacterPhysicsLOD)
+}  // namespace REGoth
@@ -0,0 +1,133 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <RTTI/RTTIUtil.hpp>
+#include <Scene/BsComponent.h>
+
+namespace REGoth
+{
+  class CharacterAI;
+  using HCharacterAI = bs::GameObjectHandle<CharacterAI>;
+
+  /**
+   * Decides which characters of a world get to use physics.
+   *
+   * Simulating the character controller of every character in the world would take a huge
+   * hit on performance, so only characters close to the main camera have physics enabled.
+   * Characters further away have their CCharacterController removed from the physics scene
+   * entirely, see CharacterAI::deactivatePhysics().
+   *
+   * There are two ranges: Characters closer than the *activation range* get physics, those
+   * further away than the *deactivation range* lose it. In between, nothing changes, so
+   * characters walking along the border don't flip between both modes on every tick.
+   * See https://regoth-project.github.io/REGoth-bs/content/characters.html
+   *
+   * All characters are checked in one pass per tick. Since adding a controller to the physics
+   * scene is rather expensive, only a limited number of characters switch per tick. The
+   * closest characters are activated first, the farthest are deactivated first. The others
+   * will switch on one of the next ticks.
+   *
+   * Characters register themselves on their first tick, see CharacterAI. The list of
+   * registered characters is not saved, as they will register again after loading.
+   */
+  class CharacterPhysicsLOD : public bs::Component
+  {
+  public:
+    /**
+     * Counters of what happened during the last fixed tick.
+     */
+    struct Statistics
+    {
+      bs::UINT32 numActive      = 0;  // Characters with physics enabled after the tick
+      bs::UINT32 numActivated   = 0;  // Characters which got physics enabled
+      bs::UINT32 numDeactivated = 0;  // Characters which got physics disabled
+      bs::UINT32 numPending     = 0;  // Switches which were due but exceeded the budget
+    };
+
+    CharacterPhysicsLOD(const bs::HSceneObject& parent);
+    virtual ~CharacterPhysicsLOD();
+
+    /**
+     * Lets the physics of the given character be controlled by this component.
+     * Registering the same character twice has no effect.
+     */
+    void registerCharacter(HCharacterAI characterAI);
+
+    /**
+     * Stops controlling the physics of the given character.
+     */
+    void unregisterCharacter(HCharacterAI characterAI);
+
+    /**
+     * @return Whether the given character is registered here.
+     */
+    bool isRegistered(HCharacterAI characterAI) const;
+
+    /**
+     * Sets the distances to the main camera at which physics of a character get enabled and
+     * disabled.
+     *
+     * Throws if the activation range is not smaller than the deactivation range.
+     */
+    void setActivationRanges(float activateMeters, float deactivateMeters);
+
+    /**
+     * Sets how many characters may switch their physics on or off per tick.
+     * 0 means no limit.
+     */
+    void setMaxSwitchesPerTick(bs::UINT32 maxSwitches);
+
+    /**
+     * @return What happened during the last fixed tick.
+     */
+    const Statistics& statistics() const
+    {
+      return mStatistics;
+    }
+
+    /**
+     * Enables or disables physics of the registered characters.
+     */
+    void fixedUpdate() override;
+
+  private:
+    /**
+     * Fills mDistancesSq with the squared distance of every registered character to the given
+     * position.
+     */
+    void computeDistancesTo(const bs::Vector3& cameraPosition);
+
+    /**
+     * Removes characters which have been destroyed since the last tick.
+     */
+    void removeDestroyedCharacters();
+
+    /**
+     * Characters whose physics are controlled by this component. Not saved.
+     */
+    bs::Vector<HCharacterAI> mCharacters;
+
+    /**
+     * Positions of the characters and their squared distance to the camera. Stored as
+     * separate arrays of plain floats, so the compiler can vectorize the distance check.
+     * Indices match mCharacters.
+     */
+    bs::Vector<float> mPositionsX;
+    bs::Vector<float> mPositionsY;
+    bs::Vector<float> mPositionsZ;
+    bs::Vector<float> mDistancesSq;
+
+    float mActivateRange           = 0.0f;
+    float mDeactivateRange         = 0.0f;
+    bs::UINT32 mMaxSwitchesPerTick = 0;
+
+    Statistics mStatistics;
+
+  public:
+    REGOTH_DECLARE_RTTI(CharacterPhysicsLOD)
+
+  protected:
+    CharacterPhysicsLOD() = default;  // For RTTI
+  };
+
+  using HCharacterPhysicsLOD = bs::GameObjectHandle<CharacterPhysicsLOD>;
+}  // namespace REGoth
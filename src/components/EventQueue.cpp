@@ -5,36 +5,91 @@
 
 namespace REGoth
 {
-  using SharedEMessage = EventQueue::SharedEMessage;
+  using MessageHandle = EventQueue::MessageHandle;
 
   EventQueue::EventQueue(const bs::HSceneObject& parent)
       : bs::Component(parent)
   {
   }
 
-  void EventQueue::handleMessage(SharedEMessage message, bs::HSceneObject sender)
+  MessageHandle EventQueue::handleMessage(bs::UINT32 slot, bs::HSceneObject sender)
   {
+    MessageHandle handle;
+    handle.slot       = slot;
+    handle.generation = mMessageSlots[slot].generation;
+
+    // Keep a reference, the slots might move if new messages are pushed by the host
+    bs::SPtr<AI::EventMessage> message = mMessageSlots[slot].message;
+
     message->isFirstRun = true;
 
-    if (shouldExecuteMessageInstantly(message))
+    if (shouldExecuteMessageInstantly(*message))
     {
       // Pass the message to the host
-      sendMessageToHost(message, sender);
+      sendMessageToHost(*message, sender);
 
       // Flag as done
       message->deleted = true;
+
+      // Never was inside the queue, so we can reuse the slot right away
+      releaseSlot(slot);
     }
     else
     {
-      mEventQueue.push_back(message);
+      mEventQueue.push_back(slot);
     }
+
+    return handle;
   }
 
-  void EventQueue::sendMessageToHost(SharedEMessage message, bs::HSceneObject sender)
+  void EventQueue::sendMessageToHost(AI::EventMessage& message, bs::HSceneObject sender)
   {
     onExecuteEventAction(message, sender);
 
-    message->isFirstRun = false;
+    message.isFirstRun = false;
+  }
+
+  bs::UINT32 EventQueue::allocateSlot(AI::EventMessageType type)
+  {
+    bs::UINT32 slot;
+
+    auto it = mFreeSlots.find(type);
+
+    if (it != mFreeSlots.end() && !it->second.empty())
+    {
+      slot = it->second.back();
+      it->second.pop_back();
+    }
+    else
+    {
+      slot = (bs::UINT32)mMessageSlots.size();
+      mMessageSlots.emplace_back();
+    }
+
+    mMessageSlots[slot].isInUse = true;
+
+    return slot;
+  }
+
+  void EventQueue::releaseSlot(bs::UINT32 slot)
+  {
+    MessageSlot& s = mMessageSlots[slot];
+
+    s.isInUse = false;
+    s.generation++;
+
+    mFreeSlots[s.message->messageType].push_back(slot);
+  }
+
+  AI::EventMessage* EventQueue::getMessage(MessageHandle handle) const
+  {
+    if (handle.slot >= mMessageSlots.size()) return nullptr;
+
+    const MessageSlot& s = mMessageSlots[handle.slot];
+
+    if (!s.isInUse || s.generation != handle.generation) return nullptr;
+
+    return s.message.get();
   }
 
   void EventQueue::fixedUpdate()
@@ -49,31 +104,24 @@ namespace REGoth
     // reason.
     for (size_t i = 0, end = mEventQueue.size(); i < end; i++)
     {
-      auto& event = mEventQueue[i];
+      bs::SPtr<AI::EventMessage> event = mMessageSlots[mEventQueue[i]].message;
+
       if (event->deleted)
       {
-        event->onMessageDone(event);
+        event->onMessageDone(*event);
       }
     }
 
     // Remove deleted messages from last time
-    for (auto it = mEventQueue.begin(); it != mEventQueue.end();)
-    {
-      if ((*it)->deleted)
-      {
-        it = mEventQueue.erase(it);
-      }
-      else
-      {
-        it++;
-      }
-    }
+    removeDeletedMessages();
 
-    // Process messages as far as we can
-    for (SharedEMessage ev : mEventQueue)
+    // Process messages as far as we can. Again, callbacks might push new messages.
+    for (size_t i = 0; i < mEventQueue.size(); i++)
     {
+      bs::SPtr<AI::EventMessage> ev = mMessageSlots[mEventQueue[i]].message;
+
       bs::HSceneObject sender = {};  // TODO: Don't we need that?
-      sendMessageToHost(ev, sender);
+      sendMessageToHost(*ev, sender);
 
       // FIXME: This event manager could have been deleted as a reaction to the message! Take care
       // of that!
@@ -85,68 +133,109 @@ namespace REGoth
     }
   }
 
-  SharedEMessage EventQueue::findLastConversationMessageWith(bs::HSceneObject other)
+  void EventQueue::removeDeletedMessages()
   {
-    auto begin = mEventQueue.rbegin();
-    auto end   = mEventQueue.rend();
+    // Shift the remaining messages to the front while keeping their order
+    bs::UINT32 numKept = 0;
 
-    auto lastConvMessageIterator = std::find_if(begin, end, [&](SharedEMessage ev) {
-      if (!ev->isOverlay && ev->messageType == AI::EventMessageType::Conversation)
+    for (bs::UINT32 slot : mEventQueue)
+    {
+      if (mMessageSlots[slot].message->deleted)
       {
-        auto conv = reinterpret_cast<AI::ConversationMessage*>(ev.get());
-        return conv->target == other;
+        releaseSlot(slot);
       }
-      return false;
-    });
+      else
+      {
+        mEventQueue[numKept] = slot;
+        numKept++;
+      }
+    }
 
-    if (lastConvMessageIterator == end) return nullptr;
+    mEventQueue.resize(numKept);
+  }
 
-    return *lastConvMessageIterator;
+  MessageHandle EventQueue::findLastConversationMessageWith(bs::HSceneObject other)
+  {
+    for (auto it = mEventQueue.rbegin(); it != mEventQueue.rend(); it++)
+    {
+      const MessageSlot& s = mMessageSlots[*it];
+      const AI::EventMessage& ev = *s.message;
+
+      if (!ev.isOverlay && ev.messageType == AI::EventMessageType::Conversation)
+      {
+        auto& conv = static_cast<const AI::ConversationMessage&>(ev);
+
+        if (conv.target == other)
+        {
+          MessageHandle handle;
+          handle.slot       = *it;
+          handle.generation = s.generation;
+
+          return handle;
+        }
+      }
+    }
+
+    return {};
   }
 
   bool EventQueue::hasConversationMessageWith(bs::HSceneObject other)
   {
-    return findLastConversationMessageWith(other) != nullptr;
+    return findLastConversationMessageWith(other).isValid();
   }
 
-  bool EventQueue::shouldExecuteMessageInstantly(SharedEMessage message) const
+  bool EventQueue::shouldExecuteMessageInstantly(const AI::EventMessage& message) const
   {
-    if (message->isJob) return false;
+    if (message.isJob) return false;
 
-    if (message->isHighPriority) return true;
+    if (message.isHighPriority) return true;
     if (mEventQueue.empty()) return true;
 
     return false;
   }
 
-  void EventQueue::waitForMessage(SharedEMessage other)
+  void EventQueue::waitForMessage(HEventQueue otherQueue, MessageHandle other)
   {
+    AI::EventMessage* otherMessage = otherQueue->getMessage(other);
+
+    // Already done, nothing to wait for
+    if (!otherMessage) return;
+
     // Push a wait-message first
     AI::ConversationMessage wait;
     wait.subType = AI::ConversationMessage::ST_WaitTillEnd;
 
     // Let the EM wait for this talking-action to complete
-    bs::SPtr<AI::ConversationMessage> queuedWait = onMessage(wait);
+    MessageHandle queuedWait = onMessage(wait);
+
+    HEventQueue thisQueue = bs::static_object_cast<EventQueue>(getHandle());
+
+    otherMessage->onMessageDone.connect([thisQueue, queuedWait](AI::EventMessage& msg) {
+      if (thisQueue.isDestroyed()) return;
+
+      AI::EventMessage* waitMessage = thisQueue->getMessage(queuedWait);
 
-    other->onMessageDone.connect([queuedWait](SharedEMessage msg) {
       // Once this event fires, we're done waiting
-      queuedWait->canceled = true;
+      if (waitMessage)
+      {
+        static_cast<AI::ConversationMessage*>(waitMessage)->canceled = true;
+      }
     });
   }
 
   void EventQueue::clear()
   {
-    for (SharedEMessage ev : mEventQueue)
+    for (bs::UINT32 slot : mEventQueue)
     {
-      ev->deleted = true;
+      mMessageSlots[slot].message->deleted = true;
     }
   }
 
   bool EventQueue::isEmpty()
   {
-    for (SharedEMessage ev : mEventQueue)
+    for (bs::UINT32 slot : mEventQueue)
     {
-      if (!ev->deleted) return false;
+      if (!mMessageSlots[slot].message->deleted) return false;
     }
 
     return true;
@@ -9,6 +9,9 @@ namespace REGoth
   class EventHandler;
   using HEventHandler = bs::GameObjectHandle<EventHandler>;
 
+  class EventQueue;
+  using HEventQueue = bs::GameObjectHandle<EventQueue>;
+
   /**
    * Event Queue Component.
    *
@@ -64,11 +67,40 @@ namespace REGoth
    * The EventQueue-component itself is kept fairly generic. To actually handle
    * incomming events, you need to create a component inheriting from this,
    * where you override the onExecuteEventAction() method.
+   *
+   *
+   * Message Storage
+   * ===============
+   *
+   * Scripts push a lot of messages, so messages are not allocated one by one.
+   * Every message lives inside a *slot* of the queue. Once a message is done,
+   * its slot is put into a pool of free slots for that kind of message and is
+   * reused for the next message of the same kind.
+   *
+   * Since slots are reused, messages are referred to via a MessageHandle,
+   * which carries the *generation* of the slot it was created for. As soon as
+   * the message is done, the generation of the slot changes and the handle
+   * stops resolving to a message, see getMessage().
    */
   class EventQueue : public bs::Component
   {
   public:
-    using SharedEMessage = bs::SPtr<AI::EventMessage>;
+    /**
+     * Refers to a message inside an EventQueue. Only valid as long as the
+     * message has not been removed from the queue it was pushed to.
+     */
+    struct MessageHandle
+    {
+      static constexpr bs::UINT32 INVALID_SLOT = ~0u;
+
+      bs::UINT32 slot       = INVALID_SLOT;
+      bs::UINT32 generation = 0;
+
+      bool isValid() const
+      {
+        return slot != INVALID_SLOT;
+      }
+    };
 
     EventQueue(const bs::HSceneObject& parent);
 
@@ -79,18 +111,29 @@ namespace REGoth
      * @param  msg     Message to send. Will be copied internally.
      * @param  sender  Object that sent the message. Can be empty.
      *
-     * @return The registered message (Copy of msg). This can be used to
-     *         register callbacks, for example.
+     * @return Handle to the registered message (Copy of msg). This can be used
+     *         to register callbacks, for example. Messages which were executed
+     *         instantly are already done, so the handle will not resolve anymore.
      */
     template <typename T>
-    bs::SPtr<T> onMessageFromObject(const T& msg, bs::HSceneObject sender)
+    MessageHandle onMessageFromObject(const T& msg, bs::HSceneObject sender)
     {
-      // Copy over the data from the given message
-      auto copyDerived = bs::bs_shared_ptr_new<T>(msg);
+      bs::UINT32 slot = allocateSlot(msg.messageType);
+
+      // Copy over the data from the given message, reusing an old one if possible
+      bs::SPtr<AI::EventMessage>& message = mMessageSlots[slot].message;
+
+      if (message)
+      {
+        *static_cast<T*>(message.get()) = msg;
+      }
+      else
+      {
+        message = bs::bs_shared_ptr_new<T>(msg);
+      }
 
       // Handle the message and potentially add it to the queue
-      handleMessage(copyDerived, sender);
-      return copyDerived;
+      return handleMessage(slot, sender);
     }
 
     /**
@@ -98,15 +141,21 @@ namespace REGoth
      *
      * @param  msg     Message to send. Will be copied internally.
      *
-     * @return The registered message (Copy of msg). This can be used to
-     *         register callbacks, for example.
+     * @return Handle to the registered message, see onMessageFromObject().
      */
     template <typename T>
-    bs::SPtr<T> onMessage(const T& msg)
+    MessageHandle onMessage(const T& msg)
     {
       return onMessageFromObject(msg, {});
     }
 
+    /**
+     * Resolves a handle to a message of this queue.
+     *
+     * @return The message, or nullptr if it has already been removed from the queue.
+     */
+    AI::EventMessage* getMessage(MessageHandle handle) const;
+
     /**
      * @return Whether the message queue is currently empty.
      */
@@ -118,9 +167,9 @@ namespace REGoth
      *
      * @param  other  Character to search for.
      *
-     * @return Pointer to the last non-overlay conv-message, if found. If not, nullptr.
+     * @return Handle to the last non-overlay conv-message, if found. If not, an invalid handle.
      */
-    SharedEMessage findLastConversationMessageWith(bs::HSceneObject other);
+    MessageHandle findLastConversationMessageWith(bs::HSceneObject other);
 
     /**
      * Searches the messages if any conversation message exists, that has the Character
@@ -136,9 +185,10 @@ namespace REGoth
      * Blocks the event-queue until the given event was processed. This is usually used
      * to have one Character wait for an other Character to finish some action.
      *
-     * @param other Message to wait for
+     * @param otherQueue  Queue the message to wait for is inside of.
+     * @param other       Message to wait for
      */
-    void waitForMessage(SharedEMessage other);
+    void waitForMessage(HEventQueue otherQueue, MessageHandle other);
 
     /**
      * Removes all pending messages
@@ -154,7 +204,7 @@ namespace REGoth
      * Don't forget to flag the message as "done" when the action was executed
      * completely, e.g. when the animation is done.
      */
-    virtual void onExecuteEventAction(SharedEMessage message, bs::HSceneObject sender) = 0;
+    virtual void onExecuteEventAction(AI::EventMessage& message, bs::HSceneObject sender) = 0;
 
     /**
      * Cyclic update
@@ -177,29 +227,76 @@ namespace REGoth
 
     /**
      * Handles an incomming message. This will decide whether or not to immediately execute the
-     * message or whether it should wait in the queue. Immediate messages will be flagged as
-     * to-delete after execution
+     * message or whether it should wait in the queue. Immediate messages will be removed
+     * right after execution.
+     *
+     * @param slot  Slot of the message to handle.
      *
-     * @param message Message to handle
+     * @return Handle to the message.
      */
-    void handleMessage(SharedEMessage message, bs::HSceneObject sender);
+    MessageHandle handleMessage(bs::UINT32 slot, bs::HSceneObject sender);
 
     /**
      * Sends the given message to the host-vob
      */
-    void sendMessageToHost(SharedEMessage message, bs::HSceneObject sender);
+    void sendMessageToHost(AI::EventMessage& message, bs::HSceneObject sender);
 
     /**
      * To be called right after a message arrived. This function will tell you
      * whether the event should be handled now, instantly. Those one-shot
      * messages are also to be deleted after they have been handled.
      */
-    bool shouldExecuteMessageInstantly(SharedEMessage message) const;
+    bool shouldExecuteMessageInstantly(const AI::EventMessage& message) const;
+
+    /**
+     * Takes a free slot which last held a message of the given type, or creates a new one.
+     * The message of a new slot is still empty.
+     *
+     * @return Index of the slot.
+     */
+    bs::UINT32 allocateSlot(AI::EventMessageType type);
+
+    /**
+     * Puts the slot back into the pool of its message type and invalidates all handles to it.
+     */
+    void releaseSlot(bs::UINT32 slot);
+
+    /**
+     * Removes all messages flagged as deleted from the queue in a single pass and
+     * releases their slots.
+     */
+    void removeDeletedMessages();
+
+    struct MessageSlot
+    {
+      /**
+       * Message stored in here. Stays allocated when the slot is free, so it can be
+       * overwritten by the next message of the same type.
+       */
+      bs::SPtr<AI::EventMessage> message;
+
+      /**
+       * Increased every time the slot is released, so old handles stop resolving.
+       */
+      bs::UINT32 generation = 0;
+
+      bool isInUse = false;
+    };
+
+    /**
+     * Storage of all messages, see *Message Storage*.
+     */
+    bs::Vector<MessageSlot> mMessageSlots;
+
+    /**
+     * Free slots by the type of message they last held.
+     */
+    bs::UnorderedMap<AI::EventMessageType, bs::Vector<bs::UINT32>> mFreeSlots;
 
     /**
-     * Events registered and managed here.
+     * Events registered and managed here, as indices into mMessageSlots.
      */
-    bs::Vector<SharedEMessage> mEventQueue;
+    bs::Vector<bs::UINT32> mEventQueue;
 
   public:
     REGOTH_DECLARE_RTTI(EventQueue)
@@ -23,6 +23,16 @@ namespace REGoth
 
     mElapsedSeconds += delta;
     mElapsedIngameSeconds += delta * CLOCK_SPEED_FACTOR;
+
+    mTimers.advance(mElapsedSeconds);
+    mIngameTimers.advance(mElapsedIngameSeconds);
+  }
+
+  void GameClock::restartTimers()
+  {
+    // Nothing is scheduled yet after loading, so this only moves the wheels to the current time
+    mTimers.fireAll(mElapsedSeconds);
+    mIngameTimers.fireAll(mElapsedIngameSeconds);
   }
 
   bs::INT32 GameClock::getDay() const
@@ -104,8 +114,8 @@ namespace REGoth
 
     // TODO: According to
     //       https://forum.worldofplayers.de/forum/threads/396326?p=6231841&viewfull=1#post6231841
-    //       if this shall be the Wld_setTime external, it also needs to implement these three
-    //       functions here RoutineManager.SetDailyRoutinePos(RoutinesOnly)
+    //       if this shall be the Wld_setTime external, it also needs to implement these
+    //       functions here (RoutineManager.SetDailyRoutinePos is done via the ingame timers)
     //       Game.SetObjectRoutineTimeChange(GameHour, GameMinute, Hour, Minute)
     //       SpawnManager.SpawnImmediately(ResetSpawnTime)
   }
@@ -120,8 +130,36 @@ namespace REGoth
 
   void GameClock::setTime(bs::UINT32 day, bs::UINT8 hour, bs::UINT8 min)
   {
+    float previousIngameSeconds = mElapsedIngameSeconds;
+
     mElapsedIngameSeconds =
         day * SECONDS_IN_A_DAY + hour * SECONDS_IN_AN_HOUR + min * SECONDS_IN_A_MINUTE;
+
+    // All timers are in the future if we went back in time, so everyone waiting has to check
+    // again, like characters waiting for their next routine switch. Otherwise, only those
+    // timers which were skipped fire, in order.
+    if (mElapsedIngameSeconds < previousIngameSeconds)
+    {
+      mIngameTimers.fireAll(mElapsedIngameSeconds);
+    }
+    else
+    {
+      mIngameTimers.advance(mElapsedIngameSeconds);
+    }
+  }
+
+  float GameClock::getIngameSecondsAtNext(bs::INT32 hour, bs::INT32 min) const
+  {
+    float startOfDay = getDay() * SECONDS_IN_A_DAY;
+    float timeOfDay  = hour * SECONDS_IN_AN_HOUR + min * SECONDS_IN_A_MINUTE;
+    float result     = startOfDay + timeOfDay;
+
+    if (result <= mElapsedIngameSeconds)
+    {
+      result += SECONDS_IN_A_DAY;
+    }
+
+    return result;
   }
 
   REGOTH_DEFINE_RTTI(GameClock)
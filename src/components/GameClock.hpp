@@ -1,4 +1,5 @@
 #pragma once
+#include <AI/TimerWheel.hpp>
 #include <BsPrerequisites.h>
 #include <RTTI/RTTIUtil.hpp>
 #include <Scene/BsComponent.h>
@@ -10,6 +11,12 @@ namespace REGoth
    * Component that handles play and ingame time.
    * Offers externals for timespecific Wld_* functions.
    * Shall be instantiated with the World.
+   *
+   * Anything which needs to happen at a certain point in time registers a timer instead of
+   * checking the time on every tick: timers() runs on play time, like `AI_Wait()`, while
+   * ingameTimers() runs on ingame time, like the switches between daily routine tasks. Both
+   * are advanced once per tick. Timers are not saved, their owners register them again after
+   * loading. The timers start at the time which was loaded, see restartTimers().
    */
   class GameClock : public bs::Component
   {
@@ -17,7 +24,8 @@ namespace REGoth
     GameClock(const bs::HSceneObject& parent);
 
     /**
-     * Triggered once every fixed time step. Updates elapsedSeconds for play and ingame time.
+     * Triggered once every fixed time step. Updates elapsedSeconds for play and ingame time
+     * and fires the timers which are due.
      */
     void fixedUpdate() override;
 
@@ -83,12 +91,49 @@ namespace REGoth
 
     void setDay(bs::UINT32 day);
 
+    /**
+     * @return  Total ingame seconds elapsed at the next time the clock shows the given time of
+     *          day (hh:mm). This is always in the future, so if the clock shows exactly that
+     *          time right now, the same time on the next day is returned.
+     */
+    float getIngameSecondsAtNext(bs::INT32 hour, bs::INT32 min) const;
+
+    /**
+     * @return  Timers running on play time, in seconds since the game started.
+     */
+    AI::TimerWheel& timers()
+    {
+      return mTimers;
+    }
+
+    /**
+     * @return  Timers running on ingame time, in total elapsed ingame seconds. If the time is
+     *          set back, all of them fire right away.
+     */
+    AI::TimerWheel& ingameTimers()
+    {
+      return mIngameTimers;
+    }
+
   private:
     float mElapsedSeconds       = 0.0f;
     float mElapsedIngameSeconds = 0.0f;
 
+    /**
+     * Runtime state, their owners register the timers again after loading. Not saved.
+     */
+    AI::TimerWheel mTimers{100.0f};
+    AI::TimerWheel mIngameTimers{1.0f};
+
     void setTime(bs::UINT32 day, bs::UINT8 hour, bs::UINT8 min);
 
+    /**
+     * Makes the timers continue at the current time. Called after loading, where the time has
+     * been restored but the timers would otherwise start at 0 again, firing everything
+     * scheduled for up to the current time at the next tick.
+     */
+    void restartTimers();
+
   public:
     REGOTH_DECLARE_RTTI(GameClock)
 
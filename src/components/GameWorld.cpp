@@ -1,27 +1,38 @@
 #include "GameWorld.hpp"
 #include <components/Sky.hpp>
 #include <BsZenLib/ImportPath.hpp>
+#include <FileSystem/BsFileSystem.h>
 #include <RTTI/RTTI_GameWorld.hpp>
 #include <Resources/BsResources.h>
 #include <Scene/BsPrefab.h>
 #include <Scene/BsSceneManager.h>
+#include <components/AIScheduler.hpp>
 #include <components/Character.hpp>
+#include <components/CharacterEventQueue.hpp>
+#include <components/CharacterPerception.hpp>
+#include <components/CharacterPhysicsLOD.hpp>
 #include <components/Focusable.hpp>
 #include <components/GameClock.hpp>
 #include <components/Item.hpp>
+#include <components/SaveGameWriter.hpp>
 #include <components/VisualCharacter.hpp>
 #include <components/Waynet.hpp>
+#include <components/WorldStreamer.hpp>
 #include <daedalus/DATFile.h>
 #include <exception/Throw.hpp>
+#include <original-content/OriginalGameResources.hpp>
 #include <original-content/VirtualFileSystem.hpp>
 #include <scripting/ScriptVMForGameWorld.hpp>
 #include <world/internals/ConstructFromZEN.hpp>
+#include <world/internals/PhysicsMeshCache.hpp>
 
 namespace REGoth
 {
-  GameWorld::GameWorld(const bs::HSceneObject& parent, const bs::String& zenFile)
+  GameWorld::GameWorld(const bs::HSceneObject& parent, const bs::String& zenFile,
+                       VobStreaming vobStreaming)
       : bs::Component(parent)
       , mZenFile(zenFile)
+      , mVobStreaming(vobStreaming)
   {
     setName("GameWorld");
   }
@@ -41,24 +52,23 @@ namespace REGoth
   {
     HGameWorld thisWorld = bs::static_object_cast<GameWorld>(getHandle());
 
-    // Always do this after importing or deserializing
-    fillFindByNameCache();
-
-    // FIXME: Enable these again if BsSceneManager::findComponents works at this point.
-    //        It seems to be too early for the components to be found when deserializing the world...
-    //        At the moment, these lists are stored inside the save game, which is not optimal.
-    // findAllCharacters();
-    // findAllItems();
-
     // If this is true here, we're being de-serialized
-    if (mIsInitialized) return;
+    if (mIsInitialized)
+    {
+      restoreLookupTables();
+      return;
+    }
+
+    fillFindByNameCache();
 
     initScriptVM();
 
     if (!mZenFile.empty())
     {
       // Import the ZEN and add all scene objects as children to this SO.
-      bs::HSceneObject so = Internals::constructFromZEN(thisWorld, mZenFile);
+      bool streamVobs = mVobStreaming == VobStreaming::Sectorized;
+
+      bs::HSceneObject so = Internals::constructFromZEN(thisWorld, mZenFile, streamVobs);
 
       if (!so)
       {
@@ -78,6 +88,11 @@ namespace REGoth
     mGameClock = SO()->addComponent<GameClock>();
     mGameClock->setTime(8, 0);
 
+    mAIScheduler         = SO()->addComponent<AIScheduler>();
+    mCharacterPhysicsLOD = SO()->addComponent<CharacterPhysicsLOD>();
+    mCharacterPerception = SO()->addComponent<CharacterPerception>();
+    mSaveGameWriter      = SO()->addComponent<SaveGameWriter>(thisWorld);
+
     SO()->addComponent<Sky>(thisWorld);
 
     mIsInitialized = true;
@@ -187,19 +202,25 @@ namespace REGoth
 
   void GameWorld::initScriptVM()
   {
-    bs::Vector<bs::UINT8> data = gVirtualFileSystem().readFile("GOTHIC.DAT");
+    const bs::String datFileName = "GOTHIC.DAT";
+
+    bs::Vector<bs::UINT8> data = gVirtualFileSystem().readFile(datFileName);
 
     mScriptVM = bs::bs_shared_ptr_new<Scripting::ScriptVMForGameWorld>(
-        bs::static_object_cast<GameWorld>(getHandle()), data);
+        bs::static_object_cast<GameWorld>(getHandle()), datFileName, data);
 
     mScriptVM->initialize();
   }
 
-  HGameWorld GameWorld::importZEN(const bs::String& zenFile)
+  HGameWorld GameWorld::importZEN(const bs::String& zenFile, VobStreaming vobStreaming)
   {
+    // Resources of a previously loaded world are likely not needed anymore
+    gOriginalGameResources().evictCachedResources();
+    Internals::gPhysicsMeshCache().clear();
+
     bs::HSceneObject rootSO = bs::SceneObject::create("root");
 
-    return rootSO->addComponent<GameWorld>(zenFile);
+    return rootSO->addComponent<GameWorld>(zenFile, vobStreaming);
   }
 
   void GameWorld::onImportedZEN()
@@ -237,6 +258,21 @@ namespace REGoth
     mWaynet = waynet;
   }
 
+  void GameWorld::linkWaynet(HWaynet waynet)
+  {
+    mWaynet = waynet;
+
+    for (HCharacter character : mAllCharacters)
+    {
+      HCharacterEventQueue eventQueue = character->SO()->getComponent<CharacterEventQueue>();
+
+      if (eventQueue)
+      {
+        eventQueue->setWaynet(waynet);
+      }
+    }
+  }
+
   bs::String GameWorld::worldName() const
   {
     return mZenFile.substr(0, mZenFile.find_first_of('.'));
@@ -304,6 +340,57 @@ namespace REGoth
     visit(SO());
   }
 
+  void GameWorld::storeLookupTables()
+  {
+    // Objects only found lazily by findObjectByName() so far should be found right away as well
+    fillFindByNameCache();
+
+    mSavedObjectNames.clear();
+    mSavedObjects.clear();
+
+    mSavedObjectNames.reserve(mSceneObjectsByNameCached.size());
+    mSavedObjects.reserve(mSceneObjectsByNameCached.size());
+
+    for (const auto& entry : mSceneObjectsByNameCached)
+    {
+      mSavedObjectNames.push_back(entry.first);
+      mSavedObjects.push_back(entry.second);
+    }
+
+    auto isDestroyed = [](const bs::GameObjectHandleBase& h) { return h.isDestroyed(); };
+
+    mAllCharacters.erase(std::remove_if(mAllCharacters.begin(), mAllCharacters.end(), isDestroyed),
+                         mAllCharacters.end());
+    mAllItems.erase(std::remove_if(mAllItems.begin(), mAllItems.end(), isDestroyed),
+                    mAllItems.end());
+
+    if (mWaynet)
+    {
+      mWaynet->populatePositionCaches();
+    }
+  }
+
+  void GameWorld::restoreLookupTables()
+  {
+    if (mSavedObjects.empty() || mSavedObjectNames.size() != mSavedObjects.size())
+    {
+      fillFindByNameCache();
+    }
+    else
+    {
+      mSceneObjectsByNameCached.clear();
+      mSceneObjectsByNameCached.reserve(mSavedObjects.size());
+
+      for (size_t i = 0; i < mSavedObjects.size(); i++)
+      {
+        mSceneObjectsByNameCached.emplace(std::move(mSavedObjectNames[i]), mSavedObjects[i]);
+      }
+    }
+
+    mSavedObjectNames.clear();
+    mSavedObjects.clear();
+  }
+
   bs::Vector<HCharacter> GameWorld::findCharactersInRange(float rangeInMeters,
                                                           const bs::Vector3& around) const
   {
@@ -343,8 +430,13 @@ namespace REGoth
 
   void GameWorld::save(const bs::String& saveName)
   {
+    storeLookupTables();
+
     bs::HPrefab cached = bs::Prefab::create(SO());
 
+    mSavedObjectNames.clear();
+    mSavedObjects.clear();
+
     enum
     {
       Overwrite    = true,
@@ -358,11 +450,185 @@ namespace REGoth
 
   bs::HPrefab GameWorld::load(const bs::String& saveName)
   {
+    gOriginalGameResources().evictCachedResources();
+    Internals::gPhysicsMeshCache().clear();
+
     // TODO: Should load at savegame location
     bs::Path path = BsZenLib::GothicPathToCachedWorld(saveName);
 
     return bs::gResources().load<bs::Prefab>(path);
   }
 
+  void GameWorld::saveDelta(const bs::String& saveName)
+  {
+    bs::HPrefab delta = createDeltaSnapshot();
+
+    enum
+    {
+      Overwrite    = true,
+      KeepExisting = false,
+    };
+
+    // TODO: Should store at savegame location
+    bs::Path path = BsZenLib::GothicPathToCachedWorld(saveName);
+    bs::gResources().save(delta, path, Overwrite);
+  }
+
+  bs::HPrefab GameWorld::createDeltaSnapshot()
+  {
+    // Take the static world out of the scene graph while saving, so it doesn't end up in the
+    // prefab. Handles into it are cleared, as they could not be resolved after loading anyways.
+    bs::HSceneObject staticWorld = bs::SceneObject::create("StaticWorld");
+    moveStaticWorld(SO(), staticWorld);
+
+    HWaynet waynet = mWaynet;
+    linkWaynet({});
+
+    auto reattachStaticWorld = [&]() {
+      moveStaticWorld(staticWorld, SO());
+      staticWorld->destroy(true);
+
+      linkWaynet(waynet);
+    };
+
+    // Creating the prefab copies the scene objects
+    bs::HPrefab delta;
+
+    try
+    {
+      delta = bs::Prefab::create(SO());
+    }
+    catch (...)
+    {
+      // Otherwise the world would go on without its static parts
+      reattachStaticWorld();
+      throw;
+    }
+
+    reattachStaticWorld();
+
+    return delta;
+  }
+
+  HGameWorld GameWorld::loadDelta(const bs::String& saveName)
+  {
+    gOriginalGameResources().evictCachedResources();
+    Internals::gPhysicsMeshCache().clear();
+
+    // TODO: Should load at savegame location
+    bs::Path path = BsZenLib::GothicPathToCachedWorld(saveName);
+
+    if (!bs::FileSystem::exists(path)) return {};
+
+    bs::HPrefab delta = bs::gResources().load<bs::Prefab>(path);
+
+    if (!delta) return {};
+
+    bs::HSceneObject worldSO = delta->instantiate();
+    HGameWorld world         = worldSO->getComponent<GameWorld>();
+
+    if (!world)
+    {
+      worldSO->destroy(true);
+      REGOTH_THROW(InvalidStateException, "Savegame " + saveName + " does not contain a world!");
+    }
+
+    if (!world->mZenFile.empty())
+    {
+      // A world streaming its vobs has saved its WorldStreamer as part of the delta, which
+      // loads the streamed vobs on its own. They must not be part of the static world then.
+      world->mVobStreaming =
+          worldSO->getComponent<WorldStreamer>() ? VobStreaming::Sectorized : VobStreaming::Disabled;
+
+      bs::HSceneObject staticWorld = loadStaticWorld(world->mZenFile, world->mVobStreaming);
+
+      moveStaticWorld(staticWorld, worldSO);
+      staticWorld->destroy(true);
+
+      world->onStaticWorldAttached();
+    }
+
+    return world;
+  }
+
+  void GameWorld::onStaticWorldAttached()
+  {
+    fillFindByNameCache();
+    findWaynet();
+    linkWaynet(mWaynet);
+  }
+
+  bool GameWorld::isPartOfStaticWorld(bs::HSceneObject so)
+  {
+    return !so->getComponent<Character>() && !so->getComponent<Item>();
+  }
+
+  void GameWorld::moveStaticWorld(bs::HSceneObject from, bs::HSceneObject to)
+  {
+    // Collect first, as moving changes the child indices
+    bs::Vector<bs::HSceneObject> staticChildren;
+
+    for (bs::UINT32 i = 0; i < from->getNumChildren(); i++)
+    {
+      bs::HSceneObject child = from->getChild(i);
+
+      if (isPartOfStaticWorld(child))
+      {
+        staticChildren.push_back(child);
+      }
+    }
+
+    for (bs::HSceneObject child : staticChildren)
+    {
+      child->setParent(to);
+    }
+  }
+
+  bs::HSceneObject GameWorld::loadStaticWorld(const bs::String& zenFile,
+                                              VobStreaming vobStreaming)
+  {
+    enum
+    {
+      Overwrite    = true,
+      KeepExisting = false,
+    };
+
+    bool streamVobs = vobStreaming == VobStreaming::Sectorized;
+
+    bs::String cacheName = Internals::staticWorldCacheName(zenFile, streamVobs);
+
+    if (cacheName.empty())
+    {
+      REGOTH_THROW(InvalidParametersException, "Failed to read ZEN-file: " + zenFile);
+    }
+
+    bs::Path path = BsZenLib::GothicPathToCachedWorld(cacheName);
+
+    if (bs::FileSystem::exists(path))
+    {
+      bs::HPrefab cached = bs::gResources().load<bs::Prefab>(path);
+
+      if (cached)
+      {
+        return cached->instantiate();
+      }
+    }
+
+    bs::gDebug().logDebug("[GameWorld] Creating static world cache for " + zenFile);
+
+    // Items found in the ZEN are part of the delta save already, if they still exist
+    bs::HSceneObject staticWorld = Internals::constructStaticWorldFromZEN(zenFile, streamVobs);
+
+    if (!staticWorld)
+    {
+      REGOTH_THROW(InvalidParametersException, "Failed to import ZEN-file: " + zenFile);
+    }
+
+    bs::HPrefab cached = bs::Prefab::create(staticWorld);
+    bs::gResources().save(cached, path, Overwrite);
+
+    return staticWorld;
+  }
+
   REGOTH_DEFINE_RTTI(GameWorld)
 }  // namespace REGoth
@@ -14,6 +14,18 @@ namespace REGoth
   class GameClock;
   using HGameClock = bs::GameObjectHandle<GameClock>;
 
+  class AIScheduler;
+  using HAIScheduler = bs::GameObjectHandle<AIScheduler>;
+
+  class CharacterPhysicsLOD;
+  using HCharacterPhysicsLOD = bs::GameObjectHandle<CharacterPhysicsLOD>;
+
+  class CharacterPerception;
+  using HCharacterPerception = bs::GameObjectHandle<CharacterPerception>;
+
+  class SaveGameWriter;
+  using HSaveGameWriter = bs::GameObjectHandle<SaveGameWriter>;
+
   class Character;
   using HCharacter = bs::GameObjectHandle<Character>;
 
@@ -71,6 +83,40 @@ namespace REGoth
    *    bs::HPrefab prefab = GameWorld::load("MySavegame");
    *    prefab->instantiate();
    *
+   * Since saves made via `save()` are also used as a cache of imported worlds, they
+   * store the lookup tables of the world along with the scene: The objects by name
+   * used by `findObjectByName()`, all characters and items and the waypoint
+   * positions of the waynet. Those are restored as they are when loading, so nothing
+   * needs to walk the whole scene before the first frame can be drawn.
+   *
+   *
+   * Delta Save Games
+   * ================
+   *
+   * Most of a world never changes while playing: The world mesh, static vobs and
+   * the waynet are the same as in the ZEN-file. A save made via `saveDelta()`
+   * only stores what does change, namely the script state, characters, items
+   * and the components attached to the *Root SO*, like the GameClock. Everything
+   * else is called the *static world*.
+   *
+   * When loading a delta save via `loadDelta()`, the static world is loaded from
+   * a cache made from the ZEN-file the world was created from. That cache is
+   * created on the first load and rebuilt once the ZEN-file changes. If the world
+   * was streaming its vobs, the streamed vobs are left to the saved WorldStreamer.
+   *
+   * Saves only contain the values of the script symbols, the symbols themselves
+   * are created from `GOTHIC.DAT` again. Since those values only make sense with
+   * the same `GOTHIC.DAT` they were saved with, loading throws if it has changed
+   * since. This applies to full saves as well.
+   *
+   *    gameWorld->saveDelta("MySavegame");
+   *
+   *    HGameWorld loaded = GameWorld::loadDelta("MySavegame");
+   *
+   * To not block the game while writing, use the SaveGameWriter instead:
+   *
+   *    gameWorld->saveGameWriter()->saveAsync("MySavegame");
+   *
    *
    * World Script Engine
    * ===================
@@ -104,10 +150,20 @@ namespace REGoth
       EmptyWorld,
     };
 
+    /**
+     * Whether static vobs should be streamed in and out by distance, see WorldStreamer.
+     */
+    enum class VobStreaming
+    {
+      Disabled,
+      Sectorized,
+    };
+
     /**
      * Imports a world from ZEN. See importZEN().
      */
-    GameWorld(const bs::HSceneObject& parent, const bs::String& zenFile);
+    GameWorld(const bs::HSceneObject& parent, const bs::String& zenFile,
+              VobStreaming vobStreaming = VobStreaming::Disabled);
     GameWorld(const bs::HSceneObject& parent, Empty empty);
 
     virtual ~GameWorld();
@@ -138,6 +194,42 @@ namespace REGoth
       return mGameClock;
     }
 
+    /**
+     * @return  Handle to the AIScheduler updating the script states of all characters.
+     *          Empty for worlds saved before the scheduler existed.
+     */
+    HAIScheduler aiScheduler() const
+    {
+      return mAIScheduler;
+    }
+
+    /**
+     * @return  Handle to the component deciding which characters have physics enabled.
+     *          Empty for worlds saved before it existed.
+     */
+    HCharacterPhysicsLOD characterPhysicsLOD() const
+    {
+      return mCharacterPhysicsLOD;
+    }
+
+    /**
+     * @return  Handle to the component letting the characters perceive each other.
+     *          Empty for worlds saved before it existed.
+     */
+    HCharacterPerception characterPerception() const
+    {
+      return mCharacterPerception;
+    }
+
+    /**
+     * @return  Handle to the component writing delta saves in the background.
+     *          Empty for worlds saved before it existed.
+     */
+    HSaveGameWriter saveGameWriter() const
+    {
+      return mSaveGameWriter;
+    }
+
     /**
      * Access to the worlds ScriptVM with GOTHIC.DAT loaded.
      */
@@ -159,9 +251,13 @@ namespace REGoth
      * Since importing a ZEN can take a while, you can `save()` the
      * world afterwards and load from the save, which is much quicker.
      *
+     * For large worlds, pass `VobStreaming::Sectorized` to only keep the static
+     * vobs around the camera inside the scene, see WorldStreamer.
+     *
      * @return Handle to the imported GameWorld.
      */
-    static HGameWorld importZEN(const bs::String& zenFile);
+    static HGameWorld importZEN(const bs::String& zenFile,
+                                VobStreaming vobStreaming = VobStreaming::Disabled);
 
     /**
      * Creates an empty world.
@@ -187,6 +283,31 @@ namespace REGoth
      */
     static bs::HPrefab load(const bs::String& saveName);
 
+    /**
+     * Saves only the parts of the world which change while playing to a savegame
+     * with the given name. See *Delta Save Games*.
+     */
+    void saveDelta(const bs::String& saveName);
+
+    /**
+     * Creates a copy of the parts of the world which would be written by saveDelta().
+     *
+     * The copy does not change when the world goes on, so it can be written to disk later,
+     * even from another thread. See SaveGameWriter.
+     */
+    bs::HPrefab createDeltaSnapshot();
+
+    /**
+     * Loads the world with the given name previously saved via saveDelta() and puts
+     * the static world of its ZEN back in.
+     *
+     * Throws if `GOTHIC.DAT` is different from the one the world was saved with, see
+     * DaedalusVM.
+     *
+     * @return Handle to the loaded world. Empty, if the save does not exist.
+     */
+    static HGameWorld loadDelta(const bs::String& saveName);
+
     /**
      * Runs the worlds init script.
      *
@@ -282,6 +403,14 @@ namespace REGoth
      */
     bs::Vector<HCharacter> findCharactersInRange(float rangeInMeters,
                                                  const bs::Vector3& around) const;
+    /**
+     * @return All characters living in this world.
+     */
+    const bs::Vector<HCharacter>& allCharacters() const
+    {
+      return mAllCharacters;
+    }
+
     /**
      * Finds all items which are in the given range around the given location.
      */
@@ -308,12 +437,57 @@ namespace REGoth
      */
     void findWaynet();
 
+    /**
+     * Sets the waynet of this world and of all pathfinders using it.
+     */
+    void linkWaynet(HWaynet waynet);
+
+    /**
+     * Called after the static world has been put back into a world loaded from a delta save.
+     * Restores everything referring to the static world, as it was not part of the save.
+     */
+    void onStaticWorldAttached();
+
+    /**
+     * @return Whether the given child of the Root SO belongs to the static world,
+     *         i.e. it is neither a character nor an item.
+     */
+    static bool isPartOfStaticWorld(bs::HSceneObject so);
+
+    /**
+     * Moves all children of \p from which belong to the static world to \p to.
+     */
+    static void moveStaticWorld(bs::HSceneObject from, bs::HSceneObject to);
+
+    /**
+     * Loads the static world of the given ZEN from cache. If there is no cache yet,
+     * the static parts of the ZEN are imported and the cache created.
+     *
+     * @param  vobStreaming  Whether the world the static world is for streams its vobs.
+     *                       Streamed vobs are not part of the static world then.
+     *
+     * @return Scene object holding the static world as children.
+     */
+    static bs::HSceneObject loadStaticWorld(const bs::String& zenFile, VobStreaming vobStreaming);
+
     /**
      * Clears and fills the mSceneObjectsByNameCached map with objects being
      * in the scene right now.
      */
     void fillFindByNameCache();
 
+    /**
+     * Brings the lookup tables up to date and copies those which cannot be serialized as they
+     * are into mSavedObjectNames and mSavedObjects. Called by save().
+     */
+    void storeLookupTables();
+
+    /**
+     * Restores the lookup tables after loading. Falls back to walking the scene if the save
+     * didn't contain them, like delta saves.
+     */
+    void restoreLookupTables();
+
     /**
      * Fills mAllCharacters, mAllItems, and so on.
      */
@@ -325,6 +499,12 @@ namespace REGoth
      */
     bs::String mZenFile;
 
+    /**
+     * Whether static vobs are streamed. Not saved, as delta saves can tell by the saved
+     * WorldStreamer, see loadDelta().
+     */
+    VobStreaming mVobStreaming = VobStreaming::Disabled;
+
     /**
      * Access to the Waynet of this world.
      */
@@ -335,6 +515,26 @@ namespace REGoth
      */
     HGameClock mGameClock;
 
+    /**
+     * Updates the script states of all characters in this world.
+     */
+    HAIScheduler mAIScheduler;
+
+    /**
+     * Enables and disables physics of the characters in this world.
+     */
+    HCharacterPhysicsLOD mCharacterPhysicsLOD;
+
+    /**
+     * Lets the characters in this world perceive each other.
+     */
+    HCharacterPerception mCharacterPerception;
+
+    /**
+     * Writes delta saves of this world in the background.
+     */
+    HSaveGameWriter mSaveGameWriter;
+
     /**
      * Script-VM with GOTHIC.DAT loaded.
      */
@@ -350,12 +550,18 @@ namespace REGoth
     bs::UnorderedMap<bs::String, bs::HSceneObject> mSceneObjectsByNameCached;
 
     /**
-     * Access to every character, item and others. Not saved, can be built after loading.
-     * FIXME: Stored inside the savegame for now because BsSceneManager::findComponents doesn't work
+     * Access to every character, item and others. Stored inside the savegame, so they don't
+     * have to be searched for after loading. See storeLookupTables().
      */
     bs::Vector<HCharacter> mAllCharacters;
     bs::Vector<HItem> mAllItems;
 
+    /**
+     * Contents of mSceneObjectsByNameCached, only filled while saving and loading.
+     */
+    bs::Vector<bs::String> mSavedObjectNames;
+    bs::Vector<bs::HSceneObject> mSavedObjects;
+
     /**
      * Used to skip onInitialized() when loading via RTTI.
      */
@@ -0,0 +1,267 @@
+#include "SaveGameWriter.hpp"
+#include <BsZenLib/ImportPath.hpp>
+#include <FileSystem/BsFileSystem.h>
+#include <RTTI/RTTI_SaveGameWriter.hpp>
+#include <Resources/BsResourceManifest.h>
+#include <Resources/BsResources.h>
+#include <Scene/BsPrefab.h>
+#include <Utility/BsTime.h>
+#include <Utility/BsTimer.h>
+#include <components/GameWorld.hpp>
+#include <cstdio>
+#include <exception/Throw.hpp>
+
+namespace REGoth
+{
+  /**
+   * Taking the snapshot longer than this would show as a hitch, so it is worth a warning.
+   * Roughly one frame at 60 FPS.
+   */
+  constexpr bs::UINT64 SNAPSHOT_BUDGET_MICROSECONDS = 16000;
+
+  /** Appended to the file name of a save while it is being written. */
+  constexpr const char* TEMPORARY_FILE_SUFFIX = ".tmp";
+
+  /** Appended to the file name of the previous save while it is being replaced. */
+  constexpr const char* PREVIOUS_FILE_SUFFIX = ".old";
+
+  SaveGameWriter::SaveGameWriter(const bs::HSceneObject& parent, HGameWorld world)
+      : bs::Component(parent)
+      , mWorld(world)
+  {
+    setName("SaveGameWriter");
+  }
+
+  SaveGameWriter::~SaveGameWriter()
+  {
+  }
+
+  bool SaveGameWriter::saveAsync(const bs::String& saveName, CompletionCallback onCompleted,
+                                 ProgressCallback onProgress)
+  {
+    if (isSaving())
+    {
+      bs::gDebug().logWarning("[SaveGameWriter] Cannot save to " + saveName +
+                              " while another save is being written");
+      return false;
+    }
+
+    bs::Timer timer;
+
+    auto save         = bs::bs_shared_ptr_new<PendingSave>();
+    save->saveName    = saveName;
+    save->path        = BsZenLib::GothicPathToCachedWorld(saveName);  // TODO: Savegame location
+    save->snapshot    = mWorld->createDeltaSnapshot();
+    save->onCompleted = onCompleted;
+    save->onProgress  = onProgress;
+
+    mStatistics.snapshotMicroseconds = timer.getMicroseconds();
+
+    if (mStatistics.snapshotMicroseconds > SNAPSHOT_BUDGET_MICROSECONDS)
+    {
+      bs::gDebug().logWarning(bs::StringUtil::format(
+          "[SaveGameWriter] Snapshot for {0} took {1} ms", saveName,
+          mStatistics.snapshotMicroseconds / 1000.0f));
+    }
+
+    // The task holds on to the save, so it stays valid even if this component goes away
+    save->task = bs::Task::create("SaveGameWriter", [save]() { writeSnapshot(*save); });
+
+    mPendingSave = save;
+
+    bs::TaskScheduler::instance().addTask(save->task);
+
+    return true;
+  }
+
+  void SaveGameWriter::writeSnapshot(PendingSave& save)
+  {
+    enum
+    {
+      Compress     = true,
+      DontCompress = false,
+    };
+
+    bs::Timer timer;
+
+    bs::Path temporaryPath = save.path;
+    temporaryPath.setFilename(save.path.getFilename() + TEMPORARY_FILE_SUFFIX);
+
+    try
+    {
+      // Only encodes the snapshot into the file. Unlike gResources().save(), this doesn't
+      // touch the resource manifest, which is not safe to do from a worker thread. The
+      // snapshot is registered under its final path by finishPendingSave() instead.
+      bs::gResources()._save(save.snapshot.getInternalPtr(), temporaryPath, Compress);
+
+      save.stage = Stage::Replacing;
+
+      replaceFile(temporaryPath, save.path);
+
+      save.writeMicroseconds = timer.getMicroseconds();
+      save.stage             = Stage::Done;
+    }
+    catch (const std::exception& e)
+    {
+      save.error = e.what();
+      save.stage = Stage::Failed;
+    }
+  }
+
+  void SaveGameWriter::replaceFile(const bs::Path& from, const bs::Path& to)
+  {
+    bs::String fromPath = from.toString();
+    bs::String toPath   = to.toString();
+
+    // Atomically replaces an existing file on POSIX systems
+    if (std::rename(fromPath.c_str(), toPath.c_str()) == 0) return;
+
+    if (!bs::FileSystem::exists(to))
+    {
+      REGOTH_THROW(InvalidStateException, "Failed to move " + fromPath + " to " + toPath);
+    }
+
+    // Some systems, like Windows, refuse to rename onto an existing file. Move the previous
+    // save aside instead of deleting it, so it is only gone once the new one is in place.
+    bs::String previousPath = toPath + PREVIOUS_FILE_SUFFIX;
+
+    std::remove(previousPath.c_str());
+
+    if (std::rename(toPath.c_str(), previousPath.c_str()) != 0 ||
+        std::rename(fromPath.c_str(), toPath.c_str()) != 0)
+    {
+      REGOTH_THROW(InvalidStateException, "Failed to replace " + toPath + " with " + fromPath);
+    }
+
+    std::remove(previousPath.c_str());
+  }
+
+  void SaveGameWriter::waitUntilDone()
+  {
+    if (!isSaving()) return;
+
+    mPendingSave->task->wait();
+
+    finishPendingSave();
+  }
+
+  void SaveGameWriter::enableAutosave(const bs::String& saveName, float intervalSeconds)
+  {
+    if (intervalSeconds <= 0.0f)
+    {
+      REGOTH_THROW(InvalidParametersException, "Autosave interval must be positive");
+    }
+
+    mAutosaveName            = saveName;
+    mAutosaveIntervalSeconds = intervalSeconds;
+    mTimeUntilAutosave       = intervalSeconds;
+  }
+
+  void SaveGameWriter::disableAutosave()
+  {
+    mAutosaveName.clear();
+    mAutosaveIntervalSeconds = 0.0f;
+  }
+
+  void SaveGameWriter::update()
+  {
+    if (isSaving())
+    {
+      reportProgress();
+
+      if (mPendingSave->task->isComplete())
+      {
+        finishPendingSave();
+      }
+    }
+
+    if (mAutosaveName.empty()) return;
+
+    mTimeUntilAutosave -= bs::gTime().getFrameDelta();
+
+    if (mTimeUntilAutosave > 0.0f) return;
+
+    // Try again on the next frame if a save is still running
+    if (saveAsync(mAutosaveName))
+    {
+      mTimeUntilAutosave = mAutosaveIntervalSeconds;
+    }
+  }
+
+  void SaveGameWriter::onDestroyed()
+  {
+    // Don't leave a half-written save behind
+    waitUntilDone();
+  }
+
+  float SaveGameWriter::progressOf(Stage stage)
+  {
+    // The snapshot is already taken once a save is pending. Most of the time goes into writing.
+    switch (stage)
+    {
+      case Stage::Writing:
+        return 0.1f;
+      case Stage::Replacing:
+        return 0.9f;
+      case Stage::Done:
+      case Stage::Failed:
+      default:
+        return 1.0f;
+    }
+  }
+
+  void SaveGameWriter::reportProgress()
+  {
+    Stage stage = mPendingSave->stage;
+
+    if (stage == mPendingSave->reportedStage) return;
+
+    mPendingSave->reportedStage = stage;
+
+    if (mPendingSave->onProgress)
+    {
+      mPendingSave->onProgress(progressOf(stage));
+    }
+  }
+
+  void SaveGameWriter::finishPendingSave()
+  {
+    // Clear first, so the callback may start the next save
+    bs::SPtr<PendingSave> save = mPendingSave;
+    mPendingSave               = nullptr;
+
+    bool succeeded = save->stage == Stage::Done;
+
+    if (succeeded)
+    {
+      // Done here on the game thread, as the manifest is shared with everything else loading
+      bs::gResources()
+          .getResourceManifest("Default")
+          ->registerResource(save->snapshot.getUUID(), save->path);
+
+      mStatistics.writeMicroseconds = save->writeMicroseconds;
+    }
+    else
+    {
+      bs::gDebug().logError("[SaveGameWriter] Failed to write " + save->saveName + ": " +
+                            save->error);
+    }
+
+    // The task refers back to the save, so break that cycle. The snapshot is freed here as well
+    // instead of on the worker thread which may still be holding the task.
+    save->task     = nullptr;
+    save->snapshot = nullptr;
+
+    if (save->onProgress && save->reportedStage != save->stage)
+    {
+      save->onProgress(1.0f);
+    }
+
+    if (save->onCompleted)
+    {
+      save->onCompleted(save->saveName, succeeded);
+    }
+  }
+
+  REGOTH_DEFINE_RTTI(SaveGameWriter)
+}  // namespace REGoth
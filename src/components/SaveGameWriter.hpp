@@ -0,0 +1,189 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <RTTI/RTTIUtil.hpp>
+#include <Scene/BsComponent.h>
+#include <Threading/BsTaskScheduler.h>
+#include <atomic>
+
+namespace REGoth
+{
+  class GameWorld;
+  using HGameWorld = bs::GameObjectHandle<GameWorld>;
+
+  /**
+   * Writes delta saves of a world in the background, see GameWorld::saveDelta().
+   *
+   * Saving is split into two parts: On the game thread, a snapshot of the world is taken
+   * via GameWorld::createDeltaSnapshot(). The snapshot is a copy of the scene objects, so the
+   * game can go on right away without changing what is being saved. Serializing, compressing
+   * and writing the snapshot is then done by one of bs:f's worker threads.
+   *
+   * The save is first written to a temporary file which then replaces the actual save, so an
+   * existing save is never left half-written, for example if the game crashes while saving.
+   * The worker thread only encodes the snapshot into that file. Registering it with bs:f's
+   * resource manifest is left to the game thread.
+   *
+   * Callbacks are always called on the game thread, from update().
+   *
+   * Only one save is written at a time. Autosaves are skipped while another save is running.
+   */
+  class SaveGameWriter : public bs::Component
+  {
+  public:
+    /**
+     * Called whenever the save made a step forward. \p progress goes from 0 to 1.
+     */
+    using ProgressCallback = std::function<void(float progress)>;
+
+    /**
+     * Called once the save has been written, or writing failed.
+     */
+    using CompletionCallback = std::function<void(const bs::String& saveName, bool succeeded)>;
+
+    /**
+     * Timings of the last save.
+     */
+    struct Statistics
+    {
+      bs::UINT64 snapshotMicroseconds = 0;  // Time spent on the game thread
+      bs::UINT64 writeMicroseconds    = 0;  // Time spent in the background
+    };
+
+    SaveGameWriter(const bs::HSceneObject& parent, HGameWorld world);
+    virtual ~SaveGameWriter();
+
+    /**
+     * Takes a snapshot of the world and starts writing it to the save with the given name.
+     *
+     * @param  saveName     Name of the save, as passed to GameWorld::loadDelta().
+     * @param  onCompleted  Called once the save has been written. Optional.
+     * @param  onProgress   Called whenever the save made a step forward. Optional.
+     *
+     * @return False, if another save is still being written. Nothing is saved then.
+     */
+    bool saveAsync(const bs::String& saveName, CompletionCallback onCompleted = nullptr,
+                   ProgressCallback onProgress = nullptr);
+
+    /**
+     * @return Whether a save is being written right now.
+     */
+    bool isSaving() const
+    {
+      return mPendingSave != nullptr;
+    }
+
+    /**
+     * Blocks until the save being written right now is done and calls its completion callback.
+     * Does nothing if no save is being written.
+     */
+    void waitUntilDone();
+
+    /**
+     * Saves the world to the given save every few seconds, e.g. `AUTOSAVE`.
+     */
+    void enableAutosave(const bs::String& saveName, float intervalSeconds);
+
+    /**
+     * Stops saving automatically.
+     */
+    void disableAutosave();
+
+    /**
+     * @return Timings of the last save which has been completed.
+     */
+    const Statistics& statistics() const
+    {
+      return mStatistics;
+    }
+
+    /**
+     * Reports the progress of the running save and triggers autosaves.
+     */
+    void update() override;
+
+  protected:
+    void onDestroyed() override;
+
+  private:
+    enum class Stage
+    {
+      Writing,
+      Replacing,
+      Done,
+      Failed,
+    };
+
+    /**
+     * A save being written. Shared with the worker thread.
+     */
+    struct PendingSave
+    {
+      bs::String saveName;
+      bs::Path path;
+      bs::HPrefab snapshot;
+      bs::SPtr<bs::Task> task;
+
+      CompletionCallback onCompleted;
+      ProgressCallback onProgress;
+
+      std::atomic<Stage> stage{Stage::Writing};
+
+      /**
+       * Stage last passed to onProgress. Only accessed from the game thread.
+       */
+      Stage reportedStage = Stage::Writing;
+
+      /**
+       * Set by the worker thread before moving to Stage::Done or Stage::Failed.
+       */
+      bs::String error;
+      bs::UINT64 writeMicroseconds = 0;
+    };
+
+    /**
+     * Serializes the snapshot into a temporary file and replaces the save with it.
+     * Runs on a worker thread.
+     */
+    static void writeSnapshot(PendingSave& save);
+
+    /**
+     * Replaces the file at \p to with the one at \p from. The previous file at \p to is kept
+     * until the new one is in place. Throws if that fails.
+     */
+    static void replaceFile(const bs::Path& from, const bs::Path& to);
+
+    /**
+     * @return How far the save has come when reaching the given stage, from 0 to 1.
+     */
+    static float progressOf(Stage stage);
+
+    /**
+     * Calls the progress callback if the save made a step forward since the last call.
+     */
+    void reportProgress();
+
+    /**
+     * Registers the written save with the resource manifest, calls the completion callback
+     * and frees the snapshot. The task must be complete.
+     */
+    void finishPendingSave();
+
+    HGameWorld mWorld;
+
+    bs::SPtr<PendingSave> mPendingSave;
+
+    bs::String mAutosaveName;
+    float mAutosaveIntervalSeconds = 0.0f;
+    float mTimeUntilAutosave       = 0.0f;
+
+    Statistics mStatistics;
+
+  public:
+    REGOTH_DECLARE_RTTI(SaveGameWriter)
+
+  protected:
+    SaveGameWriter() = default;  // For RTTI
+  };
+
+  using HSaveGameWriter = bs::GameObjectHandle<SaveGameWriter>;
+}  // namespace REGoth
@@ -39,11 +39,14 @@ namespace REGoth
   void Sky::applySkySettingsToCamera() const
   {
     const auto& camera = bs::gSceneManager().getMainCamera();
+
+    if (!camera) return;
+
     float near;
     float far;
     bs::Color fogColor;
 
-    mSkyColoring->calculateFogDistanceAndColor(near, far, fogColor);
+    mSkyColoring->calculateFogDistanceAndColor(*camera, near, far, fogColor);
 
     // TODO: Use fog near and far
     (void)near;
@@ -25,44 +25,6 @@ namespace REGoth
   {
   }
 
-  void StoryInformation::onInitialized()
-  {
-    if (mAllInfos.empty())
-    {
-      findAllInfos();
-    }
-  }
-
-  void StoryInformation::findAllInfos()
-  {
-    auto& objectStorage = mGameWorld->scriptVM().scriptObjects();
-    auto& symbolStorage = mGameWorld->scriptVM().scriptSymbols();
-
-    for (Scripting::ScriptObjectHandle h : mSelf->allInfosForThisCharacter())
-    {
-      auto& data = objectStorage.get(h);
-
-      DialogueInfo info;
-      info.name        = data.instanceName;
-      info.priority    = data.intValue("NR");
-      info.isPermanent = data.intValue("PERMANENT") != 0;
-      info.isImportant = data.intValue("IMPORTANT") != 0;
-      info.isTrade     = data.intValue("TRADE") != 0;
-      info.choiceText  = data.stringValue("DESCRIPTION");
-
-      info.conditionFunction =
-          symbolStorage.findFunctionByAddress(data.functionPointerValue("CONDITION"));
-      info.informationFunction =
-          symbolStorage.findFunctionByAddress(data.functionPointerValue("INFORMATION"));
-
-      bs::UINT32 index = mAllInfos.size();
-
-      mAllInfos.emplace_back(info);
-
-      bs::gDebug().logDebug("[StoryInformation] Info " + info.name + " for " + mSelf->getName());
-    }
-  }
-
   bs::Vector<const StoryInformation::DialogueInfo*> StoryInformation::gatherAvailableDialogueLines(
       HCharacter other) const
   {
@@ -70,23 +32,21 @@ namespace REGoth
 
     bs::Vector<const StoryInformation::DialogueInfo*> result;
 
-    for (bs::UINT32 i = 0; i < (bs::UINT32)mAllInfos.size(); i++)
+    for (const DialogueInfo& info : mSelf->allInfosForThisCharacter())
     {
-      if (isDialogueInfoAvaliable(i, other, otherInfo))
+      if (isDialogueInfoAvaliable(info, other, otherInfo))
       {
-        result.push_back(&mAllInfos[i]);
+        result.push_back(&info);
       }
     }
 
     return result;
   }
 
-  bool StoryInformation::isDialogueInfoAvaliable(bs::UINT32 index, HCharacter other,
+  bool StoryInformation::isDialogueInfoAvaliable(const DialogueInfo& info, HCharacter other,
                                                  HStoryInformation otherInfo) const
   {
-    const auto& info = mAllInfos[index];
-
-    if (!info.isPermanent && otherInfo->knowsInfo(info.name))
+    if (!info.isPermanent && otherInfo->knowsInfo(info))
     {
      return false;
     }
@@ -96,12 +56,66 @@ namespace REGoth
 
   bool StoryInformation::knowsInfo(const bs::String& name) const
   {
-    return mKnownInfos.find(name) != mKnownInfos.end();
+    return isKnownOrdinal(infoOrdinalByName(name));
+  }
+
+  bool StoryInformation::knowsInfo(Scripting::SymbolIndex instance) const
+  {
+    return isKnownOrdinal(mGameWorld->scriptVM().infoOrdinal(instance));
+  }
+
+  bool StoryInformation::knowsInfo(const DialogueInfo& info) const
+  {
+    return isKnownOrdinal(info.ordinal);
   }
 
   void StoryInformation::giveKnowledgeAboutInfo(const bs::String& name)
   {
-    mKnownInfos.insert(name);
+    auto& symbols = mGameWorld->scriptVM().scriptSymbols();
+
+    giveKnowledgeAboutInfo(symbols.findIndexBySymbolName(name));
+  }
+
+  void StoryInformation::giveKnowledgeAboutInfo(Scripting::SymbolIndex instance)
+  {
+    bs::UINT32 ordinal = mGameWorld->scriptVM().infoOrdinal(instance);
+
+    if (ordinal == Scripting::INFO_ORDINAL_INVALID)
+    {
+      REGOTH_THROW(InvalidParametersException,
+                   "Not an information instance: " +
+                       mGameWorld->scriptVM().scriptSymbols().getSymbolName(instance));
+    }
+
+    if (isKnownOrdinal(ordinal)) return;
+
+    size_t word = ordinal / 64;
+
+    if (word >= mKnownInfos.size())
+    {
+      mKnownInfos.resize(word + 1, 0);
+    }
+
+    mKnownInfos[word] |= (bs::UINT64)1 << (ordinal % 64);
+
+    mGameWorld->scriptVM().onKnownInfosChanged();
+  }
+
+  bool StoryInformation::isKnownOrdinal(bs::UINT32 ordinal) const
+  {
+    size_t word = ordinal / 64;
+
+    // Also catches Scripting::INFO_ORDINAL_INVALID
+    if (word >= mKnownInfos.size()) return false;
+
+    return (mKnownInfos[word] >> (ordinal % 64)) & 1;
+  }
+
+  bs::UINT32 StoryInformation::infoOrdinalByName(const bs::String& name) const
+  {
+    auto& vm = mGameWorld->scriptVM();
+
+    return vm.infoOrdinal(vm.scriptSymbols().findIndexBySymbolName(name));
   }
 
   void StoryInformation::startDialogueWith(HCharacter other)
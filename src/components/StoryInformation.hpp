@@ -1,5 +1,5 @@
 #pragma once
-#include "scripting/ScriptTypes.hpp"
+#include "scripting/DialogueInfo.hpp"
 #include <RTTI/RTTIUtil.hpp>
 #include <Scene/BsComponent.h>
 
@@ -65,10 +65,12 @@ namespace REGoth
    *     };
    *
    *
-   * This component is attached to a character. It then stores a list of all
-   * *Information*-instances this character can be asked about. And which have
-   * the character has asked others about. It can also evaluate which dialogue
-   * lines should be displayed when the hero talks to this character.
+   * This component is attached to a character. It stores which
+   * *Information*-instances the character has asked others about. It can also
+   * evaluate which dialogue lines should be displayed when the hero talks to this
+   * character. The *Information*-instances this character can be asked about are
+   * the same for all characters of the same instance, so they are only gathered
+   * once by the script VM, see DaedalusVMForGameWorld::dialogueInfosOfNpc().
    *
    */
   class StoryInformation : public bs::Component
@@ -77,60 +79,11 @@ namespace REGoth
     StoryInformation(const bs::HSceneObject& parent, HGameWorld gameWorld, HCharacter self);
     virtual ~StoryInformation();
 
-    /**
-     * Native version if the `C_INFO` script class for efficiency.
-     */
-    struct DialogueInfo
-    {
-      /**
-       * Instance name of this info
-       */
-      bs::String name;
-
-      /**
-       * Called `nr` in the original script files. This defines the order the dialogue lines
-       * should be displayed in the UI. However, sometimes those numbers are not unique, some are
-       * missing, so `priority` is the better name here. Low numbers mean higher priority.
-       */
-      bs::UINT32 priority;
-
-      /**
-       * Script function to execute to check whether this information should be avaialble to the
-       * user in the UI. If this returns 0, it should not be shown.
-       */
-      Scripting::SymbolIndex conditionFunction;
-
-      /**
-       * Script function to execute once the user has chosen this dialogue line. This usually
-       * does the back-and-forth conversation.
-       */
-      Scripting::SymbolIndex informationFunction;
-
-      /**
-       * Whether this information should disapper once you talked about it once.
-       */
-      bool isPermanent;
-
-      /**
-       * If true, the NPC should start talking to the hero as soon as the hero comes into range.
-       * This is often used for guards who are supposed to stop the player from entering
-       * certain locations.
-       */
-      bool isImportant;
-
-      /**
-       * If true, this information will open the trade window.
-       */
-      bool isTrade;
-
-      /**
-       * The text to display to the user in the UI. Called `description` inside scripts.
-       */
-      bs::String choiceText;
-    };
+    using DialogueInfo = Scripting::DialogueInfo;
 
     /**
-     * Assembles a list of all dialogue lines to be shown to the user in the UI.
+     * Assembles a list of all dialogue lines to be shown to the user in the UI, sorted by
+     * priority.
      *
      * @param  other  Dialogue-Parter. Usually this is the hero.
      */
@@ -141,18 +94,27 @@ namespace REGoth
      *
      * @param  name  UPPERCASE Name of the *Information*-Instance, e.g. `INFO_THORUS_WORKFORGOMEZ`.
      *
-     * Throws if this info is not available at all for this character.
+     * Throws if there is no symbol with that name. Prefer the other overloads where possible,
+     * as looking up the name is much slower than checking whether the info is known.
      */
     bool knowsInfo(const bs::String& name) const;
 
+    /**
+     * @return Whether the character knows the given info. False if the symbol is not an
+     *         *Information*-Instance.
+     */
+    bool knowsInfo(Scripting::SymbolIndex instance) const;
+    bool knowsInfo(const DialogueInfo& info) const;
+
     /**
      * Lets this character remember that someone talked about the given info with them.
      *
      * @param  name  UPPERCASE Name of the *Information*-Instance, e.g. `INFO_THORUS_WORKFORGOMEZ`.
      *
-     * Throws if this info is not available at all for this character.
+     * Throws if this is not an *Information*-Instance.
      */
     void giveKnowledgeAboutInfo(const bs::String& name);
+    void giveKnowledgeAboutInfo(Scripting::SymbolIndex instance);
 
     /**
      * TODO: Refactor, so this doesn't need to access the UI internally. I'd like this class to
@@ -177,40 +139,39 @@ namespace REGoth
      */
     void clearChoices();
 
-  protected:
-    void onInitialized() override;
-
   private:
     /**
-     * Looks through all script symbols to find all *Information*-Instances available to this
-     * character.
+     * @return Whether the info with the given ordinal is known, see
+     *         DaedalusVMForGameWorld::infoOrdinal().
      */
-    void findAllInfos();
+    bool isKnownOrdinal(bs::UINT32 ordinal) const;
+
+    /**
+     * @return Ordinal of the *Information*-Instance with the given name, or
+     *         Scripting::INFO_ORDINAL_INVALID.
+     */
+    bs::UINT32 infoOrdinalByName(const bs::String& name) const;
 
     /**
      * @return Whether the given DialogueInfos dialogue line should be shown to the user in the UI.
      *
-     * @param  index      Info-Index into mAllInfos.
+     * @param  info       Info of this character to check.
      * @param  other      Dialogue-Parter. Usually this is the hero.
      * @param  otherInfo  StoryInformation component of `other`. Could be retrieved internally, but
      *                    is a parameter here for efficiency when calling this in a loop.
      *
      * @note   May call script code!
      */
-    bool isDialogueInfoAvaliable(bs::UINT32 index, HCharacter other,
+    bool isDialogueInfoAvaliable(const DialogueInfo& info, HCharacter other,
                                  HStoryInformation otherInfo) const;
 
   public:
     REGOTH_DECLARE_RTTI(StoryInformation)
 
-    /** All possible infos to talk about with this character. These are static and
-        can be gathered directly from the scripts on startup.
-        Not serialized, can be generated from script symbols easily. */
-    bs::Vector<DialogueInfo> mAllInfos;
-
-    /** Set of *Information*-Instances this character knows. Contains names such as
-       `INFO_THORUS_WORKFORGOMEZ` */
-    bs::Set<bs::String> mKnownInfos;
+    /** *Information*-Instances this character knows. Bit `i % 64` of element `i / 64` is set if
+        the info with ordinal `i` is known, see DaedalusVMForGameWorld::infoOrdinal(). Only as
+        long as needed for the highest ordinal known. */
+    bs::Vector<bs::UINT64> mKnownInfos;
 
     HCharacter mSelf;
     HGameWorld mGameWorld;
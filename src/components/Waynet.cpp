@@ -236,6 +236,19 @@ namespace REGoth
     return path;
   }
 
+  void Waynet::populatePositionCaches()
+  {
+    if (!hasCachedWaypointPositions())
+    {
+      populateWaypointPositionCache();
+    }
+
+    if (!hasCachedFreepointPositions())
+    {
+      populateFreepointPositionCache();
+    }
+  }
+
   void Waynet::populateWaypointPositionCache()
   {
     mWaypointPositions.clear();
@@ -166,6 +166,13 @@ namespace REGoth
      */
     void debugDraw(const REGoth::HAnchoredTextLabels& textLabels);
 
+    /**
+     * Fills the position caches used by the searches, if not done yet. The searches would do
+     * that themselves on first use, so this only needs to be called before searching from
+     * multiple threads at once.
+     */
+    void populatePositionCaches();
+
   private:
 
     /**
@@ -189,7 +196,8 @@ namespace REGoth
 
     /**
      * Cached positions for faster access during searches.
-     * Waypoints are supposed to be static, so it's okay to cache these.
+     * Waypoints are supposed to be static, so it's okay to cache these. Saved along with the
+     * waynet, so they don't need to be gathered again after loading.
      */
     bs::Vector<bs::Vector3> mWaypointPositions;
     bs::Vector<bs::Vector3> mFreepointPositions;
@@ -0,0 +1,159 @@
+#include "WorldStreamer.hpp"
+#include <BsZenLib/ImportPath.hpp>
+#include <Components/BsCCamera.h>
+#include <RTTI/RTTI_WorldStreamer.hpp>
+#include <Resources/BsResources.h>
+#include <Scene/BsPrefab.h>
+#include <Scene/BsSceneManager.h>
+#include <Scene/BsSceneObject.h>
+#include <exception/Throw.hpp>
+
+namespace REGoth
+{
+  /**
+   * Default range in which sectors get loaded, measured from the camera to the sectors center.
+   * Must be smaller than DEFAULT_UNLOAD_RANGE_METERS.
+   */
+  constexpr float DEFAULT_LOAD_RANGE_METERS = 150.0f;
+
+  /** See DEFAULT_LOAD_RANGE_METERS */
+  constexpr float DEFAULT_UNLOAD_RANGE_METERS = 200.0f;
+
+  /**
+   * Loading a sector instantiates a whole prefab, which takes a while. To not cause a hitch
+   * when moving quickly, only this many sectors are loaded per frame.
+   */
+  constexpr bs::UINT32 MAX_SECTOR_LOADS_PER_FRAME = 1;
+
+  WorldStreamer::WorldStreamer(const bs::HSceneObject& parent, float sectorSize)
+      : bs::Component(parent)
+      , mSectorSize(sectorSize)
+      , mLoadRange(DEFAULT_LOAD_RANGE_METERS)
+      , mUnloadRange(DEFAULT_UNLOAD_RANGE_METERS)
+  {
+    setName("WorldStreamer");
+  }
+
+  WorldStreamer::~WorldStreamer()
+  {
+  }
+
+  void WorldStreamer::addSector(const bs::Vector3& center, const bs::String& prefabName)
+  {
+    mSectorCenters.push_back(center);
+    mSectorPrefabs.push_back(prefabName);
+  }
+
+  void WorldStreamer::setStreamingRanges(float loadRangeMeters, float unloadRangeMeters)
+  {
+    if (unloadRangeMeters <= loadRangeMeters)
+    {
+      REGOTH_THROW(InvalidParametersException,
+                   "Unload range of the world streamer must be larger than the load range!");
+    }
+
+    mLoadRange   = loadRangeMeters;
+    mUnloadRange = unloadRangeMeters;
+  }
+
+  bs::UINT32 WorldStreamer::numLoadedSectors() const
+  {
+    bs::UINT32 num = 0;
+
+    for (const auto& so : mLoadedSectors)
+    {
+      if (so) num += 1;
+    }
+
+    return num;
+  }
+
+  void WorldStreamer::update()
+  {
+    const auto& mainCamera = bs::gSceneManager().getMainCamera();
+
+    if (!mainCamera) return;
+
+    // Sectors are distributed on the XZ-plane only
+    bs::Vector3 cameraPosition = mainCamera->getTransform().pos();
+    cameraPosition.y           = 0.0f;
+
+    mLoadedSectors.resize(mSectorCenters.size());
+    mHasSectorFailedToLoad.resize(mSectorCenters.size(), false);
+
+    float loadRangeSq   = mLoadRange * mLoadRange;
+    float unloadRangeSq = mUnloadRange * mUnloadRange;
+
+    bs::UINT32 numLoadedThisFrame = 0;
+
+    for (bs::UINT32 i = 0; i < (bs::UINT32)mSectorCenters.size(); i++)
+    {
+      bs::Vector3 center = mSectorCenters[i];
+      center.y           = 0.0f;
+
+      float distanceSq = center.squaredDistance(cameraPosition);
+      bool isLoaded    = !mLoadedSectors[i].isDestroyed();
+
+      if (mHasSectorFailedToLoad[i]) continue;
+
+      if (isLoaded)
+      {
+        if (distanceSq > unloadRangeSq)
+        {
+          unloadSector(i);
+        }
+      }
+      else
+      {
+        if (distanceSq < loadRangeSq && numLoadedThisFrame < MAX_SECTOR_LOADS_PER_FRAME)
+        {
+          loadSector(i);
+          numLoadedThisFrame += 1;
+        }
+      }
+    }
+  }
+
+  void WorldStreamer::loadSector(bs::UINT32 sector)
+  {
+    bs::Path path      = BsZenLib::GothicPathToCachedWorld(mSectorPrefabs[sector]);
+    bs::HPrefab prefab = bs::gResources().load<bs::Prefab>(path);
+
+    if (!prefab)
+    {
+      bs::gDebug().logWarning("[WorldStreamer] Failed to load sector: " + mSectorPrefabs[sector]);
+
+      // Don't try again on every frame
+      mHasSectorFailedToLoad[sector] = true;
+      return;
+    }
+
+    // Loaded sectors are not saved with the world, they are always restored from the prefabs.
+    bs::HSceneObject sectorSO = bs::SceneObject::create(mSectorPrefabs[sector], bs::SOF_DontSave);
+    sectorSO->setParent(SO());
+
+    bs::HSceneObject contents = prefab->instantiate();
+    contents->setParent(sectorSO);
+
+    mLoadedSectors[sector] = sectorSO;
+  }
+
+  void WorldStreamer::unloadSector(bs::UINT32 sector)
+  {
+    if (mLoadedSectors[sector].isDestroyed()) return;
+
+    // Once the last handle to the sectors resources is gone, bs:f will unload them as well
+    mLoadedSectors[sector]->destroy();
+    mLoadedSectors[sector] = {};
+  }
+
+  void WorldStreamer::unloadAllSectors()
+  {
+    for (bs::UINT32 i = 0; i < (bs::UINT32)mLoadedSectors.size(); i++)
+    {
+      unloadSector(i);
+    }
+  }
+
+  REGOTH_DEFINE_RTTI(WorldStreamer)
+}  // namespace REGoth
@@ -0,0 +1,137 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <RTTI/RTTIUtil.hpp>
+#include <Scene/BsComponent.h>
+
+namespace REGoth
+{
+  /**
+   * Streams static parts of the world in and out depending on the distance to the main camera.
+   *
+   * When a world is imported with vob streaming enabled, the static vobs are not kept inside
+   * the scene. Instead, they are bucketed into a grid of square sectors on the XZ-plane and
+   * each sector is saved as its own prefab. This component then loads the sectors around the
+   * main camera and unloads those which are far away, so memory usage and scene size stay
+   * bounded no matter how large the world is.
+   *
+   * Like the physics activation of characters, loading and unloading uses two different
+   * ranges, so a sector at the edge of the load range does not get loaded and unloaded
+   * over and over again:
+   *
+   *  - Sectors closer than the *load range* get loaded,
+   *  - Sectors further away than the *unload range* get unloaded,
+   *  - Sectors in between keep their current state.
+   *
+   * Only vobs which are never referenced by scripts or the waynet are streamed. Items,
+   * freepoints and the like stay inside the scene all the time.
+   *
+   * The loaded sectors are never saved along with the world, as they are always loaded from
+   * the prefabs created during import.
+   */
+  class WorldStreamer : public bs::Component
+  {
+  public:
+    /**
+     * @param  sectorSize  Edge length of a single sector in meters.
+     */
+    WorldStreamer(const bs::HSceneObject& parent, float sectorSize);
+    virtual ~WorldStreamer();
+
+    /**
+     * Registers a sector which can be streamed in.
+     *
+     * @param  center      Center of the sector in world space.
+     * @param  prefabName  Name of the prefab holding the sectors objects, as passed to
+     *                     BsZenLib::GothicPathToCachedWorld().
+     */
+    void addSector(const bs::Vector3& center, const bs::String& prefabName);
+
+    /**
+     * Sets the ranges in which sectors are loaded and unloaded, measured from the
+     * main camera to the sectors center on the XZ-plane.
+     *
+     * The unload range must be larger than the load range.
+     */
+    void setStreamingRanges(float loadRangeMeters, float unloadRangeMeters);
+
+    /**
+     * @return Edge length of a single sector in meters.
+     */
+    float sectorSize() const
+    {
+      return mSectorSize;
+    }
+
+    /**
+     * @return Number of sectors currently loaded.
+     */
+    bs::UINT32 numLoadedSectors() const;
+
+    /**
+     * Unloads all sectors currently loaded. They will be loaded again on the next update
+     * if they are close enough to the camera.
+     */
+    void unloadAllSectors();
+
+    /**
+     * Loads and unloads sectors around the main camera.
+     */
+    void update() override;
+
+  private:
+    /**
+     * Instantiates the prefab of the given sector and attaches it to the world.
+     */
+    void loadSector(bs::UINT32 sector);
+
+    /**
+     * Destroys the objects of the given sector.
+     */
+    void unloadSector(bs::UINT32 sector);
+
+    /**
+     * Edge length of a single sector in meters.
+     */
+    float mSectorSize = 0.0f;
+
+    /**
+     * Sectors closer than this to the camera are loaded.
+     */
+    float mLoadRange = 0.0f;
+
+    /**
+     * Sectors further away than this from the camera are unloaded.
+     */
+    float mUnloadRange = 0.0f;
+
+    /**
+     * Centers of all known sectors in world space.
+     */
+    bs::Vector<bs::Vector3> mSectorCenters;
+
+    /**
+     * Prefab name of each sector, same indices as mSectorCenters.
+     */
+    bs::Vector<bs::String> mSectorPrefabs;
+
+    /**
+     * Runtime state: Scene object holding the objects of each loaded sector, same indices
+     * as mSectorCenters. Empty handle for sectors not loaded right now. Not saved.
+     */
+    bs::Vector<bs::HSceneObject> mLoadedSectors;
+
+    /**
+     * Runtime state: Sectors whose prefab could not be loaded, so we don't try again
+     * on every frame. Not saved.
+     */
+    bs::Vector<bool> mHasSectorFailedToLoad;
+
+  public:
+    REGOTH_DECLARE_RTTI(WorldStreamer)
+
+  protected:
+    WorldStreamer() = default;  // For RTTI
+  };
+
+  using HWorldStreamer = bs::GameObjectHandle<WorldStreamer>;
+}  // namespace REGoth
@@ -0,0 +1,86 @@
+#include "HeadlessEngine.hpp"
+#include <BsApplication.h>
+#include <algorithm>
+#include <iostream>
+
+namespace REGoth
+{
+  HeadlessEngine::HeadlessEngine(const bs::String& title, bool isPhysicsEnabled)
+      : mTitle(title)
+      , mIsPhysicsEnabled(isPhysicsEnabled)
+  {
+  }
+
+  void HeadlessEngine::initializeBsf()
+  {
+    using namespace bs;
+
+    START_UP_DESC desc = Application::buildStartUpDesc(VideoMode(1280, 720), mTitle, false);
+
+    // Null-plugins don't need a GPU or audio device
+    desc.renderAPI = "bsfNullRenderAPI";
+    desc.renderer  = "bsfNullRenderer";
+    desc.audio     = "bsfNullAudio";
+
+    if (!mIsPhysicsEnabled)
+    {
+      desc.physics = "bsfNullPhysics";
+    }
+
+    desc.primaryWindowDesc.hidden = true;
+
+    Application::startUp(desc);
+  }
+
+  void HeadlessEngine::setupInput()
+  {
+    // Nobody is there to press buttons
+  }
+
+  void CommandLineOptions::add(const bs::String& prefix, bs::String& target)
+  {
+    mOptions.push_back({prefix, false, [&target](const bs::String& value) { target = value; }});
+  }
+
+  void CommandLineOptions::add(const bs::String& prefix, bs::UINT32& target)
+  {
+    mOptions.push_back(
+        {prefix, false, [&target](const bs::String& value) { target = bs::parseUINT32(value); }});
+  }
+
+  void CommandLineOptions::add(const bs::String& prefix, float& target)
+  {
+    mOptions.push_back(
+        {prefix, false, [&target](const bs::String& value) { target = bs::parseFloat(value); }});
+  }
+
+  void CommandLineOptions::addFlag(const bs::String& name, bool& target)
+  {
+    mOptions.push_back({name, true, [&target](const bs::String&) { target = true; }});
+  }
+
+  bool CommandLineOptions::parse(int argc, char** argv) const
+  {
+    // The first argument is the game directory, which is handled by REGoth::main()
+    for (int i = 2; i < argc; i++)
+    {
+      bs::String arg = argv[i];
+
+      auto matches = [&](const Option& option) {
+        return option.isFlag ? arg == option.name : bs::StringUtil::startsWith(arg, option.name);
+      };
+
+      auto it = std::find_if(mOptions.begin(), mOptions.end(), matches);
+
+      if (it == mOptions.end())
+      {
+        std::cout << "Unknown option: " << arg << std::endl;
+        return false;
+      }
+
+      it->assign(arg.substr(it->name.size()));
+    }
+
+    return true;
+  }
+}  // namespace REGoth
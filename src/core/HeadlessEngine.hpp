@@ -0,0 +1,83 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <REGothEngine.hpp>
+#include <functional>
+
+namespace REGoth
+{
+  /**
+   * Base for tools, tests and benchmarks which run without anything to look at or interact
+   * with: bs:f is started with the null-plugins for rendering and audio and a hidden window,
+   * and no input is set up.
+   *
+   *    class MyBenchmark : public REGoth::HeadlessEngine
+   *    {
+   *    public:
+   *      MyBenchmark() : HeadlessEngine("REGoth My Benchmark") {}
+   *
+   *      void setupScene() override { ... }
+   *      void run() override { ... }
+   *    };
+   */
+  class HeadlessEngine : public REGothEngine
+  {
+  public:
+    /**
+     * @param  title             Title of the hidden window, e.g. `REGoth SaveGame Benchmark`.
+     * @param  isPhysicsEnabled  Whether to use the actual physics plugin. Without it, nothing
+     *                           collides and raycasts never hit.
+     */
+    HeadlessEngine(const bs::String& title, bool isPhysicsEnabled = true);
+
+    void initializeBsf() override;
+
+    void setupInput() override;
+
+  private:
+    bs::String mTitle;
+    bool mIsPhysicsEnabled;
+  };
+
+  /**
+   * Parses the options passed to a tool after the game directory, like `--world=WORLD.ZEN`.
+   * Every option is bound to the variable it is written to:
+   *
+   *    CommandLineOptions options;
+   *    options.add("--world=", config.world);
+   *    options.addFlag("--physics", config.isPhysicsEnabled);
+   *
+   *    if (!options.parse(argc, argv)) return -1;
+   */
+  class CommandLineOptions
+  {
+  public:
+    /**
+     * Adds an option with a value, which follows right after the given prefix.
+     */
+    void add(const bs::String& prefix, bs::String& target);
+    void add(const bs::String& prefix, bs::UINT32& target);
+    void add(const bs::String& prefix, float& target);
+
+    /**
+     * Adds an option without a value, which sets \p target to true if given.
+     */
+    void addFlag(const bs::String& name, bool& target);
+
+    /**
+     * Parses all arguments after the game directory, which is handled by REGoth::main().
+     *
+     * @return False, if there was an unknown option. That has been reported on stdout then.
+     */
+    bool parse(int argc, char** argv) const;
+
+  private:
+    struct Option
+    {
+      bs::String name;
+      bool isFlag = false;
+      std::function<void(const bs::String& value)> assign;
+    };
+
+    bs::Vector<Option> mOptions;
+  };
+}  // namespace REGoth
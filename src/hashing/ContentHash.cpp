@@ -0,0 +1,59 @@
+#include "ContentHash.hpp"
+#include <cstring>
+
+namespace REGoth
+{
+  namespace Hashing
+  {
+    /**
+     * FNV-1a, but working on 8 bytes at once for most of the data, which makes
+     * hashing larger files like ZENs or DATs reasonably fast.
+     */
+    bs::UINT64 contentHash(const void* data, size_t size, bs::UINT64 seed)
+    {
+      constexpr bs::UINT64 PRIME = 0x100000001b3ull;
+
+      const bs::UINT8* bytes = reinterpret_cast<const bs::UINT8*>(data);
+      bs::UINT64 hash        = seed;
+
+      size_t numWords = size / sizeof(bs::UINT64);
+
+      for (size_t i = 0; i < numWords; i++)
+      {
+        bs::UINT64 word;
+        std::memcpy(&word, bytes + i * sizeof(bs::UINT64), sizeof(word));
+
+        hash ^= word;
+        hash *= PRIME;
+        hash ^= hash >> 32;
+      }
+
+      for (size_t i = numWords * sizeof(bs::UINT64); i < size; i++)
+      {
+        hash ^= bytes[i];
+        hash *= PRIME;
+      }
+
+      // Mix in the size so data only differing in trailing zeros is told apart
+      hash ^= (bs::UINT64)size;
+      hash *= PRIME;
+
+      return hash;
+    }
+
+    bs::String toHexString(bs::UINT64 hash)
+    {
+      static const char* digits = "0123456789abcdef";
+
+      bs::String result(16, '0');
+
+      for (int i = 15; i >= 0; i--)
+      {
+        result[i] = digits[hash & 0xF];
+        hash >>= 4;
+      }
+
+      return result;
+    }
+  }  // namespace Hashing
+}  // namespace REGoth
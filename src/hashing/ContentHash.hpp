@@ -0,0 +1,47 @@
+/** \file
+ *
+ * Hashing of raw data, used to detect whether cached data is still up to date
+ * with the original files it was created from.
+ */
+
+#pragma once
+
+#include <BsPrerequisites.h>
+
+namespace REGoth
+{
+  namespace Hashing
+  {
+    /**
+     * Initial value for contentHash(), can be used to start a chain of hashes.
+     */
+    constexpr bs::UINT64 CONTENT_HASH_SEED = 0xcbf29ce484222325ull;
+
+    /**
+     * Computes a 64-bit, non-cryptographic hash of the given data.
+     *
+     * The hash is stable across runs, so it can be stored on disk.
+     *
+     * @param  data  Data to hash.
+     * @param  size  Size of the data in bytes.
+     * @param  seed  Hash to continue from, see CONTENT_HASH_SEED.
+     *
+     * @return Hash of the given data.
+     */
+    bs::UINT64 contentHash(const void* data, size_t size, bs::UINT64 seed = CONTENT_HASH_SEED);
+
+    /**
+     * Convenience overload of contentHash() for byte arrays.
+     */
+    inline bs::UINT64 contentHash(const bs::Vector<bs::UINT8>& data,
+                                  bs::UINT64 seed = CONTENT_HASH_SEED)
+    {
+      return contentHash(data.data(), data.size(), seed);
+    }
+
+    /**
+     * @return The given hash as hex-string of fixed length, e.g. `00a1b2c3d4e5f607`.
+     */
+    bs::String toHexString(bs::UINT64 hash);
+  }  // namespace Hashing
+}  // namespace REGoth
@@ -0,0 +1,258 @@
+#include <Components/BsCCamera.h>
+#include <Physics/BsPhysics.h>
+#include <Scene/BsGameObjectManager.h>
+#include <Scene/BsSceneManager.h>
+#include <Scene/BsSceneObject.h>
+#include <Utility/BsTime.h>
+#include <Utility/BsTimer.h>
+#include <chrono>
+#include <components/AIScheduler.hpp>
+#include <components/Character.hpp>
+#include <components/CharacterEventQueue.hpp>
+#include <components/GameClock.hpp>
+#include <components/GameWorld.hpp>
+#include <core/HeadlessEngine.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+/**
+ * Simulates the daily routines of all characters in a world without rendering anything.
+ *
+ * Instead of running bsf's mainloop, which is bound to the wall clock, the world is ticked
+ * manually with the fixed timestep. Every tick is therefore exactly the same on every run,
+ * regardless of how fast the machine is, and the simulation can run faster than real time.
+ *
+ * Once per ingame hour, the position and active state of every character is written to the
+ * log, as well as how many NPC-ticks per second the simulation achieved.
+ *
+ * Usage:
+ *
+ *     REGothAISimulation <path/to/game> [--world=WORLD.ZEN] [--hours=24] [--speed=100]
+ *                                       [--seed=0] [--physics]
+ *
+ * A speed of 0 runs as fast as possible.
+ *
+ * Without `--physics`, the main camera is placed far away from the world, so all characters
+ * stay in the far tier of the AIScheduler. That tier only follows the daily routines, which does
+ * not need physics or animation (see CharacterAI). No state loop functions run there, so the
+ * states written to the log are only those the routines have started. Pass `--physics` to
+ * place the camera at the hero, so the characters around it run their state loops as well.
+ */
+class REGothAISimulation : public REGoth::HeadlessEngine
+{
+public:
+  struct Config
+  {
+    bs::String world        = "WORLD.ZEN";
+    bs::UINT32 numGameHours = 24;
+    float speedFactor       = 100.0f;  // 0 means as fast as possible
+    bs::UINT32 seed         = 0;
+    bool isPhysicsEnabled   = false;
+  };
+
+  REGothAISimulation(const Config& config)
+      : HeadlessEngine("REGoth AI Simulation", config.isPhysicsEnabled)
+      , mConfig(config)
+  {
+  }
+
+  void setupMainCamera() override
+  {
+    REGoth::REGothEngine::setupMainCamera();
+
+    if (!mConfig.isPhysicsEnabled)
+    {
+      // Far enough away so that no character ever activates its physics
+      mMainCamera->SO()->setPosition(bs::Vector3(0.0f, 100000.0f, 0.0f));
+    }
+  }
+
+  void setupScene() override
+  {
+    using namespace REGoth;
+
+    // Scripts use rand(), fix the seed so every run is the same
+    std::srand(mConfig.seed);
+
+    mWorld = GameWorld::importZEN(mConfig.world);
+
+    HCharacter hero = mWorld->insertCharacter("PC_HERO", "START");
+    hero->useAsHero();
+
+    mWorld->runInitScripts();
+
+    // A time budget would make the outcome depend on the speed of the machine
+    mWorld->aiScheduler()->setScriptTimeBudget(std::numeric_limits<float>::max());
+
+    if (mConfig.isPhysicsEnabled)
+    {
+      // Observe the world from where the hero is, like a player would
+      mMainCamera->SO()->setPosition(hero->SO()->getTransform().pos());
+    }
+  }
+
+  void run() override
+  {
+    float stepSeconds = bs::gTime().getFixedFrameDelta();
+
+    bs::gDebug().logDebug(bs::StringUtil::format(
+        "[AISimulation] Simulating {0} ingame hours of {1} at {2}x speed, physics: {3}",
+        mConfig.numGameHours, mConfig.world, mConfig.speedFactor, mConfig.isPhysicsEnabled));
+
+    if (!mConfig.isPhysicsEnabled)
+    {
+      bs::gDebug().logDebug(
+          "[AISimulation] All characters are in the far tier, so only daily routines run. "
+          "Use --physics to run state loops as well.");
+    }
+
+    bs::Timer timer;
+
+    bs::INT32 lastHour        = currentHourOfGame();
+    bs::UINT32 numHoursPassed = 0;
+
+    logSummary();
+
+    while (numHoursPassed < mConfig.numGameHours)
+    {
+      tick(stepSeconds);
+
+      if (currentHourOfGame() != lastHour)
+      {
+        lastHour = currentHourOfGame();
+        numHoursPassed++;
+
+        logSummary();
+        logThroughput(timer);
+      }
+
+      if (mConfig.speedFactor > 0.0f)
+      {
+        waitForRealTime(timer, stepSeconds);
+      }
+    }
+
+    bs::gDebug().logDebug("[AISimulation] Done!");
+    logThroughput(timer);
+  }
+
+private:
+  /**
+   * Does what bsf's mainloop would do during one fixed update.
+   */
+  void tick(float stepSeconds)
+  {
+    bs::gSceneManager()._fixedUpdate();
+
+    if (mConfig.isPhysicsEnabled)
+    {
+      bs::gPhysics().fixedUpdate(stepSeconds);
+      bs::gSceneManager()._update();
+    }
+
+    bs::GameObjectManager::instance().destroyQueuedObjects();
+
+    mNumTicks++;
+    mNumNPCTicks += mWorld->allCharacters().size();
+
+    const REGoth::AIScheduler::Statistics& stats = mWorld->aiScheduler()->statistics();
+
+    for (bs::UINT32 i = 0; i < REGoth::AIScheduler::NUM_TIERS; i++)
+    {
+      mNumScriptStateUpdates += stats.tiers[i].numUpdated;
+    }
+  }
+
+  /**
+   * Sleeps if the simulation got ahead of the configured speed factor.
+   */
+  void waitForRealTime(bs::Timer& timer, float stepSeconds)
+  {
+    double simulatedSeconds = mNumTicks * (double)stepSeconds / mConfig.speedFactor;
+    double realSeconds      = timer.getMicroseconds() / 1000000.0;
+
+    if (simulatedSeconds > realSeconds)
+    {
+      std::this_thread::sleep_for(std::chrono::duration<double>(simulatedSeconds - realSeconds));
+    }
+  }
+
+  /**
+   * @return Hours passed since the start of the game. Changes whenever an ingame hour passed.
+   */
+  bs::INT32 currentHourOfGame() const
+  {
+    return mWorld->gameclock()->getDay() * 24 + mWorld->gameclock()->getHour();
+  }
+
+  /**
+   * Writes the position and active state of every character to the log.
+   */
+  void logSummary() const
+  {
+    using namespace REGoth;
+
+    HGameClock clock = mWorld->gameclock();
+
+    bs::gDebug().logDebug(bs::StringUtil::format("[AISimulation] Day {0}, {1}:{2}",
+                                                 clock->getDay(), clock->getHour(),
+                                                 clock->getMinute()));
+
+    for (HCharacter character : mWorld->allCharacters())
+    {
+      if (character.isDestroyed()) continue;
+
+      HCharacterEventQueue eventQueue = character->SO()->getComponent<CharacterEventQueue>();
+
+      const bs::Vector3& position = character->SO()->getTransform().pos();
+
+      bs::String state = eventQueue ? eventQueue->getCurrentStateName() : "";
+
+      bs::gDebug().logDebug(bs::StringUtil::format(
+          "[AISimulation]   {0}: ({1}, {2}, {3}) {4}", character->SO()->getName(), position.x,
+          position.y, position.z, state.empty() ? "<no state>" : state));
+    }
+  }
+
+  /**
+   * Writes how many ticks have been simulated per second of real time to the log.
+   */
+  void logThroughput(bs::Timer& timer) const
+  {
+    double realSeconds = timer.getMicroseconds() / 1000000.0;
+
+    if (realSeconds <= 0.0) return;
+
+    bs::gDebug().logDebug(bs::StringUtil::format(
+        "[AISimulation] {0} ticks in {1} s: {2} NPC-ticks/s, {3} script state updates/s",
+        mNumTicks, realSeconds, mNumNPCTicks / realSeconds,
+        mNumScriptStateUpdates / realSeconds));
+  }
+
+  Config mConfig;
+  REGoth::HGameWorld mWorld;
+
+  bs::UINT64 mNumTicks              = 0;
+  bs::UINT64 mNumNPCTicks           = 0;
+  bs::UINT64 mNumScriptStateUpdates = 0;
+};
+
+int main(int argc, char** argv)
+{
+  REGothAISimulation::Config config;
+
+  REGoth::CommandLineOptions options;
+  options.add("--world=", config.world);
+  options.add("--hours=", config.numGameHours);
+  options.add("--speed=", config.speedFactor);
+  options.add("--seed=", config.seed);
+  options.addFlag("--physics", config.isPhysicsEnabled);
+
+  if (!options.parse(argc, argv)) return -1;
+
+  REGothAISimulation regoth(config);
+
+  return REGoth::main(regoth, argc, argv);
+}
@@ -0,0 +1,132 @@
+#include <Utility/BsTimer.h>
+#include <components/Character.hpp>
+#include <components/GameWorld.hpp>
+#include <core/HeadlessEngine.hpp>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <scripting/ScriptVMForGameWorld.hpp>
+
+/**
+ * Measures how many calls per second go through some of the externals scripts call most,
+ * like `Npc_GetDistToWP()` in the loops of script states.
+ *
+ * The arguments are pushed onto the stack like a script would before every call, and the
+ * result is popped afterwards. So the numbers include popping the arguments, calling the
+ * external and pushing its result, but not running any byte-code.
+ *
+ * Usage:
+ *
+ *     REGothExternalBenchmark <path/to/game> [--world=WORLD.ZEN] [--calls=1000000]
+ */
+class REGothExternalBenchmark : public REGoth::HeadlessEngine
+{
+public:
+  struct Config
+  {
+    bs::String world = "WORLD.ZEN";
+    bs::UINT32 calls = 1000000;
+  };
+
+  REGothExternalBenchmark(const Config& config)
+      : HeadlessEngine("REGoth External Benchmark")
+      , mConfig(config)
+  {
+  }
+
+  void setupScene() override
+  {
+    using namespace REGoth;
+
+    std::srand(0);
+
+    mWorld = GameWorld::importZEN(mConfig.world);
+
+    HCharacter hero = mWorld->insertCharacter("PC_HERO", "START");
+    hero->useAsHero();
+  }
+
+  void run() override
+  {
+    using namespace REGoth::Scripting;
+
+    ScriptVMForGameWorld& vm = mWorld->scriptVM();
+    DaedalusStack& stack     = vm.stack();
+
+    SymbolIndex hero = vm.scriptSymbols().findIndexBySymbolName("HERO");
+
+    std::cout << "[ExternalBenchmark] " << mConfig.calls << " calls per external on "
+              << mConfig.world << std::endl;
+
+    measure("Npc_GetDistToWP", [&]() {
+      stack.pushInstance(hero);
+      stack.pushString("START");
+    });
+
+    measure("Hlp_Random", [&]() { stack.pushInt(100); });
+
+    measure("Wld_IsTime", [&]() {
+      stack.pushInt(8);
+      stack.pushInt(0);
+      stack.pushInt(20);
+      stack.pushInt(0);
+    });
+  }
+
+private:
+  /**
+   * Calls the external with the given name the configured number of times and reports how
+   * many calls went through per second. All of those externals return an int.
+   *
+   * @param  pushArguments  Pushes the arguments for a single call.
+   */
+  void measure(const bs::String& external, const std::function<void()>& pushArguments)
+  {
+    using namespace REGoth::Scripting;
+
+    ScriptVMForGameWorld& vm = mWorld->scriptVM();
+    DaedalusStack& stack     = vm.stack();
+
+    bs::String symbolName = external;
+    bs::StringUtil::toUpperCase(symbolName);
+
+    SymbolIndex symbol = vm.scriptSymbols().findIndexBySymbolName(symbolName);
+
+    // Keeps the compiler from throwing the results away
+    bs::INT64 checksum = 0;
+
+    bs::Timer timer;
+
+    for (bs::UINT32 i = 0; i < mConfig.calls; i++)
+    {
+      pushArguments();
+      vm.callExternal(symbol);
+      checksum += stack.popInt();
+    }
+
+    bs::UINT64 microseconds = std::max<bs::UINT64>(timer.getMicroseconds(), 1);
+
+    std::cout << "[ExternalBenchmark] " << external << ": "
+              << mConfig.calls * 1000000.0 / microseconds << " calls/s, "
+              << microseconds * 1000.0 / mConfig.calls << " ns per call (checksum " << checksum
+              << ")" << std::endl;
+  }
+
+  Config mConfig;
+  REGoth::HGameWorld mWorld;
+};
+
+int main(int argc, char** argv)
+{
+  REGothExternalBenchmark::Config config;
+
+  REGoth::CommandLineOptions options;
+  options.add("--world=", config.world);
+  options.add("--calls=", config.calls);
+
+  if (!options.parse(argc, argv)) return -1;
+
+  REGothExternalBenchmark regoth(config);
+
+  return REGoth::main(regoth, argc, argv);
+}
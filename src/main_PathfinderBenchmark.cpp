@@ -0,0 +1,190 @@
+#include <AI/Pathfinder.hpp>
+#include <Scene/BsSceneObject.h>
+#include <Utility/BsTime.h>
+#include <Utility/BsTimer.h>
+#include <components/GameWorld.hpp>
+#include <components/Waynet.hpp>
+#include <components/Waypoint.hpp>
+#include <core/HeadlessEngine.hpp>
+#include <cstdlib>
+#include <exception/Throw.hpp>
+#include <iostream>
+
+/**
+ * Measures how long it takes the Pathfinder to let lots of agents follow routes on the waynet
+ * of an imported world.
+ *
+ * The agents are not characters, they only consist of a Pathfinder and a position. On every
+ * tick, each agent asks its Pathfinder where to go next and moves there at walking speed.
+ * Once an agent arrived, it starts a new route to a random waypoint. Starting routes and
+ * following them are timed separately, since following happens on every tick while starting
+ * a route happens rarely.
+ *
+ * Usage:
+ *
+ *     REGothPathfinderBenchmark <path/to/game> [--world=WORLD.ZEN] [--agents=1000]
+ *                                              [--ticks=600]
+ */
+class REGothPathfinderBenchmark : public REGoth::HeadlessEngine
+{
+public:
+  struct Config
+  {
+    bs::String world     = "WORLD.ZEN";
+    bs::UINT32 numAgents = 1000;
+    bs::UINT32 numTicks  = 600;
+  };
+
+  REGothPathfinderBenchmark(const Config& config)
+      : HeadlessEngine("REGoth Pathfinder Benchmark")
+      , mConfig(config)
+  {
+  }
+
+  void setupScene() override
+  {
+    using namespace REGoth;
+
+    // Same routes on every run
+    std::srand(0);
+
+    mWorld = GameWorld::importZEN(mConfig.world);
+
+    if (mWorld->waynet()->allWaypoints().empty())
+    {
+      REGOTH_THROW(InvalidStateException, "World has no waypoints to walk on!");
+    }
+
+    AI::Pathfinder::UserConfiguration configuration;
+    configuration.height        = 0.5f;
+    configuration.radius        = 0.35f;
+    configuration.stepHeight    = 0.5f;
+    configuration.maxSlopeAngle = bs::Math::PI / 4.0f;
+
+    mAgents.resize(mConfig.numAgents);
+
+    for (Agent& agent : mAgents)
+    {
+      agent.pathfinder = bs::bs_shared_ptr_new<AI::Pathfinder>(mWorld->waynet());
+      agent.pathfinder->setConfiguration(configuration);
+
+      agent.position   = randomWaypointPosition();
+      agent.nextTarget = randomWaypointPosition();
+    }
+  }
+
+  void run() override
+  {
+    using namespace REGoth;
+
+    float stepSeconds = bs::gTime().getFixedFrameDelta();
+
+    bs::UINT64 followMicroseconds = 0;
+    bs::UINT64 routeMicroseconds  = 0;
+    bs::UINT64 numRoutesStarted   = 0;
+
+    bs::Timer timer;
+
+    for (bs::UINT32 tick = 0; tick < mConfig.numTicks; tick++)
+    {
+      timer.reset();
+
+      for (Agent& agent : mAgents)
+      {
+        if (agent.pathfinder->hasActiveRouteBeenCompleted(agent.position))
+        {
+          agent.pathfinder->startNewRouteTo(agent.position, agent.nextTarget);
+          agent.nextTarget = randomWaypointPosition();
+
+          numRoutesStarted++;
+        }
+      }
+
+      routeMicroseconds += timer.getMicroseconds();
+      timer.reset();
+
+      for (Agent& agent : mAgents)
+      {
+        agent.instruction = agent.pathfinder->updateToNextInstructionToTarget(agent.position);
+      }
+
+      followMicroseconds += timer.getMicroseconds();
+
+      for (Agent& agent : mAgents)
+      {
+        moveTowards(agent, agent.instruction.targetPosition, stepSeconds);
+      }
+    }
+
+    double numAgentTicks = (double)mConfig.numTicks * mConfig.numAgents;
+
+    std::cout << "[PathfinderBenchmark] " << mConfig.numAgents << " agents, "
+              << mConfig.numTicks << " ticks on " << mConfig.world << std::endl;
+    std::cout << "[PathfinderBenchmark] Following: " << followMicroseconds / 1000.0 << " ms, "
+              << followMicroseconds * 1000.0 / numAgentTicks << " ns per agent and tick"
+              << std::endl;
+    std::cout << "[PathfinderBenchmark] Starting: " << routeMicroseconds / 1000.0 << " ms for "
+              << numRoutesStarted << " routes" << std::endl;
+  }
+
+private:
+  struct Agent
+  {
+    bs::SPtr<REGoth::AI::Pathfinder> pathfinder;
+    REGoth::AI::Pathfinder::Instruction instruction;
+    bs::Vector3 position;
+
+    // Picked ahead of time, so picking doesn't count into the time for starting routes
+    bs::Vector3 nextTarget;
+  };
+
+  /**
+   * Moves the agent in a straight line, as the Pathfinder expects a character to do.
+   */
+  void moveTowards(Agent& agent, const bs::Vector3& target, float stepSeconds)
+  {
+    constexpr float WALK_SPEED_METERS_PER_SECOND = 3.0f;
+
+    bs::Vector3 toTarget = target - agent.position;
+    float distance       = toTarget.length();
+    float stepDistance   = WALK_SPEED_METERS_PER_SECOND * stepSeconds;
+
+    if (distance <= stepDistance)
+    {
+      agent.position = target;
+    }
+    else
+    {
+      agent.position += toTarget * (stepDistance / distance);
+    }
+  }
+
+  bs::Vector3 randomWaypointPosition() const
+  {
+    const auto& waypoints = mWorld->waynet()->allWaypoints();
+
+    REGoth::HWaypoint waypoint = waypoints[std::rand() % waypoints.size()];
+
+    return waypoint->SO()->getTransform().pos();
+  }
+
+  Config mConfig;
+  REGoth::HGameWorld mWorld;
+  bs::Vector<Agent> mAgents;
+};
+
+int main(int argc, char** argv)
+{
+  REGothPathfinderBenchmark::Config config;
+
+  REGoth::CommandLineOptions options;
+  options.add("--world=", config.world);
+  options.add("--agents=", config.numAgents);
+  options.add("--ticks=", config.numTicks);
+
+  if (!options.parse(argc, argv)) return -1;
+
+  REGothPathfinderBenchmark regoth(config);
+
+  return REGoth::main(regoth, argc, argv);
+}
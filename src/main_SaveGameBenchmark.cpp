@@ -0,0 +1,174 @@
+#include <BsZenLib/ImportPath.hpp>
+#include <FileSystem/BsFileSystem.h>
+#include <Resources/BsResources.h>
+#include <Scene/BsPrefab.h>
+#include <Scene/BsSceneObject.h>
+#include <Utility/BsTimer.h>
+#include <components/Character.hpp>
+#include <components/GameWorld.hpp>
+#include <components/SaveGameWriter.hpp>
+#include <core/HeadlessEngine.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <world/internals/ConstructFromZEN.hpp>
+
+/**
+ * Compares saving and loading a world as a whole via GameWorld::save() against saving only
+ * what changes while playing via GameWorld::saveDelta().
+ *
+ * The world is imported and set up like a new game, then saved and loaded a few times in both
+ * formats. Reported are the average times and the sizes of the saves. The cache of the static
+ * world used by delta saves is created before timing, as that only happens once per ZEN.
+ *
+ * Delta saves are also written via the SaveGameWriter, where only taking the snapshot blocks
+ * the game. That time is reported separately from the time spent writing in the background.
+ * Those saves are compressed, so their size is reported as well.
+ *
+ * Usage:
+ *
+ *     REGothSaveGameBenchmark <path/to/game> [--world=WORLD.ZEN] [--runs=5]
+ */
+class REGothSaveGameBenchmark : public REGoth::HeadlessEngine
+{
+public:
+  struct Config
+  {
+    bs::String world = "WORLD.ZEN";
+    bs::UINT32 runs  = 5;
+  };
+
+  REGothSaveGameBenchmark(const Config& config)
+      : HeadlessEngine("REGoth SaveGame Benchmark")
+      , mConfig(config)
+  {
+  }
+
+  void setupScene() override
+  {
+    using namespace REGoth;
+
+    // Scripts use rand(), fix the seed so every run saves the same world
+    std::srand(0);
+
+    mWorld = GameWorld::importZEN(mConfig.world);
+
+    HCharacter hero = mWorld->insertCharacter("PC_HERO", "START");
+    hero->useAsHero();
+
+    mWorld->runInitScripts();
+  }
+
+  void run() override
+  {
+    using namespace REGoth;
+
+    const bs::String fullSave  = "SaveGameBenchmark-Full-" + mConfig.world;
+    const bs::String deltaSave = "SaveGameBenchmark-Delta-" + mConfig.world;
+    const bs::String asyncSave = "SaveGameBenchmark-Background-" + mConfig.world;
+
+    bs::UINT64 fullSaveMicroseconds   = 0;
+    bs::UINT64 deltaSaveMicroseconds  = 0;
+    bs::UINT64 fullLoadMicroseconds   = 0;
+    bs::UINT64 deltaLoadMicroseconds  = 0;
+    bs::UINT64 snapshotMicroseconds   = 0;
+    bs::UINT64 backgroundMicroseconds = 0;
+
+    bs::Timer timer;
+
+    for (bs::UINT32 run = 0; run < mConfig.runs; run++)
+    {
+      timer.reset();
+      mWorld->save(fullSave);
+      fullSaveMicroseconds += timer.getMicroseconds();
+
+      timer.reset();
+      mWorld->saveDelta(deltaSave);
+      deltaSaveMicroseconds += timer.getMicroseconds();
+
+      HSaveGameWriter writer = mWorld->saveGameWriter();
+      writer->saveAsync(asyncSave);
+      writer->waitUntilDone();
+
+      snapshotMicroseconds += writer->statistics().snapshotMicroseconds;
+      backgroundMicroseconds += writer->statistics().writeMicroseconds;
+    }
+
+    mWorld->SO()->destroy(true);
+
+    // Creates the cache of the static world
+    GameWorld::loadDelta(deltaSave)->SO()->destroy(true);
+
+    for (bs::UINT32 run = 0; run < mConfig.runs; run++)
+    {
+      bs::gResources().unloadAllUnused();
+
+      timer.reset();
+      bs::HSceneObject fullSO = GameWorld::load(fullSave)->instantiate();
+      fullLoadMicroseconds += timer.getMicroseconds();
+
+      fullSO->destroy(true);
+      bs::gResources().unloadAllUnused();
+
+      timer.reset();
+      HGameWorld deltaWorld = GameWorld::loadDelta(deltaSave);
+      deltaLoadMicroseconds += timer.getMicroseconds();
+
+      deltaWorld->SO()->destroy(true);
+    }
+
+    std::cout << "[SaveGameBenchmark] " << mConfig.runs << " runs on " << mConfig.world
+              << std::endl;
+
+    report("Full", fullSave, fullSaveMicroseconds, fullLoadMicroseconds);
+    report("Delta", deltaSave, deltaSaveMicroseconds, deltaLoadMicroseconds);
+
+    std::cout << "[SaveGameBenchmark] Background delta: snapshot "
+              << snapshotMicroseconds / 1000.0 / mConfig.runs << " ms on the game thread, writing "
+              << backgroundMicroseconds / 1000.0 / mConfig.runs << " ms in the background, "
+              << fileSize(BsZenLib::GothicPathToCachedWorld(asyncSave)) / 1024
+              << " KiB compressed" << std::endl;
+
+    bs::String staticWorldCache = REGoth::Internals::staticWorldCacheName(mConfig.world, false);
+    bs::UINT64 staticWorldSize  = fileSize(BsZenLib::GothicPathToCachedWorld(staticWorldCache));
+
+    std::cout << "[SaveGameBenchmark] Static world cache: " << staticWorldSize / 1024
+              << " KiB, shared by all delta saves of the world" << std::endl;
+  }
+
+private:
+  void report(const bs::String& kind, const bs::String& saveName, bs::UINT64 saveMicroseconds,
+              bs::UINT64 loadMicroseconds) const
+  {
+    bs::UINT64 size = fileSize(BsZenLib::GothicPathToCachedWorld(saveName));
+
+    std::cout << "[SaveGameBenchmark] " << kind << ": save "
+              << saveMicroseconds / 1000.0 / mConfig.runs << " ms, load "
+              << loadMicroseconds / 1000.0 / mConfig.runs << " ms, " << size / 1024 << " KiB"
+              << std::endl;
+  }
+
+  static bs::UINT64 fileSize(const bs::Path& path)
+  {
+    if (!bs::FileSystem::exists(path)) return 0;
+
+    return bs::FileSystem::getFileSize(path);
+  }
+
+  Config mConfig;
+  REGoth::HGameWorld mWorld;
+};
+
+int main(int argc, char** argv)
+{
+  REGothSaveGameBenchmark::Config config;
+
+  REGoth::CommandLineOptions options;
+  options.add("--world=", config.world);
+  options.add("--runs=", config.runs);
+
+  if (!options.parse(argc, argv)) return -1;
+
+  REGothSaveGameBenchmark regoth(config);
+
+  return REGoth::main(regoth, argc, argv);
+}
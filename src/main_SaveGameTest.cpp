@@ -0,0 +1,234 @@
+#include <Components/BsCCharacterController.h>
+#include <Scene/BsPrefab.h>
+#include <Scene/BsSceneObject.h>
+#include <Serialization/BsMemorySerializer.h>
+#include <components/Character.hpp>
+#include <components/CharacterAI.hpp>
+#include <components/GameWorld.hpp>
+#include <core/HeadlessEngine.hpp>
+#include <exception/Throw.hpp>
+#include <iostream>
+#include <scripting/ScriptSymbolStorage.hpp>
+#include <scripting/ScriptVMForGameWorld.hpp>
+
+/**
+ * Saves and loads a world in both the full and the delta format and checks whether
+ * what was saved comes back the same.
+ *
+ * Checked are:
+ *
+ *  - A character whose physics were asleep while saving loads without a character controller
+ *    and gets a new one once its physics wake up again.
+ *  - Function pointers (`var func`) keep the function they were assigned.
+ *
+ * Throws on the first check which fails.
+ *
+ * Usage:
+ *
+ *     REGothSaveGameTester <path/to/game> [--world=WORLD.ZEN]
+ */
+class REGothSaveGameTester : public REGoth::HeadlessEngine
+{
+public:
+  struct Config
+  {
+    bs::String world = "WORLD.ZEN";
+  };
+
+  REGothSaveGameTester(const Config& config)
+      : HeadlessEngine("REGoth SaveGame Tester")
+      , mConfig(config)
+  {
+  }
+
+  void setupScene() override
+  {
+    using namespace REGoth;
+
+    mWorld = GameWorld::importZEN(mConfig.world);
+
+    HCharacter hero = mWorld->insertCharacter("PC_HERO", "START");
+    hero->useAsHero();
+
+    // Same as what the CharacterPhysicsLOD does to characters far away
+    HCharacter sleeper = mWorld->insertCharacter("PC_HERO", "START");
+    sleeper->SO()->getComponent<CharacterAI>()->deactivatePhysics();
+
+    assignFunctionPointer();
+  }
+
+  void run() override
+  {
+    using namespace REGoth;
+
+    const bs::String fullSave  = "SaveGameTest-Full-" + mConfig.world;
+    const bs::String deltaSave = "SaveGameTest-Delta-" + mConfig.world;
+
+    mWorld->save(fullSave);
+    mWorld->saveDelta(deltaSave);
+
+    mWorld->SO()->destroy(true);
+
+    bs::HSceneObject fullSO = GameWorld::load(fullSave)->instantiate();
+    checkSleepingCharacter("Full", fullSO->getComponent<GameWorld>());
+    checkFunctionPointer("Full", fullSO->getComponent<GameWorld>());
+    fullSO->destroy(true);
+
+    HGameWorld deltaWorld = GameWorld::loadDelta(deltaSave);
+    checkSleepingCharacter("Delta", deltaWorld);
+    checkFunctionPointer("Delta", deltaWorld);
+    deltaWorld->SO()->destroy(true);
+
+    checkFunctionPointerValues();
+
+    std::cout << "[SaveGameTester] All checks passed" << std::endl;
+  }
+
+private:
+  void checkSleepingCharacter(const bs::String& format, REGoth::HGameWorld world)
+  {
+    using namespace REGoth;
+
+    HCharacterAI sleeper;
+
+    for (HCharacter character : world->allCharacters())
+    {
+      HCharacterAI ai = character->SO()->getComponent<CharacterAI>();
+
+      if (!ai->isPhysicsActive()) sleeper = ai;
+    }
+
+    check(format, !sleeper.isDestroyed(), "Character with physics asleep is still asleep");
+    check(format, !sleeper->SO()->getComponent<bs::CCharacterController>(),
+          "Character with physics asleep has no controller");
+
+    sleeper->activatePhysics();
+
+    check(format, sleeper->isPhysicsActive(), "Physics wake up again");
+    check(format, !!sleeper->SO()->getComponent<bs::CCharacterController>(),
+          "Character gets a new controller when waking up");
+  }
+
+  /**
+   * Points the first `var func` of the scripts to a function it doesn't point to yet, like
+   * `EParOp_AssignFunc` would. Not all scripts have one, see checkFunctionPointerValues().
+   */
+  void assignFunctionPointer()
+  {
+    using namespace REGoth::Scripting;
+
+    ScriptSymbolStorage& symbols = mWorld->scriptVM().scriptSymbols();
+
+    SymbolIndex anyFunction = SYMBOL_INDEX_INVALID;
+
+    for (SymbolIndex i = 0; i < symbols.numSymbols(); i++)
+    {
+      if (symbols.getSymbolType(i) != SymbolType::ScriptFunction) continue;
+
+      const SymbolScriptFunction& function = symbols.getSymbol<SymbolScriptFunction>(i);
+
+      if (function.isClassVar) continue;
+
+      if (function.isKeptAfterLoad)
+      {
+        anyFunction = i;
+      }
+      else if (mFunctionPointer == SYMBOL_INDEX_INVALID)
+      {
+        mFunctionPointer = i;
+      }
+    }
+
+    if (mFunctionPointer == SYMBOL_INDEX_INVALID || anyFunction == SYMBOL_INDEX_INVALID) return;
+
+    SymbolScriptFunction& pointer = symbols.getSymbol<SymbolScriptFunction>(mFunctionPointer);
+
+    pointer.address         = symbols.getSymbol<SymbolScriptFunction>(anyFunction).address;
+    mFunctionPointerAddress = pointer.address;
+  }
+
+  void checkFunctionPointer(const bs::String& format, REGoth::HGameWorld world)
+  {
+    using namespace REGoth::Scripting;
+
+    if (mFunctionPointer == SYMBOL_INDEX_INVALID)
+    {
+      std::cout << "[SaveGameTester] " << format << ": Scripts have no function pointer"
+                << std::endl;
+      return;
+    }
+
+    ScriptSymbolStorage& symbols = world->scriptVM().scriptSymbols();
+
+    check(format,
+          symbols.getSymbol<SymbolScriptFunction>(mFunctionPointer).address ==
+              mFunctionPointerAddress,
+          "Function pointer keeps its function");
+  }
+
+  /**
+   * Serializes the values of a function pointer and applies them to its symbol again. Unlike
+   * checkFunctionPointer(), this works with any scripts.
+   */
+  static void checkFunctionPointerValues()
+  {
+    using namespace REGoth::Scripting;
+
+    ScriptSymbolStorage symbols;
+
+    SymbolIndex index             = symbols.appendSymbol<SymbolScriptFunction>("POINTER");
+    SymbolScriptFunction& pointer = symbols.getSymbol<SymbolScriptFunction>(index);
+
+    pointer.isClassVar      = false;
+    pointer.isKeptAfterLoad = false;
+    pointer.address         = 1234;
+
+    ScriptSymbolValues values = symbols.collectMutableValues();
+
+    bs::MemorySerializer serializer;
+    bs::UINT32 size    = 0;
+    bs::UINT8* encoded = serializer.encode(&values, size);
+
+    auto decodedValues =
+        std::static_pointer_cast<ScriptSymbolValues>(serializer.decode(encoded, size));
+
+    bs::bs_free(encoded);
+
+    pointer.address = 0;
+
+    symbols.applyMutableValues(*decodedValues);
+
+    check("Symbol values", pointer.address == 1234, "Function pointer keeps its function");
+  }
+
+  static void check(const bs::String& format, bool condition, const bs::String& what)
+  {
+    std::cout << "[SaveGameTester] " << format << ": " << what << ": "
+              << (condition ? "OK" : "FAILED") << std::endl;
+
+    if (!condition)
+    {
+      REGOTH_THROW(InvalidStateException, format + " save failed check: " + what);
+    }
+  }
+
+  Config mConfig;
+  REGoth::HGameWorld mWorld;
+
+  REGoth::Scripting::SymbolIndex mFunctionPointer = REGoth::Scripting::SYMBOL_INDEX_INVALID;
+  bs::UINT32 mFunctionPointerAddress              = 0;
+};
+
+int main(int argc, char** argv)
+{
+  REGothSaveGameTester::Config config;
+
+  REGoth::CommandLineOptions options;
+  options.add("--world=", config.world);
+
+  if (!options.parse(argc, argv)) return -1;
+
+  REGothSaveGameTester regoth(config);
+
+  return REGoth::main(regoth, argc, argv);
+}
@@ -0,0 +1,158 @@
+#include <Serialization/BsMemorySerializer.h>
+#include <Utility/BsTimer.h>
+#include <components/GameWorld.hpp>
+#include <core/HeadlessEngine.hpp>
+#include <iostream>
+#include <scripting/ScriptSymbolQueries.hpp>
+#include <scripting/ScriptVMForGameWorld.hpp>
+
+/**
+ * Compares saving and loading all script objects in the compact format of the
+ * ScriptObjectStorage against the previous format, where every object was saved on its own
+ * together with the names of all its members.
+ *
+ * Besides the `C_INFO` objects created by the scripts anyways, one blank object is created per
+ * instance of `C_NPC` and `C_ITEM`, which is roughly what a world full of characters and items
+ * would hold. Reported are the average times and the sizes of both formats.
+ *
+ * Usage:
+ *
+ *     REGothScriptObjectBenchmark <path/to/game> [--runs=20]
+ */
+class REGothScriptObjectBenchmark : public REGoth::HeadlessEngine
+{
+public:
+  struct Config
+  {
+    bs::UINT32 runs = 20;
+  };
+
+  REGothScriptObjectBenchmark(const Config& config)
+      : HeadlessEngine("REGoth ScriptObject Benchmark")
+      , mConfig(config)
+  {
+  }
+
+  void setupScene() override
+  {
+    using namespace REGoth;
+
+    mWorld = GameWorld::createEmpty();
+
+    createBlankInstancesOf("C_NPC");
+    createBlankInstancesOf("C_ITEM");
+  }
+
+  void run() override
+  {
+    using namespace REGoth;
+
+    Scripting::ScriptObjectStorage& storage = mWorld->scriptVM().scriptObjects();
+
+    bs::Vector<Scripting::ScriptObject*> objects;
+    for (Scripting::ScriptObjectHandle h = 1; objects.size() < storage.numObjects(); h++)
+    {
+      if (storage.isValid(h)) objects.push_back(&storage.get(h));
+    }
+
+    bs::UINT64 compactSaveMicroseconds   = 0;
+    bs::UINT64 compactLoadMicroseconds   = 0;
+    bs::UINT64 perObjectSaveMicroseconds = 0;
+    bs::UINT64 perObjectLoadMicroseconds = 0;
+    bs::UINT64 compactSize               = 0;
+    bs::UINT64 perObjectSize             = 0;
+
+    bs::MemorySerializer serializer;
+    bs::Timer timer;
+
+    for (bs::UINT32 run = 0; run < mConfig.runs; run++)
+    {
+      bs::UINT32 size = 0;
+
+      timer.reset();
+      bs::UINT8* data = serializer.encode(&storage, size);
+      compactSaveMicroseconds += timer.getMicroseconds();
+
+      compactSize = size;
+
+      timer.reset();
+      serializer.decode(data, size);
+      compactLoadMicroseconds += timer.getMicroseconds();
+
+      bs::bs_free(data);
+
+      bs::Vector<std::pair<bs::UINT8*, bs::UINT32>> encodedObjects;
+      encodedObjects.reserve(objects.size());
+
+      perObjectSize = 0;
+
+      timer.reset();
+      for (Scripting::ScriptObject* object : objects)
+      {
+        data = serializer.encode(object, size);
+        encodedObjects.emplace_back(data, size);
+      }
+      perObjectSaveMicroseconds += timer.getMicroseconds();
+
+      timer.reset();
+      for (const auto& encoded : encodedObjects)
+      {
+        serializer.decode(encoded.first, encoded.second);
+      }
+      perObjectLoadMicroseconds += timer.getMicroseconds();
+
+      for (const auto& encoded : encodedObjects)
+      {
+        perObjectSize += encoded.second;
+        bs::bs_free(encoded.first);
+      }
+    }
+
+    std::cout << "[ScriptObjectBenchmark] " << mConfig.runs << " runs on " << objects.size()
+              << " script objects" << std::endl;
+
+    report("Compact", compactSaveMicroseconds, compactLoadMicroseconds, compactSize);
+    report("Per object", perObjectSaveMicroseconds, perObjectLoadMicroseconds, perObjectSize);
+  }
+
+private:
+  void createBlankInstancesOf(const bs::String& className)
+  {
+    using namespace REGoth::Scripting;
+
+    ScriptVMForGameWorld& vm = mWorld->scriptVM();
+
+    for (SymbolIndex instance : Queries::findAllInstancesOfClass(vm.scriptSymbols(), className))
+    {
+      ScriptObjectHandle handle = vm.instanciateBlankObjectOfClass(className);
+
+      vm.scriptObjects().get(handle).instanceName = vm.scriptSymbols().getSymbolName(instance);
+    }
+  }
+
+  void report(const bs::String& format, bs::UINT64 saveMicroseconds, bs::UINT64 loadMicroseconds,
+              bs::UINT64 size) const
+  {
+    std::cout << "[ScriptObjectBenchmark] " << format << ": save "
+              << saveMicroseconds / 1000.0 / mConfig.runs << " ms, load "
+              << loadMicroseconds / 1000.0 / mConfig.runs << " ms, " << size / 1024 << " KiB"
+              << std::endl;
+  }
+
+  Config mConfig;
+  REGoth::HGameWorld mWorld;
+};
+
+int main(int argc, char** argv)
+{
+  REGothScriptObjectBenchmark::Config config;
+
+  REGoth::CommandLineOptions options;
+  options.add("--runs=", config.runs);
+
+  if (!options.parse(argc, argv)) return -1;
+
+  REGothScriptObjectBenchmark regoth(config);
+
+  return REGoth::main(regoth, argc, argv);
+}
@@ -17,6 +17,33 @@
 #include <original-content/VirtualFileSystem.hpp>
 #include <components/GameWorld.hpp>
 
+/**
+ * Logs the time passed since the world started loading once the first frame is being updated,
+ * then removes itself.
+ */
+class LoadTimeReporter : public bs::Component
+{
+public:
+  LoadTimeReporter(const bs::HSceneObject& parent, const bs::Timer& sinceLoadStarted)
+      : bs::Component(parent)
+      , mSinceLoadStarted(sinceLoadStarted)
+  {
+    setName("LoadTimeReporter");
+  }
+
+  void update() override
+  {
+    bs::gDebug().logDebug(
+        bs::StringUtil::format("[REGothWorldCacheTest] First frame {0} ms after loading started",
+                               mSinceLoadStarted.getMicroseconds() / 1000.0f));
+
+    destroy();
+  }
+
+private:
+  bs::Timer mSinceLoadStarted;
+};
+
 class REGothWorldCacheTest : public REGoth::REGothEngine
 {
 public:
@@ -48,8 +75,16 @@ public:
     {
       bs::gDebug().logDebug("[REGothWorldCacheTest] Loading world from SaveGame: " + world);
 
+      bs::Timer timer;
+
       bs::HPrefab world = GameWorld::load(saveGame);
       world->instantiate();
+
+      bs::gDebug().logDebug(bs::StringUtil::format(
+          "[REGothWorldCacheTest] Loaded and instantiated in {0} ms",
+          timer.getMicroseconds() / 1000.0f));
+
+      mMainCamera->SO()->addComponent<LoadTimeReporter>(timer);
     }
   }
 };
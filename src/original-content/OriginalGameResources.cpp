@@ -9,69 +9,122 @@
 
 namespace REGoth
 {
-  bs::HTexture OriginalGameResources::texture(const bs::String& originalFileName)
+  template <typename T, typename LoadFn>
+  T OriginalGameResources::lookupOrLoad(bs::UnorderedMap<bs::String, T>& cache,
+                                        const bs::String& originalFileName, LoadFn load)
   {
-    if (BsZenLib::HasCachedTexture(originalFileName))
+    bs::String key = originalFileName;
+    bs::StringUtil::toUpperCase(key);
+
     {
-      return BsZenLib::LoadCachedTexture(originalFileName);
+      bs::Lock lock(mCacheMutex);
+
+      auto it = cache.find(key);
+
+      if (it != cache.end())
+      {
+        mNumCacheHits += 1;
+        return it->second;
+      }
+
+      mNumCacheMisses += 1;
     }
-    else
+
+    // Loading is done without holding the lock so multiple resources can be loaded in parallel
+    T resource = load();
+
+    // Don't cache failed loads, the resource might become available later
+    if (resource)
     {
-      return BsZenLib::ImportAndCacheTexture(originalFileName, gVirtualFileSystem().getFileIndex());
+      bs::Lock lock(mCacheMutex);
+      cache[key] = resource;
     }
+
+    return resource;
+  }
+
+  bs::HTexture OriginalGameResources::texture(const bs::String& originalFileName)
+  {
+    return lookupOrLoad(mCachedTextures, originalFileName, [&]() -> bs::HTexture {
+      if (BsZenLib::HasCachedTexture(originalFileName))
+      {
+        return BsZenLib::LoadCachedTexture(originalFileName);
+      }
+      else
+      {
+        bs::Lock lock(mImportMutex);
+        return BsZenLib::ImportAndCacheTexture(originalFileName,
+                                               gVirtualFileSystem().getFileIndex());
+      }
+    });
   }
 
   BsZenLib::Res::HModelScriptFile OriginalGameResources::modelScript(
       const bs::String& originalFileName)
   {
-    if (BsZenLib::HasCachedMDS(originalFileName))
-    {
-      return BsZenLib::LoadCachedMDS(originalFileName);
-    }
-    else
-    {
-      return BsZenLib::ImportAndCacheMDS(originalFileName, gVirtualFileSystem().getFileIndex());
-    }
+    return lookupOrLoad(
+        mCachedModelScripts, originalFileName, [&]() -> BsZenLib::Res::HModelScriptFile {
+      if (BsZenLib::HasCachedMDS(originalFileName))
+      {
+        return BsZenLib::LoadCachedMDS(originalFileName);
+      }
+      else
+      {
+        bs::Lock lock(mImportMutex);
+        return BsZenLib::ImportAndCacheMDS(originalFileName, gVirtualFileSystem().getFileIndex());
+      }
+    });
   }
 
   BsZenLib::Res::HMeshWithMaterials OriginalGameResources::staticMesh(
       const bs::String& originalFileName)
   {
-    if (BsZenLib::HasCachedStaticMesh(originalFileName))
-    {
-      return BsZenLib::LoadCachedStaticMesh(originalFileName);
-    }
-    else
-    {
-      return BsZenLib::ImportAndCacheStaticMesh(originalFileName,
-                                                gVirtualFileSystem().getFileIndex());
-    }
+    return lookupOrLoad(
+        mCachedStaticMeshes, originalFileName, [&]() -> BsZenLib::Res::HMeshWithMaterials {
+      if (BsZenLib::HasCachedStaticMesh(originalFileName))
+      {
+        return BsZenLib::LoadCachedStaticMesh(originalFileName);
+      }
+      else
+      {
+        bs::Lock lock(mImportMutex);
+        return BsZenLib::ImportAndCacheStaticMesh(originalFileName,
+                                                  gVirtualFileSystem().getFileIndex());
+      }
+    });
   }
 
   BsZenLib::Res::HMeshWithMaterials OriginalGameResources::morphMesh(
       const bs::String& originalFileName)
   {
-    if (BsZenLib::HasCachedMorphMesh(originalFileName))
-    {
-      return BsZenLib::LoadCachedMorphMesh(originalFileName);
-    }
-    else
-    {
-      return BsZenLib::ImportAndCacheMorphMesh(originalFileName,
-                                               gVirtualFileSystem().getFileIndex());
-    }
+    return lookupOrLoad(
+        mCachedMorphMeshes, originalFileName, [&]() -> BsZenLib::Res::HMeshWithMaterials {
+      if (BsZenLib::HasCachedMorphMesh(originalFileName))
+      {
+        return BsZenLib::LoadCachedMorphMesh(originalFileName);
+      }
+      else
+      {
+        bs::Lock lock(mImportMutex);
+        return BsZenLib::ImportAndCacheMorphMesh(originalFileName,
+                                                 gVirtualFileSystem().getFileIndex());
+      }
+    });
   }
 
   bs::HFont OriginalGameResources::font(const bs::String& originalFileName)
   {
-    if (BsZenLib::HasCachedFont(originalFileName))
-    {
-      return BsZenLib::LoadCachedFont(originalFileName);
-    }
-    else
-    {
-      return BsZenLib::ImportAndCacheFont(originalFileName, gVirtualFileSystem().getFileIndex());
-    }
+    return lookupOrLoad(mCachedFonts, originalFileName, [&]() -> bs::HFont {
+      if (BsZenLib::HasCachedFont(originalFileName))
+      {
+        return BsZenLib::LoadCachedFont(originalFileName);
+      }
+      else
+      {
+        bs::Lock lock(mImportMutex);
+        return BsZenLib::ImportAndCacheFont(originalFileName, gVirtualFileSystem().getFileIndex());
+      }
+    });
   }
 
   bs::HSpriteTexture OriginalGameResources::sprite(const bs::String& originalFileName)
@@ -88,6 +141,50 @@ namespace REGoth
     return bs::SpriteTexture::create(t);
   }
 
+  void OriginalGameResources::evictCachedResources()
+  {
+    bs::Lock lock(mCacheMutex);
+
+    mCachedTextures.clear();
+    mCachedModelScripts.clear();
+    mCachedStaticMeshes.clear();
+    mCachedMorphMeshes.clear();
+    mCachedFonts.clear();
+  }
+
+  OriginalGameResources::CacheStatistics OriginalGameResources::cacheStatistics() const
+  {
+    bs::Lock lock(mCacheMutex);
+
+    CacheStatistics stats;
+
+    stats.numHits   = mNumCacheHits;
+    stats.numMisses = mNumCacheMisses;
+
+    stats.numCachedResources = (bs::UINT32)(mCachedTextures.size() + mCachedModelScripts.size() +
+                                            mCachedStaticMeshes.size() +
+                                            mCachedMorphMeshes.size() + mCachedFonts.size());
+
+    return stats;
+  }
+
+  void OriginalGameResources::resetCacheStatistics()
+  {
+    bs::Lock lock(mCacheMutex);
+
+    mNumCacheHits   = 0;
+    mNumCacheMisses = 0;
+  }
+
+  void OriginalGameResources::logCacheStatistics() const
+  {
+    CacheStatistics stats = cacheStatistics();
+
+    bs::gDebug().logDebug(bs::StringUtil::format(
+        "[OriginalGameResources] Cache: {0} hits, {1} misses, {2} resources held", stats.numHits,
+        stats.numMisses, stats.numCachedResources));
+  }
+
   OriginalGameResources& gOriginalGameResources()
   {
     static OriginalGameResources s_instance;
@@ -29,10 +29,41 @@ namespace REGoth
    * To make loading more efficient, a check whether the resource to load has been
    * cached is done. If it was not, the resource is imported into the cache so it
    * can be loaded quicker next time.
+   *
+   * On top of the on-disk cache, every loaded resource is also kept in an in-memory
+   * cache keyed by its (uppercased) original file name. Requesting the same resource
+   * twice will then hand out the handle loaded the first time without touching the
+   * disk cache again. Since hundreds of vobs share the same few meshes, this saves a lot
+   * of time when importing worlds. Use evictCachedResources() to drop those handles,
+   * e.g. when switching worlds.
+   *
+   * Resources may be requested from multiple threads at once, e.g. while importing a
+   * world. Importing resources which have not been cached on disk yet is serialized
+   * though, since that modifies the resource manifest.
    */
   class OriginalGameResources
   {
   public:
+    /**
+     * Counters of the in-memory resource cache, see cacheStatistics().
+     */
+    struct CacheStatistics
+    {
+      /**
+       * Number of requests which could be served from the in-memory cache.
+       */
+      bs::UINT32 numHits = 0;
+
+      /**
+       * Number of requests which had to go to the disk cache or the original files.
+       */
+      bs::UINT32 numMisses = 0;
+
+      /**
+       * Number of handles currently held by the in-memory cache.
+       */
+      bs::UINT32 numCachedResources = 0;
+    };
 
     /**
      * Loads a texture from the original game files.
@@ -102,6 +133,60 @@ namespace REGoth
      * @return Sprite with the given texture. Empty handle if loading failed.
      */
     bs::HSpriteTexture sprite(const bs::String& originalFileName);
+
+    /**
+     * Drops all resource handles held by the in-memory cache.
+     *
+     * Resources still referenced from elsewhere stay loaded, but the next request for
+     * them will go through the disk cache again. Should be called when switching worlds
+     * so resources only used by the old world can be unloaded.
+     *
+     * The hit/miss counters are not reset, see resetCacheStatistics().
+     */
+    void evictCachedResources();
+
+    /**
+     * @return Current counters of the in-memory resource cache.
+     */
+    CacheStatistics cacheStatistics() const;
+
+    /**
+     * Resets the hit/miss counters of the in-memory resource cache.
+     */
+    void resetCacheStatistics();
+
+    /**
+     * Writes the current counters of the in-memory resource cache to the debug log.
+     */
+    void logCacheStatistics() const;
+
+  private:
+    /**
+     * Looks up the given resource inside the given in-memory cache. If it is not in
+     * there, it is loaded via `load` and added to the cache if loading succeeded.
+     */
+    template <typename T, typename LoadFn>
+    T lookupOrLoad(bs::UnorderedMap<bs::String, T>& cache, const bs::String& originalFileName,
+                   LoadFn load);
+
+    bs::UnorderedMap<bs::String, bs::HTexture> mCachedTextures;
+    bs::UnorderedMap<bs::String, BsZenLib::Res::HModelScriptFile> mCachedModelScripts;
+    bs::UnorderedMap<bs::String, BsZenLib::Res::HMeshWithMaterials> mCachedStaticMeshes;
+    bs::UnorderedMap<bs::String, BsZenLib::Res::HMeshWithMaterials> mCachedMorphMeshes;
+    bs::UnorderedMap<bs::String, bs::HFont> mCachedFonts;
+
+    bs::UINT32 mNumCacheHits   = 0;
+    bs::UINT32 mNumCacheMisses = 0;
+
+    /**
+     * Guards the in-memory caches and counters.
+     */
+    mutable bs::Mutex mCacheMutex;
+
+    /**
+     * Only one thread may import resources into the disk cache at a time.
+     */
+    bs::Mutex mImportMutex;
   };
 
   /**
@@ -0,0 +1,84 @@
+#pragma once
+#include "ScriptTypes.hpp"
+#include <BsPrerequisites.h>
+
+namespace REGoth
+{
+  namespace Scripting
+  {
+    /**
+     * Position of an *Information*-instance among all of them, see
+     * DaedalusVMForGameWorld::infoOrdinal().
+     */
+    enum : bs::UINT32
+    {
+      INFO_ORDINAL_INVALID = UINT32_MAX
+    };
+
+    /**
+     * Native version of the `C_INFO` script class for efficiency.
+     *
+     * These are read once from the script objects of all *Information*-instances, see
+     * DaedalusVMForGameWorld::dialogueInfosOfNpc().
+     */
+    struct DialogueInfo
+    {
+      /**
+       * Instance name of this info
+       */
+      bs::String name;
+
+      /**
+       * Symbol of the *Information*-instance, e.g. `INFO_THORUS_WORKFORGOMEZ`.
+       */
+      SymbolIndex instance = SYMBOL_INDEX_INVALID;
+
+      /**
+       * Position of this info among all *Information*-instances. Used to look up whether a
+       * character knows it, see StoryInformation.
+       */
+      bs::UINT32 ordinal = INFO_ORDINAL_INVALID;
+
+      /**
+       * Called `nr` in the original script files. This defines the order the dialogue lines
+       * should be displayed in the UI. However, sometimes those numbers are not unique, some are
+       * missing, so `priority` is the better name here. Low numbers mean higher priority.
+       */
+      bs::UINT32 priority;
+
+      /**
+       * Script function to execute to check whether this information should be avaialble to the
+       * user in the UI. If this returns 0, it should not be shown.
+       */
+      SymbolIndex conditionFunction;
+
+      /**
+       * Script function to execute once the user has chosen this dialogue line. This usually
+       * does the back-and-forth conversation.
+       */
+      SymbolIndex informationFunction;
+
+      /**
+       * Whether this information should disapper once you talked about it once.
+       */
+      bool isPermanent;
+
+      /**
+       * If true, the NPC should start talking to the hero as soon as the hero comes into range.
+       * This is often used for guards who are supposed to stop the player from entering
+       * certain locations.
+       */
+      bool isImportant;
+
+      /**
+       * If true, this information will open the trade window.
+       */
+      bool isTrade;
+
+      /**
+       * The text to display to the user in the UI. Called `description` inside scripts.
+       */
+      bs::String choiceText;
+    };
+  }  // namespace Scripting
+}  // namespace REGoth
@@ -5,6 +5,109 @@ namespace REGoth
 {
   namespace Scripting
   {
+    /**
+     * Puts every distinct string into the string table once and hands out its index.
+     */
+    class StringTableBuilder
+    {
+    public:
+      StringTableBuilder(bs::Vector<bs::String>& table)
+          : mTable(table)
+      {
+      }
+
+      bs::UINT32 indexOf(const bs::String& string)
+      {
+        auto it = mIndices.find(string);
+
+        if (it != mIndices.end()) return it->second;
+
+        bs::UINT32 index = (bs::UINT32)mTable.size();
+
+        mTable.push_back(string);
+        mIndices.emplace(string, index);
+
+        return index;
+      }
+
+    private:
+      bs::Vector<bs::String>& mTable;
+      bs::UnorderedMap<bs::String, bs::UINT32> mIndices;
+    };
+
+    /**
+     * Where the members of a layout start inside EncodedScriptObjects::layouts.
+     */
+    struct DecodedLayout
+    {
+      bs::UINT32 className;
+      bs::UINT32 numInts;
+      bs::UINT32 numFloats;
+      bs::UINT32 numStrings;
+      bs::UINT32 numFunctionPointers;
+      size_t membersStart;
+    };
+
+    static void throwMalformed()
+    {
+      REGOTH_THROW(InvalidStateException, "Malformed script objects inside savegame!");
+    }
+
+    static const bs::String& stringAt(const EncodedScriptObjects& encoded, bs::UINT32 index)
+    {
+      if (index >= encoded.stringTable.size()) throwMalformed();
+
+      return encoded.stringTable[index];
+    }
+
+    /**
+     * Adds the name and array size of every member to the layout.
+     */
+    template <typename V>
+    static void appendMemberLayout(const bs::Map<bs::String, V>& members,
+                                   StringTableBuilder& strings, bs::Vector<bs::UINT32>& layout)
+    {
+      for (const auto& member : members)
+      {
+        layout.push_back(strings.indexOf(member.first));
+        layout.push_back((bs::UINT32)member.second.size());
+      }
+    }
+
+    /**
+     * Reads the members of one kind described by the layout at \p layout, taking their values
+     * from \p values starting at \p valueCursor. \p convert turns a single stored value into
+     * the one stored inside the object.
+     */
+    template <typename V, typename E, typename Convert>
+    static void decodeMembers(const bs::UINT32*& layout, bs::UINT32 numMembers,
+                              const EncodedScriptObjects& encoded, const bs::Vector<E>& values,
+                              size_t& valueCursor, bs::Map<bs::String, V>& members,
+                              Convert convert)
+    {
+      for (bs::UINT32 i = 0; i < numMembers; i++)
+      {
+        const bs::String& name = stringAt(encoded, layout[0]);
+        bs::UINT32 arraySize   = layout[1];
+        layout += 2;
+
+        if (valueCursor + arraySize > values.size()) throwMalformed();
+
+        V array;
+        array.reserve(arraySize);
+
+        for (bs::UINT32 j = 0; j < arraySize; j++)
+        {
+          array.push_back(convert(values[valueCursor + j]));
+        }
+
+        valueCursor += arraySize;
+
+        // Members were encoded in the order of the map, so they can always go to the end
+        members.emplace_hint(members.end(), name, std::move(array));
+      }
+    }
+
     ScriptObjectStorage::~ScriptObjectStorage()
     {
     }
@@ -56,7 +159,7 @@ namespace REGoth
         REGOTH_THROW(InvalidStateException, "Script Object Handle is invalid!");
       }
 
-      ScriptObject* pCached = findHandleInCache(handle);
+      ScriptObject* pCached = mIsAccessCacheEnabled ? findHandleInCache(handle) : nullptr;
 
       if (pCached)
       {
@@ -71,12 +174,25 @@ namespace REGoth
           REGOTH_THROW(InvalidStateException, "Script Object Handle does reference a known object!");
         }
 
-        addObjectToCache(handle, it->second);
+        if (mIsAccessCacheEnabled)
+        {
+          addObjectToCache(handle, it->second);
+        }
 
         return it->second;
       }
     }
 
+    void ScriptObjectStorage::setAccessCacheEnabled(bool enabled)
+    {
+      mIsAccessCacheEnabled = enabled;
+
+      if (!enabled)
+      {
+        invalidateCache();
+      }
+    }
+
     void ScriptObjectStorage::clear()
     {
       mObjects.clear();
@@ -121,6 +237,162 @@ namespace REGoth
       mCachePosition = 0;
     }
 
+    EncodedScriptObjects ScriptObjectStorage::encodeObjects() const
+    {
+      EncodedScriptObjects encoded;
+      StringTableBuilder strings(encoded.stringTable);
+
+      bs::Map<bs::Vector<bs::UINT32>, bs::UINT32> layoutIndices;
+      bs::Vector<bs::UINT32> layout;
+
+      encoded.handles.reserve(mObjects.size());
+      encoded.objectLayouts.reserve(mObjects.size());
+      encoded.instanceNames.reserve(mObjects.size());
+
+      for (const auto& entry : mObjects)
+      {
+        const ScriptObject& object = entry.second;
+
+        layout.clear();
+        layout.push_back(strings.indexOf(object.className));
+        layout.push_back((bs::UINT32)object.ints.size());
+        layout.push_back((bs::UINT32)object.floats.size());
+        layout.push_back((bs::UINT32)object.strings.size());
+        layout.push_back((bs::UINT32)object.functionPointers.size());
+
+        appendMemberLayout(object.ints, strings, layout);
+        appendMemberLayout(object.floats, strings, layout);
+        appendMemberLayout(object.strings, strings, layout);
+
+        for (const auto& member : object.functionPointers)
+        {
+          layout.push_back(strings.indexOf(member.first));
+        }
+
+        auto it = layoutIndices.find(layout);
+
+        if (it == layoutIndices.end())
+        {
+          it = layoutIndices.emplace(layout, (bs::UINT32)layoutIndices.size()).first;
+
+          encoded.layouts.insert(encoded.layouts.end(), layout.begin(), layout.end());
+        }
+
+        encoded.handles.push_back(object.handle);
+        encoded.objectLayouts.push_back(it->second);
+        encoded.instanceNames.push_back(strings.indexOf(object.instanceName));
+
+        for (const auto& member : object.ints)
+        {
+          encoded.ints.insert(encoded.ints.end(), member.second.begin(), member.second.end());
+        }
+
+        for (const auto& member : object.floats)
+        {
+          encoded.floats.insert(encoded.floats.end(), member.second.begin(), member.second.end());
+        }
+
+        for (const auto& member : object.strings)
+        {
+          for (const bs::String& value : member.second)
+          {
+            encoded.strings.push_back(strings.indexOf(value));
+          }
+        }
+
+        for (const auto& member : object.functionPointers)
+        {
+          encoded.functionPointers.push_back(member.second);
+        }
+      }
+
+      return encoded;
+    }
+
+    void ScriptObjectStorage::decodeObjects(const EncodedScriptObjects& encoded)
+    {
+      constexpr bs::UINT32 LAYOUT_HEADER_SIZE = 5;
+
+      bs::Vector<DecodedLayout> layouts;
+
+      for (size_t cursor = 0; cursor < encoded.layouts.size();)
+      {
+        if (cursor + LAYOUT_HEADER_SIZE > encoded.layouts.size()) throwMalformed();
+
+        DecodedLayout layout;
+        layout.className           = encoded.layouts[cursor + 0];
+        layout.numInts             = encoded.layouts[cursor + 1];
+        layout.numFloats           = encoded.layouts[cursor + 2];
+        layout.numStrings          = encoded.layouts[cursor + 3];
+        layout.numFunctionPointers = encoded.layouts[cursor + 4];
+        layout.membersStart        = cursor + LAYOUT_HEADER_SIZE;
+
+        cursor = layout.membersStart +
+                 2 * (size_t)(layout.numInts + layout.numFloats + layout.numStrings) +
+                 layout.numFunctionPointers;
+
+        if (cursor > encoded.layouts.size()) throwMalformed();
+
+        layouts.push_back(layout);
+      }
+
+      size_t numObjects = encoded.handles.size();
+
+      if (encoded.objectLayouts.size() != numObjects || encoded.instanceNames.size() != numObjects)
+      {
+        throwMalformed();
+      }
+
+      auto keepInt      = [](bs::INT32 value) { return value; };
+      auto keepFloat    = [](float value) { return value; };
+      auto lookUpString = [&](bs::UINT32 index) { return stringAt(encoded, index); };
+
+      size_t intCursor             = 0;
+      size_t floatCursor           = 0;
+      size_t stringCursor          = 0;
+      size_t functionPointerCursor = 0;
+
+      mObjects.clear();
+
+      for (size_t i = 0; i < numObjects; i++)
+      {
+        if (encoded.objectLayouts[i] >= layouts.size()) throwMalformed();
+
+        const DecodedLayout& layout = layouts[encoded.objectLayouts[i]];
+        const bs::UINT32* members   = encoded.layouts.data() + layout.membersStart;
+
+        ScriptObject object;
+        object.handle       = encoded.handles[i];
+        object.className    = stringAt(encoded, layout.className);
+        object.instanceName = stringAt(encoded, encoded.instanceNames[i]);
+
+        decodeMembers(members, layout.numInts, encoded, encoded.ints, intCursor, object.ints,
+                      keepInt);
+        decodeMembers(members, layout.numFloats, encoded, encoded.floats, floatCursor,
+                      object.floats, keepFloat);
+        decodeMembers(members, layout.numStrings, encoded, encoded.strings, stringCursor,
+                      object.strings, lookUpString);
+
+        if (functionPointerCursor + layout.numFunctionPointers > encoded.functionPointers.size())
+        {
+          throwMalformed();
+        }
+
+        for (bs::UINT32 j = 0; j < layout.numFunctionPointers; j++)
+        {
+          object.functionPointers.emplace_hint(object.functionPointers.end(),
+                                               stringAt(encoded, members[j]),
+                                               encoded.functionPointers[functionPointerCursor++]);
+        }
+
+        // Handles were encoded in the order of the map as well
+        mObjects.emplace_hint(mObjects.end(), object.handle, std::move(object));
+      }
+
+      invalidateCache();
+    }
+
+    REGOTH_DEFINE_RTTI(EncodedScriptObjects)
     REGOTH_DEFINE_RTTI(ScriptObjectStorage)
 
   }  // namespace Scripting
@@ -6,6 +6,46 @@ namespace REGoth
 {
   namespace Scripting
   {
+    /**
+     * Compact form of all objects inside a ScriptObjectStorage, as written into a savegame.
+     *
+     * Objects of the same class share the same members, so the names and array sizes of the
+     * members, called the *layout*, are only stored once for all of them. Per object, only
+     * the layout and the raw values are stored. All strings, including the names, are stored
+     * once inside the string table and referred to by their index.
+     *
+     * See ScriptObjectStorage::encodeObjects() and ScriptObjectStorage::decodeObjects().
+     */
+    struct EncodedScriptObjects : public bs::IReflectable
+    {
+      bs::Vector<bs::String> stringTable;
+
+      /**
+       * All layouts, one after another. Each starts with the class name, followed by the
+       * number of int, float, string and function pointer members. Then come the name and
+       * array size of each int, float and string member and the names of the function pointer
+       * members, in the order of the object's maps.
+       */
+      bs::Vector<bs::UINT32> layouts;
+
+      /**
+       * Per object: Its handle, the index of its layout and its instance name.
+       */
+      bs::Vector<ScriptObjectHandle> handles;
+      bs::Vector<bs::UINT32> objectLayouts;
+      bs::Vector<bs::UINT32> instanceNames;
+
+      /**
+       * Member values of all objects, one after another.
+       */
+      ScriptInts ints;
+      ScriptFloats floats;
+      bs::Vector<bs::UINT32> strings;
+      bs::Vector<bs::UINT32> functionPointers;
+
+      REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(EncodedScriptObjects)
+    };
+
     /**
      * Storage for all script objects used by the scripting backend to be used by the
      * native game code.
@@ -61,10 +101,41 @@ namespace REGoth
        */
       void clear();
 
+      /**
+       * Enables or disables the access cache, see mAccessCachedHandles. Looking up objects
+       * updates the cache, so it must be disabled while multiple threads use the storage.
+       * Disabling also empties the cache.
+       */
+      void setAccessCacheEnabled(bool enabled);
+
+      /**
+       * @return All objects inside this storage in their compact form, see EncodedScriptObjects.
+       */
+      EncodedScriptObjects encodeObjects() const;
+
+      /**
+       * Replaces the objects inside this storage with the given ones, previously encoded via
+       * encodeObjects(). Throws if the encoded data is malformed.
+       */
+      void decodeObjects(const EncodedScriptObjects& encoded);
+
+      /**
+       * @return Number of objects inside this storage.
+       */
+      bs::UINT32 numObjects() const
+      {
+        return (bs::UINT32)mObjects.size();
+      }
+
     private:
       bs::Map<ScriptObjectHandle, ScriptObject> mObjects;
       ScriptObjectHandle mNextHandle = 1;
 
+      /**
+       * Objects being saved or just loaded from a savegame. Empty otherwise.
+       */
+      EncodedScriptObjects mSerializedObjects;
+
       /**
        * Checks whether the script object behind the given handle is cached.
        * If so, a pointer to that object is returned. If it was not cached,
@@ -109,6 +180,7 @@ namespace REGoth
       std::array<ScriptObjectHandle, ACCESS_CACHE_SIZE> mAccessCachedHandles;
       std::array<ScriptObject*, ACCESS_CACHE_SIZE> mAccessCachedObjects;
       bs::UINT32 mCachePosition = 0;
+      bool mIsAccessCacheEnabled = true;
 
     public:
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(ScriptObjectStorage)
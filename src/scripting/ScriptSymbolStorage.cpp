@@ -5,6 +5,147 @@ namespace REGoth
 {
   namespace Scripting
   {
+    /**
+     * @return Whether the value of the given symbol is part of a savegame.
+     */
+    static bool isSymbolValueSaved(const SymbolBase& symbol)
+    {
+      return !symbol.isClassVar && !symbol.isKeptAfterLoad;
+    }
+
+    /**
+     * Appends the values of all given symbols to \p target, one after another.
+     */
+    template <typename T, typename V>
+    static void appendValues(const bs::Vector<SymbolIndex>& symbols,
+                             const ScriptSymbolStorage& storage, V T::*values,
+                             bs::Vector<typename V::value_type>& target)
+    {
+      for (SymbolIndex index : symbols)
+      {
+        const V& source = storage.getSymbol<T>(index).*values;
+
+        target.insert(target.end(), source.begin(), source.end());
+      }
+    }
+
+    /**
+     * Reverse of appendValues(). Throws if the number of values does not match.
+     */
+    template <typename T, typename V>
+    static void distributeValues(const bs::Vector<SymbolIndex>& symbols,
+                                 const ScriptSymbolStorage& storage, V T::*values,
+                                 const bs::Vector<typename V::value_type>& source)
+    {
+      using namespace bs;
+
+      size_t cursor = 0;
+
+      for (SymbolIndex index : symbols)
+      {
+        V& target = storage.getSymbol<T>(index).*values;
+
+        if (cursor + target.size() > source.size())
+        {
+          BS_EXCEPT(InvalidStateException, "Saved symbol values do not fit the DAT-file!");
+        }
+
+        std::copy(source.begin() + cursor, source.begin() + cursor + target.size(),
+                  target.begin());
+
+        cursor += target.size();
+      }
+
+      if (cursor != source.size())
+      {
+        BS_EXCEPT(InvalidStateException, "Saved symbol values do not fit the DAT-file!");
+      }
+    }
+
+    ScriptSymbolValues ScriptSymbolStorage::collectMutableValues() const
+    {
+      ScriptSymbolValues values;
+
+      for (const auto& symbol : mStorage)
+      {
+        if (!isSymbolValueSaved(*symbol)) continue;
+
+        switch (symbol->type)
+        {
+          case SymbolType::Int:
+            values.intSymbols.push_back(symbol->index);
+            break;
+
+          case SymbolType::Float:
+            values.floatSymbols.push_back(symbol->index);
+            break;
+
+          case SymbolType::String:
+            values.stringSymbols.push_back(symbol->index);
+            break;
+
+          case SymbolType::Instance:
+            values.instanceSymbols.push_back(symbol->index);
+            values.instances.push_back(getSymbol<SymbolInstance>(symbol->index).instance);
+            break;
+
+          case SymbolType::ScriptFunction:
+            // Actual functions are always const, so these are written by EParOp_AssignFunc
+            values.functionSymbols.push_back(symbol->index);
+            values.functionAddresses.push_back(
+                getSymbol<SymbolScriptFunction>(symbol->index).address);
+            break;
+
+          default:
+            break;
+        }
+      }
+
+      appendValues(values.intSymbols, *this, &SymbolInt::ints, values.ints);
+      appendValues(values.floatSymbols, *this, &SymbolFloat::floats, values.floats);
+      appendValues(values.stringSymbols, *this, &SymbolString::strings, values.strings);
+
+      return values;
+    }
+
+    void ScriptSymbolStorage::applyMutableValues(const ScriptSymbolValues& values)
+    {
+      using namespace bs;
+
+      distributeValues(values.intSymbols, *this, &SymbolInt::ints, values.ints);
+      distributeValues(values.floatSymbols, *this, &SymbolFloat::floats, values.floats);
+      distributeValues(values.stringSymbols, *this, &SymbolString::strings, values.strings);
+
+      if (values.instanceSymbols.size() != values.instances.size())
+      {
+        BS_EXCEPT(InvalidStateException, "Saved symbol values do not fit the DAT-file!");
+      }
+
+      for (size_t i = 0; i < values.instanceSymbols.size(); i++)
+      {
+        getSymbol<SymbolInstance>(values.instanceSymbols[i]).instance = values.instances[i];
+      }
+
+      if (values.functionSymbols.size() != values.functionAddresses.size())
+      {
+        BS_EXCEPT(InvalidStateException, "Saved symbol values do not fit the DAT-file!");
+      }
+
+      for (size_t i = 0; i < values.functionSymbols.size(); i++)
+      {
+        getSymbol<SymbolScriptFunction>(values.functionSymbols[i]).address =
+            values.functionAddresses[i];
+      }
+    }
+
+    void ScriptSymbolStorage::restoreSerializedValues()
+    {
+      applyMutableValues(mSerializedValues);
+
+      mSerializedValues = ScriptSymbolValues();
+    }
+
+    REGOTH_DEFINE_RTTI(ScriptSymbolValues)
     REGOTH_DEFINE_RTTI(ScriptSymbolStorage)
-  }
+  }  // namespace Scripting
 }  // namespace REGoth
@@ -7,6 +7,37 @@ namespace REGoth
 {
   namespace Scripting
   {
+    /**
+     * Values of all symbols which change while playing: Global ints, floats and strings and
+     * which script objects the instance symbols refer to. Everything else about the symbols
+     * is defined by the DAT-file, so this is all a savegame needs to store.
+     *
+     * The values of all symbols of one type are stored one after another. How many values
+     * belong to each symbol is also defined by the DAT-file.
+     */
+    struct ScriptSymbolValues : public bs::IReflectable
+    {
+      bs::Vector<SymbolIndex> intSymbols;
+      ScriptInts ints;
+
+      bs::Vector<SymbolIndex> floatSymbols;
+      ScriptFloats floats;
+
+      bs::Vector<SymbolIndex> stringSymbols;
+      ScriptStrings strings;
+
+      bs::Vector<SymbolIndex> instanceSymbols;
+      bs::Vector<ScriptObjectHandle> instances;
+
+      /**
+       * Function pointers, i.e. `var func` symbols which were assigned another function.
+       */
+      bs::Vector<SymbolIndex> functionSymbols;
+      bs::Vector<bs::UINT32> functionAddresses;
+
+      REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(ScriptSymbolValues)
+    };
+
     /**
      * Holds the list of all created symbols and their data.
      *
@@ -87,6 +118,14 @@ namespace REGoth
         return getSymbolBase(index).name;
       }
 
+      /**
+       * @return Number of symbols inside the storage. Valid indices go from 0 to this.
+       */
+      bs::UINT32 numSymbols() const
+      {
+        return (bs::UINT32)mStorage.size();
+      }
+
       /**
        * Looks up the symbol at the given index.
        *
@@ -229,6 +268,27 @@ namespace REGoth
         mFunctionsByAddress[fn.address] = index;
       }
 
+      /**
+       * Collects the values of all symbols which change while playing. Symbols kept after
+       * loading and class members are left out, see SymbolBase.
+       */
+      ScriptSymbolValues collectMutableValues() const;
+
+      /**
+       * Sets the values of the symbols to the given ones, previously collected via
+       * collectMutableValues().
+       *
+       * Throws if the values do not fit the symbols, e.g. if they were collected with
+       * a different DAT-file.
+       */
+      void applyMutableValues(const ScriptSymbolValues& values);
+
+      /**
+       * Applies the values read from a savegame. Only the values are saved, so the symbols
+       * themselves must have been created from the DAT-file again before calling this.
+       */
+      void restoreSerializedValues();
+
       /**
        * @return Symbol of the function with the given address.
        */
@@ -292,6 +352,11 @@ namespace REGoth
       bs::Map<bs::String, SymbolIndex> mSymbolsByName;
       bs::Map<bs::UINT32, SymbolIndex> mFunctionsByAddress;
 
+      /**
+       * Values being saved or just loaded from a savegame. Empty otherwise.
+       */
+      ScriptSymbolValues mSerializedValues;
+
     public:
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(ScriptSymbolStorage)
     };
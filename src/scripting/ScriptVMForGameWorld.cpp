@@ -7,8 +7,9 @@ namespace REGoth
   namespace Scripting
   {
     ScriptVMForGameWorld::ScriptVMForGameWorld(HGameWorld gameWorld,
+                                               const bs::String& datFileName,
                                                const bs::Vector<bs::UINT8>& datFileData)
-        : DaedalusVMForGameWorld(gameWorld, datFileData)
+        : DaedalusVMForGameWorld(gameWorld, datFileName, datFileData)
     {
     }
 
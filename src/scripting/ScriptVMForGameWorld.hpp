@@ -16,7 +16,8 @@ namespace REGoth
     class ScriptVMForGameWorld : public DaedalusVMForGameWorld
     {
     public:
-      ScriptVMForGameWorld(HGameWorld gameWorld, const bs::Vector<bs::UINT8>& datFileData);
+      ScriptVMForGameWorld(HGameWorld gameWorld, const bs::String& datFileName,
+                           const bs::Vector<bs::UINT8>& datFileData);
 
     protected:
 
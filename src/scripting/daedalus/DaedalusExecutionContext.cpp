@@ -0,0 +1,28 @@
+#include "DaedalusExecutionContext.hpp"
+
+namespace REGoth
+{
+  namespace Scripting
+  {
+    void DaedalusCommandBuffer::defer(std::function<void()> command)
+    {
+      mCommands.push_back(std::move(command));
+    }
+
+    void DaedalusCommandBuffer::apply()
+    {
+      for (const auto& command : mCommands)
+      {
+        command();
+      }
+
+      mCommands.clear();
+      mWrittenSymbols.clear();
+
+      mStagedInts.clear();
+      mStagedFloats.clear();
+      mStagedStrings.clear();
+      mStagedHandles.clear();
+    }
+  }  // namespace Scripting
+}  // namespace REGoth
@@ -0,0 +1,235 @@
+/**\file
+ */
+#pragma once
+#include "DaedalusClassVarResolver.hpp"
+#include "DaedalusStack.hpp"
+#include <BsPrerequisites.h>
+#include <random>
+
+namespace REGoth
+{
+  namespace Scripting
+  {
+    /**
+     * Records changes to state shared between script execution contexts, so they can be applied
+     * later at a point where only one thread is running scripts.
+     *
+     * Commands are applied in the order they were recorded.
+     */
+    class DaedalusCommandBuffer
+    {
+    public:
+      /**
+       * Records a command to be run once the buffer is applied.
+       */
+      void defer(std::function<void()> command);
+
+      /**
+       * Records a write to the given variable. All writes to the same variable go to the same
+       * staged copy, which is what stagedValueOf() returns from then on.
+       *
+       * @param  writeBack  Whether to write the staged copy back to \p target once the buffer
+       *                    is applied, at the point the first write was recorded. If not, the
+       *                    copy is private to the context, like the locals of script functions.
+       *
+       * @return Reference to the staged copy. Stays valid until the buffer is applied.
+       */
+      template <typename T>
+      T& stageWrite(T& target, bool writeBack = true)
+      {
+        StagedValues<T>& values = stagedValues((T*)nullptr);
+
+        auto it = values.find(&target);
+
+        if (it != values.end()) return it->second;
+
+        // Elements of unordered maps don't move when more are added
+        T& staged = values.emplace(&target, target).first->second;
+
+        if (writeBack)
+        {
+          T* pTarget = &target;
+          T* pStaged = &staged;
+
+          defer([pTarget, pStaged]() { *pTarget = *pStaged; });
+        }
+
+        return staged;
+      }
+
+      /**
+       * @return The staged copy of the given variable if it has been written to, otherwise
+       *         the variable itself.
+       */
+      template <typename T>
+      const T& stagedValueOf(const T& target) const
+      {
+        const StagedValues<T>& values = stagedValues((T*)nullptr);
+
+        if (values.empty()) return target;
+
+        auto it = values.find(const_cast<T*>(&target));
+
+        return it != values.end() ? it->second : target;
+      }
+
+      /**
+       * Records that the given symbol has been written to, see DaedalusVM::symbolWriteVersion().
+       * Cheaper than deferring a command, as most script writes go to global symbols.
+       */
+      void recordSymbolWrite(SymbolIndex symbolIndex)
+      {
+        mWrittenSymbols.push_back(symbolIndex);
+      }
+
+      /**
+       * @return Symbols written to since the buffer was last applied, once per write.
+       */
+      const bs::Vector<SymbolIndex>& writtenSymbols() const
+      {
+        return mWrittenSymbols;
+      }
+
+      /**
+       * Runs all recorded commands and empties the buffer, including the staged copies and
+       * the written symbols. Use DaedalusVM::applySideEffects() to also count the writes.
+       */
+      void apply();
+
+      /**
+       * @return Whether nothing has been recorded, not even private staged copies.
+       */
+      bool isEmpty() const
+      {
+        return mCommands.empty() && mWrittenSymbols.empty() && mStagedInts.empty() &&
+               mStagedFloats.empty() && mStagedStrings.empty() && mStagedHandles.empty();
+      }
+
+    private:
+      template <typename T>
+      using StagedValues = bs::UnorderedMap<T*, T>;
+
+      StagedValues<bs::INT32>& stagedValues(bs::INT32*)
+      {
+        return mStagedInts;
+      }
+
+      StagedValues<float>& stagedValues(float*)
+      {
+        return mStagedFloats;
+      }
+
+      StagedValues<bs::String>& stagedValues(bs::String*)
+      {
+        return mStagedStrings;
+      }
+
+      StagedValues<bs::UINT32>& stagedValues(bs::UINT32*)
+      {
+        return mStagedHandles;
+      }
+
+      const StagedValues<bs::INT32>& stagedValues(bs::INT32*) const
+      {
+        return mStagedInts;
+      }
+
+      const StagedValues<float>& stagedValues(float*) const
+      {
+        return mStagedFloats;
+      }
+
+      const StagedValues<bs::String>& stagedValues(bs::String*) const
+      {
+        return mStagedStrings;
+      }
+
+      const StagedValues<bs::UINT32>& stagedValues(bs::UINT32*) const
+      {
+        return mStagedHandles;
+      }
+
+      bs::Vector<std::function<void()>> mCommands;
+      bs::Vector<SymbolIndex> mWrittenSymbols;
+
+      /**
+       * Staged copies of written variables by the variable they belong to. Handles are the
+       * values of instance symbols and function pointers.
+       */
+      StagedValues<bs::INT32> mStagedInts;
+      StagedValues<float> mStagedFloats;
+      StagedValues<bs::String> mStagedStrings;
+      StagedValues<bs::UINT32> mStagedHandles;
+    };
+
+    /**
+     * Everything the DaedalusVM needs to run a script function, which is not the script
+     * itself: The stack, the registers and the *Current Instance*.
+     *
+     * The VM has a main context, which is used by default. Additional contexts can be created to
+     * run scripts on multiple threads at once, see DaedalusVM::createExecutionContext(). Those
+     * hold the instances registers like `SELF` themselves instead of writing them into the global
+     * symbols. Also, while a context is deferring side effects, all writes to global variables,
+     * other objects and the world go into its command buffer instead. Scripts running on the
+     * context read their own writes back from there, see DaedalusCommandBuffer::stagedValueOf().
+     */
+    struct DaedalusExecutionContext
+    {
+      /**
+       * Number of instance symbols which can be held by a context, see
+       * DaedalusVM::findInstanceRegister().
+       */
+      static constexpr bs::UINT32 NUM_INSTANCE_REGISTERS = 4;
+
+      /**
+       * Register holding the object the context is running scripts for, i.e. `SELF`.
+       */
+      static constexpr bs::UINT32 SELF_REGISTER = 0;
+
+      DaedalusExecutionContext(const ScriptSymbolStorage& scriptSymbols,
+                               ScriptObjectStorage& scriptObjects)
+          : classVarResolver(scriptSymbols, scriptObjects)
+      {
+      }
+
+      DaedalusStack stack;
+
+      /**
+       * Program counter register
+       */
+      bs::UINT32 pc = 0;
+
+      /**
+       * Function nesting counter.
+       */
+      bs::INT32 callDepth = 0;
+
+      /**
+       * Holds the *Current Instance*-register.
+       */
+      DaedalusClassVarResolver classVarResolver;
+
+      /**
+       * Values of instance symbols like `SELF`. Unused by the main context.
+       */
+      ScriptObjectHandle instanceRegisters[NUM_INSTANCE_REGISTERS] = {};
+
+      /**
+       * If true, every executed instruction will be logged to the console.
+       */
+      bool isDisassemblerEnabled = false;
+
+      /**
+       * If true, changes to shared state are recorded into the command buffer.
+       */
+      bool isDeferringSideEffects = false;
+
+      DaedalusCommandBuffer commandBuffer;
+
+      /**
+       * Random numbers for scripts. `rand()` would depend on the order threads run in.
+       */
+      std::minstd_rand random;
+    };
+  }  // namespace Scripting
+}  // namespace REGoth
@@ -38,7 +38,7 @@ namespace REGoth
     {
       mStackString.emplace_back();
       mStackString.back().isVariableValue = false;
-      mStackString.back().value           = value;
+      mStackString.back().value           = std::move(value);
     }
 
     void DaedalusStack::pushStringVariable(SymbolIndex symbol, bs::UINT32 arrayIndex)
@@ -151,7 +151,8 @@ namespace REGoth
             "Top of script stack is a variable, but we were expecting it to be a simple string!");
       }
 
-      bs::String v = mStackString.back().value;
+      // Move instead of copy, the entry is gone afterwards anyways
+      bs::String v = std::move(mStackString.back().value);
 
       mStackString.pop_back();
 
@@ -1,11 +1,13 @@
 #include "DaedalusVMForGameWorld.hpp"
 #include "DaedalusClassVarResolver.hpp"
+#include "DaedalusExecutionContext.hpp"
 #include <RTTI/RTTI_DaedalusVMForGameWorld.hpp>
 #include <Scene/BsSceneObject.h>
 #include <animation/StateNaming.hpp>
 #include <components/Character.hpp>
 #include <components/CharacterAI.hpp>
 #include <components/CharacterEventQueue.hpp>
+#include <components/CharacterPerception.hpp>
 #include <components/Freepoint.hpp>
 #include <components/GameClock.hpp>
 #include <components/GameWorld.hpp>
@@ -22,9 +24,73 @@ namespace REGoth
 {
   namespace Scripting
   {
+    /**
+     * Externals which may be called by state loops running on worker threads, see
+     * AIScheduler. They either only compute something from their arguments, only read what
+     * stays the same while the loops are running or defer what they do via runOrDefer().
+     *
+     * Positions of characters are fine, as the AIScheduler updates them before starting the
+     * threads. Everything looking at other objects, the physics scene or the UI is not.
+     */
+    const bs::Vector<bs::String> WORKER_SAFE_EXTERNALS = {
+        // Helpers
+        "PRINT",
+        "PRINTDEBUGINSTCH",
+        "HLP_RANDOM",
+        "HLP_GETNPC",
+        "HLP_ISVALIDNPC",
+        "HLP_ISVALIDITEM",
+        "INTTOSTRING",
+        "INTTOFLOAT",
+        "FLOATTOINT",
+        "CONCATSTRINGS",
+
+        // Reading
+        "NPC_ISPLAYER",
+        "WLD_GETDAY",
+        "WLD_ISTIME",
+        "NPC_GETDISTTONPC",
+        "NPC_GETDISTTOPLAYER",
+        "NPC_ISNEAR",
+        "NPC_KNOWSINFO",
+        "NPC_REFUSETALK",
+        "NPC_GETSTATETIME",
+        "NPC_GETBODYSTATE",
+
+        // Deferred
+        "WLD_INSERTNPC",
+        "WLD_INSERTITEM",
+        "WLD_SETTIME",
+        "NPC_SETTALENTSKILL",
+        "EQUIPITEM",
+        "CREATEINVITEMS",
+        "CREATEINVITEM",
+        "MDL_SETVISUAL",
+        "MDL_SETVISUALBODY",
+        "TA_MIN",
+        "NPC_EXCHANGEROUTINE",
+        "AI_GOTOWP",
+        "AI_GOTOFP",
+        "AI_GOTONEXTFP",
+        "AI_GOTONPC",
+        "AI_SETWALKMODE",
+        "AI_WAIT",
+        "AI_STARTSTATE",
+        "AI_PLAYANI",
+        "NPC_SETTOFISTMODE",
+        "NPC_SETREFUSETALK",
+        "NPC_PERCENABLE",
+        "NPC_PERCDISABLE",
+        "NPC_SETPERCTIME",
+        "NPC_SENDPASSIVEPERC",
+        "AI_PROCESSINFOS",
+        "AI_STOPPROCESSINFOS",
+    };
+
     DaedalusVMForGameWorld::DaedalusVMForGameWorld(HGameWorld gameWorld,
+                                                   const bs::String& datFileName,
                                                    const bs::Vector<bs::UINT8>& datFileData)
-        : DaedalusVM(datFileData)
+        : DaedalusVM(datFileName, datFileData)
         , mWorld(gameWorld)
     {
     }
@@ -34,6 +100,7 @@ namespace REGoth
       DaedalusVM::initialize();
 
       createAllInformationInstances();
+      createStateFunctionTable();
     }
 
     void DaedalusVMForGameWorld::fillSymbolStorage()
@@ -101,17 +168,18 @@ namespace REGoth
         mapping().map(obj, mappedSceneObject);
       }
 
-      instance.instance = obj;
+      // Goes through the VM, so conditions reading the symbol see it has changed
+      setInstanceOfSymbol(instance.index, obj);
 
-      ScriptObjectHandle oldCurrentInstance = mClassVarResolver->getCurrentInstance();
+      ScriptObjectHandle oldCurrentInstance = context().classVarResolver.getCurrentInstance();
       ScriptObjectHandle oldSelf            = getInstance("SELF");
 
       setInstance("SELF", obj);
-      mClassVarResolver->setCurrentInstance(obj);
+      context().classVarResolver.setCurrentInstance(obj);
 
       executeScriptFunction(instance.constructorAddress);
 
-      mClassVarResolver->setCurrentInstance(oldCurrentInstance);
+      context().classVarResolver.setCurrentInstance(oldCurrentInstance);
       setInstance("SELF", oldSelf);
 
       // debugLogScriptObject(objData);
@@ -129,7 +197,7 @@ namespace REGoth
     {
       self->useAsSelf();
 
-      mStack.clear();
+      context().stack.clear();
 
       const auto& functionSym = scriptSymbols().getSymbol<SymbolScriptFunction>(function);
       executeScriptFunction(functionSym.address);
@@ -146,19 +214,64 @@ namespace REGoth
       }
     }
 
+    bool DaedalusVMForGameWorld::runStateLoopFunction(DaedalusExecutionContext& context,
+                                                      SymbolIndex function, HCharacter self,
+                                                      ScriptObjectHandle other,
+                                                      ScriptObjectHandle victim,
+                                                      ScriptObjectHandle item)
+    {
+      ScopedExecutionContext scope(context);
+
+      context.isDeferringSideEffects = true;
+
+      // SELF is set by the other overload
+      setOther(other);
+      setVictim(victim);
+      setItem(item);
+
+      return runStateLoopFunction(function, self);
+    }
+
     bool DaedalusVMForGameWorld::runInfoConditionFunction(SymbolIndex function, HCharacter self,
                                                           HCharacter other)
     {
+      auto it = mInfoConditions.find(function);
+
+      InfoCondition* condition = it != mInfoConditions.end() ? &it->second : nullptr;
+
+      if (condition && condition->isMemoizable && isMemoizedResultValid(*condition, self, other))
+      {
+        return condition->result;
+      }
+
       self->useAsSelf();
       other->useAsOther();
 
-      mStack.clear();
+      context().stack.clear();
 
       const auto& functionSym = scriptSymbols().getSymbol<SymbolScriptFunction>(function);
 
       executeScriptFunction(functionSym.address);
 
-      return popIntValue() != 0;
+      bool result = popIntValue() != 0;
+
+      if (condition && condition->isMemoizable)
+      {
+        condition->hasResult         = true;
+        condition->result            = result;
+        condition->self              = self;
+        condition->other             = other;
+        condition->knownInfosVersion = mKnownInfosVersion;
+
+        condition->symbolVersions.clear();
+
+        for (SymbolIndex symbol : condition->symbolsRead)
+        {
+          condition->symbolVersions.push_back(symbolWriteVersion(symbol));
+        }
+      }
+
+      return result;
     }
 
     void DaedalusVMForGameWorld::runInfoFunction(SymbolIndex function, HCharacter self,
@@ -167,7 +280,7 @@ namespace REGoth
       self->useAsSelf();
       other->useAsOther();
 
-      mStack.clear();
+      context().stack.clear();
 
       const auto& functionSym = scriptSymbols().getSymbol<SymbolScriptFunction>(function);
 
@@ -254,66 +367,50 @@ namespace REGoth
 
     void DaedalusVMForGameWorld::setInstance(SymbolIndex instance, ScriptObjectHandle scriptObject)
     {
-      SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(instance);
-
-      symbol.instance = scriptObject;
+      setInstanceOfSymbol(instance, scriptObject);
     }
 
     void DaedalusVMForGameWorld::setInstance(const bs::String& instance,
                                              ScriptObjectHandle scriptObject)
     {
-      SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(instance);
-
-      symbol.instance = scriptObject;
+      setInstanceOfSymbol(mScriptSymbols.findIndexBySymbolName(instance), scriptObject);
     }
 
     ScriptObjectHandle DaedalusVMForGameWorld::getInstance(const bs::String& instance) const
     {
-      const SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(instance);
-
-      return symbol.instance;
+      return getInstanceOfSymbol(mScriptSymbols.findIndexBySymbolName(instance));
     }
 
     ScriptObjectHandle DaedalusVMForGameWorld::getInstance(SymbolIndex symbolIndex) const
     {
-      const SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(symbolIndex);
-
-      return symbol.instance;
+      return getInstanceOfSymbol(symbolIndex);
     }
 
-    HCharacter DaedalusVMForGameWorld::getInstanceCharacter(const bs::String& instance) const
+    bs::INT32 DaedalusVMForGameWorld::findInstanceRegister(SymbolIndex symbolIndex) const
     {
-      const SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(instance);
-
-      if (!mappingConst().isMappedToSomething(symbol.instance))
-      {
-        return {};
-      }
+      if (symbolIndex == mSelfSymbol) return DaedalusExecutionContext::SELF_REGISTER;
+      if (symbolIndex == mOtherSymbol) return 1;
+      if (symbolIndex == mVictimSymbol) return 2;
+      if (symbolIndex == mItemSymbol) return 3;
 
-      bs::HSceneObject characterSO = mappingConst().getMappedSceneObject(symbol.instance);
-
-      HCharacter character = characterSO->getComponent<Character>();
-
-      if (!character)
-      {
-        REGOTH_THROW(InvalidParametersException,
-                     "Expected to be passed a Character instance, but the scene object does "
-                     "not have a character-component!");
-      }
+      return -1;
+    }
 
-      return character;
+    HCharacter DaedalusVMForGameWorld::getInstanceCharacter(const bs::String& instance) const
+    {
+      return getInstanceCharacter(mScriptSymbols.findIndexBySymbolName(instance));
     }
 
     HCharacter DaedalusVMForGameWorld::getInstanceCharacter(SymbolIndex symbolIndex) const
     {
-      const SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(symbolIndex);
+      ScriptObjectHandle scriptObject = getInstanceOfSymbol(symbolIndex);
 
-      if (!mappingConst().isMappedToSomething(symbol.instance))
+      if (!mappingConst().isMappedToSomething(scriptObject))
       {
         return {};
       }
 
-      bs::HSceneObject characterSO = mappingConst().getMappedSceneObject(symbol.instance);
+      bs::HSceneObject characterSO = mappingConst().getMappedSceneObject(scriptObject);
 
       HCharacter character = characterSO->getComponent<Character>();
 
@@ -329,27 +426,14 @@ namespace REGoth
 
     HItem DaedalusVMForGameWorld::getInstanceItem(const bs::String& instance) const
     {
-      const SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(instance);
-
-      bs::HSceneObject itemSO = mappingConst().getMappedSceneObject(symbol.instance);
-
-      HItem item = itemSO->getComponent<Item>();
-
-      if (!item)
-      {
-        REGOTH_THROW(InvalidParametersException,
-                     "Expected to be passed a Item instance, but the scene object does "
-                     "not have a item-component!");
-      }
-
-      return item;
+      return getInstanceItem(mScriptSymbols.findIndexBySymbolName(instance));
     }
 
     HItem DaedalusVMForGameWorld::getInstanceItem(SymbolIndex symbolIndex) const
     {
-      const SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(symbolIndex);
+      ScriptObjectHandle scriptObject = getInstanceOfSymbol(symbolIndex);
 
-      bs::HSceneObject itemSO = mappingConst().getMappedSceneObject(symbol.instance);
+      bs::HSceneObject itemSO = mappingConst().getMappedSceneObject(scriptObject);
 
       HItem item = itemSO->getComponent<Item>();
 
@@ -431,338 +515,298 @@ namespace REGoth
     {
       using This = DaedalusVMForGameWorld;
 
-      registerExternal("PRINT", (externalCallback)&This::external_Print);
-      registerExternal("PRINTDEBUGINSTCH", (externalCallback)&This::external_PrintDebugInstCh);
-      registerExternal("HLP_RANDOM", (externalCallback)&This::external_HLP_Random);
+      registerExternal("PRINT", &This::external_Print);
+      registerExternal("PRINTDEBUGINSTCH", &This::external_PrintDebugInstCh);
+      registerExternal("HLP_RANDOM", &This::external_HLP_Random);
+      // Pushes an instance, which has no typed counterpart
       registerExternal("HLP_GETNPC", (externalCallback)&This::external_HLP_GetNpc);
-      registerExternal("HLP_ISVALIDNPC", (externalCallback)&This::external_HLP_IsValidNpc);
-      registerExternal("HLP_ISVALIDITEM", (externalCallback)&This::external_HLP_IsValidItem);
-      registerExternal("INTTOSTRING", (externalCallback)&This::external_IntToString);
-      registerExternal("INTTOFLOAT", (externalCallback)&This::external_IntToFloat);
-      registerExternal("FLOATTOINT", (externalCallback)&This::external_FloatToInt);
-      registerExternal("NPC_ISPLAYER", (externalCallback)&This::external_NPC_IsPlayer);
-      registerExternal("WLD_INSERTNPC", (externalCallback)&This::external_WLD_InsertNpc);
-      registerExternal("CONCATSTRINGS", (externalCallback)&This::external_ConcatStrings);
-      registerExternal("WLD_INSERTITEM", (externalCallback)&This::external_WLD_InsertItem);
-      registerExternal("NPC_SETTALENTSKILL", (externalCallback)&This::external_NPC_SetTalentSkill);
-      registerExternal("EQUIPITEM", (externalCallback)&This::external_NPC_EquipItem);
-      registerExternal("CREATEINVITEMS", (externalCallback)&This::external_NPC_CreateInventoryItems);
-      registerExternal("CREATEINVITEM", (externalCallback)&This::external_NPC_CreateInventoryItem);
-      registerExternal("MDL_SETVISUAL", (externalCallback)&This::external_MDL_SetVisual);
-      registerExternal("MDL_SETVISUALBODY", (externalCallback)&This::external_MDL_SetVisualBody);
-      registerExternal("WLD_GETDAY", (externalCallback)&This::external_WLD_GetDay);
-      registerExternal("WLD_ISTIME", (externalCallback)&This::external_WLD_IsTime);
-      registerExternal("WLD_SETTIME", (externalCallback)&This::external_WLD_SetTime);
-      registerExternal("TA_MIN", (externalCallback)&This::external_TA_Min);
-      registerExternal("NPC_EXCHANGEROUTINE", (externalCallback)&This::external_NPC_ExchangeRoutine);
-      registerExternal("AI_GOTOWP", (externalCallback)&This::external_AI_GotoWaypoint);
-      registerExternal("AI_GOTOFP", (externalCallback)&This::external_AI_GotoFreepoint);
-      registerExternal("AI_GOTONEXTFP", (externalCallback)&This::external_AI_GotoNextFreepoint);
-      registerExternal("AI_GOTONPC", (externalCallback)&This::external_AI_GotoNpc);
-      registerExternal("AI_SETWALKMODE", (externalCallback)&This::external_AI_SetWalkMode);
-      registerExternal("AI_WAIT", (externalCallback)&This::external_AI_Wait);
-      registerExternal("AI_STARTSTATE", (externalCallback)&This::external_AI_StartState);
-      registerExternal("AI_PLAYANI", (externalCallback)&This::external_AI_PlayAnimation);
-      registerExternal("NPC_GETNEARESTWP", (externalCallback)&This::external_Npc_GetNearestWP);
-      registerExternal("NPC_GETNEXTWP", (externalCallback)&This::external_Npc_GetNextWP);
-      registerExternal("NPC_GETDISTTOWP", (externalCallback)&This::external_Npc_GetDistToWP);
-      registerExternal("NPC_GETDISTTONPC", (externalCallback)&This::external_Npc_GetDistToNpc);
-      registerExternal("NPC_GETDISTTOITEM", (externalCallback)&This::external_Npc_GetDistToItem);
-      registerExternal("NPC_GETDISTTOPLAYER", (externalCallback)&This::external_Npc_GetDistToPlayer);
-      registerExternal("NPC_ISNEAR", (externalCallback)&This::external_Npc_IsNear);
-      registerExternal("NPC_SETTOFISTMODE", (externalCallback)&This::external_Npc_SetToFistMode);
-      registerExternal("NPC_KNOWSINFO", (externalCallback)&This::external_Npc_KnowsInfo);
-      registerExternal("NPC_REFUSETALK", (externalCallback)&This::external_Npc_RefuseTalk);
-      registerExternal("NPC_GETSTATETIME", (externalCallback)&This::external_Npc_GetStateTime);
-      registerExternal("NPC_GETBODYSTATE", (externalCallback)&This::external_Npc_GetBodyState);
-      registerExternal("AI_PROCESSINFOS", (externalCallback)&This::external_AI_ProcessInfos);
-      registerExternal("AI_STOPPROCESSINFOS", (externalCallback)&This::external_AI_StopProcessInfos);
-
-      registerExternal("INFOMANAGER_HASFINISHED",
-                       (externalCallback)&This::external_InfoManager_HasFinished);
-    }
-
-    void DaedalusVMForGameWorld::external_Print()
-    {
-      bs::gDebug().logDebug("[ScriptVMInterface] [Print] " + popStringValue());
-    }
-
-    void DaedalusVMForGameWorld::external_PrintDebugInstCh()
-    {
-      bs::String text     = popStringValue();
-      bs::INT32 character = popIntValue();
+      registerExternal("HLP_ISVALIDNPC", &This::external_HLP_IsValidNpc);
+      registerExternal("HLP_ISVALIDITEM", &This::external_HLP_IsValidItem);
+      registerExternal("INTTOSTRING", &This::external_IntToString);
+      registerExternal("INTTOFLOAT", &This::external_IntToFloat);
+      registerExternal("FLOATTOINT", &This::external_FloatToInt);
+      registerExternal("NPC_ISPLAYER", &This::external_NPC_IsPlayer);
+      registerExternal("WLD_INSERTNPC", &This::external_WLD_InsertNpc);
+      registerExternal("CONCATSTRINGS", &This::external_ConcatStrings);
+      registerExternal("WLD_INSERTITEM", &This::external_WLD_InsertItem);
+      registerExternal("NPC_SETTALENTSKILL", &This::external_NPC_SetTalentSkill);
+      registerExternal("EQUIPITEM", &This::external_NPC_EquipItem);
+      registerExternal("CREATEINVITEMS", &This::external_NPC_CreateInventoryItems);
+      registerExternal("CREATEINVITEM", &This::external_NPC_CreateInventoryItem);
+      registerExternal("MDL_SETVISUAL", &This::external_MDL_SetVisual);
+      registerExternal("MDL_SETVISUALBODY", &This::external_MDL_SetVisualBody);
+      registerExternal("WLD_GETDAY", &This::external_WLD_GetDay);
+      registerExternal("WLD_ISTIME", &This::external_WLD_IsTime);
+      registerExternal("WLD_SETTIME", &This::external_WLD_SetTime);
+      registerExternal("TA_MIN", &This::external_TA_Min);
+      registerExternal("NPC_EXCHANGEROUTINE", &This::external_NPC_ExchangeRoutine);
+      registerExternal("AI_GOTOWP", &This::external_AI_GotoWaypoint);
+      registerExternal("AI_GOTOFP", &This::external_AI_GotoFreepoint);
+      registerExternal("AI_GOTONEXTFP", &This::external_AI_GotoNextFreepoint);
+      registerExternal("AI_GOTONPC", &This::external_AI_GotoNpc);
+      registerExternal("AI_SETWALKMODE", &This::external_AI_SetWalkMode);
+      registerExternal("AI_WAIT", &This::external_AI_Wait);
+      registerExternal("AI_STARTSTATE", &This::external_AI_StartState);
+      registerExternal("AI_PLAYANI", &This::external_AI_PlayAnimation);
+      registerExternal("NPC_GETNEARESTWP", &This::external_Npc_GetNearestWP);
+      registerExternal("NPC_GETNEXTWP", &This::external_Npc_GetNextWP);
+      registerExternal("NPC_GETDISTTOWP", &This::external_Npc_GetDistToWP);
+      registerExternal("NPC_GETDISTTONPC", &This::external_Npc_GetDistToNpc);
+      registerExternal("NPC_GETDISTTOITEM", &This::external_Npc_GetDistToItem);
+      registerExternal("NPC_GETDISTTOPLAYER", &This::external_Npc_GetDistToPlayer);
+      registerExternal("NPC_ISNEAR", &This::external_Npc_IsNear);
+      registerExternal("NPC_SETTOFISTMODE", &This::external_Npc_SetToFistMode);
+      registerExternal("NPC_KNOWSINFO", &This::external_Npc_KnowsInfo);
+      registerExternal("NPC_REFUSETALK", &This::external_Npc_RefuseTalk);
+      registerExternal("NPC_SETREFUSETALK", &This::external_Npc_SetRefuseTalk);
+      registerExternal("NPC_GETSTATETIME", &This::external_Npc_GetStateTime);
+      registerExternal("NPC_GETBODYSTATE", &This::external_Npc_GetBodyState);
+      registerExternal("NPC_PERCENABLE", &This::external_Npc_PercEnable);
+      registerExternal("NPC_PERCDISABLE", &This::external_Npc_PercDisable);
+      registerExternal("NPC_SETPERCTIME", &This::external_Npc_SetPercTime);
+      registerExternal("NPC_SENDPASSIVEPERC", &This::external_Npc_SendPassivePerc);
+      registerExternal("NPC_CANSEENPC", &This::external_Npc_CanSeeNpc);
+      registerExternal("NPC_CANSEENPCFREELOS", &This::external_Npc_CanSeeNpcFreeLOS);
+      registerExternal("NPC_CANSEEITEM", &This::external_Npc_CanSeeItem);
+      registerExternal("AI_PROCESSINFOS", &This::external_AI_ProcessInfos);
+      registerExternal("AI_STOPPROCESSINFOS", &This::external_AI_StopProcessInfos);
+
+      registerExternal("INFOMANAGER_HASFINISHED", &This::external_InfoManager_HasFinished);
+
+      for (const bs::String& name : WORKER_SAFE_EXTERNALS)
+      {
+        markExternalWorkerSafe(name);
+      }
+    }
 
+    void DaedalusVMForGameWorld::external_Print(const bs::String& text)
+    {
+      bs::gDebug().logDebug("[ScriptVMInterface] [Print] " + text);
+    }
+
+    void DaedalusVMForGameWorld::external_PrintDebugInstCh(bs::INT32 character,
+                                                           const bs::String& text)
+    {
       // Don't need this. Just get the parameters off the stack.
     }
 
-    void DaedalusVMForGameWorld::external_HLP_Random()
+    bs::INT32 DaedalusVMForGameWorld::external_HLP_Random(bs::INT32 max)
     {
-      mStack.pushInt(rand() % popIntValue());
+      DaedalusExecutionContext& ctx = context();
+
+      // Other threads might be using rand() at the same time, which would make the results
+      // depend on the order the threads are running in
+      bs::INT32 random = ctx.isDeferringSideEffects ? (bs::INT32)ctx.random() : rand();
+
+      return random % max;
     }
 
     void DaedalusVMForGameWorld::external_HLP_GetNpc()
     {
       bs::INT32 symbolIndex = popIntValue();
 
-      mStack.pushInstance((SymbolIndex)symbolIndex);
+      context().stack.pushInstance((SymbolIndex)symbolIndex);
     }
 
-    void DaedalusVMForGameWorld::external_HLP_IsValidNpc()
+    bool DaedalusVMForGameWorld::external_HLP_IsValidNpc(HCharacter character)
     {
-      HCharacter character = popCharacterInstance();
-
-      if (character.isDestroyed())
-      {
-        mStack.pushInt(0);
-      }
-      else
-      {
-        mStack.pushInt(1);
-      }
+      return !character.isDestroyed();
     }
 
-    void DaedalusVMForGameWorld::external_HLP_IsValidItem()
+    bool DaedalusVMForGameWorld::external_HLP_IsValidItem(HItem item)
     {
-      HItem item = popItemInstance();
-
-      if (item.isDestroyed())
-      {
-        mStack.pushInt(0);
-      }
-      else
-      {
-        mStack.pushInt(1);
-      }
+      return !item.isDestroyed();
     }
 
-    void DaedalusVMForGameWorld::external_IntToString()
+    bs::String DaedalusVMForGameWorld::external_IntToString(bs::INT32 value)
     {
-      mStack.pushString(bs::toString(popIntValue()));
+      return bs::toString(value);
     }
 
-    void DaedalusVMForGameWorld::external_IntToFloat()
+    float DaedalusVMForGameWorld::external_IntToFloat(bs::INT32 value)
     {
-      mStack.pushFloat((float)popIntValue());
+      return (float)value;
     }
 
-    void DaedalusVMForGameWorld::external_FloatToInt()
+    bs::INT32 DaedalusVMForGameWorld::external_FloatToInt(float value)
     {
-      mStack.pushInt((bs::INT32)popFloatValue());
+      return (bs::INT32)value;
     }
 
-    void DaedalusVMForGameWorld::external_ConcatStrings()
+    bs::String DaedalusVMForGameWorld::external_ConcatStrings(const bs::String& a,
+                                                              const bs::String& b)
     {
-      bs::String b = popStringValue();
-      bs::String a = popStringValue();
-
-      mStack.pushString(a + b);
+      return a + b;
     }
 
-    void DaedalusVMForGameWorld::external_WLD_InsertItem()
+    void DaedalusVMForGameWorld::external_WLD_InsertItem(bs::INT32 instance,
+                                                         const bs::String& spawnpoint)
     {
-      bs::String spawnpoint = popStringValue();
-      SymbolIndex instance  = popIntValue();
-
-      mWorld->insertItem(mScriptSymbols.getSymbolName(instance), spawnpoint);
+      runOrDefer([this, instance, spawnpoint]() {
+        mWorld->insertItem(mScriptSymbols.getSymbolName(instance), spawnpoint);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_WLD_InsertNpc()
+    void DaedalusVMForGameWorld::external_WLD_InsertNpc(bs::INT32 instance,
+                                                        const bs::String& waypoint)
     {
-      bs::String waypoint  = popStringValue();
-      SymbolIndex instance = popIntValue();
-
-      mWorld->insertCharacter(mScriptSymbols.getSymbolName(instance), waypoint);
+      runOrDefer([this, instance, waypoint]() {
+        mWorld->insertCharacter(mScriptSymbols.getSymbolName(instance), waypoint);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_WLD_GetDay()
+    bs::INT32 DaedalusVMForGameWorld::external_WLD_GetDay()
     {
-      bs::INT32 day = mWorld->gameclock()->getDay();
-
-      mStack.pushInt(day);
+      return mWorld->gameclock()->getDay();
     }
 
-    void DaedalusVMForGameWorld::external_WLD_IsTime()
+    bool DaedalusVMForGameWorld::external_WLD_IsTime(bs::INT32 hour1, bs::INT32 min1,
+                                                     bs::INT32 hour2, bs::INT32 min2)
     {
-      bs::INT32 min2  = popIntValue();
-      bs::INT32 hour2 = popIntValue();
-      bs::INT32 min1  = popIntValue();
-      bs::INT32 hour1 = popIntValue();
-
-      bool test = mWorld->gameclock()->isTime(hour1, min1, hour2, min2);
-
-      mStack.pushInt(test ? 1 : 0);
+      return mWorld->gameclock()->isTime(hour1, min1, hour2, min2);
     }
 
-    void DaedalusVMForGameWorld::external_WLD_SetTime()
+    void DaedalusVMForGameWorld::external_WLD_SetTime(bs::INT32 hour, bs::INT32 min)
     {
-      bs::INT32 min  = popIntValue();
-      bs::INT32 hour = popIntValue();
-
-      mWorld->gameclock()->setTime(hour, min);
+      runOrDefer([this, hour, min]() { mWorld->gameclock()->setTime(hour, min); });
     }
 
-    void DaedalusVMForGameWorld::external_NPC_IsPlayer()
+    bool DaedalusVMForGameWorld::external_NPC_IsPlayer(HCharacter character)
     {
-      HCharacter character = popCharacterInstance();
-
-      mStack.pushInt(character->isPlayer() ? 1 : 0);
+      return character->isPlayer();
     }
 
-    void DaedalusVMForGameWorld::external_NPC_SetTalentSkill()
+    void DaedalusVMForGameWorld::external_NPC_SetTalentSkill(HCharacter character,
+                                                             bs::INT32 talent, bs::INT32 skill)
     {
-      bs::INT32 skill      = popIntValue();
-      bs::INT32 talent     = popIntValue();
-      HCharacter character = popCharacterInstance();
-
       bs::gDebug().logWarning("[External] Using external stub: NPC_SetTalentSkill");
     }
 
-    void DaedalusVMForGameWorld::external_NPC_EquipItem()
+    void DaedalusVMForGameWorld::external_NPC_EquipItem(HCharacter character,
+                                                        const bs::String& instance)
     {
-      bs::String instance  = popStringValue();
-      HCharacter character = popCharacterInstance();
-
-      character->equipItem(instance);
+      runOrDefer([character, instance]() { character->equipItem(instance); });
     }
-    void DaedalusVMForGameWorld::external_NPC_CreateInventoryItems()
+    void DaedalusVMForGameWorld::external_NPC_CreateInventoryItems(HCharacter character,
+                                                                   const bs::String& instance,
+                                                                   bs::INT32 num)
     {
-      bs::INT32 num        = popIntValue();
-      bs::String instance  = popStringValue();
-      HCharacter character = popCharacterInstance();
-
-      character->createInventoryItem(instance, num);
+      runOrDefer([character, instance, num]() { character->createInventoryItem(instance, num); });
     }
 
-    void DaedalusVMForGameWorld::external_NPC_CreateInventoryItem()
+    void DaedalusVMForGameWorld::external_NPC_CreateInventoryItem(HCharacter character,
+                                                                  const bs::String& instance)
     {
-      bs::String instance  = popStringValue();
-      HCharacter character = popCharacterInstance();
-
-      character->createInventoryItem(instance, 1);
+      runOrDefer([character, instance]() { character->createInventoryItem(instance, 1); });
     }
 
-    void DaedalusVMForGameWorld::external_MDL_SetVisual()
+    void DaedalusVMForGameWorld::external_MDL_SetVisual(HCharacter character, bs::String visual)
     {
-      bs::String visual    = popStringValue();
-      HCharacter character = popCharacterInstance();
+      bs::StringUtil::toUpperCase(visual);
 
-      HVisualCharacter characterVisual;
+      runOrDefer([character, visual]() {
+        HVisualCharacter characterVisual;
 
-      // if (!character->SO()->hasComponent<VisualCharacter>())
-      // {
-      // characterVisual = character->SO()->addComponent<VisualCharacter>();
-      // }
-      // else
-      // {
-      characterVisual = character->SO()->getComponent<VisualCharacter>();
-      // }
+        // if (!character->SO()->hasComponent<VisualCharacter>())
+        // {
+        // characterVisual = character->SO()->addComponent<VisualCharacter>();
+        // }
+        // else
+        // {
+        characterVisual = character->SO()->getComponent<VisualCharacter>();
+        // }
 
-      bs::StringUtil::toUpperCase(visual);
-      characterVisual->setVisual(visual);
+        characterVisual->setVisual(visual);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_MDL_SetVisualBody()
+    void DaedalusVMForGameWorld::external_MDL_SetVisualBody(
+        HCharacter character, const bs::String& bodyMesh, bs::INT32 bodyTexIndex,
+        bs::INT32 bodyTexColor, const bs::String& headMesh, bs::INT32 headTexIndex,
+        bs::INT32 teethTexIndex, bs::INT32 armorInstance)
     {
-      bs::INT32 armorInstance = popIntValue();
-
-      bs::INT32 teethTexIndex = popIntValue();
-      bs::INT32 headTexIndex  = popIntValue();
-      bs::String headMesh     = popStringValue();
-
-      bs::INT32 bodyTexColor = popIntValue();
-      bs::INT32 bodyTexIndex = popIntValue();
-      bs::String bodyMesh    = popStringValue();
-
-      // If an armor is set here, we need to replace the body mesh from the input parameters with the
-      // visual settings from inside the armor instance
-      if (armorInstance != -1)
-      {
-        // TODO: Original Gothic adds the Armor straight to the inventory. We just create a
-        // temporary instance to extract the visual information from it
-        ScriptObjectHandle armorSObj = getInstance(armorInstance);
-
-        if (!armorSObj)
+      // Might create a script object for the armor
+      runOrDefer([this, character, armorInstance, bodyMesh, headMesh]() mutable {
+        // If an armor is set here, we need to replace the body mesh from the input parameters
+        // with the visual settings from inside the armor instance
+        if (armorInstance != -1)
         {
-          armorSObj = instanciateClass("C_ITEM", armorInstance, {});
-        }
+          // TODO: Original Gothic adds the Armor straight to the inventory. We just create a
+          // temporary instance to extract the visual information from it
+          ScriptObjectHandle armorSObj = getInstance(armorInstance);
 
-        ScriptObject& armor = mScriptObjects.get(armorSObj);
+          if (!armorSObj)
+          {
+            armorSObj = instanciateClass("C_ITEM", armorInstance, {});
+          }
 
-        bodyMesh = armor.stringValue("VISUAL_CHANGE");
-      }
+          ScriptObject& armor = mScriptObjects.get(armorSObj);
 
-      HCharacter character = popCharacterInstance();
+          bodyMesh = armor.stringValue("VISUAL_CHANGE");
+        }
 
-      HVisualCharacter characterVisual = character->SO()->getComponent<VisualCharacter>();
+        HVisualCharacter characterVisual = character->SO()->getComponent<VisualCharacter>();
 
-      bs::StringUtil::toUpperCase(bodyMesh);
-      characterVisual->setBodyMesh(bodyMesh);
+        bs::StringUtil::toUpperCase(bodyMesh);
+        characterVisual->setBodyMesh(bodyMesh);
 
-      bs::StringUtil::toUpperCase(headMesh);
-      characterVisual->setHeadMesh(headMesh);
+        bs::StringUtil::toUpperCase(headMesh);
+        characterVisual->setHeadMesh(headMesh);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_GotoWaypoint()
+    void DaedalusVMForGameWorld::external_AI_GotoWaypoint(HCharacter self, bs::String waypoint)
     {
-      bs::String waypoint = popStringValue();
-      HCharacter self     = popCharacterInstance();
-
       bs::StringUtil::toUpperCase(waypoint);
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+      runOrDefer([this, self, waypoint]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      eventQueue->pushGotoObject(mWorld->findObjectByName(waypoint));
+        eventQueue->pushGotoObject(mWorld->findObjectByName(waypoint));
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_GotoFreepoint()
+    void DaedalusVMForGameWorld::external_AI_GotoFreepoint(HCharacter self, bs::String freepoint)
     {
-      bs::String freepoint = popStringValue();
-      HCharacter self      = popCharacterInstance();
-
       bs::StringUtil::toUpperCase(freepoint);
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+      runOrDefer([this, self, freepoint]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      eventQueue->pushGotoObject(mWorld->findObjectByName(freepoint));
+        eventQueue->pushGotoObject(mWorld->findObjectByName(freepoint));
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_GotoNextFreepoint()
+    void DaedalusVMForGameWorld::external_AI_GotoNextFreepoint(HCharacter self,
+                                                               bs::String freepointName)
     {
-      bs::String freepointName = popStringValue();
-      HCharacter self          = popCharacterInstance();
-
       bs::StringUtil::toUpperCase(freepointName);
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+      runOrDefer([this, self, freepointName]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      const auto& at = self->SO()->getTransform().pos();
-      HFreepoint freepoint =
-          mWorld->waynet()->findClosestFreepointTo(freepointName, at).secondClosest;
+        const auto& at = self->SO()->getTransform().pos();
+        HFreepoint freepoint =
+            mWorld->waynet()->findClosestFreepointTo(freepointName, at).secondClosest;
 
-      eventQueue->pushGotoObject(freepoint->SO());
+        eventQueue->pushGotoObject(freepoint->SO());
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_GotoNpc()
+    void DaedalusVMForGameWorld::external_AI_GotoNpc(HCharacter self, HCharacter other)
     {
-      HCharacter other = popCharacterInstance();
-      HCharacter self  = popCharacterInstance();
+      runOrDefer([self, other]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
-
-      eventQueue->pushGotoObject(other->SO());
+        eventQueue->pushGotoObject(other->SO());
+      });
     }
 
-    void DaedalusVMForGameWorld::external_TA_Min()
+    void DaedalusVMForGameWorld::external_TA_Min(HCharacter self, bs::INT32 start_h,
+                                                 bs::INT32 start_m, bs::INT32 stop_h,
+                                                 bs::INT32 stop_m, bs::INT32 action,
+                                                 bs::String waypoint)
     {
-      bs::String waypoint = popStringValue();
-      SymbolIndex action =
-          popIntValue();  // This does not push onto the function stack for some reason
-      bs::INT32 stop_m  = popIntValue();
-      bs::INT32 stop_h  = popIntValue();
-      bs::INT32 start_m = popIntValue();
-      bs::INT32 start_h = popIntValue();
-      HCharacter self   = popCharacterInstance();
-
       bs::StringUtil::toUpperCase(waypoint);
 
       AI::ScriptState::RoutineTask task;
@@ -774,35 +818,35 @@ namespace REGoth
 
       task.waypoint = waypoint;
 
-      if (action != SYMBOL_INDEX_INVALID)
+      // This does not push onto the function stack for some reason
+      if ((SymbolIndex)action != SYMBOL_INDEX_INVALID)
       {
         task.scriptFunction = scriptSymbols().getSymbolName(action);
       }
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+      runOrDefer([self, task]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      eventQueue->insertRoutineTask(task);
+        eventQueue->insertRoutineTask(task);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_NPC_ExchangeRoutine()
+    void DaedalusVMForGameWorld::external_NPC_ExchangeRoutine(HCharacter self,
+                                                              bs::String routineName)
     {
-      bs::String routineName = popStringValue();
-      HCharacter self        = popCharacterInstance();
-
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
-
       bs::StringUtil::toUpperCase(routineName);
 
-      self->setDailyRoutine(routineName);
+      runOrDefer([self, routineName]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+
+        self->setDailyRoutine(routineName);
 
-      eventQueue->reinitRoutine();
+        eventQueue->reinitRoutine();
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_SetWalkMode()
+    void DaedalusVMForGameWorld::external_AI_SetWalkMode(HCharacter self, bs::INT32 walkModeIndex)
     {
-      bs::INT32 walkModeIndex = popIntValue();
-      HCharacter self         = popCharacterInstance();
-
       AI::WalkMode realWalkMode;
       switch (walkModeIndex)
       {
@@ -834,226 +878,246 @@ namespace REGoth
           REGOTH_THROW(InvalidParametersException, "Invalid Walk-Mode!");
       }
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+      runOrDefer([self, realWalkMode]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      eventQueue->pushSetWalkMode(realWalkMode);
+        eventQueue->pushSetWalkMode(realWalkMode);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_Wait()
+    void DaedalusVMForGameWorld::external_AI_Wait(HCharacter self, float seconds)
     {
-      float seconds   = popFloatValue();
-      HCharacter self = popCharacterInstance();
+      runOrDefer([self, seconds]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
-
-      eventQueue->pushWait(seconds);
+        eventQueue->pushWait(seconds);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_StartState()
+    void DaedalusVMForGameWorld::external_AI_StartState(HCharacter self, bs::INT32 stateFnIndex,
+                                                        bs::INT32 endOldState,
+                                                        const bs::String& waypoint)
     {
-      bs::String waypoint    = popStringValue();
-      bs::INT32 endOldState  = popIntValue();
-      bs::INT32 stateFnIndex = popIntValue();
-      HCharacter self        = popCharacterInstance();
-
       const auto& functionSym = scriptSymbols().getSymbol<SymbolScriptFunction>(stateFnIndex);
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+      bs::String state       = functionSym.name;
+      HCharacter stateOther  = other();
+      HCharacter stateVictim = victim();
 
-      if (endOldState != 0)
-      {
-        // End old state gracefully
-        eventQueue->pushStartScriptState(functionSym.name, waypoint, other(), victim());
-      }
-      else
-      {
-        // Interrupt old state
-        eventQueue->pushInterruptAndStartScriptState(functionSym.name, waypoint, other(), victim());
-      }
+      runOrDefer([self, state, waypoint, endOldState, stateOther, stateVictim]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+
+        if (endOldState != 0)
+        {
+          // End old state gracefully
+          eventQueue->pushStartScriptState(state, waypoint, stateOther, stateVictim);
+        }
+        else
+        {
+          // Interrupt old state
+          eventQueue->pushInterruptAndStartScriptState(state, waypoint, stateOther, stateVictim);
+        }
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_PlayAnimation()
+    void DaedalusVMForGameWorld::external_AI_PlayAnimation(HCharacter self,
+                                                           const bs::String& animation)
     {
-      bs::String animation = popStringValue();
-      HCharacter self      = popCharacterInstance();
-
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
-      eventQueue->pushPlayAnimation(animation);
+      runOrDefer([self, animation]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+        eventQueue->pushPlayAnimation(animation);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetNearestWP()
+    bs::String DaedalusVMForGameWorld::external_Npc_GetNearestWP(HCharacter self)
     {
-      HCharacter self = popCharacterInstance();
-
-      mStack.pushString(self->getNearestWaypoint());
+      return self->getNearestWaypoint();
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetNextWP()
+    bs::String DaedalusVMForGameWorld::external_Npc_GetNextWP(HCharacter self)
     {
-      HCharacter self = popCharacterInstance();
-
-      mStack.pushString(self->getNextWaypoint());
+      return self->getNextWaypoint();
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetDistToWP()
+    bs::INT32 DaedalusVMForGameWorld::external_Npc_GetDistToWP(HCharacter self,
+                                                              const bs::String& waypoint)
     {
-      bs::String waypoint = popStringValue();
-      HCharacter self     = popCharacterInstance();
-
       float distanceMeters = self->getDistanceToWaypoint(waypoint);
 
       if (distanceMeters < 0)
       {
-        mStack.pushInt(INT32_MAX);
+        return INT32_MAX;
       }
       else
       {
-        mStack.pushInt(distanceMeters * 100);
+        return (bs::INT32)(distanceMeters * 100);
       }
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetDistToNpc()
+    bs::INT32 DaedalusVMForGameWorld::external_Npc_GetDistToNpc(HCharacter self, HCharacter other)
     {
-      HCharacter other = popCharacterInstance();
-      HCharacter self  = popCharacterInstance();
-
       // This is sometimes used with Npc_DetectNpc() which is supposed to set
       // `other`. If that doesn't work we'll end up with an invalid handle here.
       if (!other)
       {
-        mStack.pushInt(INT32_MAX);
+        return INT32_MAX;
       }
       else
       {
-        mStack.pushInt(self->getDistanceToObject(other->SO()) * 100);
+        return (bs::INT32)(self->getDistanceToObject(other->SO()) * 100);
       }
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetDistToItem()
+    bs::INT32 DaedalusVMForGameWorld::external_Npc_GetDistToItem(HCharacter self, HItem item)
     {
-      HItem item      = popItemInstance();
-      HCharacter self = popCharacterInstance();
-
-      mStack.pushInt(self->getDistanceToObject(item->SO()) * 100);
+      return (bs::INT32)(self->getDistanceToObject(item->SO()) * 100);
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetDistToPlayer()
+    bs::INT32 DaedalusVMForGameWorld::external_Npc_GetDistToPlayer(HCharacter self)
     {
-      HCharacter self = popCharacterInstance();
-
       // I hope they don't mean the player controlled character but the hero.
       // FIXME: Clarify, does this is supposed to check the distance to the hero?
       //        Might as well fix this if we can easily get the reference to the player
       //        controlled character here. For normal gameplay using the hero should work though.
-      mStack.pushInt(self->getDistanceToHero() * 100);
+      return (bs::INT32)(self->getDistanceToHero() * 100);
     }
 
-    void DaedalusVMForGameWorld::external_Npc_IsNear()
+    bool DaedalusVMForGameWorld::external_Npc_IsNear(HCharacter self, HCharacter other)
     {
-      HCharacter other = popCharacterInstance();
-      HCharacter self  = popCharacterInstance();
+      return self->isNearCharacter(other);
+    }
 
-      bool isNear = self->isNearCharacter(other);
+    void DaedalusVMForGameWorld::external_Npc_SetToFistMode(HCharacter self)
+    {
+      runOrDefer([self]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      mStack.pushInt(isNear ? 1 : 0);
+        eventQueue->pushGoToFistModeImmediate();
+      });
     }
 
-    void DaedalusVMForGameWorld::external_Npc_SetToFistMode()
+    bool DaedalusVMForGameWorld::external_Npc_KnowsInfo(HCharacter self,
+                                                        bs::INT32 infoSymbolIndex)
     {
-      HCharacter self = popCharacterInstance();
+      auto information = self->SO()->getComponent<StoryInformation>();
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+      return information->knowsInfo((SymbolIndex)infoSymbolIndex);
+    }
 
-      eventQueue->pushGoToFistModeImmediate();
+    bool DaedalusVMForGameWorld::external_Npc_RefuseTalk(HCharacter self)
+    {
+      return self->refuseTalk();
     }
 
-    void DaedalusVMForGameWorld::external_Npc_KnowsInfo()
+    void DaedalusVMForGameWorld::external_Npc_SetRefuseTalk(HCharacter self, bs::INT32 seconds)
     {
-      bs::INT32 infoSymbolIndex = popIntValue();
-      HCharacter self           = popCharacterInstance();
+      runOrDefer([self, seconds]() { self->setRefuseTalk(seconds); });
+    }
 
-      const bs::String& infoName = scriptSymbols().getSymbolName(infoSymbolIndex);
-      auto information           = self->SO()->getComponent<StoryInformation>();
+    bs::INT32 DaedalusVMForGameWorld::external_Npc_GetStateTime(HCharacter self)
+    {
+      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      if (information->knowsInfo(infoName))
-      {
-        mStack.pushInt(1);
-      }
-      else
-      {
-        mStack.pushInt(0);
-      }
+      // Scripts expect this value to be rounded down
+      return (bs::INT32)eventQueue->getCurrentStateRunningTime();
     }
 
-    void DaedalusVMForGameWorld::external_Npc_RefuseTalk()
+    void DaedalusVMForGameWorld::external_Npc_PercEnable(HCharacter self, bs::INT32 type,
+                                                         bs::INT32 function)
     {
-      HCharacter self = popCharacterInstance();
+      runOrDefer([self, type, function]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+
+        eventQueue->enablePerception((AI::PerceptionType)type, (SymbolIndex)function);
+      });
+    }
 
-      bs::gDebug().logWarning("[External] Using external stub: NPC_RefuseTalk");
+    void DaedalusVMForGameWorld::external_Npc_PercDisable(HCharacter self, bs::INT32 type)
+    {
+      runOrDefer([self, type]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      mStack.pushInt(0);
+        eventQueue->disablePerception((AI::PerceptionType)type);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetStateTime()
+    void DaedalusVMForGameWorld::external_Npc_SetPercTime(HCharacter self, float seconds)
     {
-      HCharacter self = popCharacterInstance();
+      runOrDefer([self, seconds]() {
+        auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
-      auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
+        eventQueue->setPerceptionInterval(seconds);
+      });
+    }
 
-      // Scripts expect this value to be rounded down
-      mStack.pushInt((bs::INT32)eventQueue->getCurrentStateRunningTime());
+    void DaedalusVMForGameWorld::external_Npc_SendPassivePerc(HCharacter source, bs::INT32 type,
+                                                              HCharacter other, HCharacter victim)
+    {
+      runOrDefer([this, source, type, other, victim]() {
+        HCharacterPerception perception = mWorld->characterPerception();
+
+        if (perception)
+        {
+          perception->sendPassivePerception(source, (AI::PerceptionType)type, other, victim);
+        }
+      });
     }
 
-    void DaedalusVMForGameWorld::external_Npc_Percenable()
+    bool DaedalusVMForGameWorld::external_Npc_CanSeeNpc(HCharacter self, HCharacter target)
     {
-      HCharacter self = popCharacterInstance();
+      return self->canSeeNPC(target->SO());
     }
 
-    void DaedalusVMForGameWorld::external_Npc_GetBodyState()
+    bool DaedalusVMForGameWorld::external_Npc_CanSeeNpcFreeLOS(HCharacter self, HCharacter target)
     {
-      HCharacter self = popCharacterInstance();
+      return self->canSeeNpcFreeLOS(target->SO());
+    }
 
+    bool DaedalusVMForGameWorld::external_Npc_CanSeeItem(HCharacter self, HItem item)
+    {
+      return self->canSeeItem(item->SO());
+    }
+
+    bs::INT32 DaedalusVMForGameWorld::external_Npc_GetBodyState(HCharacter self)
+    {
       // TODO: Implement this. There is no "stub"-debug log here because the function
       //       is called so often and it would spam the terminal.
 
-      mStack.pushInt(0);
+      return 0;
     }
 
-    void DaedalusVMForGameWorld::external_InfoManager_HasFinished()
+    bool DaedalusVMForGameWorld::external_InfoManager_HasFinished()
     {
       // bs::gDebug().logWarning("[External] Using external stub: InfoManager_HasFinished");
 
-      if (gGameplayUI()->isDialogueInProgress())
-      {
-        mStack.pushInt(0);
-      }
-      else
-      {
-        mStack.pushInt(1);
-      }
+      return !gGameplayUI()->isDialogueInProgress();
     }
 
-    void DaedalusVMForGameWorld::external_AI_ProcessInfos()
+    void DaedalusVMForGameWorld::external_AI_ProcessInfos(HCharacter self)
     {
-      HCharacter self = popCharacterInstance();
+      HCharacter otherCharacter = other();
 
-      auto storyInfo = self->SO()->getComponent<StoryInformation>();
+      runOrDefer([self, otherCharacter]() {
+        auto storyInfo = self->SO()->getComponent<StoryInformation>();
 
-      storyInfo->startDialogueWith(other());
+        storyInfo->startDialogueWith(otherCharacter);
+      });
     }
 
-    void DaedalusVMForGameWorld::external_AI_StopProcessInfos()
+    void DaedalusVMForGameWorld::external_AI_StopProcessInfos(HCharacter self)
     {
-      HCharacter self = popCharacterInstance();
+      HCharacter otherCharacter = other();
 
-      auto storyInfo = self->SO()->getComponent<StoryInformation>();
+      runOrDefer([self, otherCharacter]() {
+        auto storyInfo = self->SO()->getComponent<StoryInformation>();
 
-      storyInfo->stopDialogueWith(other());
+        storyInfo->stopDialogueWith(otherCharacter);
+      });
     }
 
     void DaedalusVMForGameWorld::script_PrintPlus(const bs::String& text)
     {
-      mStack.pushString(text);
+      context().stack.pushString(text);
       executeScriptFunction("PrintPlus");
     }
 
@@ -1062,47 +1126,138 @@ namespace REGoth
       bs::Vector<SymbolIndex> instanceSymbols =
           Queries::findAllInstancesOfClass(scriptSymbols(), "C_INFO");
 
-      bs::Vector<ScriptObjectHandle> instances;
-      for (SymbolIndex s : instanceSymbols)
+      mDialogueInfosByNpc.clear();
+      mInfoConditions.clear();
+
+      // Symbols are the same as long as the DAT-file is, so are the ordinals
+      mInfoOrdinals.assign(scriptSymbols().numSymbols(), INFO_ORDINAL_INVALID);
+      mNumInfos = (bs::UINT32)instanceSymbols.size();
+
+      for (bs::UINT32 ordinal = 0; ordinal < mNumInfos; ordinal++)
       {
-        instances.push_back(instanciateClass("C_INFO", s, {}));
+        SymbolIndex s        = instanceSymbols[ordinal];
+        ScriptObjectHandle h = instanciateClass("C_INFO", s, {});
+        ScriptObject& data   = scriptObjects().get(h);
+
+        mInfoOrdinals[s] = ordinal;
+
+        DialogueInfo info;
+        info.name        = data.instanceName;
+        info.instance    = s;
+        info.ordinal     = ordinal;
+        info.priority    = data.intValue("NR");
+        info.isPermanent = data.intValue("PERMANENT") != 0;
+        info.isImportant = data.intValue("IMPORTANT") != 0;
+        info.isTrade     = data.intValue("TRADE") != 0;
+        info.choiceText  = data.stringValue("DESCRIPTION");
+
+        info.conditionFunction =
+            scriptSymbols().findFunctionByAddress(data.functionPointerValue("CONDITION"));
+        info.informationFunction =
+            scriptSymbols().findFunctionByAddress(data.functionPointerValue("INFORMATION"));
+
+        if (info.conditionFunction != SYMBOL_INDEX_INVALID &&
+            mInfoConditions.find(info.conditionFunction) == mInfoConditions.end())
+        {
+          mInfoConditions[info.conditionFunction] = analyzeInfoCondition(info.conditionFunction);
+        }
+
+        SymbolIndex npcSymbol = (SymbolIndex)data.intValue("NPC");
+
+        mDialogueInfosByNpc[npcSymbol].emplace_back(std::move(info));
+      }
+
+      // Infos of the same priority stay in the order they were defined in
+      for (auto& entry : mDialogueInfosByNpc)
+      {
+        std::stable_sort(entry.second.begin(), entry.second.end(),
+                         [](const DialogueInfo& a, const DialogueInfo& b) {
+                           return a.priority < b.priority;
+                         });
       }
 
-      bs::Vector<bs::UINT32> symbolIndices;
-      symbolIndices.reserve(instances.size());
+      bs::UINT32 numMemoizable = 0;
+
+      for (const auto& entry : mInfoConditions)
+      {
+        if (entry.second.isMemoizable) numMemoizable += 1;
+      }
+
+      bs::gDebug().logDebug(bs::StringUtil::format(
+          "[DaedalusVMForGameWorld] {0} of {1} info conditions can be memoized", numMemoizable,
+          mInfoConditions.size()));
+    }
+
+    DaedalusVMForGameWorld::InfoCondition DaedalusVMForGameWorld::analyzeInfoCondition(
+        SymbolIndex function) const
+    {
+      const auto& functionSym = scriptSymbolsConst().getSymbol<SymbolScriptFunction>(function);
+
+      FunctionDependencies dependencies = findFunctionDependencies(functionSym.address);
+
+      SymbolIndex knowsInfo = scriptSymbolsConst().findIndexBySymbolName("NPC_KNOWSINFO");
 
-      for (ScriptObjectHandle h : instances)
+      InfoCondition condition;
+      condition.isMemoizable = !dependencies.hasOtherDependencies;
+
+      // Whether an info is known is tracked via mKnownInfosVersion, any other external could
+      // depend on anything
+      for (SymbolIndex external : dependencies.externalsCalled)
       {
-        symbolIndices.push_back(scriptObjects().get(h).intValue("NPC"));
+        if (external != knowsInfo)
+        {
+          condition.isMemoizable = false;
+        }
       }
 
-      for (bs::UINT32 i = 0; i < (bs::UINT32)instances.size(); i++)
+      // Those are compared directly, as they are set before every call
+      for (SymbolIndex symbol : dependencies.symbolsRead)
       {
-        SymbolIndex npcSymbol         = symbolIndices[i];
-        ScriptObjectHandle infoHandle = instances[i];
+        if (symbol != mSelfSymbol && symbol != mOtherSymbol)
+        {
+          condition.symbolsRead.push_back(symbol);
+        }
+      }
+
+      return condition;
+    }
 
-        mInformationInstancesByNpcs[npcSymbol].push_back(infoHandle);
+    bool DaedalusVMForGameWorld::isMemoizedResultValid(const InfoCondition& condition,
+                                                       HCharacter self, HCharacter other) const
+    {
+      if (!condition.hasResult) return false;
+      if (condition.self != self || condition.other != other) return false;
+      if (condition.knownInfosVersion != mKnownInfosVersion) return false;
+
+      for (size_t i = 0; i < condition.symbolsRead.size(); i++)
+      {
+        if (condition.symbolVersions[i] != symbolWriteVersion(condition.symbolsRead[i]))
+        {
+          return false;
+        }
       }
+
+      return true;
     }
 
-    const bs::Vector<ScriptObjectHandle>& DaedalusVMForGameWorld::allInfosOfNpc(
+    const bs::Vector<DialogueInfo>& DaedalusVMForGameWorld::dialogueInfosOfNpc(
         const bs::String& instanceName) const
     {
       SymbolIndex npcInstance = scriptSymbolsConst().findIndexBySymbolName(instanceName);
 
-      if (mInformationInstancesByNpcs.empty())
+      if (mDialogueInfosByNpc.empty())
       {
         REGOTH_THROW(InvalidStateException,
                      "createAllInformationInstances has not been called or failed!");
       }
 
-      auto it = mInformationInstancesByNpcs.find(npcInstance);
+      auto it = mDialogueInfosByNpc.find(npcInstance);
 
       // Some NPCs don't have anything to say, so they don't appear in this list.
-      if (it == mInformationInstancesByNpcs.end())
+      if (it == mDialogueInfosByNpc.end())
       {
         // It's okay to return this static empty vector here because the return value is const.
-        static bs::Vector<ScriptObjectHandle> s_empty = {};
+        static bs::Vector<DialogueInfo> s_empty = {};
 
         return s_empty;
       }
@@ -1110,6 +1265,62 @@ namespace REGoth
       return it->second;
     }
 
+    void DaedalusVMForGameWorld::createStateFunctionTable()
+    {
+      mStateFunctions.clear();
+
+      const auto& symbols = scriptSymbolsConst();
+
+      bs::Vector<SymbolIndex> functions = symbols.query([](const SymbolBase& s) {
+        return s.type == SymbolType::ScriptFunction;  //
+      });
+
+      const std::pair<bs::String, SymbolIndex StateFunctions::*> suffixes[] = {
+          {"_LOOP", &StateFunctions::loop},
+          {"_END", &StateFunctions::end},
+          {"_INTERRUPT", &StateFunctions::interrupt},
+      };
+
+      for (SymbolIndex function : functions)
+      {
+        const bs::String& name = symbols.getSymbolName(function);
+
+        // Find out whether this is `<main function>_LOOP`, `_END` or `_INTERRUPT`
+        for (const auto& suffix : suffixes)
+        {
+          if (!bs::StringUtil::endsWith(name, suffix.first, false)) continue;
+
+          bs::String mainName = name.substr(0, name.size() - suffix.first.size());
+
+          if (!symbols.hasSymbolWithName(mainName)) continue;
+
+          SymbolIndex mainFunction = symbols.findIndexBySymbolName(mainName);
+
+          if (symbols.getSymbolType(mainFunction) != SymbolType::ScriptFunction) continue;
+
+          mStateFunctions[mainFunction].*suffix.second = function;
+        }
+      }
+    }
+
+    const DaedalusVMForGameWorld::StateFunctions& DaedalusVMForGameWorld::findStateFunctions(
+        SymbolIndex mainFunction) const
+    {
+      auto it = mStateFunctions.find(mainFunction);
+
+      // Most script functions are not states. The ones which are might have no functions
+      // other than the main function.
+      if (it == mStateFunctions.end())
+      {
+        // It's okay to return this static value here because the return value is const.
+        static const StateFunctions s_none = {};
+
+        return s_none;
+      }
+
+      return it->second;
+    }
+
     REGOTH_DEFINE_RTTI(DaedalusVMForGameWorld)
   }  // namespace Scripting
 }  // namespace REGoth
@@ -3,6 +3,7 @@
 #pragma once
 #include "REGothDaedalusVM.hpp"
 #include <BsPrerequisites.h>
+#include <scripting/DialogueInfo.hpp>
 
 namespace REGoth
 {
@@ -23,7 +24,8 @@ namespace REGoth
     class DaedalusVMForGameWorld : public DaedalusVM
     {
     public:
-      DaedalusVMForGameWorld(HGameWorld gameWorld, const bs::Vector<bs::UINT8>& datFileData);
+      DaedalusVMForGameWorld(HGameWorld gameWorld, const bs::String& datFileName,
+                             const bs::Vector<bs::UINT8>& datFileData);
 
       /**
        * Initializes the ScriptVM. To be called after the object is constructed.
@@ -61,10 +63,30 @@ namespace REGoth
        */
       bool runStateLoopFunction(SymbolIndex function, HCharacter self);
 
+      /**
+       * Same as runStateLoopFunction(), but runs on the given execution context with all
+       * side effects deferred into its command buffer. Safe to call from multiple threads
+       * at once, as long as every thread uses its own context. The recorded side effects
+       * must be applied via applySideEffects() once the threads are done.
+       *
+       * Only for functions which canRunOnWorkerThread().
+       *
+       * @param  context  Context to run on. Its instance registers are set to the given objects.
+       *
+       * @return Whether the State is done.
+       */
+      bool runStateLoopFunction(DaedalusExecutionContext& context, SymbolIndex function,
+                                HCharacter self, ScriptObjectHandle other,
+                                ScriptObjectHandle victim, ScriptObjectHandle item);
+
       /**
        * Wrapper to call the function set in `C_INFO.condition` to check whether a dialogue line
        * should be displayed to the user in the UI.
        *
+       * Most condition functions only check some global variables and which infos are known
+       * already. Those are only run again if one of these has changed since the last call with
+       * the same characters, see InfoCondition.
+       *
        * @note  This function will clean the stack! Some script functions don't push a return value
        *        and so we would get whatever was on the stack before. Since this is only called from
        *        engine code, it's okay to throw away the whole script stack here.
@@ -73,6 +95,15 @@ namespace REGoth
        */
       bool runInfoConditionFunction(SymbolIndex function, HCharacter self, HCharacter other);
 
+      /**
+       * To be called whenever any character got to know an info, so conditions checking
+       * `Npc_KnowsInfo()` are run again.
+       */
+      void onKnownInfosChanged()
+      {
+        mKnownInfosVersion += 1;
+      }
+
       /**
        * Wrapper to call the function set in `C_INFO.information`.
        */
@@ -112,22 +143,106 @@ namespace REGoth
       void setSelf(ScriptObjectHandle self);
 
       /**
-       * @return All *Information*-Instances meant for the given NPC. See
+       * @return All *Information*-Instances meant for the given NPC, sorted by priority. See
        * createAllInformationInstances() for more information.
        */
-      const bs::Vector<ScriptObjectHandle>& allInfosOfNpc(const bs::String& instanceName) const;
+      const bs::Vector<DialogueInfo>& dialogueInfosOfNpc(const bs::String& instanceName) const;
+
+      /**
+       * @return Position of the given *Information*-instance among all of them, from 0 to
+       *         numInfos(). INFO_ORDINAL_INVALID, if the symbol is not an *Information*-instance.
+       */
+      bs::UINT32 infoOrdinal(SymbolIndex instance) const
+      {
+        return instance < mInfoOrdinals.size() ? mInfoOrdinals[instance] : INFO_ORDINAL_INVALID;
+      }
+
+      /**
+       * @return Number of *Information*-instances.
+       */
+      bs::UINT32 numInfos() const
+      {
+        return mNumInfos;
+      }
+
+      /**
+       * Optional functions belonging to the main function of a script state, like `ZS_TALK`.
+       * See AI::ScriptState for more information.
+       */
+      struct StateFunctions
+      {
+        SymbolIndex loop      = SYMBOL_INDEX_INVALID;  // e.g. `ZS_TALK_LOOP`
+        SymbolIndex end       = SYMBOL_INDEX_INVALID;  // e.g. `ZS_TALK_END`
+        SymbolIndex interrupt = SYMBOL_INDEX_INVALID;  // e.g. `ZS_TALK_INTERRUPT`
+      };
+
+      /**
+       * @param  mainFunction  Symbol of the main function of a state, e.g. `ZS_TALK`.
+       *
+       * @return The functions of the state the given main function belongs to. All invalid
+       *         if the function has none of them.
+       */
+      const StateFunctions& findStateFunctions(SymbolIndex mainFunction) const;
 
     protected:
+      template <typename T>
+      friend struct ExternalArgument;
+
+      /**
+       * What the condition function of an info depends on and its last result. Only
+       * functions which depend on nothing but global variables, instance symbols and
+       * `Npc_KnowsInfo()` are memoized.
+       */
+      struct InfoCondition
+      {
+        bool isMemoizable = false;
+
+        /**
+         * Global variables and instance symbols read, other than `SELF` and `OTHER`.
+         */
+        bs::Vector<SymbolIndex> symbolsRead;
+
+        /**
+         * Last result, valid as long as the version of every symbol read and of the known
+         * infos is still the same and the function is run for the same characters.
+         */
+        bool hasResult = false;
+        bool result    = false;
+        HCharacter self;
+        HCharacter other;
+        bs::Vector<bs::UINT32> symbolVersions;
+        bs::UINT32 knownInfosVersion = 0;
+      };
 
       /**
-       * Fills mAllInformationInstances. This is done here at one place because otherwise
+       * Fills mDialogueInfosByNpc. This is done here at one place because otherwise
        * every single created NPC would need to loop through all symbols every time, find
        * the `C_INFO` instances, create instances, check whether they are for the correct
        * npc and so on. This would be rather inefficient, so we just keep a list of all
        * *Information*-instances here.
+       *
+       * Also finds out what the condition functions of the infos depend on, see InfoCondition.
        */
       void createAllInformationInstances();
 
+      /**
+       * @return What the given condition function depends on.
+       */
+      InfoCondition analyzeInfoCondition(SymbolIndex function) const;
+
+      /**
+       * @return Whether the last result of the given condition is still valid.
+       */
+      bool isMemoizedResultValid(const InfoCondition& condition, HCharacter self,
+                                 HCharacter other) const;
+
+      /**
+       * Fills mStateFunctions. Looking up the loop-, end- and interrupt-functions by name would
+       * mean building and looking up three strings on every state change, which happen a lot.
+       * Instead, all script functions are sorted into the table once.
+       */
+      void createStateFunctionTable();
+
       /**
        * Does popInstance() and resolves the Character-component.
        *
@@ -186,57 +301,73 @@ namespace REGoth
       HItem getInstanceItem(SymbolIndex symbolIndex) const;
 
       void script_PrintPlus(const bs::String& text);
-      void external_PrintDebugInstCh();
-      void external_Print();
-      void external_HLP_Random();
+      void external_PrintDebugInstCh(bs::INT32 character, const bs::String& text);
+      void external_Print(const bs::String& text);
+      bs::INT32 external_HLP_Random(bs::INT32 max);
       void external_HLP_GetNpc();
-      void external_HLP_IsValidNpc();
-      void external_HLP_IsValidItem();
-      void external_IntToString();
-      void external_IntToFloat();
-      void external_FloatToInt();
-      void external_ConcatStrings();
-      void external_WLD_InsertItem();
-      void external_WLD_InsertNpc();
-      void external_WLD_GetDay();
-      void external_WLD_IsTime();
-      void external_WLD_SetTime();
-      void external_NPC_IsPlayer();
-      void external_NPC_SetTalentSkill();
-      void external_NPC_EquipItem();
-      void external_NPC_CreateInventoryItems();
-      void external_NPC_CreateInventoryItem();
-      void external_MDL_SetVisual();
-      void external_MDL_SetVisualBody();
-      void external_AI_GotoWaypoint();
-      void external_AI_GotoFreepoint();
-      void external_AI_GotoNextFreepoint();
-      void external_AI_GotoNpc();
-      void external_TA_Min();
-      void external_NPC_ExchangeRoutine();
-      void external_AI_SetWalkMode();
-      void external_AI_Wait();
-      void external_AI_StartState();
-      void external_AI_PlayAnimation();
-      void external_Npc_GetNearestWP();
-      void external_Npc_GetNextWP();
-      void external_Npc_GetDistToWP();
-      void external_Npc_GetDistToNpc();
-      void external_Npc_GetDistToItem();
-      void external_Npc_GetDistToPlayer();
-      void external_Npc_IsNear();
-      void external_Npc_SetToFistMode();
-      void external_Npc_KnowsInfo();
-      void external_Npc_RefuseTalk();
-      void external_Npc_GetStateTime();
-      void external_Npc_Percenable();
-      void external_Npc_GetBodyState();
-      void external_InfoManager_HasFinished();
-      void external_AI_ProcessInfos();
-      void external_AI_StopProcessInfos();
+      bool external_HLP_IsValidNpc(HCharacter character);
+      bool external_HLP_IsValidItem(HItem item);
+      bs::String external_IntToString(bs::INT32 value);
+      float external_IntToFloat(bs::INT32 value);
+      bs::INT32 external_FloatToInt(float value);
+      bs::String external_ConcatStrings(const bs::String& a, const bs::String& b);
+      void external_WLD_InsertItem(bs::INT32 instance, const bs::String& spawnpoint);
+      void external_WLD_InsertNpc(bs::INT32 instance, const bs::String& waypoint);
+      bs::INT32 external_WLD_GetDay();
+      bool external_WLD_IsTime(bs::INT32 hour1, bs::INT32 min1, bs::INT32 hour2, bs::INT32 min2);
+      void external_WLD_SetTime(bs::INT32 hour, bs::INT32 min);
+      bool external_NPC_IsPlayer(HCharacter character);
+      void external_NPC_SetTalentSkill(HCharacter character, bs::INT32 talent, bs::INT32 skill);
+      void external_NPC_EquipItem(HCharacter character, const bs::String& instance);
+      void external_NPC_CreateInventoryItems(HCharacter character, const bs::String& instance,
+                                             bs::INT32 num);
+      void external_NPC_CreateInventoryItem(HCharacter character, const bs::String& instance);
+      void external_MDL_SetVisual(HCharacter character, bs::String visual);
+      void external_MDL_SetVisualBody(HCharacter character, const bs::String& bodyMesh,
+                                      bs::INT32 bodyTexIndex, bs::INT32 bodyTexColor,
+                                      const bs::String& headMesh, bs::INT32 headTexIndex,
+                                      bs::INT32 teethTexIndex, bs::INT32 armorInstance);
+      void external_AI_GotoWaypoint(HCharacter self, bs::String waypoint);
+      void external_AI_GotoFreepoint(HCharacter self, bs::String freepoint);
+      void external_AI_GotoNextFreepoint(HCharacter self, bs::String freepointName);
+      void external_AI_GotoNpc(HCharacter self, HCharacter other);
+      void external_TA_Min(HCharacter self, bs::INT32 start_h, bs::INT32 start_m,
+                           bs::INT32 stop_h, bs::INT32 stop_m, bs::INT32 action,
+                           bs::String waypoint);
+      void external_NPC_ExchangeRoutine(HCharacter self, bs::String routineName);
+      void external_AI_SetWalkMode(HCharacter self, bs::INT32 walkModeIndex);
+      void external_AI_Wait(HCharacter self, float seconds);
+      void external_AI_StartState(HCharacter self, bs::INT32 stateFnIndex, bs::INT32 endOldState,
+                                  const bs::String& waypoint);
+      void external_AI_PlayAnimation(HCharacter self, const bs::String& animation);
+      bs::String external_Npc_GetNearestWP(HCharacter self);
+      bs::String external_Npc_GetNextWP(HCharacter self);
+      bs::INT32 external_Npc_GetDistToWP(HCharacter self, const bs::String& waypoint);
+      bs::INT32 external_Npc_GetDistToNpc(HCharacter self, HCharacter other);
+      bs::INT32 external_Npc_GetDistToItem(HCharacter self, HItem item);
+      bs::INT32 external_Npc_GetDistToPlayer(HCharacter self);
+      bool external_Npc_IsNear(HCharacter self, HCharacter other);
+      void external_Npc_SetToFistMode(HCharacter self);
+      bool external_Npc_KnowsInfo(HCharacter self, bs::INT32 infoSymbolIndex);
+      bool external_Npc_RefuseTalk(HCharacter self);
+      void external_Npc_SetRefuseTalk(HCharacter self, bs::INT32 seconds);
+      bs::INT32 external_Npc_GetStateTime(HCharacter self);
+      void external_Npc_PercEnable(HCharacter self, bs::INT32 type, bs::INT32 function);
+      void external_Npc_PercDisable(HCharacter self, bs::INT32 type);
+      void external_Npc_SetPercTime(HCharacter self, float seconds);
+      void external_Npc_SendPassivePerc(HCharacter source, bs::INT32 type, HCharacter other,
+                                        HCharacter victim);
+      bool external_Npc_CanSeeNpc(HCharacter self, HCharacter target);
+      bool external_Npc_CanSeeNpcFreeLOS(HCharacter self, HCharacter target);
+      bool external_Npc_CanSeeItem(HCharacter self, HItem item);
+      bs::INT32 external_Npc_GetBodyState(HCharacter self);
+      bool external_InfoManager_HasFinished();
+      void external_AI_ProcessInfos(HCharacter self);
+      void external_AI_StopProcessInfos(HCharacter self);
 
       void fillSymbolStorage() override;
       void registerAllExternals() override;
+      bs::INT32 findInstanceRegister(SymbolIndex symbolIndex) const override;
 
     protected:
       /** Handle to the game world this is used in */
@@ -249,8 +380,21 @@ namespace REGoth
       SymbolIndex mVictimSymbol = SYMBOL_INDEX_INVALID;
       SymbolIndex mItemSymbol   = SYMBOL_INDEX_INVALID;
 
-      /** Cache of all information instances for all NPCs */
-      bs::Map<SymbolIndex, bs::Vector<ScriptObjectHandle>> mInformationInstancesByNpcs;
+      /** Cache of all information instances for all NPCs, sorted by priority. Not saved. */
+      bs::UnorderedMap<SymbolIndex, bs::Vector<DialogueInfo>> mDialogueInfosByNpc;
+
+      /** Ordinal of every *Information*-instance by symbol index, see infoOrdinal(). */
+      bs::Vector<bs::UINT32> mInfoOrdinals;
+      bs::UINT32 mNumInfos = 0;
+
+      /** Condition functions of all infos. Not saved. */
+      bs::UnorderedMap<SymbolIndex, InfoCondition> mInfoConditions;
+
+      /** Counts how often any character got to know an info, see onKnownInfosChanged(). */
+      bs::UINT32 mKnownInfosVersion = 0;
+
+      /** Functions of all script states by their main function. Not saved. */
+      bs::UnorderedMap<SymbolIndex, StateFunctions> mStateFunctions;
 
     public:
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(DaedalusVMForGameWorld);
@@ -258,5 +402,37 @@ namespace REGoth
     protected:
       DaedalusVMForGameWorld() = default;  // For RTTI
     };
+
+    template <>
+    struct ExternalArgument<HCharacter>
+    {
+      void pop(DaedalusVMForGameWorld& vm)
+      {
+        value = vm.popCharacterInstance();
+      }
+
+      HCharacter&& get()
+      {
+        return std::move(value);
+      }
+
+      HCharacter value;
+    };
+
+    template <>
+    struct ExternalArgument<HItem>
+    {
+      void pop(DaedalusVMForGameWorld& vm)
+      {
+        value = vm.popItemInstance();
+      }
+
+      HItem&& get()
+      {
+        return std::move(value);
+      }
+
+      HItem value;
+    };
   }  // namespace Scripting
 }  // namespace REGoth
@@ -2,14 +2,20 @@
 #include "DATSymbolStorageLoader.hpp"
 #include "DaedalusClassVarResolver.hpp"
 #include "DaedalusDisassembler.hpp"
+#include "DaedalusExecutionContext.hpp"
 #include <RTTI/RTTI_REGothDaedalusVM.hpp>
+#include <algorithm>
 #include <daedalus/DATFile.h>
 #include <exception/Throw.hpp>
+#include <hashing/ContentHash.hpp>
+#include <original-content/VirtualFileSystem.hpp>
 
 namespace REGoth
 {
   namespace Scripting
   {
+    constexpr bs::UINT32 DaedalusVM::NO_EXTERNAL;
+
     const bs::Set<bs::String> FUNCTIONS_TO_ACTIVATE_DISASSEMBLER_FOR = {
         "DIA_BAALPARVEZ_GOTOPSI_CONDITION",
         "DIA_BAALPARVEZ_GOTOPSI_INFO",
@@ -23,18 +29,301 @@ namespace REGoth
         "PRINTDEBUGINT",
     };
 
-    DaedalusVM::DaedalusVM(const bs::Vector<bs::UINT8>& datFileData)
+    /**
+     * Context the scripts on this thread are currently running with. If not set, the VMs main
+     * context is used.
+     */
+    static thread_local DaedalusExecutionContext* s_activeContext = nullptr;
+
+    DaedalusVM::DaedalusVM(const bs::String& datFileName,
+                           const bs::Vector<bs::UINT8>& datFileData)
+        : mDatFileName(datFileName)
+        , mDatFileHash(Hashing::contentHash(datFileData))
     {
       mDatFile = bs::bs_shared_ptr_new<Daedalus::DATFile>(datFileData.data(), datFileData.size());
-      mClassVarResolver =
-          bs::bs_shared_ptr_new<DaedalusClassVarResolver>(mScriptSymbols, mScriptObjects);
-      mDatFileData = datFileData;
+      mMainContext = createExecutionContext();
+    }
+
+    void DaedalusVM::rebuildFromDatFile()
+    {
+      bs::Vector<bs::UINT8> datFileData = gVirtualFileSystem().readFile(mDatFileName);
+
+      if (Hashing::contentHash(datFileData) != mDatFileHash)
+      {
+        REGOTH_THROW(InvalidStateException,
+                     mDatFileName + " differs from the one the savegame was made with!");
+      }
+
+      mDatFile = bs::bs_shared_ptr_new<Daedalus::DATFile>(datFileData.data(), datFileData.size());
+
+      // Also registers the externals again
+      fillSymbolStorage();
+
+      mScriptSymbols.restoreSerializedValues();
+
+      mMainContext = createExecutionContext();
+
+      mClassTemplates.createClassTemplates(mScriptSymbols);
+    }
+
+    bs::SPtr<DaedalusExecutionContext> DaedalusVM::createExecutionContext()
+    {
+      return bs::bs_shared_ptr_new<DaedalusExecutionContext>(mScriptSymbols, mScriptObjects);
+    }
+
+    DaedalusExecutionContext& DaedalusVM::context() const
+    {
+      return s_activeContext ? *s_activeContext : *mMainContext;
+    }
+
+    DaedalusStack& DaedalusVM::stack() const
+    {
+      return context().stack;
+    }
+
+    bool DaedalusVM::isMainContextActive() const
+    {
+      return !s_activeContext || s_activeContext == mMainContext.get();
+    }
+
+    DaedalusVM::ScopedExecutionContext::ScopedExecutionContext(DaedalusExecutionContext& context)
+        : mPreviousContext(s_activeContext)
+    {
+      s_activeContext = &context;
+    }
+
+    DaedalusVM::ScopedExecutionContext::~ScopedExecutionContext()
+    {
+      s_activeContext = mPreviousContext;
+    }
+
+    ScriptObjectHandle DaedalusVM::getInstanceOfSymbol(SymbolIndex symbolIndex) const
+    {
+      bs::INT32 reg = isMainContextActive() ? -1 : findInstanceRegister(symbolIndex);
+
+      if (reg >= 0)
+      {
+        return context().instanceRegisters[reg];
+      }
+
+      return readStaged(mScriptSymbols.getSymbol<SymbolInstance>(symbolIndex).instance);
+    }
+
+    void DaedalusVM::setInstanceOfSymbol(SymbolIndex symbolIndex, ScriptObjectHandle scriptObject)
+    {
+      bs::INT32 reg = isMainContextActive() ? -1 : findInstanceRegister(symbolIndex);
+
+      if (reg >= 0)
+      {
+        context().instanceRegisters[reg] = scriptObject;
+        return;
+      }
+
+      SymbolInstance& symbol = mScriptSymbols.getSymbol<SymbolInstance>(symbolIndex);
+
+      stageWriteIfShared(symbolIndex, symbol.instance) = scriptObject;
+    }
+
+    void DaedalusVM::runOrDefer(std::function<void()> command)
+    {
+      DaedalusExecutionContext& ctx = context();
+
+      if (ctx.isDeferringSideEffects)
+      {
+        ctx.commandBuffer.defer(std::move(command));
+      }
+      else
+      {
+        command();
+      }
+    }
+
+    template <typename T>
+    T& DaedalusVM::stageWriteIfShared(SymbolIndex symbolIndex, T& target)
+    {
+      DaedalusExecutionContext& ctx = context();
+
+      const SymbolBase& symbol = mScriptSymbols.getSymbolBase(symbolIndex);
+
+      if (!ctx.isDeferringSideEffects)
+      {
+        if (!symbol.isClassVar) markSymbolWritten(symbolIndex);
+
+        return target;
+      }
+
+      // Members are staged as well, even those of SELF: Other contexts may be reading the same
+      // object as their OTHER or VICTIM at the same time.
+
+      // Locals and parameters are only meaningful while the function runs, and other contexts
+      // are running the same functions at the same time
+      bool writeBack = !isLocalSymbol(symbolIndex);
+
+      // Counted once the write actually happens, see applySideEffects()
+      if (writeBack && !symbol.isClassVar)
+      {
+        ctx.commandBuffer.recordSymbolWrite(symbolIndex);
+      }
+
+      return ctx.commandBuffer.stageWrite(target, writeBack);
+    }
+
+    template <typename T>
+    const T& DaedalusVM::readStaged(const T& value) const
+    {
+      const DaedalusExecutionContext& ctx = context();
+
+      if (!ctx.isDeferringSideEffects) return value;
+
+      return ctx.commandBuffer.stagedValueOf(value);
+    }
+
+    bool DaedalusVM::isLocalSymbol(SymbolIndex symbolIndex) const
+    {
+      return symbolIndex < mIsLocalSymbol.size() && mIsLocalSymbol[symbolIndex];
+    }
+
+    void DaedalusVM::applySideEffects(DaedalusExecutionContext& context)
+    {
+      for (SymbolIndex symbolIndex : context.commandBuffer.writtenSymbols())
+      {
+        markSymbolWritten(symbolIndex);
+      }
+
+      context.commandBuffer.apply();
+    }
+
+    void DaedalusVM::markSymbolWritten(SymbolIndex symbolIndex)
+    {
+      if (symbolIndex >= mSymbolWriteVersions.size())
+      {
+        mSymbolWriteVersions.resize(mScriptSymbols.numSymbols(), 0);
+      }
+
+      mSymbolWriteVersions[symbolIndex] += 1;
+    }
+
+    DaedalusVM::FunctionDependencies DaedalusVM::findFunctionDependencies(
+        bs::UINT32 address) const
+    {
+      FunctionDependencies result;
+
+      bs::Set<SymbolIndex> symbolsRead;
+      bs::Set<SymbolIndex> externalsCalled;
+
+      // Every branch and called function is followed, so instructions are visited only once
+      bs::Set<bs::UINT32> visited;
+      bs::Vector<bs::UINT32> toVisit = {address};
+
+      auto readSymbol = [&](SymbolIndex index) {
+        const SymbolBase& symbol = mScriptSymbols.getSymbolBase(index);
+
+        switch (symbol.type)
+        {
+          case SymbolType::Int:
+          case SymbolType::Float:
+          case SymbolType::String:
+          case SymbolType::Instance:
+            if (symbol.isClassVar)
+            {
+              result.hasOtherDependencies = true;
+            }
+            else
+            {
+              symbolsRead.insert(index);
+            }
+            break;
+
+          default:
+            // Function pointers and other constants
+            break;
+        }
+      };
+
+      while (!toVisit.empty())
+      {
+        bs::UINT32 pc = toVisit.back();
+        toVisit.pop_back();
+
+        if (!visited.insert(pc).second) continue;
+
+        Daedalus::PARStackOpCode opcode = mDatFile->getStackOpCode(pc);
+
+        bool continuesToNext = true;
+
+        switch (opcode.op)
+        {
+          case Daedalus::EParOp_PushVar:
+          case Daedalus::EParOp_PushArrayVar:
+          case Daedalus::EParOp_PushInstance:
+            readSymbol((SymbolIndex)opcode.symbol);
+            break;
+
+          case Daedalus::EParOp_Jump:
+            toVisit.push_back((bs::UINT32)opcode.address);
+            continuesToNext = false;
+            break;
+
+          case Daedalus::EParOp_JumpIf:
+            toVisit.push_back((bs::UINT32)opcode.address);
+            break;
+
+          case Daedalus::EParOp_Call:
+            toVisit.push_back((bs::UINT32)opcode.address);
+            break;
+
+          case Daedalus::EParOp_CallExternal:
+            externalsCalled.insert((SymbolIndex)opcode.symbol);
+            break;
+
+          case Daedalus::EParOp_Ret:
+            continuesToNext = false;
+            break;
+
+          case Daedalus::EParOp_AssignFunc:
+          case Daedalus::EParOp_AssignString:
+          case Daedalus::EParOp_AssignFloat:
+          case Daedalus::EParOp_AssignInstance:
+          case Daedalus::EParOp_Assign:
+          case Daedalus::EParOp_AssignAdd:
+          case Daedalus::EParOp_AssignSubtract:
+          case Daedalus::EParOp_AssignMultiply:
+          case Daedalus::EParOp_AssignDivide:
+          case Daedalus::EParOp_AssignStringRef:
+            result.hasOtherDependencies = true;
+            break;
+
+          default:
+            // Arithmetic, logic, pushing constants and SetInstance only work on the stack
+            break;
+        }
+
+        if (continuesToNext)
+        {
+          toVisit.push_back(pc + opcode.opSize);
+        }
+      }
+
+      result.symbolsRead.assign(symbolsRead.begin(), symbolsRead.end());
+      result.externalsCalled.assign(externalsCalled.begin(), externalsCalled.end());
+
+      return result;
     }
 
     void DaedalusVM::fillSymbolStorage()
     {
       REGoth::Scripting::convertDatToREGothSymbolStorage(mScriptSymbols, *mDatFile);
 
+      // Locals and parameters are named like `FUNCTION.NAME`, as are the members of classes
+      mIsLocalSymbol.assign(mScriptSymbols.numSymbols(), false);
+
+      for (SymbolIndex i = 0; i < mScriptSymbols.numSymbols(); i++)
+      {
+        const SymbolBase& symbol = mScriptSymbols.getSymbolBase(i);
+
+        mIsLocalSymbol[i] = !symbol.isClassVar && symbol.name.find('.') != bs::String::npos;
+      }
+
       registerAllExternals();
     }
 
@@ -57,23 +346,25 @@ namespace REGoth
 
       const auto& symbol = mScriptSymbols.getSymbol<SymbolScriptFunction>(upper);
 
-      mPC = symbol.address;
+      context().pc = symbol.address;
 
       executeUntilReturn();
     }
 
     void DaedalusVM::executeScriptFunction(bs::UINT32 address)
     {
-      mPC = address;
+      context().pc = address;
 
       executeUntilReturn();
     }
 
     void DaedalusVM::executeUntilReturn()
     {
-      bool wasDisassemblerEnabledBefore = mIsDisassemblerEnabled;
+      DaedalusExecutionContext& ctx = context();
+
+      bool wasDisassemblerEnabledBefore = ctx.isDisassemblerEnabled;
 
-      auto symIndex = scriptSymbols().findFunctionByAddress(mPC);
+      auto symIndex = scriptSymbols().findFunctionByAddress(ctx.pc);
 
       // TODO: Guard these by some configuration variable so they only run during development
       if (symIndex != SYMBOL_INDEX_INVALID)
@@ -82,17 +373,17 @@ namespace REGoth
 
         if (shouldEnableDisassemblerForFunction(name))
         {
-          mIsDisassemblerEnabled = true;
+          ctx.isDisassemblerEnabled = true;
         }
 
-        if (mIsDisassemblerEnabled && shouldHideFunctionInDisassembly(name))
+        if (ctx.isDisassemblerEnabled && shouldHideFunctionInDisassembly(name))
         {
-          mIsDisassemblerEnabled = false;
+          ctx.isDisassemblerEnabled = false;
         }
 
-        if (mIsDisassemblerEnabled)
+        if (ctx.isDisassemblerEnabled)
         {
-          findFunctionAtAddressAndLog(mPC);
+          findFunctionAtAddressAndLog(ctx.pc);
         }
       }
 
@@ -103,14 +394,16 @@ namespace REGoth
         didNotReachReturn = executeInstructionAtPC();
       } while (didNotReachReturn);
 
-      mIsDisassemblerEnabled = wasDisassemblerEnabledBefore;
+      ctx.isDisassemblerEnabled = wasDisassemblerEnabledBefore;
     }
 
     bool DaedalusVM::executeInstructionAtPC()
     {
-      Daedalus::PARStackOpCode opcode = mDatFile->getStackOpCode(mPC);
+      DaedalusExecutionContext& ctx = context();
 
-      mPC += opcode.opSize;
+      Daedalus::PARStackOpCode opcode = mDatFile->getStackOpCode(ctx.pc);
+
+      ctx.pc += opcode.opSize;
 
       switch (opcode.op)
       {
@@ -123,12 +416,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs + rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -138,12 +431,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs - rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -153,12 +446,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs * rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -168,12 +461,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs / rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -183,12 +476,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs % rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -201,12 +494,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs | rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -216,12 +509,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs & rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -231,12 +524,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs << rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -246,12 +539,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs >> rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -260,12 +553,12 @@ namespace REGoth
           bs::INT32 lhs = popIntValue();
           bs::INT32 res = ~lhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -278,12 +571,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs || rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -293,12 +586,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs && rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -311,12 +604,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs < rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -326,12 +619,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs > rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -341,12 +634,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs <= rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -356,12 +649,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs == rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -371,12 +664,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs != rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -386,12 +679,12 @@ namespace REGoth
           bs::INT32 rhs = popIntValue();
           bs::INT32 res = lhs >= rhs ? 1 : 0;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -403,12 +696,12 @@ namespace REGoth
           bs::INT32 lhs = popIntValue();
           bs::INT32 res = +lhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -417,12 +710,12 @@ namespace REGoth
           bs::INT32 lhs = popIntValue();
           bs::INT32 res = -lhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -431,12 +724,12 @@ namespace REGoth
           bs::INT32 lhs = popIntValue();
           bs::INT32 res = !lhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
           }
 
-          mStack.pushInt(res);
+          ctx.stack.pushInt(res);
         }
         break;
 
@@ -444,16 +737,16 @@ namespace REGoth
           // -----------------------------------------------------------------------------------
 
         case Daedalus::EParOp_PushInt:
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(opcode.value), "", "");
           }
 
-          mStack.pushInt(opcode.value);
+          ctx.stack.pushInt(opcode.value);
           break;
 
         case Daedalus::EParOp_PushVar:
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, "", "", "");
           }
@@ -462,16 +755,16 @@ namespace REGoth
           break;
 
         case Daedalus::EParOp_PushInstance:
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, "", "", "");
           }
 
-          mStack.pushInstance((bs::UINT32)opcode.symbol);
+          ctx.stack.pushInstance((bs::UINT32)opcode.symbol);
           break;
 
         case Daedalus::EParOp_PushArrayVar:
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, "", "", "");
           }
@@ -485,10 +778,10 @@ namespace REGoth
         case Daedalus::EParOp_AssignFunc:
           // Function Pointes are pushed as intergers
           {
-            SymbolIndex targetIndex = mStack.popFunction();
+            SymbolIndex targetIndex = ctx.stack.popFunction();
             SymbolIndex sourceIndex = (SymbolIndex)popIntValue();
 
-            if (mIsDisassemblerEnabled)
+            if (ctx.isDisassemblerEnabled)
             {
               disassembleAndLogOpcode(opcode, "", "", "");
             }
@@ -531,11 +824,14 @@ namespace REGoth
 
             if (target.isClassVar)
             {
-              mClassVarResolver->resolveClassVariableFunctionPointer(target.name) = sourceAddress;
+              bs::UINT32& address =
+                  ctx.classVarResolver.resolveClassVariableFunctionPointer(target.name);
+
+              stageWriteIfShared(targetIndex, address) = sourceAddress;
             }
             else
             {
-              target.address = sourceAddress;
+              stageWriteIfShared(targetIndex, target.address) = sourceAddress;
             }
           }
           break;
@@ -545,7 +841,7 @@ namespace REGoth
           auto& lhs       = popStringReference();
           const auto& rhs = popStringValue();
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, rhs, lhs, "");
           }
@@ -560,7 +856,7 @@ namespace REGoth
           auto& lhs       = popFloatReference();
           const auto& rhs = popFloatValue();
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(rhs), bs::toString(lhs), "");
           }
@@ -572,18 +868,18 @@ namespace REGoth
         case Daedalus::EParOp_AssignInstance:
           // -
           {
-            SymbolIndex targetIndex = mStack.popInstance();
-            SymbolIndex sourceIndex = mStack.popInstance();
+            SymbolIndex targetIndex = ctx.stack.popInstance();
+            SymbolIndex sourceIndex = ctx.stack.popInstance();
 
             auto& target = mScriptSymbols.getSymbol<SymbolInstance>(targetIndex);
             auto& source = mScriptSymbols.getSymbol<SymbolInstance>(sourceIndex);
 
-            if (mIsDisassemblerEnabled)
+            if (ctx.isDisassemblerEnabled)
             {
               disassembleAndLogOpcode(opcode, target.name, source.name, "");
             }
 
-            target.instance = source.instance;
+            setInstanceOfSymbol(targetIndex, getInstanceOfSymbol(sourceIndex));
           }
           break;
 
@@ -592,7 +888,7 @@ namespace REGoth
           auto& lhs       = popIntReference();
           const auto& rhs = popIntValue();
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
@@ -607,7 +903,7 @@ namespace REGoth
           const auto& rhs = popIntValue();
           auto res        = lhs + rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
@@ -622,7 +918,7 @@ namespace REGoth
           const auto& rhs = popIntValue();
           auto res        = lhs - rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
@@ -637,7 +933,7 @@ namespace REGoth
           const auto& rhs = popIntValue();
           auto res        = lhs * rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
@@ -652,7 +948,7 @@ namespace REGoth
           const auto& rhs = popIntValue();
           auto res        = lhs / rhs;
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
@@ -669,7 +965,7 @@ namespace REGoth
           // ----------------------------------------------------------------------------
 
         case Daedalus::EParOp_Ret:
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
@@ -678,19 +974,19 @@ namespace REGoth
           return false;
 
         case Daedalus::EParOp_Jump:
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
 
-          mPC = (bs::UINT32)opcode.address;
+          ctx.pc = (bs::UINT32)opcode.address;
           break;
 
         case Daedalus::EParOp_JumpIf:
         {
           bs::UINT32 lhs = popIntValue();
 
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode, bs::toString(lhs));
           }
@@ -698,53 +994,45 @@ namespace REGoth
           // Jump if value on stack is 0
           if (!lhs)
           {
-            mPC = (bs::UINT32)opcode.address;
+            ctx.pc = (bs::UINT32)opcode.address;
           }
         }
         break;
 
         case Daedalus::EParOp_Call:
         {
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
 
           // Save some of this functions state and execute the whole sub-function
-          SymbolIndex currentInstance = mClassVarResolver->getCurrentInstance();
-          bs::UINT32 pc               = mPC;
+          SymbolIndex currentInstance = ctx.classVarResolver.getCurrentInstance();
+          bs::UINT32 pc               = ctx.pc;
 
-          mPC = (bs::UINT32)opcode.address;
-          mCallDepth += 1;
+          ctx.pc = (bs::UINT32)opcode.address;
+          ctx.callDepth += 1;
 
           executeUntilReturn();
 
-          mCallDepth -= 1;
-          mPC = pc;
-          mClassVarResolver->setCurrentInstance(currentInstance);
+          ctx.callDepth -= 1;
+          ctx.pc = pc;
+          ctx.classVarResolver.setCurrentInstance(currentInstance);
         }
         break;
 
         case Daedalus::EParOp_CallExternal:
         {
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
 
-          auto it = mExternals.find(opcode.symbol);
+          const ExternalFunction* external = findExternal(opcode.symbol);
 
-          if (it != mExternals.end())
+          if (external)
           {
-            SymbolIndex currentInstance = mClassVarResolver->getCurrentInstance();
-            bs::UINT32 pc               = mPC;
-            mCallDepth += 1;
-
-            (this->*it->second)();
-
-            mCallDepth -= 1;
-            mPC = pc;
-            mClassVarResolver->setCurrentInstance(currentInstance);
+            runExternal(opcode.symbol, *external);
           }
           else
           {
@@ -756,13 +1044,13 @@ namespace REGoth
             switch (sym.returnType)
             {
               case ReturnType::Int:
-                mStack.pushInt(0);
+                ctx.stack.pushInt(0);
                 break;
               case ReturnType::Float:
-                mStack.pushFloat(0.0f);
+                ctx.stack.pushFloat(0.0f);
                 break;
               case ReturnType::String:
-                mStack.pushString("");
+                ctx.stack.pushString("");
                 break;
               case ReturnType::Invalid:
               case ReturnType::Void:
@@ -782,13 +1070,12 @@ namespace REGoth
 
         case Daedalus::EParOp_SetInstance:
         {
-          if (mIsDisassemblerEnabled)
+          if (ctx.isDisassemblerEnabled)
           {
             disassembleAndLogOpcode(opcode);
           }
 
-          const SymbolInstance& instance = mScriptSymbols.getSymbol<SymbolInstance>(opcode.symbol);
-          mClassVarResolver->setCurrentInstance(instance.instance);
+          ctx.classVarResolver.setCurrentInstance(getInstanceOfSymbol(opcode.symbol));
         }
         break;
 
@@ -805,43 +1092,86 @@ namespace REGoth
 
     bs::INT32 DaedalusVM::popIntValue()
     {
-      if (mStack.isTopOfIntStackVariable())
+      DaedalusExecutionContext& ctx = context();
+
+      if (ctx.stack.isTopOfIntStackVariable())
       {
-        return popIntReference();
+        return readStaged(resolveIntVariable(ctx.stack.popIntVariable()));
       }
       else
       {
-        return mStack.popInt();
+        return ctx.stack.popInt();
       }
     }
 
     float DaedalusVM::popFloatValue()
     {
-      if (mStack.isTopOfFloatStackVariable())
+      DaedalusExecutionContext& ctx = context();
+
+      if (ctx.stack.isTopOfFloatStackVariable())
       {
-        return popFloatReference();
+        return readStaged(resolveFloatVariable(ctx.stack.popFloatVariable()));
       }
       else
       {
-        return mStack.popFloat();
+        return ctx.stack.popFloat();
       }
     }
 
     bs::String DaedalusVM::popStringValue()
     {
-      if (mStack.isTopOfStringStackVariable())
+      DaedalusExecutionContext& ctx = context();
+
+      if (ctx.stack.isTopOfStringStackVariable())
+      {
+        return readStaged(resolveStringVariable(ctx.stack.popStringVariable()));
+      }
+      else
+      {
+        return ctx.stack.popString();
+      }
+    }
+
+    const bs::String& DaedalusVM::popStringArgument(bs::String& temporary)
+    {
+      DaedalusExecutionContext& ctx = context();
+
+      if (ctx.stack.isTopOfStringStackVariable())
       {
-        return popStringReference();
+        return readStaged(resolveStringVariable(ctx.stack.popStringVariable()));
       }
       else
       {
-        return mStack.popString();
+        temporary = ctx.stack.popString();
+
+        return temporary;
       }
     }
 
+    void DaedalusVM::pushExternalResult(bs::INT32 value)
+    {
+      context().stack.pushInt(value);
+    }
+
+    void DaedalusVM::pushExternalResult(float value)
+    {
+      context().stack.pushFloat(value);
+    }
+
+    void DaedalusVM::pushExternalResult(bool value)
+    {
+      // Scripts have no booleans
+      context().stack.pushInt(value ? 1 : 0);
+    }
+
+    void DaedalusVM::pushExternalResult(bs::String value)
+    {
+      context().stack.pushString(std::move(value));
+    }
+
     ScriptObjectHandle DaedalusVM::popInstanceScriptObject()
     {
-      SymbolIndex symbol   = mStack.popInstance();
+      SymbolIndex symbol   = context().stack.popInstance();
       const auto& instance = mScriptSymbols.getSymbol<SymbolInstance>(symbol);
 
       if (instance.isClassVar)
@@ -849,20 +1179,40 @@ namespace REGoth
         REGOTH_THROW(InvalidParametersException, "Instances cannot be classvars!");
       }
 
-      return instance.instance;
+      return getInstanceOfSymbol(symbol);
     }
 
     bs::INT32& DaedalusVM::popIntReference()
     {
-      DaedalusStack::StackVariableValue var = mStack.popIntVariable();
+      DaedalusStack::StackVariableValue var = context().stack.popIntVariable();
+
+      return stageWriteIfShared(var.symbol, resolveIntVariable(var));
+    }
+
+    float& DaedalusVM::popFloatReference()
+    {
+      DaedalusStack::StackVariableValue var = context().stack.popFloatVariable();
+
+      return stageWriteIfShared(var.symbol, resolveFloatVariable(var));
+    }
+
+    bs::String& DaedalusVM::popStringReference()
+    {
+      DaedalusStack::StackVariableValue var = context().stack.popStringVariable();
 
+      return stageWriteIfShared(var.symbol, resolveStringVariable(var));
+    }
+
+    bs::INT32& DaedalusVM::resolveIntVariable(const DaedalusStack::StackVariableValue& var)
+    {
       SymbolBase& symbol = mScriptSymbols.getSymbolBase(var.symbol);
 
       if (symbol.type == SymbolType::Int)
       {
         if (symbol.isClassVar)
         {
-          ScriptInts& ints = mClassVarResolver->resolveClassVariableInts(symbol.name);
+          ScriptInts& ints =
+              context().classVarResolver.resolveClassVariableInts(symbol.name);
 
           if (var.arrayIndex >= ints.size())
           {
@@ -895,17 +1245,16 @@ namespace REGoth
       }
     }
 
-    float& DaedalusVM::popFloatReference()
+    float& DaedalusVM::resolveFloatVariable(const DaedalusStack::StackVariableValue& var)
     {
-      DaedalusStack::StackVariableValue var = mStack.popFloatVariable();
-
       SymbolBase& symbol = mScriptSymbols.getSymbolBase(var.symbol);
 
       if (symbol.type == SymbolType::Float)
       {
         if (symbol.isClassVar)
         {
-          ScriptFloats& floats = mClassVarResolver->resolveClassVariableFloats(symbol.name);
+          ScriptFloats& floats =
+              context().classVarResolver.resolveClassVariableFloats(symbol.name);
 
           if (var.arrayIndex >= floats.size())
           {
@@ -938,17 +1287,16 @@ namespace REGoth
       }
     }
 
-    bs::String& DaedalusVM::popStringReference()
+    bs::String& DaedalusVM::resolveStringVariable(const DaedalusStack::StackVariableValue& var)
     {
-      DaedalusStack::StackVariableValue var = mStack.popStringVariable();
-
       SymbolBase& symbol = mScriptSymbols.getSymbolBase(var.symbol);
 
       if (symbol.type == SymbolType::String)
       {
         if (symbol.isClassVar)
         {
-          ScriptStrings& strings = mClassVarResolver->resolveClassVariableStrings(symbol.name);
+          ScriptStrings& strings =
+              context().classVarResolver.resolveClassVariableStrings(symbol.name);
 
           if (var.arrayIndex >= strings.size())
           {
@@ -983,35 +1331,139 @@ namespace REGoth
 
     void DaedalusVM::pushVariable(SymbolIndex symbolIndex, bs::UINT32 arrayIndex)
     {
-      SymbolBase& symbol = mScriptSymbols.getSymbolBase(symbolIndex);
+      DaedalusStack& stack = context().stack;
+      SymbolBase& symbol   = mScriptSymbols.getSymbolBase(symbolIndex);
 
       if (symbol.type == SymbolType::Int)
       {
-        mStack.pushIntVariable(symbolIndex, arrayIndex);
+        stack.pushIntVariable(symbolIndex, arrayIndex);
       }
       else if (symbol.type == SymbolType::Float)
       {
-        mStack.pushFloatVariable(symbolIndex, arrayIndex);
+        stack.pushFloatVariable(symbolIndex, arrayIndex);
       }
       else if (symbol.type == SymbolType::String)
       {
-        mStack.pushStringVariable(symbolIndex, arrayIndex);
+        stack.pushStringVariable(symbolIndex, arrayIndex);
       }
       else if (symbol.type == SymbolType::Instance)
       {
-        mStack.pushInstance(symbolIndex);
+        stack.pushInstance(symbolIndex);
       }
       else if (symbol.type == SymbolType::ScriptFunction)
       {
-        mStack.pushFunction(symbolIndex);
+        stack.pushFunction(symbolIndex);
       }
     }
 
     void DaedalusVM::registerExternal(const bs::String& name, externalCallback callback)
+    {
+      setExternal(name, [this, callback]() { (this->*callback)(); });
+    }
+
+    void DaedalusVM::setExternal(const bs::String& name, ExternalFunction function)
+    {
+      SymbolIndex symbol = mScriptSymbols.findIndexBySymbolName(name);
+
+      if (symbol >= mExternalOrdinals.size())
+      {
+        // Externals are registered all at once, so make room for all of them
+        mExternalOrdinals.resize(std::max(symbol + 1, mScriptSymbols.numSymbols()), NO_EXTERNAL);
+      }
+
+      bs::UINT32& ordinal = mExternalOrdinals[symbol];
+
+      if (ordinal == NO_EXTERNAL)
+      {
+        ordinal = (bs::UINT32)mExternals.size();
+        mExternals.push_back(std::move(function));
+        mIsExternalWorkerSafe.push_back(false);
+      }
+      else
+      {
+        // Whether the new function is safe has to be stated again
+        mExternals[ordinal]            = std::move(function);
+        mIsExternalWorkerSafe[ordinal] = false;
+      }
+
+      mCanRunOnWorkerThread.clear();
+    }
+
+    void DaedalusVM::markExternalWorkerSafe(const bs::String& name)
     {
       SymbolIndex symbol = mScriptSymbols.findIndexBySymbolName(name);
 
-      mExternals[symbol] = callback;
+      if (!findExternal(symbol))
+      {
+        REGOTH_THROW(InvalidParametersException, "No external registered for symbol " + name);
+      }
+
+      mIsExternalWorkerSafe[mExternalOrdinals[symbol]] = true;
+
+      mCanRunOnWorkerThread.clear();
+    }
+
+    bool DaedalusVM::isExternalWorkerSafe(SymbolIndex externalSymbol) const
+    {
+      if (!findExternal(externalSymbol)) return true;
+
+      return mIsExternalWorkerSafe[mExternalOrdinals[externalSymbol]];
+    }
+
+    bool DaedalusVM::canRunOnWorkerThread(SymbolIndex function)
+    {
+      auto it = mCanRunOnWorkerThread.find(function);
+
+      if (it != mCanRunOnWorkerThread.end()) return it->second;
+
+      const auto& functionSym = mScriptSymbols.getSymbol<SymbolScriptFunction>(function);
+
+      FunctionDependencies dependencies = findFunctionDependencies(functionSym.address);
+
+      bool canRun = std::all_of(dependencies.externalsCalled.begin(),
+                                dependencies.externalsCalled.end(),
+                                [this](SymbolIndex s) { return isExternalWorkerSafe(s); });
+
+      mCanRunOnWorkerThread[function] = canRun;
+
+      return canRun;
+    }
+
+    void DaedalusVM::callExternal(SymbolIndex externalSymbol)
+    {
+      const ExternalFunction* external = findExternal(externalSymbol);
+
+      if (!external)
+      {
+        REGOTH_THROW(InvalidParametersException,
+                     "No external registered for symbol " +
+                         mScriptSymbols.getSymbolName(externalSymbol));
+      }
+
+      runExternal(externalSymbol, *external);
+    }
+
+    void DaedalusVM::runExternal(SymbolIndex externalSymbol, const ExternalFunction& external)
+    {
+      DaedalusExecutionContext& ctx = context();
+
+      // Scripts calling anything else must not be run there, see canRunOnWorkerThread()
+      if (ctx.isDeferringSideEffects && !isExternalWorkerSafe(externalSymbol))
+      {
+        REGOTH_THROW(InvalidStateException,
+                     "External " + mScriptSymbols.getSymbolName(externalSymbol) +
+                         " is not safe to call on a worker thread");
+      }
+
+      SymbolIndex currentInstance = ctx.classVarResolver.getCurrentInstance();
+      bs::UINT32 pc               = ctx.pc;
+      ctx.callDepth += 1;
+
+      external();
+
+      ctx.callDepth -= 1;
+      ctx.pc = pc;
+      ctx.classVarResolver.setCurrentInstance(currentInstance);
     }
 
     void DaedalusVM::disassembleAndLogOpcode(const Daedalus::PARStackOpCode& opcode,
@@ -1019,7 +1471,8 @@ namespace REGoth
                                              const bs::String& res)
     {
       bs::gDebug().logDebug(
-          bs::StringUtil::format("[DaedalusVM] Exec: {0}{1}", makeCallDepthString(mCallDepth),
+          bs::StringUtil::format("[DaedalusVM] Exec: {0}{1}",
+                                 makeCallDepthString(context().callDepth),
                                  disassembleOpcode(opcode, mScriptSymbols, lhs, rhs, res)));
     }
 
@@ -1040,7 +1493,7 @@ namespace REGoth
       }
 
       bs::gDebug().logDebug(bs::StringUtil::format("[DaedalusVM] Exec: {0}Call {1}",
-                                                   makeCallDepthString(mCallDepth), name));
+                                                   makeCallDepthString(context().callDepth), name));
     }
 
     REGOTH_DEFINE_RTTI(DaedalusVM);
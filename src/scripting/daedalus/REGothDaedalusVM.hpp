@@ -3,7 +3,11 @@
 #pragma once
 #include "DaedalusStack.hpp"
 #include <BsPrerequisites.h>
+#include <functional>
 #include <scripting/ScriptVM.hpp>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace Daedalus
 {
@@ -17,12 +21,163 @@ namespace REGoth
   {
     class DATSymbolStorageLoader;
     class DaedalusClassVarResolver;
+    struct DaedalusExecutionContext;
+
+    /**
+     * Pops an argument of type `T` off the stack for an external registered with a typed
+     * signature, see DaedalusVM::registerExternal(). pop() is called for the last argument
+     * first, as that is the one on top of the stack, then get() passes the value on to the
+     * external. Specialize this to support more argument types.
+     */
+    template <typename T>
+    struct ExternalArgument;
+
     class DaedalusVM : public ScriptVM
     {
     public:
-      DaedalusVM(const bs::Vector<bs::UINT8>& datFileData);
+      /**
+       * @param  datFileName  Name of the DAT-file inside the VDFS, e.g. `GOTHIC.DAT`. Needed
+       *                      to load it again when a savegame is loaded.
+       * @param  datFileData  Contents of the DAT-file.
+       */
+      DaedalusVM(const bs::String& datFileName, const bs::Vector<bs::UINT8>& datFileData);
+
+      /**
+       * Creates a new execution context for this VM, which can be used to run scripts
+       * on a different thread, see ScopedExecutionContext.
+       */
+      bs::SPtr<DaedalusExecutionContext> createExecutionContext();
+
+      /**
+       * Applies the side effects the given context has deferred into its command buffer and
+       * counts its writes to symbols. Must be called while no scripts are running.
+       */
+      void applySideEffects(DaedalusExecutionContext& context);
+
+      /**
+       * Makes the VM use the given execution context for scripts run on the calling thread,
+       * for as long as this object lives.
+       */
+      class ScopedExecutionContext
+      {
+      public:
+        ScopedExecutionContext(DaedalusExecutionContext& context);
+        ~ScopedExecutionContext();
+
+      private:
+        DaedalusExecutionContext* mPreviousContext;
+      };
+
+      /**
+       * @return How often scripts have written to the given global variable or instance symbol
+       *         so far. If this is the same at two points in time, the value has not changed in
+       *         between. Writes to members of script objects are not counted.
+       */
+      bs::UINT32 symbolWriteVersion(SymbolIndex symbolIndex) const
+      {
+        return symbolIndex < mSymbolWriteVersions.size() ? mSymbolWriteVersions[symbolIndex] : 0;
+      }
+
+      /**
+       * Calls the given external as if a script did. Its arguments have to be pushed onto
+       * stack() before, its return value is left on there. Meant for tools and benchmarks,
+       * scripts do this via the CallExternal-instruction.
+       *
+       * Throws if no external is registered for the symbol.
+       */
+      void callExternal(SymbolIndex externalSymbol);
+
+      /**
+       * @return Whether the given script function and all functions it calls only call
+       *         externals which are safe to call on a worker thread, see
+       *         markExternalWorkerSafe(). Only such functions may be run on an execution
+       *         context deferring its side effects.
+       *
+       * @note Not thread safe, as the result is cached.
+       */
+      bool canRunOnWorkerThread(SymbolIndex function);
+
+      /**
+       * @return Stack of the execution context active on the calling thread.
+       */
+      DaedalusStack& stack() const;
 
     protected:
+      template <typename T>
+      friend struct ExternalArgument;
+
+      /**
+       * What a script function depends on, as found by findFunctionDependencies().
+       */
+      struct FunctionDependencies
+      {
+        /**
+         * Global variables and instance symbols read by the function or functions it calls.
+         */
+        bs::Vector<SymbolIndex> symbolsRead;
+
+        /**
+         * Externals called by the function or functions it calls.
+         */
+        bs::Vector<SymbolIndex> externalsCalled;
+
+        /**
+         * Whether the function writes anything or reads members of script objects. If not,
+         * its result only depends on the symbols read and the externals called.
+         */
+        bool hasOtherDependencies = false;
+      };
+
+      /**
+       * Looks through the byte-code of the script function at the given address and all
+       * functions it calls to find out what it depends on. Does not run anything.
+       *
+       * All reachable code is looked through, even after finding other dependencies, so
+       * FunctionDependencies::externalsCalled is always complete.
+       */
+      FunctionDependencies findFunctionDependencies(bs::UINT32 address) const;
+
+      /**
+       * @return The execution context active on the calling thread.
+       */
+      DaedalusExecutionContext& context() const;
+
+      /**
+       * @return Whether the calling thread runs scripts with the main context.
+       */
+      bool isMainContextActive() const;
+
+      /**
+       * Finds which register of an execution context holds the value of the given
+       * instance symbol, instead of the symbol itself. The object the context runs for
+       * must be held by DaedalusExecutionContext::SELF_REGISTER.
+       *
+       * @return Index of the register, or -1 if the symbol is not held by a register.
+       */
+      virtual bs::INT32 findInstanceRegister(SymbolIndex symbolIndex) const
+      {
+        return -1;
+      }
+
+      /**
+       * Looks up which script object the given instance symbol refers to. Resolves registers
+       * of the active execution context.
+       */
+      ScriptObjectHandle getInstanceOfSymbol(SymbolIndex symbolIndex) const;
+
+      /**
+       * Sets which script object the given instance symbol refers to. Writes registers
+       * of the active execution context. Deferred for other symbols, if the active
+       * context is deferring side effects.
+       */
+      void setInstanceOfSymbol(SymbolIndex symbolIndex, ScriptObjectHandle scriptObject);
+
+      /**
+       * Runs the given command right away, or records it into the command buffer if the
+       * active execution context is deferring side effects.
+       */
+      void runOrDefer(std::function<void()> command);
+
       /**
        * Executes a script function until it hits its return.
        *
@@ -80,7 +235,26 @@ namespace REGoth
       ScriptObjectHandle popInstanceScriptObject();
 
       /**
-       * Pops a reference to an variable stored inside a script symbol.
+       * Pops a string without copying it, if possible: Refers to the storage of the variable
+       * if the value on the stack is one, otherwise the string is moved into \p temporary.
+       *
+       * @return Either the variable or \p temporary.
+       */
+      const bs::String& popStringArgument(bs::String& temporary);
+
+      /**
+       * Pushes the return value of an external registered with a typed signature.
+       */
+      void pushExternalResult(bs::INT32 value);
+      void pushExternalResult(float value);
+      void pushExternalResult(bool value);
+      void pushExternalResult(bs::String value);
+
+      /**
+       * Pops a reference to an variable stored inside a script symbol, to write to.
+       *
+       * If the active execution context is deferring side effects, this is a reference to a
+       * staged copy unless the variable belongs to the contexts own object.
        *
        * Throws if the value on the stack is not a variable.
        */
@@ -88,6 +262,15 @@ namespace REGoth
       float& popFloatReference();
       bs::String& popStringReference();
 
+      /**
+       * Looks up the storage of the given variable.
+       *
+       * Throws if the variable does not exist or is of a different type.
+       */
+      bs::INT32& resolveIntVariable(const DaedalusStack::StackVariableValue& var);
+      float& resolveFloatVariable(const DaedalusStack::StackVariableValue& var);
+      bs::String& resolveStringVariable(const DaedalusStack::StackVariableValue& var);
+
       /**
        * Pushes the given variable onto the stack.
        *
@@ -116,20 +299,157 @@ namespace REGoth
        *
        * @param  name      Name of the external function, UPPERCASE.
        * @param  callback  Callback to be executed when the external function
-       *                   is called.
+       *                   is called. Has to pop its arguments and push its return value
+       *                   by itself.
        */
       void registerExternal(const bs::String& name, externalCallback callback);
 
-    protected:
-      bs::SPtr<DaedalusClassVarResolver> mClassVarResolver;
-      DaedalusStack mStack;
+      /**
+       * Marks the already registered external with the given name as safe to call on a worker
+       * thread, while other threads are running scripts as well. Such an external must only
+       * read what nobody writes to in the meantime and pass everything else to runOrDefer().
+       *
+       * Throws if there is no such external.
+       */
+      void markExternalWorkerSafe(const bs::String& name);
 
       /**
-       * If true, every executed instruction will be logged to the console.
+       * Registers an external function with a typed signature, like
+       * `bs::INT32 external_Npc_GetDistToWP(HCharacter self, const bs::String& waypoint)`.
+       *
+       * The code popping the arguments is generated from the signature, see ExternalArgument
+       * for the supported types. Strings should be taken as `const bs::String&`, which then
+       * refer to the variable they were pushed as or are moved off the stack, so nothing is
+       * copied.
+       * A return value other than `void` is pushed onto the stack afterwards.
+       *
+       * @param  name      Name of the external function, UPPERCASE.
+       * @param  function  Method of the VM to be called when the external function is called.
        */
-      bool mIsDisassemblerEnabled = false;
+      template <typename VM, typename Ret, typename... Args>
+      void registerExternal(const bs::String& name, Ret (VM::*function)(Args...))
+      {
+        static_assert(std::is_base_of<DaedalusVM, VM>::value, "Externals must be VM methods");
+
+        VM& vm = static_cast<VM&>(*this);
+
+        setExternal(name, [&vm, function]() {
+          callTypedExternal(vm, function, std::index_sequence_for<Args...>());
+        });
+      }
 
     private:
+      /**
+       * Type-erased external function, which pops its arguments and pushes its return value.
+       */
+      using ExternalFunction = std::function<void()>;
+
+      /**
+       * Ordinal of symbols without an external, see mExternalOrdinals.
+       */
+      static constexpr bs::UINT32 NO_EXTERNAL = ~0u;
+
+      /**
+       * Tuple holding the arguments of an external with a typed signature.
+       */
+      template <typename... Args>
+      using ExternalArguments = std::tuple<ExternalArgument<std::decay_t<Args>>...>;
+
+      /**
+       * Pops all arguments of an external with a typed signature into \p arguments.
+       */
+      template <typename VM, typename Arguments, size_t... I>
+      static void popExternalArguments(VM& vm, Arguments& arguments, std::index_sequence<I...>)
+      {
+        // The last argument is on top of the stack. Initializer lists are evaluated in order.
+        int popInReverse[] = {0, (std::get<sizeof...(I) - 1 - I>(arguments).pop(vm), 0)...};
+        (void)popInReverse;
+      }
+
+      /**
+       * Pops the arguments, calls the external and pushes its return value, if any.
+       */
+      template <typename VM, typename Ret, typename... Args, size_t... I>
+      static void callTypedExternal(VM& vm, Ret (VM::*function)(Args...),
+                                    std::index_sequence<I...> indices)
+      {
+        ExternalArguments<Args...> arguments;
+        popExternalArguments(vm, arguments, indices);
+
+        vm.pushExternalResult((vm.*function)(std::get<I>(arguments).get()...));
+      }
+
+      template <typename VM, typename... Args, size_t... I>
+      static void callTypedExternal(VM& vm, void (VM::*function)(Args...),
+                                    std::index_sequence<I...> indices)
+      {
+        ExternalArguments<Args...> arguments;
+        popExternalArguments(vm, arguments, indices);
+
+        (vm.*function)(std::get<I>(arguments).get()...);
+      }
+
+      /**
+       * Stores the given function as the external with the given name.
+       *
+       * Throws if there is no such symbol.
+       */
+      void setExternal(const bs::String& name, ExternalFunction function);
+
+      /**
+       * @return The external registered for the given symbol. nullptr, if there is none.
+       */
+      const ExternalFunction* findExternal(SymbolIndex externalSymbol) const
+      {
+        if (externalSymbol >= mExternalOrdinals.size()) return nullptr;
+
+        bs::UINT32 ordinal = mExternalOrdinals[externalSymbol];
+
+        if (ordinal == NO_EXTERNAL) return nullptr;
+
+        return &mExternals[ordinal];
+      }
+
+      /**
+       * @return Whether the external of the given symbol may be called on a worker thread.
+       *         True for symbols without an external, as calling them only pushes a dummy value.
+       */
+      bool isExternalWorkerSafe(SymbolIndex externalSymbol) const;
+
+      /**
+       * Calls the given external, keeping the state of the calling script function intact.
+       *
+       * Throws if the active execution context is deferring side effects and the external is not
+       * safe to call on a worker thread.
+       */
+      void runExternal(SymbolIndex externalSymbol, const ExternalFunction& external);
+
+      /**
+       * Returns a staged copy of the given variable to write to, if the active execution
+       * context is deferring side effects and the variable is shared with other contexts.
+       */
+      template <typename T>
+      T& stageWriteIfShared(SymbolIndex symbolIndex, T& target);
+
+      /**
+       * @return The value the active execution context sees for the given variable: Its staged
+       *         copy if the context has written to it while deferring side effects, otherwise
+       *         the variable itself.
+       */
+      template <typename T>
+      const T& readStaged(const T& value) const;
+
+      /**
+       * @return Whether the given symbol is a local variable or parameter of a script function.
+       */
+      bool isLocalSymbol(SymbolIndex symbolIndex) const;
+
+      /**
+       * Counts a write to the given symbol, see symbolWriteVersion(). Must be called on every
+       * write to a symbol which doesn't go through stageWriteIfShared().
+       */
+      void markSymbolWritten(SymbolIndex symbolIndex);
+
       /**
        * Whether the disassembler should be turned on for the given function.
        */
@@ -153,21 +473,61 @@ namespace REGoth
       void findFunctionAtAddressAndLog(bs::UINT32 address);
 
       /**
-       * Program counter register
+       * Only the values of the symbols are saved, everything else is defined by the DAT-file.
+       * After loading a savegame, this reads the DAT-file again and restores the symbols and
+       * everything else derived from it.
+       *
+       * Throws if the DAT-file differs from the one the savegame was made with.
        */
-      bs::UINT32 mPC = 0;
+      void rebuildFromDatFile();
 
       /**
-       * Function nesting counter.
+       * Context used when running scripts on the main thread.
        */
-      bs::INT32 mCallDepth = 0;
+      bs::SPtr<DaedalusExecutionContext> mMainContext;
 
       bs::SPtr<Daedalus::DATFile> mDatFile;
 
-      // The whole DAT-file, for serialization
-      bs::Vector<bs::UINT8> mDatFileData;
+      /**
+       * Where the DAT-file can be found in the VDFS and the hash of its contents, so it
+       * can be loaded and checked again after loading a savegame.
+       */
+      bs::String mDatFileName;
+      bs::UINT64 mDatFileHash = 0;
+
+      /**
+       * Registered externals in the order they were registered. Not saved, as
+       * registerAllExternals() fills this again when loading.
+       */
+      bs::Vector<ExternalFunction> mExternals;
+
+      /**
+       * Index into mExternals by symbol index, NO_EXTERNAL for symbols without an external.
+       * Only a few hundred of the many thousand symbols are externals, so this keeps the lookup
+       * direct without holding an empty function for every other symbol.
+       */
+      bs::Vector<bs::UINT32> mExternalOrdinals;
+
+      /**
+       * Whether the external at the same index in mExternals is safe to call on a worker thread.
+       */
+      bs::Vector<bool> mIsExternalWorkerSafe;
+
+      /**
+       * Results of canRunOnWorkerThread() by function symbol.
+       */
+      bs::UnorderedMap<SymbolIndex, bool> mCanRunOnWorkerThread;
+
+      /**
+       * Whether a symbol is a local variable or parameter, by symbol index. Derived from the
+       * DAT-file.
+       */
+      bs::Vector<bool> mIsLocalSymbol;
 
-      bs::Map<SymbolIndex, externalCallback> mExternals;
+      /**
+       * See symbolWriteVersion(). Not saved, as nothing remembers versions across loading.
+       */
+      bs::Vector<bs::UINT32> mSymbolWriteVersions;
 
     public:
       // Remember, this is abstract, so don't create an rttiCreateEmpty()
@@ -176,5 +536,57 @@ namespace REGoth
     protected:
       DaedalusVM() = default;  // For RTTI
     };
+
+    template <>
+    struct ExternalArgument<bs::INT32>
+    {
+      void pop(DaedalusVM& vm)
+      {
+        value = vm.popIntValue();
+      }
+
+      bs::INT32 get() const
+      {
+        return value;
+      }
+
+      bs::INT32 value = 0;
+    };
+
+    template <>
+    struct ExternalArgument<float>
+    {
+      void pop(DaedalusVM& vm)
+      {
+        value = vm.popFloatValue();
+      }
+
+      float get() const
+      {
+        return value;
+      }
+
+      float value = 0.0f;
+    };
+
+    template <>
+    struct ExternalArgument<bs::String>
+    {
+      void pop(DaedalusVM& vm)
+      {
+        value = &vm.popStringArgument(temporary);
+      }
+
+      const bs::String& get() const
+      {
+        return *value;
+      }
+
+      /**
+       * Only used if the string was not pushed as a variable.
+       */
+      bs::String temporary;
+      const bs::String* value = nullptr;
+    };
   }  // namespace Scripting
 }  // namespace REGoth
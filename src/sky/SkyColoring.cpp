@@ -2,7 +2,13 @@
 #include <Image/BsColor.h>
 #include <Math/BsMath.h>
 #include <Renderer/BsCamera.h>
-#include <Scene/BsSceneManager.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define REGOTH_SKY_USE_SSE 1
+#else
+#define REGOTH_SKY_USE_SSE 0
+#endif
 
 namespace REGoth
 {
@@ -18,6 +24,63 @@ namespace REGoth
 
   static_assert(TIME_KEY_0 == 0.00f, "TIME_KEY_0 must be 0.0f!");
 
+  /**
+   * Layout of one entry of the lookup table. Colors are stored as RGBA, so each of them fills
+   * one group of 4 floats.
+   */
+  enum SkyTableValue : bs::UINT32
+  {
+    BaseColor      = 0,
+    FogColor       = 4,
+    DomeColorUpper = 8,
+    FogDistance    = 12,
+    CloudsAlpha,
+    CloudsScale,
+    SkyAlpha,
+    SkyScale,
+
+    // Padded to full groups of 4 floats
+    NUM_TABLE_VALUES = 20,
+  };
+
+  static_assert(NUM_TABLE_VALUES % 4 == 0, "Entries must consist of full groups of 4 floats");
+
+  static void storeColor(const bs::Color& color, float* target)
+  {
+    target[0] = color.r;
+    target[1] = color.g;
+    target[2] = color.b;
+    target[3] = color.a;
+  }
+
+  static bs::Color loadColor(const float* source)
+  {
+    return bs::Color(source[0], source[1], source[2], source[3]);
+  }
+
+  /**
+   * Linearly interpolates all values of two entries of the lookup table.
+   */
+  static void blendTableEntries(const float* from, const float* to, float t, float* result)
+  {
+#if REGOTH_SKY_USE_SSE
+    __m128 factor = _mm_set1_ps(t);
+
+    for (bs::UINT32 i = 0; i < NUM_TABLE_VALUES; i += 4)
+    {
+      __m128 a = _mm_loadu_ps(from + i);
+      __m128 b = _mm_loadu_ps(to + i);
+
+      _mm_storeu_ps(result + i, _mm_add_ps(a, _mm_mul_ps(factor, _mm_sub_ps(b, a))));
+    }
+#else
+    for (bs::UINT32 i = 0; i < NUM_TABLE_VALUES; i++)
+    {
+      result[i] = from[i] + t * (to[i] - from[i]);
+    }
+#endif
+  }
+
   SkyColoring::SkyColoring()
   {
   }
@@ -36,22 +99,26 @@ namespace REGoth
   {
     mMasterState.time = std::fmod(dayRatio + 0.5, 1.0);
 
-    bs::UINT32 si0;
-    bs::UINT32 si1;
+    // The sky states are keyed to full minutes, so blending the two entries around the current
+    // time gives the same result as interpolating the sky states themselves.
+    float position = mMasterState.time * LOOKUP_TABLE_SIZE;
+    bs::UINT32 e0  = std::min((bs::UINT32)position, LOOKUP_TABLE_SIZE - 1);
+    bs::UINT32 e1  = (e0 + 1) % LOOKUP_TABLE_SIZE;
 
-    findTwoSkyStatesToInterpolateBetween(si0, si1);
+    float values[NUM_TABLE_VALUES];
 
-    SkyState& s0 = mSkyStates[si0];
-    SkyState& s1 = mSkyStates[si1];
+    blendTableEntries(&mLookupTable[e0 * NUM_TABLE_VALUES], &mLookupTable[e1 * NUM_TABLE_VALUES],
+                      position - e0, values);
 
-    interpolateAndStoreIntoMasterState(s0, s1);
+    storeIntoMasterState(values, mLookupTableStartStates[e0]);
 
     // FIXME: There is some stuff about levelchanges here. Like, "turn off rain when on dragonisland"
 
     // FIXME: Multiply fogColor with 0.8 when using dome!
   }
 
-  void SkyColoring::findTwoSkyStatesToInterpolateBetween(bs::UINT32& s0, bs::UINT32& s1) const
+  void SkyColoring::findTwoSkyStatesToInterpolateBetween(float time, bs::UINT32& s0,
+                                                         bs::UINT32& s1) const
   {
     // init with values for case: time >= TIME_KEY_7 (= 0.75f)
     s0 = (bs::INT32)mSkyStates.size() - 1;
@@ -64,7 +131,7 @@ namespace REGoth
       // Since it's easier to search for the target state, which is the first state which has a
       // time larger than the current time, we search for that. The start state is the one
       // right before it.
-      if (mMasterState.time < mSkyStates[i].time)
+      if (time < mSkyStates[i].time)
       {
         // Subtracting 1 will not cause a negative numbers here since the first state has a
         // time of 0.0, so the check should never pass for it. If everything is set up correctly
@@ -76,33 +143,92 @@ namespace REGoth
     }
   }
 
-  void SkyColoring::interpolateAndStoreIntoMasterState(const SkyState& s0, const SkyState& s1)
+  void SkyColoring::interpolateSkyStates(const SkyState& s0, const SkyState& s1,
+                                         SkyState& target)
   {
     // Handle case time >= TIME_KEY_7 (= 0.75f)
     float timeS1 = s1.time < s0.time ? s1.time + 1.0f : s1.time;
 
     // Scale up time difference to [0,1]
-    float t = (mMasterState.time - s0.time) / (timeS1 - s0.time);
+    float t = (target.time - s0.time) / (timeS1 - s0.time);
 
     // Interpolate values
-    mMasterState.baseColor      = s0.baseColor + t * (s1.baseColor - s0.baseColor);
-    mMasterState.fogColor       = s0.fogColor + t * (s1.fogColor - s0.fogColor);
-    mMasterState.fogDistance    = s0.fogDistance + t * (s1.fogDistance - s0.fogDistance);
-    mMasterState.domeColorUpper = s0.domeColorUpper + t * (s1.domeColorUpper - s0.domeColorUpper);
+    target.baseColor      = s0.baseColor + t * (s1.baseColor - s0.baseColor);
+    target.fogColor       = s0.fogColor + t * (s1.fogColor - s0.fogColor);
+    target.fogDistance    = s0.fogDistance + t * (s1.fogDistance - s0.fogDistance);
+    target.domeColorUpper = s0.domeColorUpper + t * (s1.domeColorUpper - s0.domeColorUpper);
 
-    mMasterState.cloudsLayer = s0.cloudsLayer;
-    mMasterState.cloudsLayer.textureAlpha =
+    target.cloudsLayer = s0.cloudsLayer;
+    target.cloudsLayer.textureAlpha =
         bs::Math::lerp(t, s0.cloudsLayer.textureAlpha, s1.cloudsLayer.textureAlpha);
-    mMasterState.cloudsLayer.textureScale =
+    target.cloudsLayer.textureScale =
         bs::Math::lerp(t, s0.cloudsLayer.textureScale, s1.cloudsLayer.textureScale);
 
-    mMasterState.skyLayer = s0.skyLayer;
-    mMasterState.skyLayer.textureAlpha =
+    target.skyLayer = s0.skyLayer;
+    target.skyLayer.textureAlpha =
         bs::Math::lerp(t, s0.skyLayer.textureAlpha, s1.skyLayer.textureAlpha);
-    mMasterState.skyLayer.textureScale =
+    target.skyLayer.textureScale =
         bs::Math::lerp(t, s0.skyLayer.textureScale, s1.skyLayer.textureScale);
   }
 
+  void SkyColoring::rebuildLookupTable()
+  {
+    mLookupTable.assign(LOOKUP_TABLE_SIZE * NUM_TABLE_VALUES, 0.0f);
+    mLookupTableStartStates.resize(LOOKUP_TABLE_SIZE);
+
+    SkyState state;
+
+    for (bs::UINT32 e = 0; e < LOOKUP_TABLE_SIZE; e++)
+    {
+      bs::UINT32 s0;
+      bs::UINT32 s1;
+
+      // Look up the states from the middle of the entry, so rounding of the entry time can't
+      // pick the wrong ones right at a sky state.
+      findTwoSkyStatesToInterpolateBetween((e + 0.5f) / LOOKUP_TABLE_SIZE, s0, s1);
+
+      state.time = (float)e / LOOKUP_TABLE_SIZE;
+      interpolateSkyStates(mSkyStates[s0], mSkyStates[s1], state);
+
+      float* entry = &mLookupTable[e * NUM_TABLE_VALUES];
+
+      storeColor(state.baseColor, entry + BaseColor);
+      storeColor(state.fogColor, entry + FogColor);
+      storeColor(state.domeColorUpper, entry + DomeColorUpper);
+
+      entry[FogDistance] = state.fogDistance;
+      entry[CloudsAlpha] = state.cloudsLayer.textureAlpha;
+      entry[CloudsScale] = state.cloudsLayer.textureScale;
+      entry[SkyAlpha]    = state.skyLayer.textureAlpha;
+      entry[SkyScale]    = state.skyLayer.textureScale;
+
+      mLookupTableStartStates[e] = (bs::UINT8)s0;
+    }
+
+    // Layers need to be copied again
+    mMasterStartState = UINT32_MAX;
+  }
+
+  void SkyColoring::storeIntoMasterState(const float* values, bs::UINT32 startState)
+  {
+    if (startState != mMasterStartState)
+    {
+      mMasterState.cloudsLayer = mSkyStates[startState].cloudsLayer;
+      mMasterState.skyLayer    = mSkyStates[startState].skyLayer;
+      mMasterStartState        = startState;
+    }
+
+    mMasterState.baseColor      = loadColor(values + BaseColor);
+    mMasterState.fogColor       = loadColor(values + FogColor);
+    mMasterState.domeColorUpper = loadColor(values + DomeColorUpper);
+    mMasterState.fogDistance    = values[FogDistance];
+
+    mMasterState.cloudsLayer.textureAlpha = values[CloudsAlpha];
+    mMasterState.cloudsLayer.textureScale = values[CloudsScale];
+    mMasterState.skyLayer.textureAlpha    = values[SkyAlpha];
+    mMasterState.skyLayer.textureScale    = values[SkyScale];
+  }
+
   void SkyColoring::initSkyState(SkyPresetType type, SkyColoring::SkyState& s)
   {
     bs::Color skyColor_g1 = bs::Color(114, 93, 82) / 255.0f;    // G1
@@ -293,13 +419,15 @@ namespace REGoth
     {
       initSkyState(static_cast<SkyPresetType>(i), mSkyStates[i]);
     }
+
+    rebuildLookupTable();
   }
 
-  void SkyColoring::calculateFogDistanceAndColor(float& nearFog, float& farFog,
-                                                 bs::Color& finalFogColor) const
+  void SkyColoring::calculateFogDistanceAndColor(const bs::Camera& camera, float& nearFog,
+                                                 float& farFog, bs::Color& finalFogColor) const
   {
-    float farPlane             = bs::gSceneManager().getMainCamera()->getFarClipDistance();
-    bs::Vector3 cameraPosition = bs::gSceneManager().getMainCamera()->getTransform().pos();
+    float farPlane             = camera.getFarClipDistance();
+    bs::Vector3 cameraPosition = camera.getTransform().pos();
 
     // FIXME: Find proper bounds. Using the world mesh would be okay here.
     bs::AABox worldBBox = bs::AABox(bs::Vector3(0, 0, 0), bs::Vector3(100, 100, 100));
@@ -40,6 +40,10 @@ namespace REGoth
    * Fog will also be calculated by this class, since it's parameters are embedded
    * inside the `SkyState`s as well.
    *
+   * As the sky states only change with the world, the whole day cycle is interpolated once
+   * into a lookup table with one entry per game minute, see rebuildLookupTable(). Updating the
+   * sky then only blends two neighbouring entries, no matter how many sky states there are.
+   *
    * Since sky rendering is a pretty complex topic in the original game, this class
    * contains a lot of magic numbers of which we are not quite sure why many of them
    * were chosen. Probably only because it looked good.
@@ -114,11 +118,13 @@ namespace REGoth
     /**
      * Calculates the near- and farplanes for the fog
      *
+     * @param[in]   camera        Camera the fog is calculated for.
      * @param[out]  distanceNear  Where the fog should start.
      * @param[out]  distanceEnd   Where the fog should end.
      * @param[out]  color         How the fog should be colored.
      */
-    void calculateFogDistanceAndColor(float& nearFog, float& farFog, bs::Color& finalFogColor) const;
+    void calculateFogDistanceAndColor(const bs::Camera& camera, float& nearFog, float& farFog,
+                                      bs::Color& finalFogColor) const;
 
     /**
      * @return Whether it's currently nighttime
@@ -132,21 +138,38 @@ namespace REGoth
 
   private:
     /**
-     * Finds the two sky states we need to interpolate between for the current time.
-     * For example, if the current time is 0.28, this will find the sky states for
+     * Number of entries in the lookup table, one per game minute.
+     */
+    static constexpr bs::UINT32 LOOKUP_TABLE_SIZE = 24 * 60;
+
+    /**
+     * Finds the two sky states we need to interpolate between for the given time.
+     * For example, if the time is 0.28, this will find the sky states for
      * time 0.25 and the one for 0.30.
      *
-     * The current time is read from the master state.
-     *
-     * @param[out]  s0  Index of the state to interpolate from.
-     * @param[out]  s1  Index of the state to interpolate to.
+     * @param[in]   time  Time in days since last 12:00.
+     * @param[out]  s0    Index of the state to interpolate from.
+     * @param[out]  s1    Index of the state to interpolate to.
+     */
+    void findTwoSkyStatesToInterpolateBetween(float time, bs::UINT32& s0, bs::UINT32& s1) const;
+
+    /**
+     * Interpolates the two given sky states at the time set in \p target and stores the
+     * result there.
+     */
+    static void interpolateSkyStates(const SkyState& s0, const SkyState& s1, SkyState& target);
+
+    /**
+     * Interpolates the sky states for every entry of the lookup table. Must be called whenever
+     * the sky states change.
      */
-    void findTwoSkyStatesToInterpolateBetween(bs::UINT32& s0, bs::UINT32& s1) const;
+    void rebuildLookupTable();
 
     /**
-     * Interpolates the two given sky states and stores the result into the master state.
+     * Stores the blended values of the lookup table into the master state. Everything which is
+     * not interpolated is taken from the sky state with the given index.
      */
-    void interpolateAndStoreIntoMasterState(const SkyState& s0, const SkyState& s1);
+    void storeIntoMasterState(const float* values, bs::UINT32 startState);
 
     /**
      * Initializes the given skystate to the given type
@@ -162,5 +185,22 @@ namespace REGoth
      * Interpolated skystate
      */
     SkyState mMasterState;
+
+    /**
+     * Index of the sky state the layers of the master state were copied from.
+     */
+    bs::UINT32 mMasterStartState = UINT32_MAX;
+
+    /**
+     * The sky states interpolated for every game minute. Each entry is a row of values
+     * packed into groups of 4 floats, so two entries can be blended with a few SIMD operations.
+     * See `SkyTableValue` for the layout of a row.
+     */
+    bs::Vector<float> mLookupTable;
+
+    /**
+     * Index of the sky state each entry of the lookup table is interpolated from.
+     */
+    bs::Vector<bs::UINT8> mLookupTableStartStates;
   };
 }  // namespace REGoth
@@ -0,0 +1,44 @@
+#include "ParallelFor.hpp"
+#include <Threading/BsTaskScheduler.h>
+
+namespace REGoth
+{
+  namespace Threading
+  {
+    void parallelFor(const bs::String& name, bs::UINT32 numItems, bs::UINT32 minItemsPerTask,
+                     const ParallelForWorker& worker)
+    {
+      if (numItems == 0) return;
+
+      minItemsPerTask = std::max(minItemsPerTask, 1u);
+
+      bs::UINT32 numThreads = std::max((bs::UINT32)BS_THREAD_HARDWARE_CONCURRENCY, 1u);
+      bs::UINT32 numTasks   = std::min(numThreads, numItems / minItemsPerTask);
+
+      if (numTasks <= 1)
+      {
+        worker(0, numItems);
+        return;
+      }
+
+      bs::UINT32 itemsPerTask = (numItems + numTasks - 1) / numTasks;
+
+      bs::Vector<bs::SPtr<bs::Task>> tasks;
+
+      for (bs::UINT32 begin = 0; begin < numItems; begin += itemsPerTask)
+      {
+        bs::UINT32 end = std::min(begin + itemsPerTask, numItems);
+
+        auto task = bs::Task::create(name, [&worker, begin, end]() { worker(begin, end); });
+
+        bs::TaskScheduler::instance().addTask(task);
+        tasks.push_back(task);
+      }
+
+      for (auto& task : tasks)
+      {
+        task->wait();
+      }
+    }
+  }  // namespace Threading
+}  // namespace REGoth
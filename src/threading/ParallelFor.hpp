@@ -0,0 +1,35 @@
+/** \file
+ *
+ * Small helpers to spread work across the worker threads of bs:f's task scheduler.
+ */
+
+#pragma once
+
+#include <BsPrerequisites.h>
+
+namespace REGoth
+{
+  namespace Threading
+  {
+    /**
+     * Callback processing the items within `[begin, end)`.
+     */
+    using ParallelForWorker = std::function<void(bs::UINT32 begin, bs::UINT32 end)>;
+
+    /**
+     * Splits the range `[0, numItems)` into chunks and processes them in parallel
+     * using bs:f's task scheduler. Returns once all chunks have been processed.
+     *
+     * The worker must not touch the scene graph or anything else which is not
+     * thread-safe. If the range is too small to be worth splitting, the worker
+     * is run on the calling thread.
+     *
+     * @param  name             Name of the created tasks, for profiling.
+     * @param  numItems         Number of items to process.
+     * @param  minItemsPerTask  Minimum number of items a single task should process.
+     * @param  worker           Function processing a chunk of items.
+     */
+    void parallelFor(const bs::String& name, bs::UINT32 numItems, bs::UINT32 minItemsPerTask,
+                     const ParallelForWorker& worker);
+  }  // namespace Threading
+}  // namespace REGoth
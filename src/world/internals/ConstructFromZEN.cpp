@@ -1,41 +1,109 @@
 #include "ConstructFromZEN.hpp"
 #include "ImportSingleVob.hpp"
+#include "PhysicsMeshCache.hpp"
 #include <BsZenLib/ImportPath.hpp>
 #include <BsZenLib/ImportStaticMesh.hpp>
 #include <BsZenLib/ResourceManifest.hpp>
 #include <BsZenLib/ZenResources.hpp>
 #include <Components/BsCMeshCollider.h>
+#include <Math/BsMath.h>
 #include <Physics/BsPhysicsMesh.h>
 #include <Resources/BsResources.h>
+#include <Scene/BsPrefab.h>
 #include <Scene/BsSceneManager.h>
 #include <Scene/BsSceneObject.h>
 #include <components/Freepoint.hpp>
 #include <components/GameWorld.hpp>
+#include <components/Visual.hpp>
 #include <components/Waynet.hpp>
 #include <components/Waypoint.hpp>
+#include <components/WorldStreamer.hpp>
 #include <exception/Throw.hpp>
+#include <hashing/ContentHash.hpp>
+#include <original-content/OriginalGameResources.hpp>
 #include <original-content/VirtualFileSystem.hpp>
+#include <threading/ParallelFor.hpp>
 #include <zenload/zCMesh.h>
 #include <zenload/zenParser.h>
 
 namespace REGoth
 {
+  /**
+   * Edge length of a world sector when streaming vobs, see WorldStreamer.
+   */
+  constexpr float SECTOR_SIZE_METERS = 100.0f;
+
+  /**
+   * Name suffix of the cached static world of a ZEN, see Internals::staticWorldCacheName().
+   */
+  static const char* STATIC_WORLD_CACHE_SUFFIX          = "STATIC";
+  static const char* STATIC_WORLD_STREAMED_CACHE_SUFFIX = "STATIC-STREAMED";
+
   struct OriginalZen
   {
     bs::String fileName;
     ZenLoad::oCWorldData vobTree;
+
+    /**
+     * Name the world mesh is cached under. Contains size and content hash of the ZEN-file,
+     * so the cache is rebuilt once the ZEN changes.
+     */
+    bs::String worldMeshCacheName;
+
+    /**
+     * Kept around so the world mesh can be packed later, see packedWorldMesh().
+     */
+    bs::Vector<bs::UINT8> zenData;
+    bs::SPtr<ZenLoad::ZenParser> zenParser;
+
+    /**
+     * Only filled on demand, see packedWorldMesh().
+     */
     ZenLoad::PackedMesh worldMesh;
+    bool hasPackedWorldMesh = false;
+  };
+
+  /**
+   * A vob from the vob tree, flattened into a list where parents always come before
+   * their children.
+   */
+  struct FlatVob
+  {
+    const ZenLoad::zCVobData* vob = nullptr;
+
+    /**
+     * Index of the parent inside the flattened list. -1 for root vobs.
+     */
+    bs::INT32 parentIndex = -1;
+
+    /**
+     * Filled in parallel, see Internals::describeSingleVob().
+     */
+    Internals::VobDescriptor descriptor;
+    bool isValid = false;
   };
 
   static bool importZEN(const bs::String& zenFile, OriginalZen& result);
-  static bs::HSceneObject importWorldMesh(const OriginalZen& zen);
-  static void importVobs(bs::HSceneObject sceneRoot, HGameWorld gameWorld, const OriginalZen& zen);
+  static bs::HSceneObject importWorldMesh(OriginalZen& zen);
+  static const ZenLoad::PackedMesh& packedWorldMesh(OriginalZen& zen);
+  static void importVobs(bs::HSceneObject sceneRoot, HGameWorld gameWorld, const OriginalZen& zen,
+                         bs::Vector<bs::HSceneObject>& streamableVobs);
+  static void sectorizeVobs(HWorldStreamer streamer, const OriginalZen& zen,
+                            const bs::Vector<bs::HSceneObject>& vobs);
+  static bool isStreamable(Internals::VobKind kind);
   static void importWaynet(bs::HSceneObject sceneRoot, const OriginalZen& zen);
-  static void walkVobTree(bs::HSceneObject bsfParent, HGameWorld gameWorld,
-                          const ZenLoad::zCVobData& zenParent);
-
-  bs::HSceneObject Internals::constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile)
+  static void flattenVobTree(const ZenLoad::zCVobData& zenParent, bs::INT32 parentIndex,
+                             bs::Vector<FlatVob>& flatVobs);
+  static void preloadVobResources(const bs::Vector<FlatVob>& flatVobs,
+                                  bs::UnorderedMap<bs::String, bs::HPhysicsMesh>& collisionMeshes);
+  static bs::HMesh renderMeshOfVisual(const bs::String& visual);
+
+  bs::HSceneObject Internals::constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile,
+                                               bool streamVobs)
   {
+    // So the statistics logged at the end only cover this ZEN
+    Internals::gPhysicsMeshCache().resetStatistics();
+
     OriginalZen zen;
 
     bool hasLoadedZEN = importZEN(zenFile, zen);
@@ -49,12 +117,75 @@ namespace REGoth
     bs::HSceneObject worldMesh = importWorldMesh(zen);
     worldMesh->setParent(gameWorld->SO());
 
-    importVobs(gameWorld->SO(), gameWorld, zen);
+    bs::Vector<bs::HSceneObject> streamableVobs;
+    importVobs(gameWorld->SO(), gameWorld, zen, streamableVobs);
     importWaynet(gameWorld->SO(), zen);
 
+    if (streamVobs)
+    {
+      HWorldStreamer streamer = gameWorld->SO()->addComponent<WorldStreamer>(SECTOR_SIZE_METERS);
+
+      sectorizeVobs(streamer, zen, streamableVobs);
+    }
+
+    gOriginalGameResources().logCacheStatistics();
+    Internals::gPhysicsMeshCache().logStatistics();
+
     return worldMesh;
   }
 
+  bs::HSceneObject Internals::constructStaticWorldFromZEN(const bs::String& zenFile,
+                                                          bool streamVobs)
+  {
+    // So the statistics logged at the end only cover this ZEN
+    Internals::gPhysicsMeshCache().resetStatistics();
+
+    OriginalZen zen;
+
+    bool hasLoadedZEN = importZEN(zenFile, zen);
+
+    if (!hasLoadedZEN)
+    {
+      bs::gDebug().logWarning("[ConstructFromZEN] Failed to read zen-file: " + zenFile);
+      return {};
+    }
+
+    bs::HSceneObject staticWorld = bs::SceneObject::create("StaticWorld");
+
+    bs::HSceneObject worldMesh = importWorldMesh(zen);
+    worldMesh->setParent(staticWorld);
+
+    // Without a world, items are skipped
+    bs::Vector<bs::HSceneObject> streamableVobs;
+    importVobs(staticWorld, {}, zen, streamableVobs);
+    importWaynet(staticWorld, zen);
+
+    if (streamVobs)
+    {
+      // The WorldStreamer is part of the world the static world is attached to, only the
+      // sector prefabs it loads from need to exist
+      sectorizeVobs({}, zen, streamableVobs);
+    }
+
+    gOriginalGameResources().logCacheStatistics();
+    Internals::gPhysicsMeshCache().logStatistics();
+
+    return staticWorld;
+  }
+
+  bs::String Internals::staticWorldCacheName(const bs::String& zenFile, bool streamVobs)
+  {
+    bs::Vector<bs::UINT8> zenData = gVirtualFileSystem().readFile(zenFile);
+
+    if (zenData.empty()) return "";
+
+    bs::UINT64 hash = Hashing::contentHash(zenData);
+
+    return bs::StringUtil::format(
+        "{0}.{1}.{2}.{3}", zenFile, zenData.size(), Hashing::toHexString(hash),
+        streamVobs ? STATIC_WORLD_STREAMED_CACHE_SUFFIX : STATIC_WORLD_CACHE_SUFFIX);
+  }
+
   bs::HSceneObject Internals::loadWorldMeshFromZEN(const bs::String& zenFile)
   {
     OriginalZen zen;
@@ -70,55 +201,326 @@ namespace REGoth
     return importWorldMesh(zen);
   }
 
-  static void importVobs(bs::HSceneObject sceneRoot, HGameWorld gameWorld, const OriginalZen& zen)
+  /**
+   * Vobs are imported in two phases: First, all vobs are turned into plain descriptors
+   * and the resources they need are loaded. This does not touch the scene graph and is
+   * done in parallel. Then, the scene objects are created from those descriptors on
+   * the main thread.
+   */
+  static void importVobs(bs::HSceneObject sceneRoot, HGameWorld gameWorld, const OriginalZen& zen,
+                         bs::Vector<bs::HSceneObject>& streamableVobs)
   {
+    bs::Vector<FlatVob> flatVobs;
+
     for (const ZenLoad::zCVobData& root : zen.vobTree.rootVobs)
     {
-      walkVobTree(sceneRoot, gameWorld, root);
+      flattenVobTree(root, -1, flatVobs);
+    }
+
+    Threading::parallelFor("ImportVobs", (bs::UINT32)flatVobs.size(), 256,
+                           [&](bs::UINT32 begin, bs::UINT32 end) {
+                             for (bs::UINT32 i = begin; i < end; i++)
+                             {
+                               FlatVob& v = flatVobs[i];
+                               v.isValid  = Internals::describeSingleVob(*v.vob, v.descriptor);
+                             }
+                           });
+
+    bs::UnorderedMap<bs::String, bs::HPhysicsMesh> collisionMeshes;
+    preloadVobResources(flatVobs, collisionMeshes);
+
+    for (FlatVob& v : flatVobs)
+    {
+      // Children of vobs which could not be imported are skipped as well
+      if (v.parentIndex != -1 && !flatVobs[v.parentIndex].isValid)
+      {
+        v.isValid = false;
+      }
+
+      // Items need a world to create their script objects in
+      if (!gameWorld && v.descriptor.kind == Internals::VobKind::Item)
+      {
+        v.isValid = false;
+      }
+
+      if (!v.isValid) continue;
+
+      bs::HPhysicsMesh collisionMesh;
+
+      if (v.descriptor.hasCollision)
+      {
+        auto it = collisionMeshes.find(v.descriptor.visual);
+
+        if (it != collisionMeshes.end())
+        {
+          collisionMesh = it->second;
+        }
+      }
+
+      bs::HSceneObject so =
+          Internals::createSingleVob(v.descriptor, sceneRoot, gameWorld, collisionMesh);
+
+      if (!so)
+      {
+        v.isValid = false;
+      }
+      else if (isStreamable(v.descriptor.kind))
+      {
+        streamableVobs.push_back(so);
+      }
+    }
+  }
+
+  /**
+   * Only vobs which are never looked up by scripts or the waynet can be streamed.
+   */
+  static bool isStreamable(Internals::VobKind kind)
+  {
+    switch (kind)
+    {
+      case Internals::VobKind::Vob:
+      case Internals::VobKind::Light:
+      case Internals::VobKind::Sound:
+      case Internals::VobKind::Animate:
+        return true;
+
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * Moves the given vobs into a grid of sectors, saves every sector as prefab and
+   * registers them at the given WorldStreamer, if any. The vobs are removed from the scene
+   * afterwards.
+   */
+  static void sectorizeVobs(HWorldStreamer streamer, const OriginalZen& zen,
+                            const bs::Vector<bs::HSceneObject>& vobs)
+  {
+    using SectorCell = std::pair<bs::INT32, bs::INT32>;
+
+    bs::Map<SectorCell, bs::Vector<bs::HSceneObject>> vobsBySector;
+
+    for (const bs::HSceneObject& so : vobs)
+    {
+      const bs::Vector3& position = so->getTransform().pos();
+
+      SectorCell cell = {(bs::INT32)bs::Math::floor(position.x / SECTOR_SIZE_METERS),
+                         (bs::INT32)bs::Math::floor(position.z / SECTOR_SIZE_METERS)};
+
+      vobsBySector[cell].push_back(so);
+    }
+
+    enum
+    {
+      Overwrite    = true,
+      KeepExisting = false,
+    };
+
+    for (const auto& sector : vobsBySector)
+    {
+      const SectorCell& cell = sector.first;
+
+      bs::String prefabName =
+          bs::StringUtil::format("{0}.SECTOR_{1}_{2}", zen.fileName, cell.first, cell.second);
+
+      bs::HSceneObject sectorSO = bs::SceneObject::create(prefabName);
+
+      for (const bs::HSceneObject& so : sector.second)
+      {
+        so->setParent(sectorSO);
+      }
+
+      bs::HPrefab prefab = bs::Prefab::create(sectorSO);
+      bs::Path path      = BsZenLib::GothicPathToCachedWorld(prefabName);
+
+      // Registered like the other cached resources, so the WorldStreamer loading them by path
+      // does not depend on anything outside the manifest after a restart
+      BsZenLib::AddToResourceManifest(prefab, path);
+      bs::gResources().save(prefab, path, Overwrite);
+
+      bs::Vector3 center((cell.first + 0.5f) * SECTOR_SIZE_METERS, 0.0f,
+                         (cell.second + 0.5f) * SECTOR_SIZE_METERS);
+
+      if (streamer)
+      {
+        streamer->addSector(center, prefabName);
+      }
+
+      sectorSO->destroy();
     }
+
+    bs::gDebug().logDebug(bs::StringUtil::format(
+        "[ConstructFromZEN] Moved {0} vobs into {1} streamed sectors", vobs.size(),
+        vobsBySector.size()));
   }
 
-  static void walkVobTree(bs::HSceneObject bsfParent, HGameWorld gameWorld,
-                          const ZenLoad::zCVobData& zenParent)
+  static void flattenVobTree(const ZenLoad::zCVobData& zenParent, bs::INT32 parentIndex,
+                             bs::Vector<FlatVob>& flatVobs)
   {
     for (const auto& v : zenParent.childVobs)
     {
-      bs::HSceneObject so = Internals::importSingleVob(v, bsfParent, gameWorld);
+      FlatVob flat;
+      flat.vob         = &v;
+      flat.parentIndex = parentIndex;
+
+      flatVobs.push_back(flat);
+
+      flattenVobTree(v, (bs::INT32)flatVobs.size() - 1, flatVobs);
+    }
+  }
+
+  /**
+   * Loads the visuals and collision meshes of all described vobs in parallel, so
+   * creating the scene objects only has to look them up from the in-memory resource cache.
+   * Every visual is only loaded once, no matter how many vobs are using it.
+   */
+  static void preloadVobResources(const bs::Vector<FlatVob>& flatVobs,
+                                  bs::UnorderedMap<bs::String, bs::HPhysicsMesh>& collisionMeshes)
+  {
+    bs::Vector<bs::String> visuals;
+    bs::UnorderedMap<bs::String, bool> needsCollision;
+
+    for (const FlatVob& v : flatVobs)
+    {
+      if (!v.isValid || v.descriptor.visual.empty()) continue;
+
+      auto it = needsCollision.find(v.descriptor.visual);
+
+      if (it == needsCollision.end())
+      {
+        visuals.push_back(v.descriptor.visual);
+        needsCollision[v.descriptor.visual] = v.descriptor.hasCollision;
+      }
+      else
+      {
+        it->second = it->second || v.descriptor.hasCollision;
+      }
+    }
+
+    Threading::parallelFor(
+        "PreloadVobResources", (bs::UINT32)visuals.size(), 1, [&](bs::UINT32 begin, bs::UINT32 end) {
+          for (bs::UINT32 i = begin; i < end; i++)
+          {
+            const bs::String& visual = visuals[i];
+
+            if (Visual::guessVisualKind(visual) == Visual::VisualKind::InteractiveObject)
+            {
+              gOriginalGameResources().modelScript(visual);
+            }
+            else
+            {
+              renderMeshOfVisual(visual);
+            }
+          }
+        });
+
+    // Collision meshes are cooked in one batch, so identical meshes are only cooked once
+    bs::Vector<bs::String> collisionVisuals;
+    bs::Vector<bs::HMesh> collisionRenderMeshes;
+
+    for (const bs::String& visual : visuals)
+    {
+      if (!needsCollision.at(visual)) continue;
+
+      bs::HMesh mesh = renderMeshOfVisual(visual);
+
+      if (!mesh) continue;
+
+      collisionVisuals.push_back(visual);
+      collisionRenderMeshes.push_back(mesh);
+    }
+
+    bs::Vector<bs::HPhysicsMesh> physicsMeshes =
+        Internals::gPhysicsMeshCache().physicsMeshesFor(collisionRenderMeshes);
 
-      if (so)
+    for (size_t i = 0; i < collisionVisuals.size(); i++)
+    {
+      if (physicsMeshes[i])
       {
-        walkVobTree(so, gameWorld, v);
+        collisionMeshes[collisionVisuals[i]] = physicsMeshes[i];
       }
     }
   }
 
   /**
-   * Import a zenfile and load it into datastructures to work with
+   * Loads the mesh of a static- or morph-mesh visual.
+   *
+   * @return The render mesh. Empty if the visual is of another kind or failed to load.
+   */
+  static bs::HMesh renderMeshOfVisual(const bs::String& visual)
+  {
+    BsZenLib::Res::HMeshWithMaterials mesh;
+
+    switch (Visual::guessVisualKind(visual))
+    {
+      case Visual::VisualKind::StaticMesh:
+        mesh = gOriginalGameResources().staticMesh(visual);
+        break;
+
+      case Visual::VisualKind::MorphMesh:
+        mesh = gOriginalGameResources().morphMesh(visual);
+        break;
+
+      default:
+        return {};
+    }
+
+    if (!mesh) return {};
+
+    return mesh->getMesh();
+  }
+
+  /**
+   * Import a zenfile and load it into datastructures to work with.
+   *
+   * Packing the world mesh takes a long time, so that is only done once the world mesh
+   * is actually needed, see packedWorldMesh().
    */
   static bool importZEN(const bs::String& zenFile, OriginalZen& result)
   {
-    ZenLoad::ZenParser zenParser(zenFile.c_str(), gVirtualFileSystem().getFileIndex());
+    result.zenData = gVirtualFileSystem().readFile(zenFile);
+
+    if (result.zenData.empty()) return false;
 
-    if (zenParser.getFileSize() == 0) return false;
+    result.zenParser =
+        bs::bs_shared_ptr_new<ZenLoad::ZenParser>(result.zenData.data(), result.zenData.size());
 
-    zenParser.readHeader();
+    result.zenParser->readHeader();
 
     result.fileName = zenFile;
 
-    zenParser.readWorld(result.vobTree);
+    bs::UINT64 hash           = Hashing::contentHash(result.zenData);
+    result.worldMeshCacheName = bs::StringUtil::format(
+        "{0}.{1}.{2}.worldmesh", zenFile, result.zenData.size(), Hashing::toHexString(hash));
 
-    // FIXME: Don't pack the mesh if it was already cached, packing takes a long time...
-    zenParser.getWorldMesh()->packMesh(result.worldMesh, 0.01f);
+    result.zenParser->readWorld(result.vobTree);
 
     return true;
   }
 
+  /**
+   * Packs the world mesh of the given ZEN on first access.
+   */
+  static const ZenLoad::PackedMesh& packedWorldMesh(OriginalZen& zen)
+  {
+    if (!zen.hasPackedWorldMesh)
+    {
+      bs::gDebug().logDebug("[ConstructFromZEN] Packing world mesh of " + zen.fileName);
+
+      zen.zenParser->getWorldMesh()->packMesh(zen.worldMesh, 0.01f);
+      zen.hasPackedWorldMesh = true;
+    }
+
+    return zen.worldMesh;
+  }
+
   /**
    * Create a bs:f scene object holding the world mesh.
    */
-  static bs::HSceneObject importWorldMesh(const OriginalZen& zen)
+  static bs::HSceneObject importWorldMesh(OriginalZen& zen)
   {
-    bs::String meshFileName = zen.fileName + ".worldmesh";
+    const bs::String& meshFileName = zen.worldMeshCacheName;
 
     BsZenLib::Res::HMeshWithMaterials mesh;
     if (BsZenLib::HasCachedStaticMesh(meshFileName))
@@ -130,13 +532,13 @@ namespace REGoth
       {
         bs::gDebug().logWarning("Failed to load cached world mesh of zen " + zen.fileName +
                                 "- rechaching it!");
-        mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, zen.worldMesh,
+        mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, packedWorldMesh(zen),
                                                   gVirtualFileSystem().getFileIndex());
       }
     }
     else
     {
-      mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, zen.worldMesh,
+      mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, packedWorldMesh(zen),
                                                 gVirtualFileSystem().getFileIndex());
     }
 
@@ -147,25 +549,20 @@ namespace REGoth
       REGOTH_THROW(InvalidStateException, "Failed to load world mesh for zen " + zen.fileName);
     }
 
-    bs::HSceneObject meshSO    = bs::SceneObject::create(meshFileName);
+    bs::HSceneObject meshSO    = bs::SceneObject::create(zen.fileName + ".worldmesh");
     bs::HRenderable renderable = meshSO->addComponent<bs::CRenderable>();
     renderable->setMesh(mesh->getMesh());
     renderable->setMaterials(mesh->getMaterials());
 
-    if (!actualMesh->getCachedData())
+    // Cached by content, so this will only cook the physics mesh once the world mesh changed
+    bs::HPhysicsMesh physicsMesh = Internals::gPhysicsMeshCache().physicsMeshFor(actualMesh);
+
+    if (!physicsMesh)
     {
       bs::gDebug().logError("Cannot extract world mesh for physics, no mesh data available!");
     }
     else
     {
-      bs::HPhysicsMesh physicsMesh =
-          bs::PhysicsMesh::create(mesh->getMesh()->getCachedData(), bs::PhysicsMeshType::Triangle);
-
-      bs::Path physicsMeshPath = BsZenLib::GothicPathToCachedStaticMesh(meshFileName + ".physics");
-
-      BsZenLib::AddToResourceManifest(physicsMesh, physicsMeshPath);
-      bs::gResources().save(physicsMesh, physicsMeshPath, true);
-
       bs::HMeshCollider collider = meshSO->addComponent<bs::CMeshCollider>();
       collider->setMesh(physicsMesh);
     }
@@ -16,12 +16,41 @@ namespace REGoth
      * This function will load the given zenFile from the virtual file system
      * and fully convert it into a bs::f scene.
      *
-     * @param  gameWorld  World to create the objects in.
-     * @param  zenFile    Uppercase ZEN-file name, e.g. "OLDWORLD.ZEN".
+     * If `streamVobs` is set, static vobs are not added to the scene directly. Instead, they
+     * are saved into one prefab per world sector and a WorldStreamer-component is added to
+     * the world which loads them on demand.
+     *
+     * @param  gameWorld   World to create the objects in.
+     * @param  zenFile     Uppercase ZEN-file name, e.g. "OLDWORLD.ZEN".
+     * @param  streamVobs  Whether static vobs should be streamed in by sectors.
      *
      * @return Root of the created scene.
      */
-    bs::HSceneObject constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile);
+    bs::HSceneObject constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile,
+                                      bool streamVobs = false);
+
+    /**
+     * Loads the given zenFile like constructFromZEN(), but only creates the parts which
+     * never change while playing: The world mesh, the waynet and all vobs except items.
+     * No GameWorld is needed for that, see GameWorld::loadDelta().
+     *
+     * If `streamVobs` is set, static vobs are only saved into the sector prefabs a
+     * WorldStreamer created by constructFromZEN() loads from.
+     *
+     * @param  zenFile     Uppercase ZEN-file name, e.g. "OLDWORLD.ZEN".
+     * @param  streamVobs  Whether static vobs are streamed in by sectors.
+     *
+     * @return Scene object holding the static world as children. Empty, if the ZEN could
+     *         not be read.
+     */
+    bs::HSceneObject constructStaticWorldFromZEN(const bs::String& zenFile, bool streamVobs);
+
+    /**
+     * @return Name the static world of the given ZEN is cached under. Contains size and
+     *         content hash of the ZEN-file, so the cache is rebuilt once the ZEN changes.
+     *         Empty, if the ZEN could not be read.
+     */
+    bs::String staticWorldCacheName(const bs::String& zenFile, bool streamVobs);
 
     /**
      * Will load the given ZEN, but only add its world mesh to the scene.
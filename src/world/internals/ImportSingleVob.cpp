@@ -1,15 +1,12 @@
 #include "ImportSingleVob.hpp"
-#include <BsZenLib/ImportPath.hpp>
-#include <BsZenLib/ResourceManifest.hpp>
+#include "PhysicsMeshCache.hpp"
 #include <BsZenLib/ZenResources.hpp>
 #include <Components/BsCLight.h>
 #include <Components/BsCMeshCollider.h>
 #include <Components/BsCRenderable.h>
-#include <FileSystem/BsFileSystem.h>
 #include <Math/BsMatrix4.h>
 #include <Mesh/BsMesh.h>
 #include <Physics/BsPhysicsMesh.h>
-#include <Resources/BsResources.h>
 #include <Scene/BsSceneObject.h>
 #include <components/Freepoint.hpp>
 #include <components/GameWorld.hpp>
@@ -31,85 +28,167 @@ namespace
 
 namespace REGoth
 {
-  static bs::HSceneObject import_zCVob(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                       HGameWorld gameWorld);
-  static bs::HSceneObject import_zCVobLight(const ZenLoad::zCVobData& vob,
-                                            bs::HSceneObject bsfParent, HGameWorld gameWorld);
-  static bs::HSceneObject import_zCVobStartpoint(const ZenLoad::zCVobData& vob,
-                                                 bs::HSceneObject bsfParent, HGameWorld gameWorld);
-  static bs::HSceneObject import_zCVobSpot(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                           HGameWorld gameWorld);
-  static bs::HSceneObject import_oCItem(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                        HGameWorld gameWorld);
-  static bs::HSceneObject import_zCVobSound(const ZenLoad::zCVobData& vob,
-                                            bs::HSceneObject bsfParent, HGameWorld gameWorld);
-  static bs::HSceneObject import_zCVobAnimate(const ZenLoad::zCVobData& vob,
-                                              bs::HSceneObject bsfParent, HGameWorld gameWorld);
-  static bs::HSceneObject import_oCMobInter(const ZenLoad::zCVobData& vob,
-                                            bs::HSceneObject bsfParent, HGameWorld gameWorld);
-  static bs::HSceneObject import_oCMobContainer(const ZenLoad::zCVobData& vob,
-                                                bs::HSceneObject bsfParent, HGameWorld gameWorld);
-  static bs::HSceneObject import_oCMobBed(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                          HGameWorld gameWorld);
-  static bs::HSceneObject import_oCMobDoor(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                           HGameWorld gameWorld);
+  static bs::HSceneObject import_zCVob(const Internals::VobDescriptor& vob,
+                                       bs::HSceneObject parent, HGameWorld gameWorld,
+                                       bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_zCVobLight(const Internals::VobDescriptor& vob,
+                                            bs::HSceneObject parent, HGameWorld gameWorld,
+                                            bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_zCVobStartpoint(const Internals::VobDescriptor& vob,
+                                                 bs::HSceneObject parent, HGameWorld gameWorld,
+                                                 bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_zCVobSpot(const Internals::VobDescriptor& vob,
+                                           bs::HSceneObject parent, HGameWorld gameWorld,
+                                           bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_oCItem(const Internals::VobDescriptor& vob,
+                                        bs::HSceneObject parent, HGameWorld gameWorld,
+                                        bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_zCVobSound(const Internals::VobDescriptor& vob,
+                                            bs::HSceneObject parent, HGameWorld gameWorld,
+                                            bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_zCVobAnimate(const Internals::VobDescriptor& vob,
+                                              bs::HSceneObject parent, HGameWorld gameWorld,
+                                              bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_oCMobInter(const Internals::VobDescriptor& vob,
+                                            bs::HSceneObject parent, HGameWorld gameWorld,
+                                            bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_oCMobContainer(const Internals::VobDescriptor& vob,
+                                                bs::HSceneObject parent, HGameWorld gameWorld,
+                                                bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_oCMobBed(const Internals::VobDescriptor& vob,
+                                          bs::HSceneObject parent, HGameWorld gameWorld,
+                                          bs::HPhysicsMesh collisionMesh);
+  static bs::HSceneObject import_oCMobDoor(const Internals::VobDescriptor& vob,
+                                           bs::HSceneObject parent, HGameWorld gameWorld,
+                                           bs::HPhysicsMesh collisionMesh);
   static void addVisualTo(bs::HSceneObject sceneObject, const bs::String& visualName);
-  static void addCollisionTo(bs::HSceneObject sceneObject);
+  static void addCollisionTo(bs::HSceneObject sceneObject, bs::HPhysicsMesh collisionMesh);
 
-  bs::HSceneObject Internals::importSingleVob(const ZenLoad::zCVobData& vob,
-                                              bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  bool Internals::describeSingleVob(const ZenLoad::zCVobData& vob, VobDescriptor& descriptor)
   {
     if (vob.objectClass == "zCVob")
     {
-      return import_zCVob(vob, bsfParent, gameWorld);
+      descriptor.kind = VobKind::Vob;
     }
     else if (vob.objectClass == "zCVobLight:zCVob")
     {
-      return import_zCVobLight(vob, bsfParent, gameWorld);
+      descriptor.kind = VobKind::Light;
     }
     else if (vob.objectClass == "zCVobStartpoint:zCVob")
     {
-      return import_zCVobStartpoint(vob, bsfParent, gameWorld);
+      descriptor.kind = VobKind::Startpoint;
     }
     else if (vob.objectClass == "zCVobSpot:zCVob")
     {
-      return import_zCVobSpot(vob, bsfParent, gameWorld);
+      descriptor.kind = VobKind::Spot;
     }
     else if (vob.objectClass == "zCVobSound:zCVob")
     {
-      return import_zCVobSound(vob, bsfParent, gameWorld);
+      descriptor.kind = VobKind::Sound;
     }
     else if (vob.objectClass == "oCItem:zCVob")
     {
-      return import_oCItem(vob, bsfParent, gameWorld);
+      if (vob.oCItem.instanceName.empty())
+      {
+        bs::gDebug().logWarning("[ImportSingleVob] Item with empty script instance: " +
+                                bs::String(vob.vobName.c_str()));
+        return false;
+      }
+
+      descriptor.kind         = VobKind::Item;
+      descriptor.itemInstance = vob.oCItem.instanceName.c_str();
     }
     else if (vob.objectClass == "zCVobAnimate:zCVob")
     {
-      return import_zCVobAnimate(vob, bsfParent, gameWorld);
+      descriptor.kind = VobKind::Animate;
     }
     // else if (vob.objectClass == "oCMobInter:oCMOB:zCVob")
     // {
-    //   return import_oCMobInter(vob, bsfParent, gameWorld);
+    //   descriptor.kind = VobKind::MobInter;
     // }
     // else if (vob.objectClass == "oCMobContainer:oCMobInter:oCMOB:zCVob")
     // {
-    //   return import_oCMobContainer(vob, bsfParent, gameWorld);
+    //   descriptor.kind = VobKind::MobContainer;
     // }
     // else if (vob.objectClass == "oCMobBed:oCMobInter:oCMOB:zCVob")
     // {
-    //   return import_oCMobBed(vob, bsfParent, gameWorld);
+    //   descriptor.kind = VobKind::MobBed;
     // }
     // else if (vob.objectClass == "oCMobDoor:oCMobInter:oCMOB:zCVob")
     // {
-    //   return import_oCMobDoor(vob, bsfParent, gameWorld);
+    //   descriptor.kind = VobKind::MobDoor;
     // }
     else
     {
       bs::gDebug().logWarning("[ImportSingleVob] Unsupported vob class: " +
                               bs::String(vob.objectClass.c_str()));
 
+      return false;
+    }
+
+    descriptor.vob  = &vob;
+    descriptor.name = vob.vobName.c_str();
+
+    bs::Matrix4 worldMatrix = convertMatrix(vob.worldMatrix);
+    descriptor.rotation.fromRotationMatrix(worldMatrix.get3x3());
+
+    bs::Vector3 positionCM = bs::Vector3(vob.position.x, vob.position.y, vob.position.z);
+
+    float centimetersToMeters = 0.01f;
+    descriptor.position       = positionCM * centimetersToMeters;
+
+    descriptor.visual = vob.visual.c_str();
+
+    // cdDyn seems to be the general "this is supposed to collide with stuff"-flag.
+    descriptor.hasCollision = vob.cdDyn;
+
+    return true;
+  }
+
+  bs::HSceneObject Internals::createSingleVob(const VobDescriptor& descriptor,
+                                              bs::HSceneObject parent, HGameWorld gameWorld,
+                                              bs::HPhysicsMesh collisionMesh)
+  {
+    switch (descriptor.kind)
+    {
+      case VobKind::Vob:
+        return import_zCVob(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::Light:
+        return import_zCVobLight(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::Startpoint:
+        return import_zCVobStartpoint(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::Spot:
+        return import_zCVobSpot(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::Sound:
+        return import_zCVobSound(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::Item:
+        return import_oCItem(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::Animate:
+        return import_zCVobAnimate(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::MobInter:
+        return import_oCMobInter(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::MobContainer:
+        return import_oCMobContainer(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::MobBed:
+        return import_oCMobBed(descriptor, parent, gameWorld, collisionMesh);
+      case VobKind::MobDoor:
+        return import_oCMobDoor(descriptor, parent, gameWorld, collisionMesh);
+      default:
+        return {};
+    }
+  }
+
+  bs::HSceneObject Internals::importSingleVob(const ZenLoad::zCVobData& vob,
+                                              bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  {
+    VobDescriptor descriptor;
+
+    if (!describeSingleVob(vob, descriptor))
+    {
       return {};
     }
+
+    return createSingleVob(descriptor, bsfParent, gameWorld);
   }
 
   /**
@@ -117,32 +196,25 @@ namespace REGoth
    * the base class of all others, so it makes sense to handle
    * position, rotation and the visual here as these are used by all vobs.
    */
-  static bs::HSceneObject import_zCVob(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                       HGameWorld gameWorld)
+  static bs::HSceneObject import_zCVob(const Internals::VobDescriptor& vob,
+                                       bs::HSceneObject parent, HGameWorld gameWorld,
+                                       bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = bs::SceneObject::create(vob.vobName.c_str());
-
-    so->setParent(gameWorld->SO());
-
-    bs::Matrix4 worldMatrix = convertMatrix(vob.worldMatrix);
-    bs::Quaternion rotation;
-    rotation.fromRotationMatrix(worldMatrix.get3x3());
+    bs::HSceneObject so = bs::SceneObject::create(vob.name);
 
-    bs::Vector3 positionCM = bs::Vector3(vob.position.x, vob.position.y, vob.position.z);
+    so->setParent(parent);
 
-    float centimetersToMeters = 0.01f;
-    so->setPosition(positionCM * centimetersToMeters);
-    so->setRotation(rotation);
+    so->setPosition(vob.position);
+    so->setRotation(vob.rotation);
 
     if (!vob.visual.empty())
     {
-      addVisualTo(so, vob.visual.c_str());
+      addVisualTo(so, vob.visual);
     }
 
-    // cdDyn seems to be the general "this is supposed to collide with stuff"-flag.
-    if (vob.cdDyn)
+    if (vob.hasCollision)
     {
-      addCollisionTo(so);
+      addCollisionTo(so, collisionMesh);
     }
 
     return so;
@@ -152,21 +224,22 @@ namespace REGoth
    * Lights can be pointlights or spotlights, altough spotlights are not
    * used within the original game as it seems.
    */
-  static bs::HSceneObject import_zCVobLight(const ZenLoad::zCVobData& vob,
-                                            bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  static bs::HSceneObject import_zCVobLight(const Internals::VobDescriptor& vob,
+                                            bs::HSceneObject parent, HGameWorld gameWorld,
+                                            bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // FIXME: Put lights back in
     return so;
 #if 0
     bs::HLight light = so->addComponent<bs::CLight>();
 
-    auto lightColor = bs::Color::fromRGBA(vob.zCVobLight.color);
+    auto lightColor = bs::Color::fromRGBA(vob.vob->zCVobLight.color);
 
     light->setType(bs::LightType::Radial);
     light->setUseAutoAttenuation(false);
-    light->setAttenuationRadius(vob.zCVobLight.range);
+    light->setAttenuationRadius(vob.vob->zCVobLight.range);
     light->setColor(lightColor);
 
     return so;
@@ -176,10 +249,11 @@ namespace REGoth
   /**
    * The startpoint of the player in the current world. There should be only one.
    */
-  static bs::HSceneObject import_zCVobStartpoint(const ZenLoad::zCVobData& vob,
-                                                 bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  static bs::HSceneObject import_zCVobStartpoint(const Internals::VobDescriptor& vob,
+                                                 bs::HSceneObject parent, HGameWorld gameWorld,
+                                                 bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // Startpoint is found by name of the scene object
     bs::gDebug().logDebug("[ImportSingleVob] Found startpoint: " + so->getName());
@@ -190,87 +264,88 @@ namespace REGoth
   /**
    * Spots like free-points.
    */
-  static bs::HSceneObject import_zCVobSpot(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                           HGameWorld gameWorld)
+  static bs::HSceneObject import_zCVobSpot(const Internals::VobDescriptor& vob,
+                                           bs::HSceneObject parent, HGameWorld gameWorld,
+                                           bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     so->addComponent<Freepoint>();
 
     return so;
   }
 
-  static bs::HSceneObject import_oCItem(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                        HGameWorld gameWorld)
+  static bs::HSceneObject import_oCItem(const Internals::VobDescriptor& vob,
+                                        bs::HSceneObject parent, HGameWorld gameWorld,
+                                        bs::HPhysicsMesh collisionMesh)
   {
-    if (vob.oCItem.instanceName.empty())
-    {
-      bs::gDebug().logWarning("[ImportSingleVob] Item with empty script instance: " +
-                              bs::String(vob.vobName.c_str()));
-      return {};
-    }
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
-
-    so->addComponent<Item>(vob.oCItem.instanceName.c_str(), gameWorld);
+    so->addComponent<Item>(vob.itemInstance, gameWorld);
 
     return so;
   }
 
-  static bs::HSceneObject import_zCVobSound(const ZenLoad::zCVobData& vob,
-                                            bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  static bs::HSceneObject import_zCVobSound(const Internals::VobDescriptor& vob,
+                                            bs::HSceneObject parent, HGameWorld gameWorld,
+                                            bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // TODO: Implement
 
     return so;
   }
 
-  static bs::HSceneObject import_zCVobAnimate(const ZenLoad::zCVobData& vob,
-                                              bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  static bs::HSceneObject import_zCVobAnimate(const Internals::VobDescriptor& vob,
+                                              bs::HSceneObject parent, HGameWorld gameWorld,
+                                              bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // TODO: Implement
 
     return so;
   }
 
-  static bs::HSceneObject import_oCMobInter(const ZenLoad::zCVobData& vob,
-                                            bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  static bs::HSceneObject import_oCMobInter(const Internals::VobDescriptor& vob,
+                                            bs::HSceneObject parent, HGameWorld gameWorld,
+                                            bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // TODO: Implement
 
     return so;
   }
 
-  static bs::HSceneObject import_oCMobContainer(const ZenLoad::zCVobData& vob,
-                                                bs::HSceneObject bsfParent, HGameWorld gameWorld)
+  static bs::HSceneObject import_oCMobContainer(const Internals::VobDescriptor& vob,
+                                                bs::HSceneObject parent, HGameWorld gameWorld,
+                                                bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // TODO: Implement
 
     return so;
   }
 
-  static bs::HSceneObject import_oCMobBed(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                          HGameWorld gameWorld)
+  static bs::HSceneObject import_oCMobBed(const Internals::VobDescriptor& vob,
+                                          bs::HSceneObject parent, HGameWorld gameWorld,
+                                          bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // TODO: Implement
 
     return so;
   }
 
-  static bs::HSceneObject import_oCMobDoor(const ZenLoad::zCVobData& vob, bs::HSceneObject bsfParent,
-                                           HGameWorld gameWorld)
+  static bs::HSceneObject import_oCMobDoor(const Internals::VobDescriptor& vob,
+                                           bs::HSceneObject parent, HGameWorld gameWorld,
+                                           bs::HPhysicsMesh collisionMesh)
   {
-    bs::HSceneObject so = import_zCVob(vob, bsfParent, gameWorld);
+    bs::HSceneObject so = import_zCVob(vob, parent, gameWorld, collisionMesh);
 
     // TODO: Implement
 
@@ -292,45 +367,26 @@ namespace REGoth
   }
 
   /**
-   * Adds a triangle physics mesh to the given scene object. Only works if the
+   * Adds a triangle physics mesh to the given scene object. If no collision mesh is given,
+   * one is created from the renderable of the scene object. That only works if the
    * scene object has a renderable with a mesh set. The mesh must also have
    * CPU-caching enabled, so we get access to the mesh data.
    */
-  static void addCollisionTo(bs::HSceneObject sceneObject)
+  static void addCollisionTo(bs::HSceneObject sceneObject, bs::HPhysicsMesh collisionMesh)
   {
-    bs::HRenderable renderable = sceneObject->getComponent<bs::CRenderable>();
-
-    if (!renderable) return;
-
-    auto mesh = renderable->getMesh();
-
-    if (!mesh) return;
-
-    auto meshData = mesh->getCachedData();
-
-    if (!meshData) return;
-
-    bs::Path physicsMeshPath = BsZenLib::GothicPathToCachedStaticMesh(mesh->getName() + ".physics");
-
-    bs::HPhysicsMesh physicsMesh;
-    if (bs::FileSystem::exists(physicsMeshPath))
-    {
-      physicsMesh = bs::gResources().load<bs::PhysicsMesh>(physicsMeshPath);
-    }
-    else
+    if (!collisionMesh)
     {
-      bs::gDebug().logDebug("[ImportSingleVob] Caching physics mesh for " + mesh->getName());
+      bs::HRenderable renderable = sceneObject->getComponent<bs::CRenderable>();
 
-      physicsMesh = bs::PhysicsMesh::create(meshData, bs::PhysicsMeshType::Triangle);
+      if (!renderable) return;
 
-      BsZenLib::AddToResourceManifest(physicsMesh, physicsMeshPath);
-      bs::gResources().save(physicsMesh, physicsMeshPath, true);
+      collisionMesh = Internals::gPhysicsMeshCache().physicsMeshFor(renderable->getMesh());
     }
 
-    if (!physicsMesh) return;
+    if (!collisionMesh) return;
 
     bs::HMeshCollider collider = sceneObject->addComponent<bs::CMeshCollider>();
-    collider->setMesh(physicsMesh);
+    collider->setMesh(collisionMesh);
   }
 
 }  // namespace REGoth
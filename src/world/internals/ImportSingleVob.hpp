@@ -4,6 +4,8 @@
 #pragma once
 
 #include <BsPrerequisites.h>
+#include <Math/BsQuaternion.h>
+#include <Math/BsVector3.h>
 
 namespace ZenLoad
 {
@@ -17,6 +19,87 @@ namespace REGoth
 
   namespace Internals
   {
+    /**
+     * Vob classes we know how to import.
+     */
+    enum class VobKind
+    {
+      Vob,
+      Light,
+      Startpoint,
+      Spot,
+      Sound,
+      Item,
+      Animate,
+      MobInter,
+      MobContainer,
+      MobBed,
+      MobDoor,
+    };
+
+    /**
+     * Everything needed to create the scene object of a single vob, extracted from the
+     * zen-file. Descriptors are plain data and can be created on any thread, while
+     * creating the actual scene object has to happen on the main thread.
+     */
+    struct VobDescriptor
+    {
+      /**
+       * Original vob data. Used for class specific information.
+       */
+      const ZenLoad::zCVobData* vob = nullptr;
+
+      VobKind kind = VobKind::Vob;
+
+      bs::String name;
+      bs::Vector3 position = bs::Vector3::ZERO;
+      bs::Quaternion rotation = bs::Quaternion::IDENTITY;
+
+      /**
+       * Name of the visual, e.g. `STONE.3DS`. Empty if the vob doesn't have one.
+       */
+      bs::String visual;
+
+      /**
+       * Whether a collision mesh should be created from the visual.
+       */
+      bool hasCollision = false;
+
+      /**
+       * Script instance of oCItem-vobs.
+       */
+      bs::String itemInstance;
+    };
+
+    /**
+     * Extracts everything needed to create a scene object for the given vob.
+     *
+     * This does not touch the scene graph and is therefore safe to be called from
+     * worker threads.
+     *
+     * @param  vob         Information from importing the zen-file.
+     * @param  descriptor  Descriptor to fill.
+     *
+     * @return Whether the vob can be imported. If not, its children should be skipped as well.
+     */
+    bool describeSingleVob(const ZenLoad::zCVobData& vob, VobDescriptor& descriptor);
+
+    /**
+     * Creates the scene object for a vob previously described via describeSingleVob().
+     *
+     * Must be called from the main thread.
+     *
+     * @param  descriptor     Description of the vob to create.
+     * @param  parent         Scene object to add the created object to.
+     * @param  gameWorld      World the object belongs to. Only needed for items.
+     * @param  collisionMesh  Collision mesh to use if the descriptor asks for collision.
+     *                        If empty, one is created from the visual.
+     *
+     * @return Scene object modeled after the vob
+     */
+    bs::HSceneObject createSingleVob(const VobDescriptor& descriptor, bs::HSceneObject parent,
+                                     HGameWorld gameWorld, bs::HPhysicsMesh collisionMesh = {});
+
     /**
      * Imports a single vob and creates a bs:f object as similar as possible.
      *
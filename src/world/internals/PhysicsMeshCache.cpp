@@ -0,0 +1,240 @@
+#include "PhysicsMeshCache.hpp"
+#include <BsZenLib/ImportPath.hpp>
+#include <BsZenLib/ResourceManifest.hpp>
+#include <FileSystem/BsFileSystem.h>
+#include <Mesh/BsMesh.h>
+#include <Mesh/BsMeshData.h>
+#include <Physics/BsPhysicsMesh.h>
+#include <RenderAPI/BsVertexDataDesc.h>
+#include <Resources/BsResources.h>
+#include <hashing/ContentHash.hpp>
+#include <threading/ParallelFor.hpp>
+
+namespace REGoth
+{
+  namespace Internals
+  {
+    bs::HPhysicsMesh PhysicsMeshCache::physicsMeshFor(const bs::HMesh& mesh)
+    {
+      if (!mesh) return {};
+
+      auto meshData = mesh->getCachedData();
+
+      if (!meshData) return {};
+
+      bs::UINT64 hash = hashMeshGeometry(*meshData);
+
+      bs::HPhysicsMesh physicsMesh = findLoaded(hash);
+
+      if (physicsMesh) return physicsMesh;
+
+      return loadOrCook(hash, meshData);
+    }
+
+    bs::Vector<bs::HPhysicsMesh> PhysicsMeshCache::physicsMeshesFor(
+        const bs::Vector<bs::HMesh>& meshes)
+    {
+      bs::Vector<bs::SPtr<bs::MeshData>> meshDatas(meshes.size());
+      bs::Vector<bs::UINT64> hashes(meshes.size());
+
+      for (size_t i = 0; i < meshes.size(); i++)
+      {
+        if (meshes[i]) meshDatas[i] = meshes[i]->getCachedData();
+      }
+
+      Threading::parallelFor("HashMeshGeometry", (bs::UINT32)meshes.size(), 16,
+                             [&](bs::UINT32 begin, bs::UINT32 end) {
+                               for (bs::UINT32 i = begin; i < end; i++)
+                               {
+                                 if (!meshDatas[i]) continue;
+
+                                 hashes[i] = hashMeshGeometry(*meshDatas[i]);
+                               }
+                             });
+
+      // Only load or cook every distinct geometry once
+      bs::Vector<bs::UINT32> toLoad;
+      bs::UnorderedMap<bs::UINT64, bs::UINT32> firstMeshWithHash;
+
+      for (bs::UINT32 i = 0; i < (bs::UINT32)meshes.size(); i++)
+      {
+        if (!meshDatas[i]) continue;
+
+        if (firstMeshWithHash.find(hashes[i]) != firstMeshWithHash.end()) continue;
+
+        firstMeshWithHash[hashes[i]] = i;
+        toLoad.push_back(i);
+      }
+
+      bs::Vector<bs::HPhysicsMesh> loaded(toLoad.size());
+
+      Threading::parallelFor("CookPhysicsMeshes", (bs::UINT32)toLoad.size(), 1,
+                             [&](bs::UINT32 begin, bs::UINT32 end) {
+                               for (bs::UINT32 i = begin; i < end; i++)
+                               {
+                                 bs::UINT32 meshIndex = toLoad[i];
+                                 bs::UINT64 hash      = hashes[meshIndex];
+
+                                 loaded[i] = findLoaded(hash);
+
+                                 if (!loaded[i])
+                                 {
+                                   loaded[i] = loadOrCook(hash, meshDatas[meshIndex]);
+                                 }
+                               }
+                             });
+
+      bs::UnorderedMap<bs::UINT64, bs::HPhysicsMesh> loadedByHash;
+
+      for (size_t i = 0; i < toLoad.size(); i++)
+      {
+        loadedByHash[hashes[toLoad[i]]] = loaded[i];
+      }
+
+      bs::Vector<bs::HPhysicsMesh> result(meshes.size());
+      bs::UINT32 numReused = 0;
+
+      for (size_t i = 0; i < meshes.size(); i++)
+      {
+        if (!meshDatas[i]) continue;
+
+        result[i] = loadedByHash[hashes[i]];
+
+        if (firstMeshWithHash[hashes[i]] != i)
+        {
+          numReused += 1;
+        }
+      }
+
+      bs::Lock lock(mMutex);
+      mStatistics.numReused += numReused;
+
+      return result;
+    }
+
+    bs::HPhysicsMesh PhysicsMeshCache::findLoaded(bs::UINT64 hash)
+    {
+      bs::Lock lock(mMutex);
+
+      auto it = mPhysicsMeshes.find(hash);
+
+      if (it == mPhysicsMeshes.end()) return {};
+
+      mStatistics.numReused += 1;
+
+      return it->second;
+    }
+
+    bs::HPhysicsMesh PhysicsMeshCache::loadOrCook(bs::UINT64 hash,
+                                                  const bs::SPtr<bs::MeshData>& meshData)
+    {
+      bs::Path path =
+          BsZenLib::GothicPathToCachedStaticMesh(Hashing::toHexString(hash) + ".physics");
+
+      bs::HPhysicsMesh physicsMesh;
+      bool hasCooked = false;
+
+      if (bs::FileSystem::exists(path))
+      {
+        physicsMesh = bs::gResources().load<bs::PhysicsMesh>(path);
+      }
+
+      if (!physicsMesh)
+      {
+        physicsMesh = bs::PhysicsMesh::create(meshData, bs::PhysicsMeshType::Triangle);
+        hasCooked   = true;
+
+        bs::Lock lock(mSaveMutex);
+
+        BsZenLib::AddToResourceManifest(physicsMesh, path);
+        bs::gResources().save(physicsMesh, path, true);
+      }
+
+      bs::Lock lock(mMutex);
+
+      if (hasCooked)
+      {
+        mStatistics.numCooked += 1;
+      }
+      else
+      {
+        mStatistics.numLoadedFromDisk += 1;
+      }
+
+      // Another thread may have been quicker with the same geometry, keep only one of them
+      auto it = mPhysicsMeshes.find(hash);
+
+      if (it != mPhysicsMeshes.end()) return it->second;
+
+      mPhysicsMeshes[hash] = physicsMesh;
+
+      return physicsMesh;
+    }
+
+    bs::UINT64 PhysicsMeshCache::hashMeshGeometry(const bs::MeshData& meshData)
+    {
+      bs::UINT64 hash = Hashing::CONTENT_HASH_SEED;
+
+      const bs::UINT8* positions = meshData.getElementData(bs::VES_POSITION);
+      bs::UINT32 stride          = meshData.getVertexDesc()->getVertexStride();
+
+      if (positions)
+      {
+        for (bs::UINT32 i = 0; i < meshData.getNumVertices(); i++)
+        {
+          hash = Hashing::contentHash(positions + i * stride, sizeof(bs::Vector3), hash);
+        }
+      }
+
+      if (meshData.getIndexType() == bs::IT_16BIT)
+      {
+        hash = Hashing::contentHash(meshData.getIndices16(),
+                                    meshData.getNumIndices() * sizeof(bs::UINT16), hash);
+      }
+      else
+      {
+        hash = Hashing::contentHash(meshData.getIndices32(),
+                                    meshData.getNumIndices() * sizeof(bs::UINT32), hash);
+      }
+
+      return hash;
+    }
+
+    void PhysicsMeshCache::clear()
+    {
+      bs::Lock lock(mMutex);
+
+      mPhysicsMeshes.clear();
+    }
+
+    PhysicsMeshCache::Statistics PhysicsMeshCache::statistics() const
+    {
+      bs::Lock lock(mMutex);
+
+      return mStatistics;
+    }
+
+    void PhysicsMeshCache::resetStatistics()
+    {
+      bs::Lock lock(mMutex);
+
+      mStatistics = Statistics();
+    }
+
+    void PhysicsMeshCache::logStatistics() const
+    {
+      Statistics stats = statistics();
+
+      bs::gDebug().logDebug(bs::StringUtil::format(
+          "[PhysicsMeshCache] {0} cooked, {1} loaded from disk, {2} reused", stats.numCooked,
+          stats.numLoadedFromDisk, stats.numReused));
+    }
+
+    PhysicsMeshCache& gPhysicsMeshCache()
+    {
+      static PhysicsMeshCache s_instance;
+
+      return s_instance;
+    }
+  }  // namespace Internals
+}  // namespace REGoth
@@ -0,0 +1,121 @@
+/** \file
+ */
+
+#pragma once
+
+#include <BsPrerequisites.h>
+
+namespace REGoth
+{
+  namespace Internals
+  {
+    /**
+     * Cache for triangle physics meshes created from render meshes.
+     *
+     * Cooking a physics mesh takes a while, so cooked meshes are stored on disk and
+     * kept in memory. Both are keyed by a hash of the vertex positions and indices of
+     * the render mesh, so meshes with identical geometry share one physics mesh, no
+     * matter what they are called. A changed mesh also gets a new physics mesh.
+     *
+     * All methods are safe to be called from multiple threads.
+     */
+    class PhysicsMeshCache
+    {
+    public:
+      /**
+       * Counters of the physics mesh cache, see statistics().
+       */
+      struct Statistics
+      {
+        /**
+         * Number of physics meshes which had to be cooked.
+         */
+        bs::UINT32 numCooked = 0;
+
+        /**
+         * Number of physics meshes which were loaded from the disk cache.
+         */
+        bs::UINT32 numLoadedFromDisk = 0;
+
+        /**
+         * Number of requests which were served by an already loaded physics mesh.
+         */
+        bs::UINT32 numReused = 0;
+      };
+
+      /**
+       * Returns the physics mesh for the given render mesh. Loads it from disk or cooks
+       * it if it is not known yet.
+       *
+       * The mesh must have CPU-caching enabled, so we get access to the mesh data.
+       *
+       * @param  mesh  Render mesh to create the physics mesh from.
+       *
+       * @return Triangle physics mesh. Empty if the mesh has no cached data.
+       */
+      bs::HPhysicsMesh physicsMeshFor(const bs::HMesh& mesh);
+
+      /**
+       * Same as physicsMeshFor(), but for a batch of meshes. Meshes which need to be
+       * loaded or cooked are processed in parallel. Identical meshes are only cooked once.
+       *
+       * @param  meshes  Render meshes to create the physics meshes from.
+       *
+       * @return Physics mesh for each of the given meshes, in the same order.
+       */
+      bs::Vector<bs::HPhysicsMesh> physicsMeshesFor(const bs::Vector<bs::HMesh>& meshes);
+
+      /**
+       * Drops all physics meshes held in memory. The disk cache is kept.
+       */
+      void clear();
+
+      /**
+       * @return Current counters of the cache.
+       */
+      Statistics statistics() const;
+
+      /**
+       * Resets the counters returned by statistics().
+       */
+      void resetStatistics();
+
+      /**
+       * Writes the current counters to the debug log.
+       */
+      void logStatistics() const;
+
+    private:
+      /**
+       * @return Hash of the vertex positions and indices of the given mesh data.
+       */
+      static bs::UINT64 hashMeshGeometry(const bs::MeshData& meshData);
+
+      /**
+       * Loads the physics mesh with the given hash from disk or cooks and caches it.
+       */
+      bs::HPhysicsMesh loadOrCook(bs::UINT64 hash, const bs::SPtr<bs::MeshData>& meshData);
+
+      /**
+       * Looks up an already loaded physics mesh. Empty handle if there is none.
+       */
+      bs::HPhysicsMesh findLoaded(bs::UINT64 hash);
+
+      bs::UnorderedMap<bs::UINT64, bs::HPhysicsMesh> mPhysicsMeshes;
+      Statistics mStatistics;
+
+      mutable bs::Mutex mMutex;
+
+      /**
+       * Saving to the disk cache modifies the resource manifest, which may only be done by
+       * one thread at a time.
+       */
+      bs::Mutex mSaveMutex;
+    };
+
+    /**
+     * Global access to the physics mesh cache.
+     */
+    PhysicsMeshCache& gPhysicsMeshCache();
+  }  // namespace Internals
+}  // namespace REGoth